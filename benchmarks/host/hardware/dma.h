@@ -0,0 +1,284 @@
+// Host build: see pico_host.h
+#include "pico_host.h"
+#include "hardware/irq.h"
+#include "hardware/spi.h"
+#include "hardware/i2c.h"
+
+#ifndef __PICO_HOST_DMA_H__
+#define __PICO_HOST_DMA_H__
+
+// Channels run synchronously as far as their DREQ allows:
+//  - unpaced and SPI TX channels run to completion when started, TX data
+//    shifting out through pico_host_spi_transmit()
+//  - SPI RX channels move frames while the SPI's RX FIFO has any
+//  - I2C TX and RX channels work the same way against hardware/i2c.h
+//  - any other DREQ (PWM wrap, timers) moves one element per
+//    pico_host_dma_dreq() call, which a simulation makes at the pace the
+//    peripheral would
+// The transfer count is a reload value copied in at each trigger, a
+// write to dma_hw->multi_channel_trigger made by a channel triggers the
+// channels it names, and completion raises DMA_IRQ_0 for channels with
+// the interrupt enabled.
+#define NUM_DMA_CHANNELS 12
+#define PICO_HOST_DREQ_FORCE 0x3f
+
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2
+};
+
+typedef struct
+{
+    uint32_t size;
+    bool read_increment;
+    bool write_increment;
+    uint dreq;
+    bool ring_write;
+    uint ring_bits;
+} dma_channel_config;
+
+// Register views for dma_channel_hw_addr(); addresses are the low 32 bits of host pointers
+typedef struct
+{
+    volatile uint32_t read_addr;
+    volatile uint32_t write_addr;
+    volatile uint32_t transfer_count;
+    volatile uint32_t ctrl_trig;
+} dma_channel_hw_t;
+
+typedef struct
+{
+    volatile uint32_t multi_channel_trigger;
+} dma_hw_t;
+
+struct pico_host_dma_channel
+{
+    dma_channel_config config;
+    const volatile void *read_addr;
+    volatile void *write_addr;
+    uint32_t reload;
+    uint32_t count;
+    bool active;
+    bool claimed;
+    bool irq0_enabled;
+    bool irq0_status;
+};
+inline pico_host_dma_channel pico_host_dma[NUM_DMA_CHANNELS];
+inline dma_channel_hw_t pico_host_dma_hw[NUM_DMA_CHANNELS];
+inline dma_hw_t pico_host_dma_regs;
+inline uint32_t pico_host_dma_transfers = 0; // Channel starts, for benchmarks
+#define dma_hw (&pico_host_dma_regs)
+
+inline int dma_claim_unused_channel(bool)
+{
+    for (int i = 0; i < NUM_DMA_CHANNELS; i++)
+    {
+        if (!pico_host_dma[i].claimed)
+        {
+            pico_host_dma[i].claimed = true;
+            return i;
+        }
+    }
+    return -1;
+}
+inline void dma_channel_unclaim(uint channel) { pico_host_dma[channel] = pico_host_dma_channel{}; }
+inline dma_channel_config dma_channel_get_default_config(uint)
+{
+    return dma_channel_config{DMA_SIZE_32, true, false, PICO_HOST_DREQ_FORCE, false, 0};
+}
+inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { c->size = size; }
+inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { c->read_increment = incr; }
+inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { c->write_increment = incr; }
+inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { c->dreq = dreq; }
+inline void channel_config_set_ring(dma_channel_config *c, bool write, uint size_bits)
+{
+    c->ring_write = write;
+    c->ring_bits = size_bits;
+}
+
+inline void dma_start_channel_mask(uint32_t mask);
+
+inline bool pico_host_dma_spi_tx(const dma_channel_config &c) { return c.dreq >= 16 && c.dreq < 20 && (c.dreq % 2) == 0; }
+inline bool pico_host_dma_spi_rx(const dma_channel_config &c) { return c.dreq >= 16 && c.dreq < 20 && (c.dreq % 2) == 1; }
+
+inline bool pico_host_dma_i2c_tx(const dma_channel_config &c) { return c.dreq >= 32 && c.dreq < 36 && (c.dreq % 2) == 0; }
+inline bool pico_host_dma_i2c_rx(const dma_channel_config &c) { return c.dreq >= 32 && c.dreq < 36 && (c.dreq % 2) == 1; }
+
+inline uintptr_t pico_host_dma_advance(uintptr_t addr, uint32_t bytes, uint ring_bits)
+{
+    if (ring_bits == 0)
+        return addr + bytes;
+    uintptr_t mask = ((uintptr_t)1 << ring_bits) - 1;
+    return (addr & ~mask) | ((addr + bytes) & mask);
+}
+
+/**
+ * @brief Move one element; false if the channel's DREQ holds it back
+ */
+inline bool pico_host_dma_step(uint channel)
+{
+    pico_host_dma_channel &ch = pico_host_dma[channel];
+    uint32_t bytes = 1u << ch.config.size;
+    bool spi_rx = pico_host_dma_spi_rx(ch.config);
+    bool i2c_rx = pico_host_dma_i2c_rx(ch.config);
+    if (spi_rx && !pico_host_spi_readable((ch.config.dreq - 16) / 2))
+        return false;
+    if (i2c_rx && !pico_host_i2c_readable((ch.config.dreq - 32) / 2))
+        return false;
+
+    uint32_t value = 0;
+    if (spi_rx)
+    {
+        value = pico_host_spi_receive((ch.config.dreq - 16) / 2);
+    }
+    else if (i2c_rx)
+    {
+        value = pico_host_i2c_receive((ch.config.dreq - 32) / 2);
+    }
+    else
+    {
+        const volatile uint8_t *read = (const volatile uint8_t *)ch.read_addr;
+        for (uint32_t b = 0; b < bytes; b++)
+            value |= (uint32_t)read[b] << (8 * b);
+    }
+
+    if (pico_host_dma_spi_tx(ch.config))
+    {
+        pico_host_spi_transmit((ch.config.dreq - 16) / 2, value);
+    }
+    else if (pico_host_dma_i2c_tx(ch.config))
+    {
+        pico_host_i2c_transmit((ch.config.dreq - 32) / 2, value);
+    }
+    else
+    {
+        volatile uint8_t *write = (volatile uint8_t *)ch.write_addr;
+        for (uint32_t b = 0; b < bytes; b++)
+            write[b] = (uint8_t)(value >> (8 * b));
+    }
+
+    if (ch.config.read_increment)
+        ch.read_addr = (const volatile void *)pico_host_dma_advance((uintptr_t)ch.read_addr, bytes,
+                                                                   ch.config.ring_write ? 0 : ch.config.ring_bits);
+    volatile void *written = ch.write_addr;
+    if (ch.config.write_increment)
+        ch.write_addr = (volatile void *)pico_host_dma_advance((uintptr_t)ch.write_addr, bytes,
+                                                               ch.config.ring_write ? ch.config.ring_bits : 0);
+
+    if (--ch.count == 0)
+    {
+        ch.active = false;
+        if (ch.irq0_enabled)
+        {
+            ch.irq0_status = true;
+            pico_host_irq_raise(DMA_IRQ_0);
+        }
+    }
+    if (pico_host_dma_i2c_tx(ch.config))
+        pico_host_i2c_deliver((ch.config.dreq - 32) / 2);
+    if (written == &pico_host_dma_regs.multi_channel_trigger)
+        dma_start_channel_mask(value);
+    return true;
+}
+
+/**
+ * @brief Run every channel its DREQ lets through until nothing moves
+ */
+inline void pico_host_dma_pump()
+{
+    bool moved = true;
+    while (moved)
+    {
+        moved = false;
+        for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+        {
+            const dma_channel_config &c = pico_host_dma[i].config;
+            bool self_paced = c.dreq == PICO_HOST_DREQ_FORCE || pico_host_dma_spi_tx(c) || pico_host_dma_spi_rx(c) ||
+                              pico_host_dma_i2c_tx(c) || pico_host_dma_i2c_rx(c);
+            if (pico_host_dma[i].active && self_paced && pico_host_dma_step(i))
+                moved = true;
+        }
+    }
+}
+
+/**
+ * @brief A peripheral asserts a DREQ once: each active channel paced by it moves one element
+ */
+inline void pico_host_dma_dreq(uint dreq)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+    {
+        if (pico_host_dma[i].active && pico_host_dma[i].config.dreq == dreq)
+            pico_host_dma_step(i);
+    }
+    pico_host_dma_pump();
+}
+
+inline void dma_start_channel_mask(uint32_t mask)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+    {
+        // Triggering a busy channel has no effect
+        if ((mask & (1u << i)) && !pico_host_dma[i].active && pico_host_dma[i].reload)
+        {
+            pico_host_dma[i].count = pico_host_dma[i].reload;
+            pico_host_dma[i].active = true;
+            pico_host_dma_transfers++;
+        }
+    }
+    pico_host_dma_pump();
+}
+inline void dma_channel_start(uint channel) { dma_start_channel_mask(1u << channel); }
+
+inline void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+                                  const volatile void *read_addr, uint transfer_count, bool trigger)
+{
+    pico_host_dma[channel].config = *config;
+    pico_host_dma[channel].write_addr = write_addr;
+    pico_host_dma[channel].read_addr = read_addr;
+    pico_host_dma[channel].reload = transfer_count;
+    if (trigger)
+        dma_channel_start(channel);
+}
+inline void dma_channel_set_read_addr(uint channel, const volatile void *addr, bool trigger)
+{
+    pico_host_dma[channel].read_addr = addr;
+    if (trigger)
+        dma_channel_start(channel);
+}
+inline void dma_channel_set_write_addr(uint channel, volatile void *addr, bool trigger)
+{
+    pico_host_dma[channel].write_addr = addr;
+    if (trigger)
+        dma_channel_start(channel);
+}
+inline void dma_channel_set_trans_count(uint channel, uint32_t count, bool trigger)
+{
+    pico_host_dma[channel].reload = count;
+    if (trigger)
+        dma_channel_start(channel);
+}
+inline void dma_channel_transfer_from_buffer_now(uint channel, const volatile void *read_addr, uint32_t transfer_count)
+{
+    pico_host_dma[channel].read_addr = read_addr;
+    dma_channel_set_trans_count(channel, transfer_count, true);
+}
+inline bool dma_channel_is_busy(uint channel) { return pico_host_dma[channel].active; }
+inline void dma_channel_abort(uint channel) { pico_host_dma[channel].active = false; }
+inline dma_channel_hw_t *dma_channel_hw_addr(uint channel)
+{
+    const pico_host_dma_channel &ch = pico_host_dma[channel];
+    dma_channel_hw_t &hw = pico_host_dma_hw[channel];
+    hw.read_addr = (uint32_t)(uintptr_t)ch.read_addr;
+    hw.write_addr = (uint32_t)(uintptr_t)ch.write_addr;
+    hw.transfer_count = ch.active ? ch.count : 0;
+    hw.ctrl_trig = ch.active ? (1u << 24) : 0; // BUSY
+    return &hw;
+}
+inline void dma_channel_set_irq0_enabled(uint channel, bool enabled) { pico_host_dma[channel].irq0_enabled = enabled; }
+inline bool dma_channel_get_irq0_status(uint channel) { return pico_host_dma[channel].irq0_status; }
+inline void dma_channel_acknowledge_irq0(uint channel) { pico_host_dma[channel].irq0_status = false; }
+
+#endif // __PICO_HOST_DMA_H__
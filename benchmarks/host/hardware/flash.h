@@ -0,0 +1,39 @@
+/**
+ * @file flash.h
+ * @brief Host stand-in for hardware/flash.h: on-board flash is a RAM array
+ *
+ * The array is mapped at XIP_BASE, so PTPicoFlashDevice reads it as it
+ * would the XIP window. Programming only clears bits, as on the chip;
+ * nothing here models timing or power loss (pt_flash_emulator.h does).
+ */
+
+#ifndef __PICO_HOST_FLASH_H__
+#define __PICO_HOST_FLASH_H__
+
+#include "pico_host.h"
+
+#include <cstring>
+
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#define FLASH_SECTOR_SIZE 4096u
+#define FLASH_PAGE_SIZE 256u
+
+inline uint8_t pico_host_flash[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)pico_host_flash)
+
+#ifndef __not_in_flash_func
+#define __not_in_flash_func(name) name
+#endif
+
+inline void flash_range_erase(uint32_t offset, size_t count)
+{
+    memset(pico_host_flash + offset, 0xFF, count);
+}
+
+inline void flash_range_program(uint32_t offset, const uint8_t *data, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        pico_host_flash[offset + i] &= data[i];
+}
+
+#endif // __PICO_HOST_FLASH_H__
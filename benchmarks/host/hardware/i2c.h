@@ -0,0 +1,257 @@
+// Host build: see pico_host.h
+#include "pico_host.h"
+#include "hardware/irq.h"
+
+#ifndef __PICO_HOST_I2C_H__
+#define __PICO_HOST_I2C_H__
+
+// Two I2C controllers working at the IC_DATA_CMD level: each command word
+// (data byte, CMD read bit, STOP, RESTART) written by the DMA model or
+// the blocking calls runs straight away against the device hooks of its
+// bus. A START (and the address byte) goes out before the first command
+// of a transaction, on RESTART and on a change of direction; bytes read
+// wait in the RX FIFO. A NACKed address raises TX_ABRT and drops every
+// command after it, as the controller holds its TX FIFO flushed until
+// IC_CLR_TX_ABRT (or IC_CLR_INTR) is read, so a DMA read waiting for
+// bytes never finishes. STOP_DET is raised at each STOP, including the
+// one after an abort. The controller's interrupt (I2C0_IRQ/I2C1_IRQ),
+// for the raised bits in IC_INTR_MASK, is delivered once the DMA has
+// queued the transaction's STOP command: on the chip the DMA fills the
+// FIFO long before the bus reaches the end of the address byte.
+#define PICO_HOST_I2C_RX_FIFO 16
+#define PICO_ERROR_GENERIC -1
+
+#define I2C_IC_DATA_CMD_CMD_BITS 0x00000100
+#define I2C_IC_DATA_CMD_STOP_BITS 0x00000200
+#define I2C_IC_DATA_CMD_RESTART_BITS 0x00000400
+
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x00000040
+#define I2C_IC_RAW_INTR_STAT_STOP_DET_BITS 0x00000200
+#define I2C_IC_INTR_MASK_M_TX_ABRT_BITS 0x00000040
+#define I2C_IC_INTR_MASK_M_STOP_DET_BITS 0x00000200
+#define I2C_IC_STATUS_TFE_BITS 0x00000004
+
+// An IC_CLR_* register: reading it clears its bits of IC_RAW_INTR_STAT
+struct pico_host_i2c_clear_register
+{
+    uint32_t bits;
+    operator uint32_t() const volatile;
+};
+
+struct i2c_hw_t
+{
+    volatile uint32_t enable;
+    volatile uint32_t tar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t intr_mask;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t status; // TFE only: commands run as they are written, the TX FIFO is always empty
+    volatile uint32_t tx_abrt_source;
+    pico_host_i2c_clear_register clr_intr{0xFFFFFFFF};
+    pico_host_i2c_clear_register clr_tx_abrt{I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS};
+    pico_host_i2c_clear_register clr_stop_det{I2C_IC_RAW_INTR_STAT_STOP_DET_BITS};
+};
+
+// A device on the bus; a null start answers every address with a NACK
+struct pico_host_i2c_device
+{
+    bool (*start)(uint8_t address, bool read); // false: NACK
+    void (*write)(uint8_t byte);
+    uint8_t (*read)();
+    void (*stop)();
+};
+
+struct i2c_inst_t
+{
+    uint index;
+    i2c_hw_t hw;
+    uint baud;
+    bool in_transaction;
+    bool reading;
+    bool nacked;        // TX FIFO held flushed after an abort
+    bool stop_queued;   // Interrupt due once the DMA step that queued the STOP is done
+    uint8_t rx_fifo[PICO_HOST_I2C_RX_FIFO];
+    uint32_t rx_head;
+    uint32_t rx_tail;
+    pico_host_i2c_device device;
+    // Bus statistics, for benchmarks
+    uint32_t transactions; // STOP-terminated transfers
+    uint32_t nacks;
+    uint64_t bits; // SCL periods: 9 per byte, one each for START, RESTART and STOP
+};
+
+inline i2c_inst_t pico_host_i2c[2] = {{0, {}, 0, false, false, false, false, {}, 0, 0, {}, 0, 0, 0},
+                                      {1, {}, 0, false, false, false, false, {}, 0, 0, {}, 0, 0, 0}};
+#define i2c0 (&pico_host_i2c[0])
+#define i2c1 (&pico_host_i2c[1])
+
+inline pico_host_i2c_clear_register::operator uint32_t() const volatile
+{
+    for (i2c_inst_t &i2c : pico_host_i2c)
+    {
+        if (this == &i2c.hw.clr_intr || this == &i2c.hw.clr_tx_abrt || this == &i2c.hw.clr_stop_det)
+        {
+            i2c.hw.raw_intr_stat &= ~bits;
+            if (bits & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+            {
+                i2c.hw.tx_abrt_source = 0;
+                i2c.nacked = false; // TX FIFO released
+            }
+        }
+    }
+    return 0;
+}
+
+inline uint i2c_init(i2c_inst_t *i2c, uint baud)
+{
+    i2c->baud = baud < 1000000 ? baud : 1000000; // Fast-mode plus
+    i2c->hw.enable = 1;
+    i2c->hw.status = I2C_IC_STATUS_TFE_BITS;
+    return i2c->baud;
+}
+inline uint i2c_get_index(const i2c_inst_t *i2c) { return i2c->index; }
+inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) { return &i2c->hw; }
+inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) { return 32 + i2c->index * 2 + (is_tx ? 0 : 1); }
+inline size_t i2c_get_read_available(i2c_inst_t *i2c) { return i2c->rx_head - i2c->rx_tail; }
+
+/**
+ * @brief Run one IC_DATA_CMD command (called by the DMA model for the TX DREQ)
+ */
+inline void pico_host_i2c_transmit(uint index, uint32_t cmd)
+{
+    i2c_inst_t &i2c = pico_host_i2c[index & 1];
+    bool read = cmd & I2C_IC_DATA_CMD_CMD_BITS;
+    bool stop = cmd & I2C_IC_DATA_CMD_STOP_BITS;
+
+    if (i2c.nacked)
+    {
+        // Flushed after the abort until the abort is cleared
+        i2c.stop_queued |= stop;
+        return;
+    }
+
+    if (!i2c.in_transaction || (cmd & I2C_IC_DATA_CMD_RESTART_BITS) || read != i2c.reading)
+    {
+        i2c.bits += 1 + 9;
+        i2c.in_transaction = true;
+        i2c.reading = read;
+        bool ack = i2c.device.start && i2c.device.start((uint8_t)(i2c.hw.tar & 0x7F), read);
+        if (!ack)
+        {
+            i2c.nacks++;
+            i2c.hw.tx_abrt_source = 1; // ABRT_7B_ADDR_NOACK
+            i2c.hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS | I2C_IC_RAW_INTR_STAT_STOP_DET_BITS;
+            i2c.nacked = true;
+            i2c.stop_queued |= stop;
+            i2c.in_transaction = false;
+            i2c.bits += 1;
+            i2c.transactions++;
+            return;
+        }
+    }
+
+    i2c.bits += 9;
+    if (read)
+    {
+        uint8_t byte = i2c.device.read ? i2c.device.read() : 0xFF;
+        if (i2c.rx_head - i2c.rx_tail < PICO_HOST_I2C_RX_FIFO)
+            i2c.rx_fifo[i2c.rx_head++ % PICO_HOST_I2C_RX_FIFO] = byte;
+    }
+    else if (i2c.device.write)
+    {
+        i2c.device.write((uint8_t)cmd);
+    }
+
+    if (stop)
+    {
+        if (i2c.device.stop)
+            i2c.device.stop();
+        i2c.in_transaction = false;
+        i2c.hw.raw_intr_stat |= I2C_IC_RAW_INTR_STAT_STOP_DET_BITS;
+        i2c.stop_queued = true;
+        i2c.bits += 1;
+        i2c.transactions++;
+    }
+}
+
+/**
+ * @brief Raise the controller's interrupt if a STOP was queued and a masked bit is up
+ *        (called by the DMA model after each I2C TX step)
+ */
+inline void pico_host_i2c_deliver(uint index)
+{
+    i2c_inst_t &i2c = pico_host_i2c[index & 1];
+    if (!i2c.stop_queued)
+        return;
+    i2c.stop_queued = false;
+    if (i2c.hw.raw_intr_stat & i2c.hw.intr_mask)
+        pico_host_irq_raise(i2c.index ? I2C1_IRQ : I2C0_IRQ);
+}
+
+inline bool pico_host_i2c_readable(uint index)
+{
+    const i2c_inst_t &i2c = pico_host_i2c[index & 1];
+    return i2c.rx_head != i2c.rx_tail;
+}
+
+/**
+ * @brief Pop one received byte (called by the DMA model for the RX DREQ)
+ */
+inline uint32_t pico_host_i2c_receive(uint index)
+{
+    i2c_inst_t &i2c = pico_host_i2c[index & 1];
+    if (i2c.rx_head == i2c.rx_tail)
+        return 0;
+    return i2c.rx_fifo[i2c.rx_tail++ % PICO_HOST_I2C_RX_FIFO];
+}
+
+inline void i2c_read_raw_blocking(i2c_inst_t *i2c, uint8_t *dst, size_t len)
+{
+    for (size_t i = 0; i < len; i++)
+        dst[i] = (uint8_t)pico_host_i2c_receive(i2c->index);
+}
+
+inline int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    i2c->hw.tar = addr;
+    uint32_t nacks = i2c->nacks;
+    for (size_t i = 0; i < len; i++)
+    {
+        uint32_t cmd = src[i];
+        if (i + 1 == len && !nostop)
+            cmd |= I2C_IC_DATA_CMD_STOP_BITS;
+        pico_host_i2c_transmit(i2c->index, cmd);
+        if (i2c->nacks != nacks)
+        {
+            (void)(uint32_t)i2c->hw.clr_tx_abrt;
+            i2c->stop_queued = false;
+            return PICO_ERROR_GENERIC;
+        }
+    }
+    i2c->stop_queued = false;
+    return (int)len;
+}
+
+inline int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    i2c->hw.tar = addr;
+    uint32_t nacks = i2c->nacks;
+    for (size_t i = 0; i < len; i++)
+    {
+        uint32_t cmd = I2C_IC_DATA_CMD_CMD_BITS;
+        if (i + 1 == len && !nostop)
+            cmd |= I2C_IC_DATA_CMD_STOP_BITS;
+        pico_host_i2c_transmit(i2c->index, cmd);
+        if (i2c->nacks != nacks)
+        {
+            (void)(uint32_t)i2c->hw.clr_tx_abrt;
+            i2c->stop_queued = false;
+            return PICO_ERROR_GENERIC;
+        }
+    }
+    i2c->stop_queued = false;
+    i2c_read_raw_blocking(i2c, dst, len);
+    return (int)len;
+}
+
+#endif // __PICO_HOST_I2C_H__
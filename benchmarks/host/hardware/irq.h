@@ -0,0 +1,49 @@
+// Host build: see pico_host.h
+#include "pico_host.h"
+
+#ifndef __PICO_HOST_IRQ_H__
+#define __PICO_HOST_IRQ_H__
+
+// Shared handlers run synchronously from pico_host_irq_raise(), or from
+// pico_host_advance() for ADC conversions
+enum
+{
+    DMA_IRQ_0 = 11,
+    DMA_IRQ_1 = 12,
+    ADC_IRQ_FIFO = 22,
+    I2C0_IRQ = 23,
+    I2C1_IRQ = 24
+};
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+typedef void (*irq_handler_t)(void);
+
+inline irq_handler_t pico_host_irq_handlers[32][4];
+inline bool pico_host_irq_enabled[32];
+
+inline void pico_host_irq_raise(uint num)
+{
+    if (!pico_host_irq_enabled[num % 32])
+        return;
+    for (irq_handler_t handler : pico_host_irq_handlers[num % 32])
+    {
+        if (handler)
+            handler();
+    }
+}
+
+inline void irq_add_shared_handler(uint num, irq_handler_t handler, uint8_t)
+{
+    pico_host_irq_dispatch = pico_host_irq_raise; // Lets pico_host_advance() raise completions
+    for (irq_handler_t &slot : pico_host_irq_handlers[num % 32])
+    {
+        if (!slot)
+        {
+            slot = handler;
+            return;
+        }
+    }
+}
+inline void irq_set_enabled(uint num, bool enabled) { pico_host_irq_enabled[num % 32] = enabled; }
+
+#endif // __PICO_HOST_IRQ_H__
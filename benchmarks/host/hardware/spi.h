@@ -0,0 +1,105 @@
+// Host build: see pico_host.h
+#include "pico_host.h"
+
+#ifndef __PICO_HOST_SPI_H__
+#define __PICO_HOST_SPI_H__
+
+// Two SPI instances; every frame written to the data register is passed to
+// pico_host_spi_frame_hook, so a test can record the bus. The frame
+// clocked back in comes from pico_host_spi_device_hook (0 without one)
+// and waits in the RX FIFO for the DMA model.
+#define PICO_HOST_SPI_RX_FIFO 64
+
+struct spi_hw_t
+{
+    volatile uint32_t dr;
+};
+
+struct spi_inst_t
+{
+    uint index;
+    spi_hw_t hw;
+    uint baud;
+    uint data_bits;
+    uint cpol;
+    uint cpha;
+    uint32_t rx_fifo[PICO_HOST_SPI_RX_FIFO];
+    uint32_t rx_head;
+    uint32_t rx_tail;
+    uint32_t rx_overruns; // Frames lost to a full RX FIFO
+};
+
+inline spi_inst_t pico_host_spi[2] = {{0, {0}, 0, 8, 0, 0, {}, 0, 0, 0}, {1, {0}, 0, 8, 0, 0, {}, 0, 0, 0}};
+#define spi0 (&pico_host_spi[0])
+#define spi1 (&pico_host_spi[1])
+
+typedef enum
+{
+    SPI_CPOL_0 = 0,
+    SPI_CPOL_1 = 1
+} spi_cpol_t;
+typedef enum
+{
+    SPI_CPHA_0 = 0,
+    SPI_CPHA_1 = 1
+} spi_cpha_t;
+typedef enum
+{
+    SPI_LSB_FIRST = 0,
+    SPI_MSB_FIRST = 1
+} spi_order_t;
+
+inline void (*pico_host_spi_frame_hook)(uint spi_index, uint bits, uint32_t value) = nullptr;
+inline uint32_t (*pico_host_spi_device_hook)(uint spi_index, uint bits, uint32_t mosi) = nullptr;
+
+inline uint spi_init(spi_inst_t *spi, uint baud)
+{
+    spi->baud = baud < 62500000 ? baud : 62500000; // clk_peri / 2
+    return spi->baud;
+}
+inline void spi_set_format(spi_inst_t *spi, uint data_bits, spi_cpol_t cpol, spi_cpha_t cpha, spi_order_t)
+{
+    spi->data_bits = data_bits;
+    spi->cpol = cpol;
+    spi->cpha = cpha;
+}
+inline uint spi_get_index(const spi_inst_t *spi) { return spi->index; }
+inline spi_hw_t *spi_get_hw(spi_inst_t *spi) { return &spi->hw; }
+inline uint spi_get_dreq(spi_inst_t *spi, bool is_tx) { return 16 + spi->index * 2 + (is_tx ? 0 : 1); }
+
+/**
+ * @brief Shift one frame out (called by the DMA model for the TX DREQ)
+ */
+inline void pico_host_spi_transmit(uint index, uint32_t value)
+{
+    spi_inst_t &spi = pico_host_spi[index & 1];
+    uint32_t mask = spi.data_bits >= 32 ? 0xFFFFFFFFu : (1u << spi.data_bits) - 1;
+    spi.hw.dr = value & mask;
+    if (pico_host_spi_frame_hook)
+        pico_host_spi_frame_hook(index, spi.data_bits, value & mask);
+
+    uint32_t miso = pico_host_spi_device_hook ? pico_host_spi_device_hook(index, spi.data_bits, value & mask) & mask : 0;
+    if (spi.rx_head - spi.rx_tail < PICO_HOST_SPI_RX_FIFO)
+        spi.rx_fifo[spi.rx_head++ % PICO_HOST_SPI_RX_FIFO] = miso;
+    else
+        spi.rx_overruns++;
+}
+
+inline bool pico_host_spi_readable(uint index)
+{
+    const spi_inst_t &spi = pico_host_spi[index & 1];
+    return spi.rx_head != spi.rx_tail;
+}
+
+/**
+ * @brief Pop one received frame (called by the DMA model for the RX DREQ)
+ */
+inline uint32_t pico_host_spi_receive(uint index)
+{
+    spi_inst_t &spi = pico_host_spi[index & 1];
+    if (spi.rx_head == spi.rx_tail)
+        return 0;
+    return spi.rx_fifo[spi.rx_tail++ % PICO_HOST_SPI_RX_FIFO];
+}
+
+#endif // __PICO_HOST_SPI_H__
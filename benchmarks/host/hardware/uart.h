@@ -0,0 +1,48 @@
+// Host build: see pico_host.h
+#include "pico_host.h"
+#include "hardware/dma.h"
+
+#ifndef __PICO_HOST_UART_H__
+#define __PICO_HOST_UART_H__
+
+// Two UART instances. A simulation delivers received bytes with
+// pico_host_uart_receive(), which puts each in the data register and
+// asserts the RX DREQ once, so a DMA channel paced by it takes it as on
+// the chip; with no channel waiting the byte is simply overwritten, like
+// a full FIFO. Transmit pacing is not modelled.
+struct uart_hw_t
+{
+    volatile uint32_t dr;
+};
+
+struct uart_inst_t
+{
+    uint index;
+    uart_hw_t hw;
+    uint baud;
+};
+
+inline uart_inst_t pico_host_uart[2] = {{0, {0}, 0}, {1, {0}, 0}};
+#define uart0 (&pico_host_uart[0])
+#define uart1 (&pico_host_uart[1])
+
+inline uint uart_init(uart_inst_t *uart, uint baud)
+{
+    uart->baud = baud;
+    return baud;
+}
+inline void uart_set_fifo_enabled(uart_inst_t *, bool) {}
+inline uint uart_get_index(const uart_inst_t *uart) { return uart->index; }
+inline uart_hw_t *uart_get_hw(uart_inst_t *uart) { return &uart->hw; }
+inline uint uart_get_dreq(uart_inst_t *uart, bool is_tx) { return 20 + uart->index * 2 + (is_tx ? 0 : 1); }
+
+/**
+ * @brief A byte arrives on the RX pin
+ */
+inline void pico_host_uart_receive(uart_inst_t *uart, uint8_t byte)
+{
+    uart->hw.dr = byte;
+    pico_host_dma_dreq(uart_get_dreq(uart, false));
+}
+
+#endif // __PICO_HOST_UART_H__
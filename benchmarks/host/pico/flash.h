@@ -0,0 +1,24 @@
+/**
+ * @file flash.h
+ * @brief Host stand-in for pico/flash.h: flash_safe_execute() just runs the function
+ *
+ * There is no other core executing from flash on the host, so nothing
+ * needs to be parked.
+ */
+
+#ifndef __PICO_HOST_PICO_FLASH_H__
+#define __PICO_HOST_PICO_FLASH_H__
+
+#include "pico_host.h"
+
+#ifndef PICO_OK
+#define PICO_OK 0
+#endif
+
+inline int flash_safe_execute(void (*func)(void *), void *param, uint32_t)
+{
+    func(param);
+    return PICO_OK;
+}
+
+#endif // __PICO_HOST_PICO_FLASH_H__
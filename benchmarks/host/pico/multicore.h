@@ -0,0 +1,114 @@
+/**
+ * @file multicore.h
+ * @brief Host stand-in for pico/multicore.h: core 1 is a std::thread
+ *
+ * Each direction of the SIO FIFO is an 8-word queue. WFE sleeps until
+ * an SEV from either core, keeping the per-core event latch of the M0+,
+ * and gives up after a millisecond like a stray interrupt would.
+ */
+
+#ifndef __PICO_HOST_MULTICORE_H__
+#define __PICO_HOST_MULTICORE_H__
+
+#include "pico_host.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+inline thread_local uint pico_host_core = 0;
+inline uint get_core_num() { return pico_host_core; }
+
+// Events (SEV/WFE)
+inline std::mutex pico_host_event_lock;
+inline std::condition_variable pico_host_event;
+inline uint32_t pico_host_event_count = 0;
+inline thread_local uint32_t pico_host_event_seen = 0;
+
+inline void __sev()
+{
+    {
+        std::lock_guard<std::mutex> lock(pico_host_event_lock);
+        pico_host_event_count++;
+    }
+    pico_host_event.notify_all();
+}
+
+inline void __wfe()
+{
+    std::unique_lock<std::mutex> lock(pico_host_event_lock);
+    pico_host_event.wait_for(lock, std::chrono::milliseconds(1), []
+                             { return pico_host_event_count != pico_host_event_seen; });
+    pico_host_event_seen = pico_host_event_count;
+}
+
+// SIO FIFO, indexed by the receiving core
+inline std::mutex pico_host_fifo_lock;
+inline std::deque<uint32_t> pico_host_fifo[2];
+static const size_t PICO_HOST_FIFO_DEPTH = 8;
+
+inline bool multicore_fifo_rvalid()
+{
+    std::lock_guard<std::mutex> lock(pico_host_fifo_lock);
+    return !pico_host_fifo[get_core_num()].empty();
+}
+
+inline bool multicore_fifo_wready()
+{
+    std::lock_guard<std::mutex> lock(pico_host_fifo_lock);
+    return pico_host_fifo[get_core_num() ^ 1].size() < PICO_HOST_FIFO_DEPTH;
+}
+
+inline void multicore_fifo_push_blocking(uint32_t data)
+{
+    while (!multicore_fifo_wready())
+    {
+    }
+    {
+        std::lock_guard<std::mutex> lock(pico_host_fifo_lock);
+        pico_host_fifo[get_core_num() ^ 1].push_back(data);
+    }
+    __sev();
+}
+
+inline uint32_t multicore_fifo_pop_blocking()
+{
+    while (!multicore_fifo_rvalid())
+    {
+        __wfe();
+    }
+    std::lock_guard<std::mutex> lock(pico_host_fifo_lock);
+    uint32_t data = pico_host_fifo[get_core_num()].front();
+    pico_host_fifo[get_core_num()].pop_front();
+    return data;
+}
+
+inline void multicore_fifo_drain()
+{
+    std::lock_guard<std::mutex> lock(pico_host_fifo_lock);
+    pico_host_fifo[get_core_num()].clear();
+}
+
+// Core 1
+inline std::thread pico_host_core1;
+
+inline void multicore_launch_core1(void (*entry)(void))
+{
+    pico_host_core1 = std::thread([entry]()
+                                  {
+        pico_host_core = 1;
+        entry(); });
+}
+
+/**
+ * @brief Wait for core 1's entry function to return (host only)
+ */
+inline void pico_host_join_core1()
+{
+    if (pico_host_core1.joinable())
+        pico_host_core1.join();
+}
+
+#endif // __PICO_HOST_MULTICORE_H__
@@ -0,0 +1,439 @@
+/**
+ * @file pico_host.h
+ * @brief Minimal host implementation of the Pico SDK calls used by the framework
+ *
+ * Lets the framework headers compile and run on a desktop machine for
+ * benchmarking and simulation. Time comes from the host's steady clock
+ * (or a virtual clock, see pico_host_virtual_time), interrupts are
+ * no-ops, and GPIO/ADC/PWM/watchdog state lives in plain variables that
+ * a benchmark can drive (e.g. pico_host_gpio_levels to simulate encoder edges,
+ * or pico_host_gpio_drive() to also raise the GPIO edge interrupt, and
+ * pico_host_pwm_run() to clock the PWM slices). SPI, I2C, UART, DMA and
+ * flash live in hardware/spi.h, hardware/i2c.h, hardware/uart.h,
+ * hardware/dma.h and hardware/flash.h.
+ */
+
+#ifndef __PICO_HOST_H__
+#define __PICO_HOST_H__
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define PICO_ON_DEVICE 0
+#define PICO_DEFAULT_LED_PIN 25
+#define NUM_BANK0_GPIOS 30
+
+// Simulated peripheral state
+inline uint32_t pico_host_gpio_levels; // Bit per GPIO, like the SIO GPIO_IN register
+inline uint16_t pico_host_adc_value = 2048;
+inline uint16_t pico_host_pwm_level[16];
+
+// Time: the host's steady clock, or a virtual clock that only moves when
+// a simulation advances pico_host_time_us
+inline bool pico_host_virtual_time = false;
+inline uint64_t pico_host_time_us = 0;
+
+inline uint64_t time_us_64()
+{
+    if (pico_host_virtual_time)
+        return pico_host_time_us;
+
+    static const auto boot = std::chrono::steady_clock::now();
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - boot).count();
+}
+inline uint32_t time_us_32() { return (uint32_t)time_us_64(); }
+inline absolute_time_t get_absolute_time() { return time_us_64(); }
+inline int64_t absolute_time_diff_us(absolute_time_t from, absolute_time_t to) { return (int64_t)(to - from); }
+inline uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000); }
+inline void sleep_us(uint64_t us)
+{
+    uint64_t end = time_us_64() + us;
+    while (time_us_64() < end)
+    {
+    }
+}
+inline void sleep_ms(uint32_t ms) { sleep_us((uint64_t)ms * 1000); }
+inline void busy_wait_at_least_cycles(uint32_t) {}
+
+// Clocks
+enum clock_index
+{
+    clk_sys = 5
+};
+inline uint32_t clock_get_hz(enum clock_index) { return 125000000; }
+inline void tight_loop_contents() {}
+inline bool stdio_init_all() { return true; }
+
+// Interrupts
+inline uint32_t save_and_disable_interrupts() { return 0; }
+inline void restore_interrupts(uint32_t) {}
+#define __compiler_memory_barrier() __asm__ volatile("" : : : "memory")
+
+// Repeating timers: registered here and fired by pico_host_advance() in virtual time
+typedef struct repeating_timer repeating_timer_t;
+typedef bool (*repeating_timer_callback_t)(repeating_timer_t *rt);
+struct repeating_timer
+{
+    int64_t delay_us;
+    repeating_timer_callback_t callback;
+    void *user_data;
+    uint64_t next_us;
+};
+inline repeating_timer_t *pico_host_timers[8];
+inline size_t pico_host_timer_count = 0;
+
+inline bool add_repeating_timer_us(int64_t delay_us, repeating_timer_callback_t callback, void *user_data,
+                                   repeating_timer_t *out)
+{
+    if (pico_host_timer_count >= 8)
+        return false;
+    uint64_t period = (uint64_t)(delay_us < 0 ? -delay_us : delay_us);
+    *out = repeating_timer_t{delay_us, callback, user_data, time_us_64() + period};
+    pico_host_timers[pico_host_timer_count++] = out;
+    return true;
+}
+inline bool cancel_repeating_timer(repeating_timer_t *rt)
+{
+    for (size_t i = 0; i < pico_host_timer_count; i++)
+    {
+        if (pico_host_timers[i] == rt)
+        {
+            pico_host_timers[i] = pico_host_timers[--pico_host_timer_count];
+            return true;
+        }
+    }
+    return false;
+}
+
+// ADC: conversions return pico_host_adc_value, or what pico_host_adc_hook
+// makes of the selected input (e.g. a model of the circuit in front of it).
+// adc_read() converts on the spot. A conversion started by setting
+// ADC_CS_START_ONCE_BITS samples the input when it starts, as the SAR
+// does, and lands in the FIFO PICO_HOST_ADC_CONVERSION_US later in
+// virtual time, raising ADC_IRQ_FIFO (hardware/irq.h) if enabled.
+#define PICO_HOST_ADC_CONVERSION_US 2
+#define ADC_CS_START_ONCE_BITS 0x4u
+#define ADC_CS_READY_BITS 0x100u
+
+struct pico_host_adc_hw
+{
+    volatile uint32_t cs;
+};
+inline pico_host_adc_hw pico_host_adc_regs;
+#define adc_hw (&pico_host_adc_regs)
+
+inline uint pico_host_adc_input = 0;
+inline uint16_t (*pico_host_adc_hook)(uint input) = nullptr;
+inline uint16_t pico_host_adc_fifo[4];
+inline uint pico_host_adc_fifo_count = 0;
+inline bool pico_host_adc_fifo_enabled = false;
+inline bool pico_host_adc_irq_enabled = false;
+inline uint16_t pico_host_adc_sample = 0;                 // Taken when the conversion started
+inline uint64_t pico_host_adc_done_us = UINT64_MAX;       // Conversion in flight until then
+inline void (*pico_host_irq_dispatch)(uint num) = nullptr; // Set by hardware/irq.h
+inline uint32_t pico_host_adc_conversions = 0;             // FIFO conversions, for benchmarks
+
+inline void hw_set_bits(volatile uint32_t *addr, uint32_t mask) { *addr |= mask; }
+inline void hw_clear_bits(volatile uint32_t *addr, uint32_t mask) { *addr &= ~mask; }
+
+inline uint16_t pico_host_adc_convert()
+{
+    return pico_host_adc_hook ? pico_host_adc_hook(pico_host_adc_input) : pico_host_adc_value;
+}
+
+/**
+ * @brief Start a conversion requested through adc_hw->cs
+ */
+inline void pico_host_adc_poll()
+{
+    if ((adc_hw->cs & ADC_CS_START_ONCE_BITS) && pico_host_adc_done_us == UINT64_MAX)
+    {
+        adc_hw->cs &= ~(ADC_CS_START_ONCE_BITS | ADC_CS_READY_BITS);
+        pico_host_adc_sample = pico_host_adc_convert();
+        pico_host_adc_done_us = pico_host_time_us + PICO_HOST_ADC_CONVERSION_US;
+    }
+}
+
+inline void pico_host_adc_complete()
+{
+    pico_host_adc_done_us = UINT64_MAX;
+    adc_hw->cs |= ADC_CS_READY_BITS;
+    if (!pico_host_adc_fifo_enabled)
+        return;
+    pico_host_adc_conversions++;
+    if (pico_host_adc_fifo_count < 4)
+        pico_host_adc_fifo[pico_host_adc_fifo_count++] = pico_host_adc_sample;
+    if (pico_host_adc_irq_enabled && pico_host_irq_dispatch)
+        pico_host_irq_dispatch(22); // ADC_IRQ_FIFO
+}
+
+/**
+ * @brief Move the virtual clock forward, firing repeating timers and ADC conversions as they fall due
+ *
+ * As in the SDK, a timer callback may change rt->delay_us to set the
+ * period up to its next run.
+ */
+inline void pico_host_advance(uint64_t us)
+{
+    uint64_t end = pico_host_time_us + us;
+    while (true)
+    {
+        pico_host_adc_poll();
+
+        repeating_timer_t *due = nullptr;
+        for (size_t i = 0; i < pico_host_timer_count; i++)
+        {
+            if (pico_host_timers[i]->next_us <= end && (!due || pico_host_timers[i]->next_us < due->next_us))
+                due = pico_host_timers[i];
+        }
+
+        if (pico_host_adc_done_us <= end && (!due || pico_host_adc_done_us <= due->next_us))
+        {
+            if (pico_host_adc_done_us > pico_host_time_us)
+                pico_host_time_us = pico_host_adc_done_us;
+            pico_host_adc_complete();
+            continue;
+        }
+        if (!due)
+            break;
+
+        if (due->next_us > pico_host_time_us)
+            pico_host_time_us = due->next_us;
+        if (due->callback(due))
+            due->next_us += (uint64_t)(due->delay_us < 0 ? -due->delay_us : due->delay_us);
+        else
+            cancel_repeating_timer(due);
+    }
+    pico_host_time_us = end;
+}
+
+// Watchdog registers; a simulation decides when the watchdog would expire
+struct pico_host_watchdog_hw
+{
+    uint32_t load;
+    uint32_t scratch[8];
+};
+inline pico_host_watchdog_hw pico_host_watchdog;
+inline pico_host_watchdog_hw *const watchdog_hw = &pico_host_watchdog;
+inline bool pico_host_watchdog_rebooted = false;
+
+inline void watchdog_enable(uint32_t, bool) {}
+inline void watchdog_update() {}
+inline bool watchdog_caused_reboot() { return pico_host_watchdog_rebooted; }
+
+// GPIO
+enum gpio_function
+{
+    GPIO_FUNC_SPI = 1,
+    GPIO_FUNC_UART = 2,
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_SIO = 5,
+    GPIO_FUNC_PWM = 4,
+    GPIO_FUNC_NULL = 0x1f
+};
+enum gpio_irq_level
+{
+    GPIO_IRQ_LEVEL_LOW = 0x1u,
+    GPIO_IRQ_LEVEL_HIGH = 0x2u,
+    GPIO_IRQ_EDGE_FALL = 0x4u,
+    GPIO_IRQ_EDGE_RISE = 0x8u
+};
+#define GPIO_OUT 1
+#define GPIO_IN 0
+typedef void (*gpio_irq_callback_t)(uint gpio, uint32_t event_mask);
+
+// Called on every gpio_put, e.g. to put chip selects and LDAC on a recorded timeline
+inline void (*pico_host_gpio_put_hook)(uint gpio, bool value) = nullptr;
+// Called on every gpio_put_masked/gpio_set_mask/gpio_clr_mask, e.g. to follow a mux address bus
+inline void (*pico_host_gpio_masked_hook)(uint32_t mask, uint32_t value) = nullptr;
+
+inline void gpio_init(uint) {}
+inline void gpio_set_dir(uint, bool) {}
+inline void gpio_put(uint gpio, bool value)
+{
+    uint32_t bit = 1u << (gpio % NUM_BANK0_GPIOS);
+    pico_host_gpio_levels = value ? (pico_host_gpio_levels | bit) : (pico_host_gpio_levels & ~bit);
+    if (pico_host_gpio_put_hook)
+        pico_host_gpio_put_hook(gpio, value);
+}
+inline void gpio_put_masked(uint32_t mask, uint32_t value)
+{
+    pico_host_gpio_levels = (pico_host_gpio_levels & ~mask) | (value & mask);
+    if (pico_host_gpio_masked_hook)
+        pico_host_gpio_masked_hook(mask, value & mask);
+}
+inline void gpio_set_mask(uint32_t mask) { gpio_put_masked(mask, mask); }
+inline void gpio_clr_mask(uint32_t mask) { gpio_put_masked(mask, 0); }
+inline void gpio_init_mask(uint32_t) {}
+inline void gpio_set_dir_out_masked(uint32_t) {}
+inline void gpio_pull_up(uint gpio) { gpio_put(gpio, true); }
+inline void gpio_pull_down(uint gpio) { gpio_put(gpio, false); }
+inline void gpio_set_function(uint, gpio_function) {}
+inline bool gpio_get(uint gpio) { return (pico_host_gpio_levels >> (gpio % NUM_BANK0_GPIOS)) & 1; }
+inline uint32_t gpio_get_all() { return pico_host_gpio_levels; }
+
+// Edge interrupts: one callback for all pins, as on the target
+inline gpio_irq_callback_t pico_host_gpio_callback = nullptr;
+inline uint32_t pico_host_gpio_irq_events[NUM_BANK0_GPIOS];
+
+inline void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled)
+{
+    uint32_t &mask = pico_host_gpio_irq_events[gpio % NUM_BANK0_GPIOS];
+    mask = enabled ? (mask | events) : (mask & ~events);
+}
+inline void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t events, bool enabled, gpio_irq_callback_t callback)
+{
+    gpio_set_irq_enabled(gpio, events, enabled);
+    if (enabled)
+        pico_host_gpio_callback = callback;
+}
+
+/**
+ * @brief Drive an input pin from outside, raising its edge interrupt if enabled
+ */
+inline void pico_host_gpio_drive(uint gpio, bool level)
+{
+    gpio %= NUM_BANK0_GPIOS;
+    if (gpio_get(gpio) == level)
+        return;
+    gpio_put(gpio, level);
+    uint32_t event = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+    if ((pico_host_gpio_irq_events[gpio] & event) && pico_host_gpio_callback)
+        pico_host_gpio_callback(gpio, event);
+}
+
+// ADC (state and conversion model above pico_host_advance())
+inline void adc_init() {}
+inline void adc_gpio_init(uint) {}
+inline void adc_select_input(uint input) { pico_host_adc_input = input; }
+inline uint16_t adc_read() { return pico_host_adc_convert(); }
+inline void adc_fifo_setup(bool en, bool, uint16_t, bool, bool) { pico_host_adc_fifo_enabled = en; }
+inline void adc_irq_set_enabled(bool enabled) { pico_host_adc_irq_enabled = enabled; }
+inline bool adc_fifo_is_empty() { return pico_host_adc_fifo_count == 0; }
+inline uint16_t adc_fifo_get()
+{
+    if (pico_host_adc_fifo_count == 0)
+        return 0;
+    uint16_t sample = pico_host_adc_fifo[0];
+    for (uint i = 1; i < pico_host_adc_fifo_count; i++)
+        pico_host_adc_fifo[i - 1] = pico_host_adc_fifo[i];
+    pico_host_adc_fifo_count--;
+    return sample;
+}
+inline void adc_fifo_drain() { pico_host_adc_fifo_count = 0; }
+
+// PWM: slices count virtual system clock cycles moved by pico_host_pwm_run(),
+// separate from the microsecond clock. As on the chip, CC is double-buffered:
+// a slice takes the levels written to it at its next wrap, and
+// pico_host_pwm_wrap_hook sees each wrap with the levels taking effect.
+#define NUM_PWM_SLICES 8
+
+typedef struct
+{
+    uint32_t csr;
+    uint32_t div;
+    uint32_t top;
+} pwm_config;
+
+typedef struct
+{
+    volatile uint32_t csr;
+    volatile uint32_t div; // 8.4 fixed point
+    volatile uint32_t ctr;
+    volatile uint32_t cc; // B << 16 | A, as written
+    volatile uint32_t top;
+} pwm_slice_hw_t;
+
+typedef struct
+{
+    pwm_slice_hw_t slice[NUM_PWM_SLICES];
+    volatile uint32_t en;
+} pwm_hw_t;
+
+inline pwm_hw_t pico_host_pwm_regs;
+#define pwm_hw (&pico_host_pwm_regs)
+
+inline uint32_t pico_host_pwm_active[NUM_PWM_SLICES]; // CC in effect this period
+inline uint32_t pico_host_pwm_wraps[NUM_PWM_SLICES];
+inline uint32_t pico_host_pwm_frac[NUM_PWM_SLICES]; // Sixteenths of a cycle left over by the divider
+inline uint32_t pico_host_pwm_cc_writes = 0;        // Register stores to CC, for benchmarks
+inline void (*pico_host_pwm_wrap_hook)(uint slice, uint32_t cc) = nullptr;
+inline uint32_t pico_host_pwm_store_cycles = 0; // Cycles enabled slices run during a pwm_set_counter() store
+
+inline pwm_config pwm_get_default_config() { return pwm_config{0, 16, 0xFFFF}; }
+inline void pwm_config_set_clkdiv(pwm_config *c, float div) { c->div = (uint32_t)(div * 16); }
+inline void pwm_config_set_clkdiv_int(pwm_config *c, uint div) { c->div = div << 4; }
+inline void pwm_config_set_output_polarity(pwm_config *c, bool a, bool b) { c->csr = (c->csr & ~0xCu) | (a ? 4u : 0u) | (b ? 8u : 0u); }
+inline void pwm_config_set_wrap(pwm_config *c, uint16_t wrap) { c->top = wrap; }
+inline void pwm_set_enabled(uint slice, bool enabled)
+{
+    uint32_t bit = 1u << (slice % NUM_PWM_SLICES);
+    pwm_hw->en = enabled ? (pwm_hw->en | bit) : (pwm_hw->en & ~bit);
+}
+inline void pwm_set_mask_enabled(uint32_t mask) { pwm_hw->en = mask; }
+inline void pwm_init(uint slice, pwm_config *c, bool start)
+{
+    slice %= NUM_PWM_SLICES;
+    pwm_hw->slice[slice] = pwm_slice_hw_t{c->csr, c->div, 0, 0, c->top};
+    pico_host_pwm_active[slice] = 0;
+    pico_host_pwm_frac[slice] = 0;
+    pwm_set_enabled(slice, start);
+}
+inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1) & 7; }
+inline uint pwm_gpio_to_channel(uint gpio) { return gpio & 1; }
+inline void pwm_set_chan_level(uint slice, uint channel, uint16_t level)
+{
+    pico_host_pwm_level[(slice * 2 + channel) & 15] = level;
+    volatile uint32_t &cc = pwm_hw->slice[slice % NUM_PWM_SLICES].cc;
+    cc = channel ? (cc & 0xFFFFu) | ((uint32_t)level << 16) : (cc & 0xFFFF0000u) | level;
+    pico_host_pwm_cc_writes++;
+}
+inline void pwm_set_both_levels(uint slice, uint16_t level_a, uint16_t level_b)
+{
+    pico_host_pwm_level[(slice * 2) & 15] = level_a;
+    pico_host_pwm_level[(slice * 2 + 1) & 15] = level_b;
+    pwm_hw->slice[slice % NUM_PWM_SLICES].cc = ((uint32_t)level_b << 16) | level_a;
+    pico_host_pwm_cc_writes++;
+}
+
+/**
+ * @brief Run the enabled slices for a number of system clock cycles
+ */
+inline void pico_host_pwm_run(uint64_t cycles)
+{
+    for (uint s = 0; s < NUM_PWM_SLICES; s++)
+    {
+        if (!(pwm_hw->en & (1u << s)))
+            continue;
+        pwm_slice_hw_t &hw = pwm_hw->slice[s];
+        uint32_t div = hw.div >= 16 ? hw.div : 16;
+        uint64_t sixteenths = pico_host_pwm_frac[s] + cycles * 16;
+        uint64_t ctr = hw.ctr + sixteenths / div;
+        pico_host_pwm_frac[s] = (uint32_t)(sixteenths % div);
+        uint64_t wraps = ctr / ((uint64_t)hw.top + 1);
+        hw.ctr = (uint32_t)(ctr % ((uint64_t)hw.top + 1));
+        for (uint64_t w = 0; w < wraps; w++)
+        {
+            pico_host_pwm_active[s] = hw.cc;
+            pico_host_pwm_wraps[s]++;
+            if (pico_host_pwm_wrap_hook)
+                pico_host_pwm_wrap_hook(s, hw.cc);
+        }
+    }
+}
+
+inline void pwm_set_counter(uint slice, uint16_t c)
+{
+    pwm_hw->slice[slice % NUM_PWM_SLICES].ctr = c;
+    pico_host_pwm_run(pico_host_pwm_store_cycles);
+}
+inline uint16_t pwm_get_counter(uint slice) { return (uint16_t)pwm_hw->slice[slice % NUM_PWM_SLICES].ctr; }
+inline uint pwm_get_dreq(uint slice) { return 24 + (slice & 7); } // DREQ_PWM_WRAP0 + slice; see pico_host_dma_dreq()
+
+#endif // __PICO_HOST_H__
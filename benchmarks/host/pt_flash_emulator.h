@@ -0,0 +1,136 @@
+/**
+ * @file pt_flash_emulator.h
+ * @brief Host PTFlashDevice with wear counters and power-cut injection
+ *
+ * Behaves like NOR flash: an erase sets a sector to 0xFF, a program can
+ * only clear bits. Every erase is counted per sector, and a program that
+ * would need to set a bit (writing over data without an erase, which
+ * corrupts it on the chip) is counted as a conflict.
+ *
+ * cutPowerAfter(n, torn) lets n more erase/program operations complete,
+ * then interrupts the next one and fails every operation after it until
+ * powerOn(). The interrupted operation only gets its first torn bytes
+ * programmed or erased (0: lost entirely).
+ */
+
+#ifndef __PT_FLASH_EMULATOR_H__
+#define __PT_FLASH_EMULATOR_H__
+
+#include "eurorack_storage.h"
+
+#include <cstring>
+#include <vector>
+
+class PTFlashEmulator : public PTFlashDevice
+{
+private:
+    std::vector<uint8_t> memory;
+    std::vector<uint32_t> sector_erases;
+    uint32_t erases;
+    uint32_t programs;
+    uint32_t conflicts; // Programs that needed a 0 -> 1 bit change
+    uint64_t bytes_read;
+
+    int64_t operations_left; // Before the cut; -1 = no cut scheduled
+    uint32_t torn_bytes;     // Written by the interrupted operation
+    bool powered;
+
+    /**
+     * @brief Count an operation against a scheduled cut
+     * @return Bytes of the length-byte range that get written: all of
+     *         them, torn_bytes if interrupted by the cut, none if already off
+     */
+    uint32_t operate(uint32_t length)
+    {
+        if (!powered)
+            return 0;
+        if (operations_left < 0)
+            return length;
+        if (operations_left == 0)
+        {
+            powered = false;
+            return torn_bytes < length ? torn_bytes : length;
+        }
+        operations_left--;
+        return length;
+    }
+
+public:
+    PTFlashEmulator(uint32_t sectors = 16)
+        : memory(sectors * EurorackStorage::SECTOR_SIZE, 0xFF), sector_erases(sectors, 0),
+          erases(0), programs(0), conflicts(0), bytes_read(0), operations_left(-1), torn_bytes(0), powered(true)
+    {
+    }
+
+    uint32_t size() const override { return (uint32_t)memory.size(); }
+
+    void read(uint32_t offset, void *dst, size_t length) override
+    {
+        memcpy(dst, memory.data() + offset, length);
+        bytes_read += length;
+    }
+
+    bool eraseSector(uint32_t offset) override
+    {
+        uint32_t sector = offset / EurorackStorage::SECTOR_SIZE;
+        uint32_t length = operate(EurorackStorage::SECTOR_SIZE);
+        if (length == 0)
+            return false;
+
+        memset(memory.data() + sector * EurorackStorage::SECTOR_SIZE, 0xFF, length);
+        sector_erases[sector]++;
+        erases++;
+        return powered;
+    }
+
+    bool programPage(uint32_t offset, const uint8_t *page) override
+    {
+        uint32_t length = operate(EurorackStorage::PAGE_SIZE);
+        if (length == 0)
+            return false;
+
+        uint8_t *cells = memory.data() + offset;
+        for (uint32_t i = 0; i < length; i++)
+        {
+            if ((cells[i] & page[i]) != page[i])
+                conflicts++;
+            cells[i] &= page[i];
+        }
+        programs++;
+        return powered;
+    }
+
+    /**
+     * @brief Let operations more erase/program calls complete, then cut power
+     * @param torn Bytes the interrupted operation still writes (0 = lost)
+     */
+    void cutPowerAfter(uint32_t operations, uint32_t torn = 0)
+    {
+        operations_left = operations;
+        torn_bytes = torn;
+    }
+
+    /**
+     * @brief Restore power and cancel any scheduled cut; contents are kept
+     */
+    void powerOn()
+    {
+        powered = true;
+        operations_left = -1;
+    }
+
+    bool isPowered() const { return powered; }
+
+    uint32_t getEraseCount() const { return erases; }
+    uint32_t getSectorEraseCount(uint32_t sector) const { return sector_erases[sector]; }
+    uint32_t getProgramCount() const { return programs; }
+    uint32_t getConflictCount() const { return conflicts; }
+    uint64_t getBytesRead() const { return bytes_read; }
+
+    /**
+     * @brief Erase/program operations so far, the unit of cutPowerAfter()
+     */
+    uint32_t getOperationCount() const { return erases + programs; }
+};
+
+#endif // __PT_FLASH_EMULATOR_H__
@@ -0,0 +1,126 @@
+/**
+ * @file tusb.h
+ * @brief Host stand-in for the TinyUSB device calls used by PTMidiUsb
+ *
+ * Models one USB-MIDI link to a computer. The computer side queues
+ * event packets with pico_host_usb_midi_send(); tud_midi_packet_read()
+ * hands them to the device from an RX FIFO of CFG_TUD_MIDI_RX_BUFSIZE
+ * bytes. tud_midi_stream_write() packs a MIDI byte stream into event
+ * packets in a TX FIFO of CFG_TUD_MIDI_TX_BUFSIZE bytes, taking whole
+ * messages only, as TinyUSB does, and starts a bulk transfer if the IN
+ * endpoint is idle. A transfer passes each of its packets to
+ * pico_host_usb_midi_receive_hook and keeps the endpoint busy until the
+ * next tud_task(), so at most one goes out per frame. SysEx is not packed.
+ */
+
+#ifndef __PICO_HOST_TUSB_H__
+#define __PICO_HOST_TUSB_H__
+
+#include "pico_host.h"
+#include "usb/tusb_config.h"
+
+#include <cstring>
+
+#define PICO_HOST_USB_MIDI_RX_PACKETS (CFG_TUD_MIDI_RX_BUFSIZE / 4)
+#define PICO_HOST_USB_MIDI_TX_PACKETS (CFG_TUD_MIDI_TX_BUFSIZE / 4)
+
+inline bool pico_host_usb_mounted = true;
+inline uint8_t pico_host_usb_rx[PICO_HOST_USB_MIDI_RX_PACKETS][4];
+inline uint32_t pico_host_usb_rx_head = 0, pico_host_usb_rx_tail = 0;
+inline uint8_t pico_host_usb_tx[PICO_HOST_USB_MIDI_TX_PACKETS][4];
+inline uint32_t pico_host_usb_tx_count = 0;
+inline bool pico_host_usb_in_busy = false;
+inline uint32_t pico_host_usb_in_transfers = 0; // Bulk IN transfers, for benchmarks
+inline void (*pico_host_usb_midi_receive_hook)(const uint8_t packet[4]) = nullptr;
+
+/**
+ * @brief The computer sends one event packet; false if the device's RX FIFO is full
+ */
+inline bool pico_host_usb_midi_send(const uint8_t packet[4])
+{
+    if (pico_host_usb_rx_head - pico_host_usb_rx_tail >= PICO_HOST_USB_MIDI_RX_PACKETS)
+        return false;
+    memcpy(pico_host_usb_rx[pico_host_usb_rx_head++ % PICO_HOST_USB_MIDI_RX_PACKETS], packet, 4);
+    return true;
+}
+
+/**
+ * @brief Send the TX FIFO to the computer in one bulk transfer
+ */
+inline void pico_host_usb_midi_transfer()
+{
+    if (pico_host_usb_tx_count == 0)
+        return;
+    for (uint32_t i = 0; i < pico_host_usb_tx_count; i++)
+    {
+        if (pico_host_usb_midi_receive_hook)
+            pico_host_usb_midi_receive_hook(pico_host_usb_tx[i]);
+    }
+    pico_host_usb_tx_count = 0;
+    pico_host_usb_in_busy = true;
+    pico_host_usb_in_transfers++;
+}
+
+inline bool tusb_init() { return true; }
+
+/**
+ * @brief A new frame: the previous IN transfer completed, send what has queued since
+ */
+inline void tud_task()
+{
+    pico_host_usb_in_busy = false;
+    pico_host_usb_midi_transfer();
+}
+
+inline bool tud_midi_mounted() { return pico_host_usb_mounted; }
+inline uint32_t tud_midi_available() { return (pico_host_usb_rx_head - pico_host_usb_rx_tail) * 4; }
+
+inline bool tud_midi_packet_read(uint8_t packet[4])
+{
+    if (pico_host_usb_rx_head == pico_host_usb_rx_tail)
+        return false;
+    memcpy(packet, pico_host_usb_rx[pico_host_usb_rx_tail++ % PICO_HOST_USB_MIDI_RX_PACKETS], 4);
+    return true;
+}
+
+inline uint32_t tud_midi_stream_write(uint8_t cable, const uint8_t *buffer, uint32_t length)
+{
+    uint32_t written = 0;
+    while (written < length && pico_host_usb_tx_count < PICO_HOST_USB_MIDI_TX_PACKETS)
+    {
+        uint8_t status = buffer[written];
+        uint32_t message = 1;
+        uint8_t cin = status == 0xF6 ? 0x5 : 0xF; // Single byte: tune request, realtime
+        if (status < 0xF0)
+        {
+            uint8_t type = status & 0xF0;
+            message = (type == 0xC0 || type == 0xD0) ? 2 : 3;
+            cin = status >> 4;
+        }
+        else if (status == 0xF1 || status == 0xF3)
+        {
+            message = 2;
+            cin = 0x2;
+        }
+        else if (status == 0xF2)
+        {
+            message = 3;
+            cin = 0x3;
+        }
+        if (written + message > length)
+            break; // Incomplete message: TinyUSB holds it for the next write
+
+        uint8_t *packet = pico_host_usb_tx[pico_host_usb_tx_count++];
+        packet[0] = (uint8_t)((cable << 4) | cin);
+        packet[1] = buffer[written];
+        packet[2] = message > 1 ? buffer[written + 1] : 0;
+        packet[3] = message > 2 ? buffer[written + 2] : 0;
+        written += message;
+    }
+
+    if (!pico_host_usb_in_busy)
+        pico_host_usb_midi_transfer();
+    return written;
+}
+
+#endif // __PICO_HOST_TUSB_H__
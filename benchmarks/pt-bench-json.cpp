@@ -0,0 +1,165 @@
+/**
+ * @file pt-bench-json.cpp
+ * @brief Host check of PTBenchmark::parseJSON() on target captures
+ *
+ * pt-bench --compare reads whatever came over the target's UART, so the
+ * parser has to pick result entries out of console noise and refuse
+ * anything it cannot read completely. Checks:
+ *  - a clean report round-trips every field
+ *  - boot messages, log lines and blank lines between and around the
+ *    entries are skipped; entries past max are left unread
+ *  - a missing field, a bad number, min > median, 0 samples, an
+ *    unterminated name and a capture cut off mid-entry all return -1
+ *  - a report from Runner::report() itself parses back to the same values
+ *
+ * Usage: pt-bench-json (exit status 1 on a failed check)
+ */
+
+#include "pt_benchmark.h"
+#include "pt_check.h"
+
+#include <cstdlib>
+#include <string>
+
+using PTBenchmark::Result;
+
+static const char *const ENTRY_A =
+    "    {\"name\": \"event_queue/push_pop\", \"iterations\": 524288, \"samples\": 15, "
+    "\"median_ns\": 152.000, \"min_ns\": 150.500, \"mean_ns\": 153.100, "
+    "\"stddev_ns\": 2.250, \"p90_ns\": 156.000},\n";
+static const char *const ENTRY_B =
+    "    {\"name\": \"placement/sine_lookup/ram\", \"iterations\": 65536, \"samples\": 15, "
+    "\"median_ns\": 40.000, \"min_ns\": 39.000, \"mean_ns\": 40.500, "
+    "\"stddev_ns\": 0.800, \"p90_ns\": 41.000}\n";
+
+using PTCheck::check;
+
+/**
+ * @brief Parse a copy of text (parseJSON() writes into its input)
+ */
+static int parse(const std::string &text, Result *out, uint32_t max)
+{
+    static char buffer[16 * 1024];
+    snprintf(buffer, sizeof(buffer), "%s", text.c_str());
+    return PTBenchmark::parseJSON(buffer, out, max);
+}
+
+static std::string report(const char *a, const char *b)
+{
+    return std::string("{\n  \"context\": {\"platform\": \"rp2040\", \"cpu_hz\": 125000000},\n") +
+           "  \"benchmarks\": [\n" + a + b + "  ]\n}\n";
+}
+
+static void checkValid()
+{
+    Result r[4];
+    int count = parse(report(ENTRY_A, ENTRY_B), r, 4);
+    check(count == 2 && std::string(r[0].name) == "event_queue/push_pop" && r[0].iterations == 524288 &&
+              r[0].samples == 15 && r[0].median_ns == 152.0 && r[0].min_ns == 150.5 && r[0].mean_ns == 153.1 &&
+              r[0].stddev_ns == 2.25 && r[0].p90_ns == 156.0 &&
+              std::string(r[1].name) == "placement/sine_lookup/ram" && r[1].median_ns == 40.0,
+          "clean report: every field");
+
+    check(parse("", r, 4) == 0, "empty input: no results");
+    check(parse("pt-bench-target: running at 125000000 Hz\n", r, 4) == 0, "console text only: no results");
+}
+
+static void checkNoise()
+{
+    Result r[4];
+    std::string capture = std::string("\r\n\x1b[0m") + "pt-bench-target: running at 125000000 Hz\n" + "USB: suspended\n" +
+                          "{\n  \"context\": {\"platform\": \"rp2040\", \"cpu_hz\": 125000000},\n" +
+                          "  \"benchmarks\": [\n" + ENTRY_A + "\n[watchdog] fed\r\n" +
+                          "garbage \"name\" without an entry\n" + ENTRY_B + "  ]\n}\n" + "pt-bench-target: done\n";
+    int count = parse(capture, r, 4);
+    check(count == 2 && std::string(r[0].name) == "event_queue/push_pop" &&
+              std::string(r[1].name) == "placement/sine_lookup/ram",
+          "log lines around and between entries are skipped");
+
+    check(parse(capture, r, 1) == 1 && std::string(r[0].name) == "event_queue/push_pop",
+          "max = 1: first entry only");
+}
+
+static void checkMalformed()
+{
+    Result r[4];
+    auto broken = [&](const std::string &from, const std::string &to)
+    {
+        std::string entry = ENTRY_A;
+        size_t at = entry.find(from);
+        if (at == std::string::npos)
+        {
+            fprintf(stderr, "test bug: '%s' not in entry\n", from.c_str());
+            exit(1);
+        }
+        entry.replace(at, from.size(), to);
+        return parse(report(entry.c_str(), ENTRY_B), r, 4);
+    };
+
+    check(broken("\"samples\": 15, ", "") == -1, "missing field");
+    check(broken("152.000", "fast") == -1, "bad number");
+    check(broken("\"min_ns\": 150.500", "\"min_ns\": 160.000") == -1, "min above median");
+    check(broken("\"samples\": 15", "\"samples\": 0") == -1, "no samples");
+
+    std::string unterminated = report("", "") + "    {\"name\": \"event_queue/push_pop";
+    check(parse(unterminated, r, 4) == -1, "name cut off");
+
+    std::string entry = ENTRY_A;
+    bool every_cut = true;
+    for (size_t cut = entry.find(", \"iterations\""); cut < entry.find('}'); cut++)
+        every_cut &= parse(report(ENTRY_B, entry.substr(0, cut).c_str()), r, 4) == -1;
+    check(every_cut, "capture cut off at every point of an entry");
+}
+
+static uint64_t fake_ticks = 0;
+static uint64_t fakeNow() { return fake_ticks += 1000; }
+
+static void checkRoundTrip()
+{
+    PTBenchmark::Runner runner(fakeNow, 1.0);
+    runner.setSamples(5);
+    runner.setMinSampleTime(1);
+    runner.run("roundtrip/a", [] {});
+    runner.run("roundtrip/b", [] {}, 4);
+
+    // Runner::report() prints; capture it through a temporary file
+    FILE *capture = tmpfile();
+    FILE *saved = stdout;
+    stdout = capture;
+    runner.report(PTBenchmark::Format::JSON);
+    fflush(capture);
+    stdout = saved;
+
+    static char text[4096];
+    rewind(capture);
+    size_t length = fread(text, 1, sizeof(text) - 1, capture);
+    fclose(capture);
+    text[length] = '\0';
+
+    Result r[4];
+    int count = PTBenchmark::parseJSON(text, r, 4);
+    bool ok = count == 2;
+    for (int i = 0; ok && i < count; i++)
+    {
+        const Result &a = runner.getResult(i);
+        ok = std::string(r[i].name) == a.name && r[i].iterations == a.iterations && r[i].samples == a.samples &&
+             std::abs(r[i].median_ns - a.median_ns) < 0.001 && std::abs(r[i].p90_ns - a.p90_ns) < 0.001;
+    }
+    check(ok, "Runner::report() JSON parses back");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    checkValid();
+    checkNoise();
+    checkMalformed();
+    checkRoundTrip();
+
+    return PTCheck::summary();
+}
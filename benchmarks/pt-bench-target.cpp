@@ -0,0 +1,173 @@
+/**
+ * @file pt-bench-target.cpp
+ * @brief On-target benchmarks for the RP2040 (build target pt-bench-target)
+ *
+ * Runs the same suite as the host pt-bench, timed in core clock cycles
+ * with SysTick, and prints the results as JSON on stdio (UART). Capture
+ * the console and pass it to the host tool to compare the two:
+ *
+ *   pt-bench --compare=capture.txt
+ *
+ * A few kernels are also built three times to show where code runs from:
+ * copied to SRAM, executed from flash through the XIP cache, and executed
+ * through the non-caching XIP alias, which is what a cache miss costs.
+ * Framework functions marked PT_TIME_CRITICAL are always in SRAM, so the
+ * kernels here are inline-only code. The table kernel's data moves with its
+ * code: the RAM variant reads SINE_TABLE, which PT_TIME_CRITICAL_DATA puts
+ * in SRAM, and the XIP variants a copy of it left in flash.
+ */
+
+#include "pt_bench_suite.h"
+#include "eurorack_oscillators.h"
+
+#include "hardware/clocks.h"
+#include "hardware/structs/systick.h"
+#include "hardware/regs/addressmap.h"
+
+#include <cstdio>
+
+using PTBenchmark::doNotOptimize;
+
+/**
+ * @brief 64-bit cycle count from the 24-bit SysTick down-counter
+ *
+ * Must be called at least once per 2^24 cycles (~134ms at 125MHz), which
+ * the harness does at every sample boundary.
+ */
+static uint64_t systickCycles()
+{
+    static uint64_t total = 0;
+    static uint32_t last = 0;
+
+    uint32_t current = systick_hw->cvr;
+    total += (last - current) & 0x00FFFFFF;
+    last = current;
+    return total;
+}
+
+static void initSystick()
+{
+    systick_hw->csr = 0;
+    systick_hw->rvr = 0x00FFFFFF;
+    systick_hw->cvr = 0;
+    systick_hw->csr = 0x5; // Enable, clocked from the processor clock
+    systickCycles();
+}
+
+// ----------------------------------------------------------------------------
+// Memory placement: each kernel is compiled once into SRAM and once into flash
+// ----------------------------------------------------------------------------
+
+#define PT_BENCH_KERNEL(name, params, ...)                                  \
+    static void __no_inline_not_in_flash_func(name##Ram) params __VA_ARGS__ \
+    static void __attribute__((noinline)) name##Xip params __VA_ARGS__
+
+PT_BENCH_KERNEL(pitchKernel, (uint16_t adc, uint32_t base_increment), {
+    doNotOptimize(EurorackUtils::Fixed::pitchToIncrement(base_increment, EurorackUtils::Fixed::adcToPitchQ16(adc)));
+})
+
+PT_BENCH_KERNEL(voltageKernel, (float volts), {
+    doNotOptimize(EurorackUtils::CV::eurorackVoltageToDAC(volts));
+})
+
+// Interpolated table lookup. The table is a parameter: the RAM variant reads
+// the SRAM table and the XIP variants a flash copy, so both the code and its
+// data move between the two.
+PT_BENCH_KERNEL(tableKernel, (const int16_t *table, uint32_t phase, uint32_t increment), {
+    int32_t sum = 0;
+    for (int i = 0; i < 32; i++)
+    {
+        uint32_t index = phase >> (32 - EurorackOscillators::SINE_TABLE_BITS);
+        int32_t frac = (phase >> (32 - EurorackOscillators::SINE_TABLE_BITS - 15)) & 0x7FFF;
+        int32_t a = table[index];
+        int32_t b = table[index + 1];
+        sum += a + (((b - a) * frac) >> 15);
+        phase += increment;
+    }
+    doNotOptimize(sum);
+})
+
+/**
+ * @brief Same function (or flash data), reached through the XIP alias that
+ *        bypasses the cache
+ */
+template <typename F>
+static F uncached(F function)
+{
+    uintptr_t address = (uintptr_t)function;
+    return (F)(address - XIP_BASE + XIP_NOCACHE_NOALLOC_BASE);
+}
+
+// Flash copy of the sine table for the XIP variants
+static constexpr std::array<int16_t, EurorackOscillators::SINE_TABLE_SIZE + 1> sine_table_flash =
+    EurorackOscillators::detail::makeSineTable();
+
+static void benchPlacement(PTBenchmark::Runner &runner)
+{
+    static volatile uint16_t adc = 1234;
+    static volatile float volts = 1.5f;
+    static uint32_t base_increment = EurorackUtils::Fixed::frequencyToIncrement(261.63f, 48000.0f);
+    static uint32_t table_phase = 0;
+
+    auto pitch_xip_nc = uncached(&pitchKernelXip);
+    runner.run("placement/pitch_to_increment/ram", [&]()
+               { pitchKernelRam(adc, base_increment); });
+    runner.run("placement/pitch_to_increment/xip", [&]()
+               { pitchKernelXip(adc, base_increment); });
+    runner.run("placement/pitch_to_increment/xip_uncached", [&]()
+               { pitch_xip_nc(adc, base_increment); });
+
+    // Soft-float path: the float helpers themselves stay where the SDK put them
+    auto voltage_xip_nc = uncached(&voltageKernelXip);
+    runner.run("placement/voltage_to_dac/ram", [&]()
+               { voltageKernelRam(volts); });
+    runner.run("placement/voltage_to_dac/xip", [&]()
+               { voltageKernelXip(volts); });
+    runner.run("placement/voltage_to_dac/xip_uncached", [&]()
+               { voltage_xip_nc(volts); });
+
+    // 32 lookups per call, reported per lookup. The uncached variant reads the
+    // table through the uncached alias too.
+    const int16_t *table_ram = EurorackOscillators::SINE_TABLE.data();
+    const int16_t *table_xip = sine_table_flash.data();
+    const int16_t *table_xip_nc = uncached(table_xip);
+    auto table_kernel_xip_nc = uncached(&tableKernelXip);
+    runner.run("placement/sine_lookup/ram", [&]()
+               { tableKernelRam(table_ram, table_phase += 0x01000000u, base_increment); }, 32);
+    runner.run("placement/sine_lookup/xip", [&]()
+               { tableKernelXip(table_xip, table_phase += 0x01000000u, base_increment); }, 32);
+    runner.run("placement/sine_lookup/xip_uncached", [&]()
+               { table_kernel_xip_nc(table_xip_nc, table_phase += 0x01000000u, base_increment); }, 32);
+}
+
+int main()
+{
+    stdio_init_all();
+    sleep_ms(2000); // Time to attach a terminal
+
+    initSystick();
+    uint32_t cpu_hz = clock_get_hz(clk_sys);
+
+    // Static: the result buffers are too large for the main stack
+    static PTBenchmark::Runner runner(systickCycles, 1e9 / cpu_hz);
+    runner.setContext("rp2040", cpu_hz);
+    runner.setMinSampleTime(1e6); // 1ms samples keep the full run under a minute
+    runner.setSamples(15);
+
+    printf("pt-bench-target: running at %lu Hz\n", (unsigned long)cpu_hz);
+
+    PTBenchSuite::runAll(runner);
+    benchPlacement(runner);
+
+    runner.report(PTBenchmark::Format::JSON);
+    if (runner.getDroppedCount() > 0)
+        printf("pt-bench-target: FAILED, %lu benchmarks dropped, raise PTBenchmark::Runner::MAX_RESULTS\n",
+               (unsigned long)runner.getDroppedCount());
+    else
+        printf("pt-bench-target: done\n");
+
+    while (true)
+    {
+        tight_loop_contents();
+    }
+}
@@ -0,0 +1,119 @@
+/**
+ * @file pt-bench.cpp
+ * @brief Host benchmarks for the framework hot paths
+ *
+ * Builds the framework headers against host stand-ins for the Pico SDK
+ * (see host/pico_host.h) and times the code that runs on every loop or
+ * interrupt: event queue, both schedulers, protothread resume, CV
+ * conversions and quadrature decoding (see pt_bench_suite.h).
+ *
+ * Usage: pt-bench [--format=table|json|csv] [--filter=substring]
+ *                 [--samples=N] [--min-time-ms=N] [--compare=target.json]
+ *
+ * --compare reads the JSON printed by pt-bench-target (console capture
+ * is fine) and prints target vs host medians after the host run.
+ */
+
+#include "pt_bench_suite.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+
+static uint64_t hostTicks()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief Print target medians next to the host ones
+ * @return false if the file cannot be read or is not benchmark output
+ */
+static bool compareWith(const char *path, const PTBenchmark::Runner &host)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        fprintf(stderr, "compare: cannot open %s\n", path);
+        return false;
+    }
+
+    static char text[256 * 1024];
+    size_t length = fread(text, 1, sizeof(text) - 1, file);
+    fclose(file);
+    text[length] = '\0';
+
+    static PTBenchmark::Result target[PTBenchmark::Runner::MAX_RESULTS * 2];
+    int count = PTBenchmark::parseJSON(text, target, sizeof(target) / sizeof(target[0]));
+    if (count <= 0)
+    {
+        fprintf(stderr, "compare: %s has no valid benchmark results\n", path);
+        return false;
+    }
+
+    printf("\n%-36s %14s %14s %10s\n", "benchmark", "host_ns", "target_ns", "ratio");
+    for (int t = 0; t < count; t++)
+    {
+        const PTBenchmark::Result *match = nullptr;
+        for (uint32_t h = 0; h < host.getResultCount(); h++)
+        {
+            if (std::strcmp(host.getResult(h).name, target[t].name) == 0)
+                match = &host.getResult(h);
+        }
+
+        if (match)
+            printf("%-36s %14.2f %14.2f %10.1f\n", target[t].name, match->median_ns, target[t].median_ns,
+                   target[t].median_ns / match->median_ns);
+        else
+            printf("%-36s %14s %14.2f %10s\n", target[t].name, "-", target[t].median_ns, "-");
+    }
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    PTBenchmark::Runner runner(hostTicks, 1.0);
+    PTBenchmark::Format format = PTBenchmark::Format::TABLE;
+    const char *compare_path = nullptr;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *arg = argv[i];
+        if (std::strcmp(arg, "--format=json") == 0)
+            format = PTBenchmark::Format::JSON;
+        else if (std::strcmp(arg, "--format=csv") == 0)
+            format = PTBenchmark::Format::CSV;
+        else if (std::strcmp(arg, "--format=table") == 0)
+            format = PTBenchmark::Format::TABLE;
+        else if (std::strncmp(arg, "--filter=", 9) == 0)
+            runner.setFilter(arg + 9);
+        else if (std::strncmp(arg, "--samples=", 10) == 0)
+            runner.setSamples((uint32_t)std::atoi(arg + 10));
+        else if (std::strncmp(arg, "--min-time-ms=", 14) == 0)
+            runner.setMinSampleTime(std::atof(arg + 14) * 1e6);
+        else if (std::strncmp(arg, "--compare=", 10) == 0)
+            compare_path = arg + 10;
+        else
+        {
+            fprintf(stderr, "usage: %s [--format=table|json|csv] [--filter=substring] "
+                            "[--samples=N] [--min-time-ms=N] [--compare=target.json]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    PTBenchSuite::runAll(runner);
+    runner.report(format);
+    if (runner.getDroppedCount() > 0)
+    {
+        fprintf(stderr, "pt-bench: %lu benchmarks dropped, raise PTBenchmark::Runner::MAX_RESULTS\n",
+                (unsigned long)runner.getDroppedCount());
+        return 1;
+    }
+
+    if (compare_path && !compareWith(compare_path, runner))
+        return 1;
+    return 0;
+}
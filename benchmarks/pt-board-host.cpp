@@ -0,0 +1,370 @@
+/**
+ * @file pt-board-host.cpp
+ * @brief Host build of two board descriptions and their generated setup
+ *
+ * Instantiates the default pt-test board and a second, larger module
+ * from constexpr pin maps. At compile time it checks both boards with
+ * PT_BOARD_CHECK, checks that each validation rule rejects a board that
+ * breaks it, and checks the derived pin numbers and masks. At run time
+ * it runs PTBoard::init() on the host stand-ins, builds the hardware
+ * classes deferred from the pin map, attaches them to the shared edge
+ * dispatch and drives every input, expecting one event per edge. The
+ * default board is then run twice more, each time expecting the same
+ * events: once with the dispatch table generated from the pin map by
+ * makeEdgeTable() and installed by init(board, table), and once with the
+ * compile-time pin classes (PTFixedEncoder etc.) behind PTFixedDispatch.
+ * PT_EDGE_CHECK is checked at compile time to reject tables that miss an
+ * input, bind one pin twice or bind a channel the board lacks.
+ *
+ * Usage: pt-board-host (exit status 1 on a mismatch)
+ */
+
+#include "eurorack_board_default.h"
+#include "eurorack_hardware.h"
+
+#include <memory>
+#include <vector>
+
+using namespace PTBoard;
+
+// A two-voice module: two encoders, inverted gate inputs, CV outputs on
+// both channels of slice 0 and one of slice 1
+constexpr auto DUAL_BOARD = makeBoard(
+    encoderA(10, 0), encoderB(11, 0), encoderButton(12, 0),
+    encoderA(13, 1), encoderB(14, 1),
+    button(0, 0),
+    gateIn(1, 0, true), gateIn(2, 1, true),
+    gateOut(3, 0), gateOut(4, 1),
+    cvIn(26, 0), cvIn(27, 1), cvIn(28, 2),
+    cvOut(16, 0), cvOut(17, 1), cvOut(18, 2),
+    led(19, 0), led(22, 1, true));
+
+PT_BOARD_CHECK(DUAL_BOARD);
+
+// Derived values
+static_assert(EurorackBoards::DEFAULT_BOARD.gpio(Role::CV_OUT, 1) == 21, "CV out 2 is GPIO 21");
+static_assert(EurorackBoards::DEFAULT_BOARD.gpio(Role::GATE_IN, 1) == NO_PIN, "one gate input");
+static_assert(EurorackBoards::DEFAULT_BOARD.mask(Role::LED) == ((1u << 25) | (1u << 15) | (1u << 16)), "LED mask");
+static_assert(EurorackBoards::DEFAULT_BOARD.pwmSlices() == (1u << 2), "both CV outputs on slice 2");
+static_assert(DUAL_BOARD.pwmSlices() == ((1u << 0) | (1u << 1)), "CV outputs on slices 0 and 1");
+static_assert(DUAL_BOARD.count(Role::ENCODER_A) == 2, "two encoders");
+static_assert(DUAL_BOARD.activeLow(Role::GATE_IN, 1), "inverted gate inputs");
+
+// Each rule rejects a board that breaks it
+static_assert(!pinsInRange(makeBoard(led(30))), "GPIO 30 does not exist");
+static_assert(!noPinCollisions(makeBoard(button(5), led(5))), "GPIO 5 used twice");
+static_assert(!uniqueChannels(makeBoard(button(5, 0), button(6, 0))), "button 0 numbered twice");
+static_assert(!cvInputsOnAdcPins(makeBoard(cvIn(20))), "GPIO 20 has no ADC");
+static_assert(!noPwmConflicts(makeBoard(cvOut(4, 0), cvOut(20, 1))), "GPIO 4 and 20 are both slice 2 A");
+static_assert(noPwmConflicts(makeBoard(cvOut(20, 0), cvOut(21, 1))), "slice 2 A and B are separate outputs");
+static_assert(!encodersComplete(makeBoard(encoderA(2))), "encoder without phase B");
+static_assert(!encodersComplete(makeBoard(encoderA(2), encoderB(3), encoderButton(4, 1))), "button without encoder");
+
+static const char *roleName(Role role)
+{
+    switch (role)
+    {
+    case Role::ENCODER_A:
+        return "encoder A";
+    case Role::ENCODER_B:
+        return "encoder B";
+    case Role::ENCODER_BUTTON:
+        return "encoder btn";
+    case Role::BUTTON:
+        return "button";
+    case Role::GATE_IN:
+        return "gate in";
+    case Role::GATE_OUT:
+        return "gate out";
+    case Role::CV_IN:
+        return "cv in";
+    case Role::CV_OUT:
+        return "cv out";
+    case Role::LED:
+        return "led";
+    }
+    return "?";
+}
+
+static uint32_t failures = 0;
+
+static void expect(bool condition, const char *what, uint gpio)
+{
+    if (!condition)
+    {
+        printf("  FAIL: %s (GPIO %u)\n", what, gpio);
+        failures++;
+    }
+}
+
+struct EventCounts
+{
+    uint32_t turns, presses, releases, rising, falling;
+};
+
+static EventCounts drain(PTEventQueue &queue)
+{
+    EventCounts counts = {};
+    PTEvent event;
+    while (queue.pop(event))
+    {
+        counts.turns += event.type == PTEventType::ENCODER_TURN;
+        counts.presses += event.type == PTEventType::BUTTON_PRESS;
+        counts.releases += event.type == PTEventType::BUTTON_RELEASE;
+        counts.rising += event.type == PTEventType::GATE_RISING;
+        counts.falling += event.type == PTEventType::GATE_FALLING;
+    }
+    return counts;
+}
+
+/**
+ * @brief Check one event per edge: each encoder turns twice, each button
+ *        and gate input goes active and back once
+ */
+template <size_t N>
+static void expectEvents(const Board<N> &board, const EventCounts &counts)
+{
+    uint32_t buttons = board.count(Role::ENCODER_BUTTON) + board.count(Role::BUTTON);
+    expect(counts.turns == 2 * board.count(Role::ENCODER_A), "encoder turns", 0);
+    expect(counts.presses == buttons && counts.releases == buttons, "button presses/releases", 0);
+    expect(counts.rising == board.count(Role::GATE_IN) && counts.falling == board.count(Role::GATE_IN), "gate edges", 0);
+
+    printf("  events: turn %lu, press %lu, release %lu, gate rise %lu, fall %lu\n\n",
+           (unsigned long)counts.turns, (unsigned long)counts.presses, (unsigned long)counts.releases,
+           (unsigned long)counts.rising, (unsigned long)counts.falling);
+}
+
+/**
+ * @brief Start from a floating bank with no interrupts
+ */
+static void resetPins()
+{
+    pico_host_gpio_levels = 0;
+    for (uint i = 0; i < NUM_PINS; i++)
+    {
+        pico_host_gpio_irq_events[i] = 0;
+    }
+    pico_host_gpio_callback = nullptr;
+}
+
+static uint32_t irqPins()
+{
+    uint32_t mask = 0;
+    for (uint i = 0; i < NUM_PINS; i++)
+    {
+        if (pico_host_gpio_irq_events[i])
+            mask |= 1u << i;
+    }
+    return mask;
+}
+
+/**
+ * @brief Drive an input to its active level and back
+ */
+static void pulse(uint gpio, bool active_low)
+{
+    pico_host_gpio_drive(gpio, !active_low);
+    pico_host_time_us += 60000; // Past the button debounce
+    pico_host_gpio_drive(gpio, active_low);
+    pico_host_time_us += 60000;
+}
+
+template <size_t N>
+static void exercise(const char *name, const Board<N> &board)
+{
+    printf("%s: %lu pins, edge IRQ mask 0x%08lx, PWM slices 0x%02lx\n", name, (unsigned long)N,
+           (unsigned long)board.edgeMask(), (unsigned long)board.pwmSlices());
+    printf("  %-4s %-12s %-3s %-6s %s\n", "gpio", "role", "ch", "active", "peripheral");
+    for (const Pin &pin : board.pins)
+    {
+        printf("  %-4u %-12s %-3u %-6s", (uint)pin.gpio, roleName(pin.role), (uint)pin.channel,
+               pin.active_low ? "low" : "high");
+        if (pin.role == Role::CV_IN)
+            printf(" ADC%u", pin.adcInput());
+        else if (pin.role == Role::CV_OUT)
+            printf(" PWM%u %c", pin.pwmSlice(), pin.pwmChannel() ? 'B' : 'A');
+        printf("\n");
+    }
+
+    resetPins();
+    PTBoard::init(board);
+
+    for (const Pin &pin : board.pins)
+    {
+        if (pin.role == Role::CV_IN || pin.role == Role::CV_OUT)
+            continue;
+        // Inputs rest at their pull, outputs start inactive: both read as the inactive level
+        expect(gpio_get(pin.gpio) == pin.active_low, "pin not at its inactive level", pin.gpio);
+    }
+
+    // Hardware classes built from the pin map, touching nothing until attach()
+    PTEventQueue queue;
+    std::vector<std::unique_ptr<PTEncoder>> encoders;
+    std::vector<std::unique_ptr<PTButton>> buttons;
+    std::vector<std::unique_ptr<PTGateInput>> gates;
+
+    for (uint8_t ch = 0; ch < board.count(Role::ENCODER_A); ch++)
+    {
+        encoders.emplace_back(new PTEncoder(board.gpio(Role::ENCODER_A, ch), board.gpio(Role::ENCODER_B, ch),
+                                            board.gpio(Role::ENCODER_BUTTON, ch), false));
+    }
+    for (uint8_t ch = 0; ch < board.count(Role::BUTTON); ch++)
+    {
+        buttons.emplace_back(new PTButton(board.gpio(Role::BUTTON, ch), board.activeLow(Role::BUTTON, ch), 50000, false));
+    }
+    for (uint8_t ch = 0; ch < board.count(Role::GATE_IN); ch++)
+    {
+        gates.emplace_back(new PTGateInput(board.gpio(Role::GATE_IN, ch), !board.activeLow(Role::GATE_IN, ch), false));
+    }
+    expect(pico_host_gpio_callback == nullptr, "a deferred constructor enabled an interrupt", 0);
+
+    for (auto &encoder : encoders)
+    {
+        encoder->setEventQueue(&queue);
+        encoder->attach();
+    }
+    for (auto &button : buttons)
+    {
+        button->setEventQueue(&queue);
+        button->attach();
+    }
+    for (auto &gate : gates)
+    {
+        gate->setEventQueue(&queue);
+        gate->attach();
+    }
+
+    // Every edge pin but phase B (decoded on A's edges) routes to the one callback
+    expect(irqPins() == board.irqMask(), "edge interrupts on the wrong pins", 0);
+    expect(pico_host_gpio_callback == PTBoard::dispatch, "GPIO callback is not the board dispatch", 0);
+
+    // One event per edge, each from the object that owns the pin
+    for (const Pin &pin : board.pins)
+    {
+        switch (pin.role)
+        {
+        case Role::ENCODER_A:
+        case Role::ENCODER_BUTTON:
+        case Role::BUTTON:
+        case Role::GATE_IN:
+            pulse(pin.gpio, pin.active_low);
+            break;
+        default:
+            break;
+        }
+    }
+    expectEvents(board, drain(queue));
+}
+
+// The default board with compile-time pins, taken straight from the pin map
+constexpr const auto &DEFAULT = EurorackBoards::DEFAULT_BOARD;
+
+static PTFixedEncoder<DEFAULT.gpio(Role::ENCODER_A), DEFAULT.gpio(Role::ENCODER_B),
+                      DEFAULT.gpio(Role::ENCODER_BUTTON)>
+    fixed_encoder;
+static PTFixedButton<DEFAULT.gpio(Role::BUTTON, 0)> fixed_button1(0);
+static PTFixedButton<DEFAULT.gpio(Role::BUTTON, 1)> fixed_button2(1);
+static PTFixedGateInput<DEFAULT.gpio(Role::GATE_IN)> fixed_gate;
+
+using FixedInputs = PTFixedDispatch<fixed_encoder, fixed_button1, fixed_button2, fixed_gate>;
+
+static_assert(FixedInputs::IRQ_MASK == DEFAULT.irqMask(),
+              "fixed dispatch covers the board's edge pins");
+
+// The default board's runtime classes, dispatched through a table generated
+// from the pin map
+static PTEncoder table_encoder(DEFAULT.gpio(Role::ENCODER_A), DEFAULT.gpio(Role::ENCODER_B),
+                               DEFAULT.gpio(Role::ENCODER_BUTTON), false);
+static PTButton table_button1(DEFAULT.gpio(Role::BUTTON, 0), true, 50000, false);
+static PTButton table_button2(DEFAULT.gpio(Role::BUTTON, 1), true, 50000, false);
+static PTGateInput table_gate(DEFAULT.gpio(Role::GATE_IN), true, false);
+
+constexpr auto EDGES = makeEdgeTable(DEFAULT,
+                                     bind(Role::ENCODER_A, 0, PTEncoder::onEdge, &table_encoder),
+                                     bind(Role::ENCODER_BUTTON, 0, PTEncoder::onEdge, &table_encoder),
+                                     bind(Role::BUTTON, 0, PTButton::onEdge, &table_button1),
+                                     bind(Role::BUTTON, 1, PTButton::onEdge, &table_button2),
+                                     bind(Role::GATE_IN, 0, PTGateInput::onEdge, &table_gate));
+
+PT_EDGE_CHECK(DEFAULT, EDGES);
+static_assert(EDGES.slots[DEFAULT.gpio(Role::GATE_IN)].context == &table_gate &&
+                  EDGES.slots[DEFAULT.gpio(Role::ENCODER_BUTTON)].handler == PTEncoder::onEdge,
+              "bindings placed on their channel's pin");
+static_assert(EDGES.slots[DEFAULT.gpio(Role::ENCODER_B)].handler == nullptr, "phase B has no handler");
+
+// Each rule rejects a table that breaks it
+static_assert(!edgeInputsCovered(DEFAULT, makeEdgeTable(DEFAULT,
+                                                        bind(Role::ENCODER_A, 0, PTEncoder::onEdge, &table_encoder),
+                                                        bind(Role::GATE_IN, 0, PTGateInput::onEdge, &table_gate))),
+              "buttons without a handler");
+static_assert(!edgeInputsCovered(DEFAULT, makeEdgeTable(DEFAULT,
+                                                        bind(Role::ENCODER_B, 0, PTEncoder::onEdge, &table_encoder))),
+              "phase B takes no interrupts");
+static_assert(!oneHandlerPerPin(makeEdgeTable(DEFAULT, bind(Role::GATE_IN, 0, PTGateInput::onEdge, &table_gate),
+                                              bind(Role::GATE_IN, 0, PTButton::onEdge, &table_button1))),
+              "gate input bound twice");
+static_assert(!edgeBindingsPlaced(makeEdgeTable(DEFAULT, bind(Role::GATE_IN, 1, PTGateInput::onEdge, &table_gate))),
+              "the default board has one gate input");
+
+static void exerciseTable()
+{
+    printf("DEFAULT_BOARD, generated dispatch table: IRQ mask 0x%08lx\n", (unsigned long)EDGES.mask);
+
+    resetPins();
+    PTEventQueue queue;
+    table_encoder.setEventQueue(&queue);
+    table_button1.setEventQueue(&queue);
+    table_button2.setEventQueue(&queue);
+    table_gate.setEventQueue(&queue);
+    PTBoard::init(DEFAULT, EDGES);
+
+    expect(irqPins() == DEFAULT.irqMask(), "edge interrupts on the wrong pins", 0);
+    expect(pico_host_gpio_callback == PTBoard::dispatch, "GPIO callback is not the board dispatch", 0);
+
+    for (const Pin &pin : DEFAULT.pins)
+    {
+        if (DEFAULT.irqMask() & (1u << pin.gpio))
+            pulse(pin.gpio, pin.active_low);
+    }
+    expectEvents(DEFAULT, drain(queue));
+}
+
+static void exerciseFixed()
+{
+    printf("DEFAULT_BOARD, compile-time pins: IRQ mask 0x%08lx\n", (unsigned long)FixedInputs::IRQ_MASK);
+
+    resetPins();
+    PTBoard::init(DEFAULT);
+
+    PTEventQueue queue;
+    fixed_encoder.setEventQueue(&queue);
+    fixed_button1.setEventQueue(&queue);
+    fixed_button2.setEventQueue(&queue);
+    fixed_gate.setEventQueue(&queue);
+    FixedInputs::attach();
+
+    expect(irqPins() == FixedInputs::IRQ_MASK, "edge interrupts on the wrong pins", 0);
+    expect(pico_host_gpio_callback == FixedInputs::irq, "GPIO callback is not the fixed dispatch", 0);
+
+    const uint inputs[] = {DEFAULT.gpio(Role::ENCODER_A), DEFAULT.gpio(Role::ENCODER_BUTTON),
+                           DEFAULT.gpio(Role::BUTTON, 0), DEFAULT.gpio(Role::BUTTON, 1), DEFAULT.gpio(Role::GATE_IN)};
+    for (uint gpio : inputs)
+    {
+        pulse(gpio, gpio != DEFAULT.gpio(Role::GATE_IN));
+    }
+    expectEvents(DEFAULT, drain(queue));
+}
+
+int main()
+{
+    pico_host_virtual_time = true;
+    pico_host_time_us = 1000000;
+
+    exercise("DEFAULT_BOARD", EurorackBoards::DEFAULT_BOARD);
+    exercise("DUAL_BOARD", DUAL_BOARD);
+    exerciseTable();
+    exerciseFixed();
+
+    printf("%s\n", failures ? "FAILED" : "ok");
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,302 @@
+/**
+ * @file pt-core-channel.cpp
+ * @brief Host benchmark of PTCoreChannel with core 1 as a second thread
+ *
+ * Measures, between two real threads:
+ *  - messages/second for plain messages (send/receive, in order)
+ *  - blocks/second for zero-copy 128-byte audio blocks (acquire, fill,
+ *    sendBlock, receive, release)
+ *  - one-way handoff latency of a block sent every 50us, with the
+ *    receiver sleeping in receive() and with it spinning on tryReceive()
+ *  - backpressure: a receiver 20x slower than the sender must throttle
+ *    it without losing or reordering anything
+ *  - full count: each failed try-call and each blocked send()/acquire()
+ *    counts once, however many wake-ups the blocked call sleeps through
+ *
+ * Host numbers include the OS thread wake-up behind the emulated WFE,
+ * so latencies are an upper bound for the RP2040; use them to compare
+ * changes, not as device figures.
+ *
+ * Usage: pt-core-channel [--messages=N] (exit status 1 on loss or reordering)
+ */
+
+#include "pt_core_channel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+typedef PTCoreChannel<16, 128, 4> Channel; // 32 stereo 16-bit frames per block
+
+enum MessageType
+{
+    COUNT = 1,
+    AUDIO_BLOCK,
+    STOP
+};
+
+static Channel channel;
+static uint32_t message_count = 1000000;
+
+// Receiver results, read after the join
+static uint32_t errors = 0;
+static uint32_t last_value = 0;
+static bool spin_receive = false;
+static uint32_t slow_us = 0;
+static std::vector<uint32_t> latencies_ns;
+
+static uint64_t nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static void spinNs(uint64_t ns)
+{
+    uint64_t end = nowNs() + ns;
+    while (nowNs() < end)
+    {
+    }
+}
+
+/**
+ * @brief Core 1: check order and payloads until STOP
+ */
+static void receiver()
+{
+    uint32_t expected = 0;
+    while (true)
+    {
+        PTCoreMessage message;
+        if (spin_receive)
+        {
+            while (!channel.tryReceive(message))
+            {
+            }
+        }
+        else
+        {
+            channel.receive(message);
+        }
+
+        if (message.type == STOP)
+            break;
+
+        uint32_t value = message.data;
+        if (message.type == AUDIO_BLOCK)
+        {
+            const uint32_t *words = (const uint32_t *)channel.data(message);
+            uint64_t stamp;
+            memcpy(&stamp, words + 2, sizeof(stamp));
+            if (stamp)
+                latencies_ns.push_back((uint32_t)(nowNs() - stamp));
+            if (words[0] != value || words[Channel::blockSize() / 4 - 1] != ~value)
+                errors++;
+            channel.release(message);
+        }
+        if (value != expected)
+            errors++;
+        expected = value + 1;
+        last_value = value;
+
+        if (slow_us)
+            spinNs(slow_us * 1000ull);
+    }
+}
+
+static void start(bool spin, uint32_t slow)
+{
+    channel.reset();
+    errors = 0;
+    last_value = 0;
+    spin_receive = spin;
+    slow_us = slow;
+    latencies_ns.clear();
+    multicore_launch_core1(receiver);
+}
+
+static bool finish(uint32_t count)
+{
+    channel.send(STOP);
+    pico_host_join_core1();
+    return errors == 0 && last_value == count - 1 && channel.getReceived() == count + 1;
+}
+
+static void sendBlock(uint32_t value, bool stamp)
+{
+    uint32_t *words = (uint32_t *)channel.acquire();
+    for (size_t i = 0; i < Channel::blockSize() / 4; i++)
+    {
+        words[i] = value + (uint32_t)i; // Stand-in for rendering the audio
+    }
+    words[0] = value;
+    words[Channel::blockSize() / 4 - 1] = ~value;
+    uint64_t sent_ns = stamp ? nowNs() : 0;
+    memcpy(words + 2, &sent_ns, sizeof(sent_ns));
+    channel.sendBlock(words, AUDIO_BLOCK, value);
+}
+
+static bool benchMessages()
+{
+    start(false, 0);
+    uint64_t begin = nowNs();
+    for (uint32_t i = 0; i < message_count; i++)
+    {
+        channel.send(COUNT, i);
+    }
+    bool ok = finish(message_count);
+    double seconds = (nowNs() - begin) / 1e9;
+
+    printf("%-22s %10.0f msg/s  full %lu, max depth %lu  %s\n", "messages",
+           message_count / seconds, (unsigned long)channel.getFullCount(),
+           (unsigned long)channel.getMaxDepth(), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool benchBlocks()
+{
+    uint32_t count = message_count / 4;
+    start(false, 0);
+    uint64_t begin = nowNs();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sendBlock(i, false);
+    }
+    bool ok = finish(count);
+    double seconds = (nowNs() - begin) / 1e9;
+
+    printf("%-22s %10.0f blk/s  %.1f MB/s, full %lu  %s\n", "blocks (128 B)",
+           count / seconds, count * (double)Channel::blockSize() / seconds / 1e6,
+           (unsigned long)channel.getFullCount(), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool benchLatency(bool spin)
+{
+    const uint32_t count = 20000;
+    start(spin, 0);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        sendBlock(i, true);
+        spinNs(50000);
+    }
+    bool ok = finish(count) && latencies_ns.size() == count;
+
+    std::sort(latencies_ns.begin(), latencies_ns.end());
+    printf("%-22s median %7lu ns, p99 %8lu ns, max %9lu ns  %s\n",
+           spin ? "latency (spin)" : "latency (receive)",
+           (unsigned long)latencies_ns[count / 2], (unsigned long)latencies_ns[count * 99 / 100],
+           (unsigned long)latencies_ns.back(), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool benchBackpressure()
+{
+    const uint32_t count = 2000;
+    start(false, 20);
+    uint64_t begin = nowNs();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (i % 2)
+            channel.send(COUNT, i);
+        else
+            sendBlock(i, false);
+    }
+    // At most once per send(), acquire() and sendBlock() call
+    bool ok = finish(count) && channel.getFullCount() > 0 && channel.getFullCount() <= count / 2 * 3;
+    double seconds = (nowNs() - begin) / 1e9;
+
+    printf("%-22s %10.0f msg/s  full %lu, max depth %lu  %s\n", "backpressure (20us rx)",
+           count / seconds, (unsigned long)channel.getFullCount(),
+           (unsigned long)channel.getMaxDepth(), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+/**
+ * @brief Core 1 for benchFullCount(): two pauses long enough for several WFE wake-ups each
+ */
+static void pausingReceiver()
+{
+    PTCoreMessage message;
+    spinNs(5000000);
+    channel.receive(message);
+    channel.release(message);
+    spinNs(5000000);
+    do
+    {
+        channel.receive(message);
+        channel.release(message);
+    } while (message.type != STOP);
+}
+
+static bool benchFullCount()
+{
+    channel.reset();
+    uint32_t expected = 0;
+
+    // Failed try-calls: the pool, then the ring
+    void *held[Channel::blockCount()];
+    for (uint32_t i = 0; i < Channel::blockCount(); i++)
+        held[i] = channel.tryAcquire();
+    bool ok = channel.tryAcquire() == nullptr;
+    expected++;
+    for (uint32_t i = 0; i + 1 < Channel::blockCount(); i++)
+        ok &= channel.trySendBlock(held[i], AUDIO_BLOCK, i);
+    while (channel.pending() < 16)
+        ok &= channel.trySend(COUNT);
+    ok &= !channel.trySend(COUNT);
+    expected++;
+
+    // Blocked calls: acquire() until the receiver frees the first block,
+    // then send() until it takes the next message
+    multicore_launch_core1(pausingReceiver);
+    channel.acquire();
+    expected++;
+    ok &= channel.trySend(COUNT); // Refill the slot the receiver just freed
+    channel.send(COUNT);
+    expected++;
+    uint32_t full = channel.getFullCount(); // Before STOP, which may block as well
+    channel.send(STOP);
+    pico_host_join_core1();
+
+    ok &= full == expected;
+    printf("%-22s %lu, expected %lu  %s\n", "full count", (unsigned long)full, (unsigned long)expected,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--messages=", 11) == 0)
+        {
+            message_count = (uint32_t)strtoul(argv[i] + 11, nullptr, 10);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--messages=N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (message_count < 4)
+        message_count = 4;
+
+    printf("PTCoreChannel<16 messages, %lu x %lu B blocks>, %lu messages\n",
+           (unsigned long)Channel::blockCount(), (unsigned long)Channel::blockSize(),
+           (unsigned long)message_count);
+    if (std::thread::hardware_concurrency() < 2)
+        printf("Only one host CPU: the threads take turns, so spin and latency figures are not representative\n");
+
+    bool ok = benchMessages();
+    ok &= benchBlocks();
+    ok &= benchLatency(false);
+    ok &= benchLatency(true);
+    ok &= benchBackpressure();
+    ok &= benchFullCount();
+    return ok ? 0 : 1;
+}
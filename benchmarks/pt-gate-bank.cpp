@@ -0,0 +1,318 @@
+/**
+ * @file pt-gate-bank.cpp
+ * @brief Host check of PTGateBank edge timing, and its cost per step against PTGateOutput
+ *
+ * Every GPIO write (gpio_put, gpio_put_masked, gpio_set_mask,
+ * gpio_clr_mask) is recorded with a sequence number and the virtual time,
+ * so the program can tell which edges left in the same write.
+ *
+ * Checks:
+ *  - 8 gates, two of them active low, triggered in one step rise in one
+ *    write; the 2ms triggers fall together in one write 2ms later and
+ *    the 5ms ones in another at 5ms, with the right levels on every pin
+ *  - a step that raises some gates and lowers others is one write
+ *  - a retrigger moves the fall; setHigh() cancels it; an empty commit()
+ *    writes nothing; add() refuses a pin the bank already drives
+ *  - 8 PTGateOutput triggers in one step take 8 writes, for comparison
+ *
+ * It then fires 1-16 gates per step, bank and PTGateOutput, and prints
+ * GPIO writes per step (rise and fall), how many writes the step's
+ * rising edges are spread over, and host ns per step. On the RP2040 an
+ * SIO write is a single-cycle store; the bank's saving is the per-gate
+ * call overhead and, above all, that the edges leave at the same instant.
+ *
+ * Usage: pt-gate-bank (exit status 1 on a failed check)
+ */
+
+#include "eurorack_hardware.h"
+
+#include <chrono>
+#include <vector>
+
+// ---- Write recorder ----
+
+struct Edge
+{
+    uint pin;
+    bool level;
+    uint32_t write; // Sequence number of the GPIO write
+    uint64_t time_us;
+};
+
+static std::vector<Edge> edges;
+static uint32_t gpio_writes = 0;
+
+static void onMasked(uint32_t mask, uint32_t value)
+{
+    gpio_writes++;
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++)
+    {
+        if (mask & (1u << pin))
+            edges.push_back({pin, (value >> pin) & 1u ? true : false, gpio_writes, time_us_64()});
+    }
+}
+
+static void onPut(uint gpio, bool value)
+{
+    gpio_writes++;
+    edges.push_back({gpio, value, gpio_writes, time_us_64()});
+}
+
+static void record(bool on)
+{
+    edges.clear();
+    pico_host_gpio_masked_hook = on ? onMasked : nullptr;
+    pico_host_gpio_put_hook = on ? onPut : nullptr;
+}
+
+/**
+ * @brief Writes holding an edge to level on any of the pins in mask
+ */
+static std::vector<uint32_t> writesWith(uint32_t mask, bool level)
+{
+    std::vector<uint32_t> writes;
+    for (const Edge &e : edges)
+    {
+        if ((mask & (1u << e.pin)) && e.level == level && (writes.empty() || writes.back() != e.write))
+            writes.push_back(e.write);
+    }
+    return writes;
+}
+
+static uint64_t timeOf(uint32_t write)
+{
+    for (const Edge &e : edges)
+    {
+        if (e.write == write)
+            return e.time_us;
+    }
+    return 0;
+}
+
+static void runFor(PTGateBank<> &bank, uint64_t us)
+{
+    for (uint64_t t = 0; t < us; t += 100)
+    {
+        pico_host_advance(100);
+        bank.update();
+    }
+}
+
+// ---- Checks ----
+
+static bool checkSimultaneous()
+{
+    const uint FIRST_PIN = 8;
+    PTGateBank<> bank;
+    for (uint g = 0; g < 8; g++)
+    {
+        bool active_high = g != 2 && g != 5;
+        bank.add(FIRST_PIN + g, g < 4 ? 2000 : 5000, active_high);
+    }
+    const uint32_t low_pins = (1u << (FIRST_PIN + 2)) | (1u << (FIRST_PIN + 5));
+    const uint32_t short_pins = 0x0Fu << FIRST_PIN;
+    const uint32_t long_pins = 0xF0u << FIRST_PIN;
+
+    record(true);
+    uint64_t start = time_us_64();
+    for (uint g = 0; g < 8; g++)
+        bank.trigger(g);
+    bank.commit();
+    uint32_t levels_up = gpio_get_all();
+    runFor(bank, 6000);
+    uint32_t levels_down = gpio_get_all();
+
+    // Edges toward active: level high, or low on the active-low pins
+    std::vector<uint32_t> rise = writesWith((0xFFu << FIRST_PIN) & ~low_pins, true);
+    std::vector<uint32_t> rise_low = writesWith(low_pins, false);
+    std::vector<uint32_t> fall_short = writesWith(short_pins & ~low_pins, false);
+    std::vector<uint32_t> fall_short_low = writesWith(short_pins & low_pins, true);
+    std::vector<uint32_t> fall_long = writesWith(long_pins & ~low_pins, false);
+
+    bool ok = rise.size() == 1 && rise_low.size() == 1 && rise[0] == rise_low[0] && timeOf(rise[0]) == start &&
+              fall_short.size() == 1 && fall_short_low.size() == 1 && fall_short[0] == fall_short_low[0] &&
+              timeOf(fall_short[0]) == start + 2000 && fall_long.size() == 1 &&
+              timeOf(fall_long[0]) == start + 5000 && gpio_writes == 3 &&
+              ((levels_up ^ ~low_pins) & (0xFFu << FIRST_PIN)) == 0 &&
+              ((levels_down ^ low_pins) & (0xFFu << FIRST_PIN)) == 0;
+    printf("8 gates in one step: rise in %lu write(s), 2ms falls in %lu, 5ms falls in %lu, %lu writes  %s\n",
+           (unsigned long)rise.size(), (unsigned long)fall_short.size(), (unsigned long)fall_long.size(),
+           (unsigned long)gpio_writes, ok ? "ok" : "FAILED");
+    record(false);
+    gpio_writes = 0;
+    return ok;
+}
+
+static bool checkStaging()
+{
+    PTGateBank<> bank;
+    for (uint g = 0; g < 4; g++)
+        bank.add(16 + g, 3000);
+
+    // Mixed step: gates 0/1 held high, then 0 low and 2/3 high in one write
+    bank.setHigh(0);
+    bank.setHigh(1);
+    bank.commit();
+    record(true);
+    bank.setLow(0);
+    bank.setHigh(2);
+    bank.trigger(3);
+    bank.commit();
+    bool mixed_ok = gpio_writes == 1 && edges.size() == 3 && !bank.getState(0) && bank.getState(1) &&
+                    bank.getState(2) && bank.getState(3);
+
+    // Retrigger at 2ms moves gate 3's fall to 5ms; setHigh() keeps gate 1 up
+    pico_host_advance(2000);
+    bank.trigger(3);
+    bank.setHigh(1);
+    uint32_t before = gpio_writes;
+    bank.commit();
+    bool no_write = gpio_writes == before; // Both already high
+    runFor(bank, 2500);
+    bool retrigger_ok = bank.getState(3);
+    runFor(bank, 1000);
+    retrigger_ok = retrigger_ok && !bank.getState(3) && bank.getState(1);
+
+    before = gpio_writes;
+    bool empty_ok = !bank.commit() && !bank.update() && gpio_writes == before;
+
+    // A second gate on a pin in use would fight the first one's edges
+    bool duplicate_ok = bank.add(17, 3000, false) == -1 && bank.add(20, 3000) == 4;
+
+    bool ok = mixed_ok && no_write && retrigger_ok && empty_ok && duplicate_ok;
+    printf("staging: mixed step %s, retrigger %s, empty commit %s, duplicate pin %s  %s\n",
+           mixed_ok ? "ok" : "BAD", retrigger_ok && no_write ? "ok" : "BAD", empty_ok ? "ok" : "BAD",
+           duplicate_ok ? "ok" : "BAD", ok ? "ok" : "FAILED");
+    record(false);
+    gpio_writes = 0;
+    return ok;
+}
+
+static bool checkSingleOutputs()
+{
+    PTGateOutput *gates[8];
+    for (uint g = 0; g < 8; g++)
+        gates[g] = new PTGateOutput(8 + g, true, 2000);
+
+    record(true);
+    for (PTGateOutput *g : gates)
+        g->trigger();
+    uint32_t spread = (uint32_t)writesWith(0xFFu << 8, true).size();
+    record(false);
+    gpio_writes = 0;
+
+    for (PTGateOutput *g : gates)
+        delete g;
+    bool ok = spread == 8;
+    printf("8 PTGateOutput triggers in one step: rise in %lu writes  %s\n", (unsigned long)spread,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// ---- Cost per step ----
+
+static uint64_t nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static const uint32_t STEPS = 20000;
+static const uint32_t TRIGGER_US = 1000;
+
+static void costBank(uint n, double &ns, uint32_t &writes, uint32_t &spread)
+{
+    PTGateBank<> bank;
+    for (uint g = 0; g < n; g++)
+        bank.add(g, TRIGGER_US);
+
+    // One recorded step for the write counts
+    record(true);
+    for (uint g = 0; g < n; g++)
+        bank.trigger(g);
+    bank.commit();
+    spread = (uint32_t)writesWith(0xFFFF, true).size();
+    pico_host_time_us += TRIGGER_US;
+    bank.update();
+    writes = gpio_writes;
+    record(false);
+    gpio_writes = 0;
+
+    uint64_t start = nowNs();
+    for (uint32_t s = 0; s < STEPS; s++)
+    {
+        for (uint g = 0; g < n; g++)
+            bank.trigger(g);
+        bank.commit();
+        pico_host_time_us += TRIGGER_US;
+        bank.update();
+    }
+    ns = (double)(nowNs() - start) / STEPS;
+}
+
+static void costSingle(uint n, double &ns, uint32_t &writes, uint32_t &spread)
+{
+    std::vector<PTGateOutput *> gates;
+    for (uint g = 0; g < n; g++)
+        gates.push_back(new PTGateOutput(g, true, TRIGGER_US));
+
+    record(true);
+    for (PTGateOutput *g : gates)
+        g->trigger();
+    spread = (uint32_t)writesWith(0xFFFF, true).size();
+    pico_host_time_us += TRIGGER_US;
+    for (PTGateOutput *g : gates)
+        g->update();
+    writes = gpio_writes;
+    record(false);
+    gpio_writes = 0;
+
+    uint64_t start = nowNs();
+    for (uint32_t s = 0; s < STEPS; s++)
+    {
+        for (PTGateOutput *g : gates)
+            g->trigger();
+        pico_host_time_us += TRIGGER_US;
+        for (PTGateOutput *g : gates)
+            g->update();
+    }
+    ns = (double)(nowNs() - start) / STEPS;
+
+    for (PTGateOutput *g : gates)
+        delete g;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+    pico_host_virtual_time = true;
+
+    bool ok = checkSimultaneous();
+    ok &= checkStaging();
+    ok &= checkSingleOutputs();
+
+    printf("\nTrigger every gate each step, 1ms triggers (writes: rise + fall; spread: writes holding the rises)\n");
+    printf("%5s %11s %11s %11s %13s %13s %13s\n", "gates", "bank_writes", "bank_spread", "bank_ns", "single_writes",
+           "single_spread", "single_ns");
+    static const uint counts[] = {1, 2, 4, 8, 12, 16};
+    for (uint n : counts)
+    {
+        double bank_ns, single_ns;
+        uint32_t bank_writes, bank_spread, single_writes, single_spread;
+        costBank(n, bank_ns, bank_writes, bank_spread);
+        costSingle(n, single_ns, single_writes, single_spread);
+        bool row_ok = bank_writes == 2 && bank_spread == 1 && single_spread == n;
+        ok &= row_ok;
+        printf("%5u %11lu %11lu %11.1f %13lu %13lu %13.1f%s\n", n, (unsigned long)bank_writes,
+               (unsigned long)bank_spread, bank_ns, (unsigned long)single_writes, (unsigned long)single_spread,
+               single_ns, row_ok ? "" : "  FAILED");
+    }
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
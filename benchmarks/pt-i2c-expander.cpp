@@ -0,0 +1,411 @@
+/**
+ * @file pt-i2c-expander.cpp
+ * @brief Host check of PTI2cExpander against a modelled MCP23017/PCA9555, and its bus load
+ *
+ * The host I2C/DMA stand-ins (host/hardware/i2c.h, dma.h) run the
+ * expander's burst reads and output writes against a register-level
+ * model of each chip on address 0x20. The model drives INT the way the
+ * chip does: the MCP23017 latches a change until its port is read, the
+ * PCA9555 signals while the inputs differ from the last read. Transfers
+ * complete instantly; bus time is counted in SCL periods instead.
+ *
+ * Checks, per chip:
+ *  - init() configures directions, pull-ups and interrupts
+ *  - a bouncing press and release give one BUTTON_PRESS and one
+ *    BUTTON_RELEASE; a gate and a button changing together take one read
+ *  - LED changes on several pins go out as one write per update(), an
+ *    update() with nothing changed sends nothing, input pins stay inputs
+ *  - a read the chip NACKs is abandoned by update() after the timeout,
+ *    counted, and retried
+ *  - a write the chip NACKs is counted as an error, not as a write, does
+ *    not hold up the next read, and is sent again
+ *
+ * It then plays 8 bouncing buttons at increasing press rates for 10 s
+ * (virtual time), with LEDs following seven of them plus a step LED
+ * moving 8 times a second and update() at 1kHz. It prints bus
+ * transactions per second and bus occupancy at 400kHz next to a driver
+ * that polls the inputs every millisecond and writes each LED change in
+ * its own transaction.
+ *
+ * Usage: pt-i2c-expander (exit status 1 on a failed check)
+ */
+
+#include "eurorack_i2c_expander.h"
+
+#include <cstring>
+
+using EurorackExpander::Chip;
+
+static const uint SDA_PIN = 4;
+static const uint SCL_PIN = 5;
+static const uint INT_PIN = 6;
+static const uint8_t ADDRESS = 0x20;
+static const uint16_t INPUT_MASK = 0x00FF; // Port A/0 inputs, port B/1 LEDs
+
+// ---- Expander model ----
+
+struct ExpanderModel
+{
+    Chip chip;
+    uint8_t regs[0x16];
+    uint16_t pins;      // Levels driven on the input pins (pulled up: 1 when open)
+    uint16_t pending;   // MCP23017: changes latched until their port is read
+    uint16_t last_read; // PCA9555: input port contents at their last read
+    uint8_t pointer;
+    bool first_byte;
+    bool wrote_outputs;
+    uint32_t output_writes; // Transactions that wrote an output latch
+    uint32_t nacks_left;    // Answer this many address bytes with a NACK
+};
+
+static ExpanderModel model;
+
+static bool isMcp() { return model.chip == Chip::MCP23017; }
+
+static uint16_t pair(uint8_t reg) { return (uint16_t)(model.regs[reg] | (model.regs[reg + 1] << 8)); }
+
+static uint16_t inputPins() { return isMcp() ? pair(EurorackExpander::MCP23017_IODIRA) : pair(EurorackExpander::PCA9555_CONFIG0); }
+
+static uint16_t levels()
+{
+    uint16_t outputs = isMcp() ? pair(EurorackExpander::MCP23017_OLATA) : pair(EurorackExpander::PCA9555_OUTPUT0);
+    return (uint16_t)((model.pins & inputPins()) | (outputs & ~inputPins()));
+}
+
+static void driveInt()
+{
+    bool active = isMcp() ? (model.pending & pair(EurorackExpander::MCP23017_GPINTENA)) != 0
+                          : ((levels() ^ model.last_read) & inputPins()) != 0;
+    pico_host_gpio_drive(INT_PIN, !active); // Open-drain, active low
+}
+
+static void advancePointer()
+{
+    if (isMcp())
+        model.pointer = (uint8_t)((model.pointer + 1) % sizeof(model.regs));
+    else
+        model.pointer = (uint8_t)((model.pointer & ~1u) | ((model.pointer + 1) & 1u)); // Within the pair
+}
+
+static bool onStart(uint8_t address, bool read)
+{
+    if (address != ADDRESS)
+        return false;
+    if (model.nacks_left)
+    {
+        model.nacks_left--;
+        return false;
+    }
+    model.first_byte = !read;
+    return true;
+}
+
+static void onWrite(uint8_t byte)
+{
+    if (model.first_byte)
+    {
+        model.pointer = byte;
+        model.first_byte = false;
+        return;
+    }
+    if (model.pointer < sizeof(model.regs))
+        model.regs[model.pointer] = byte;
+    uint8_t outputs = isMcp() ? EurorackExpander::MCP23017_OLATA : EurorackExpander::PCA9555_OUTPUT0;
+    if ((model.pointer & ~1u) == outputs)
+        model.wrote_outputs = true;
+    advancePointer();
+}
+
+static uint8_t onRead()
+{
+    uint8_t inputs = isMcp() ? EurorackExpander::MCP23017_GPIOA : EurorackExpander::PCA9555_INPUT0;
+    uint8_t value = model.pointer < sizeof(model.regs) ? model.regs[model.pointer] : 0xFF;
+    if ((model.pointer & ~1u) == inputs)
+    {
+        // Reading a port returns its levels and releases its part of INT
+        uint8_t shift = (uint8_t)(8 * (model.pointer & 1u));
+        value = (uint8_t)(levels() >> shift);
+        model.pending = (uint16_t)(model.pending & ~(0xFFu << shift));
+        model.last_read = (uint16_t)((model.last_read & ~(0xFFu << shift)) | (value << shift));
+        driveInt();
+    }
+    advancePointer();
+    return value;
+}
+
+static void onStop()
+{
+    if (model.wrote_outputs)
+        model.output_writes++;
+    model.wrote_outputs = false;
+}
+
+static void resetModel(Chip chip)
+{
+    model = ExpanderModel{};
+    model.chip = chip;
+    model.pins = 0xFFFF;
+    if (!isMcp())
+    {
+        model.regs[EurorackExpander::PCA9555_OUTPUT0] = model.regs[EurorackExpander::PCA9555_OUTPUT0 + 1] = 0xFF;
+        model.regs[EurorackExpander::PCA9555_CONFIG0] = model.regs[EurorackExpander::PCA9555_CONFIG0 + 1] = 0xFF;
+    }
+    else
+    {
+        model.regs[EurorackExpander::MCP23017_IODIRA] = model.regs[EurorackExpander::MCP23017_IODIRA + 1] = 0xFF;
+    }
+    pico_host_i2c[0] = i2c_inst_t{};
+    pico_host_i2c[0].device = pico_host_i2c_device{onStart, onWrite, onRead, onStop};
+    pico_host_gpio_levels |= 1u << INT_PIN;
+}
+
+/**
+ * @brief Drive input pins from outside (buttons, gate sources)
+ */
+static void setPins(uint16_t mask, uint16_t value)
+{
+    uint16_t before = levels();
+    model.pins = (uint16_t)((model.pins & ~mask) | (value & mask));
+    model.pending = (uint16_t)(model.pending | ((before ^ levels()) & inputPins()));
+    driveInt();
+}
+
+/**
+ * @brief A press or release: the contact bounces for about a millisecond
+ */
+static void bounce(uint pin, bool pressed, uint bounces = 4)
+{
+    for (uint i = 0; i < bounces; i++)
+    {
+        setPins((uint16_t)(1u << pin), (uint16_t)(((i & 1) == 0) == pressed ? 0 : 1u << pin));
+        pico_host_advance(150);
+    }
+    setPins((uint16_t)(1u << pin), pressed ? 0 : (uint16_t)(1u << pin));
+}
+
+static uint32_t transactions() { return pico_host_i2c[0].transactions; }
+
+// ---- Checks ----
+
+static uint32_t drain(PTEventQueue &queue, PTEventType type, uint32_t data, uint32_t &others)
+{
+    uint32_t matching = 0;
+    PTEvent event;
+    while (queue.pop(event))
+    {
+        if (event.type == type && event.data == data)
+            matching++;
+        else
+            others++;
+    }
+    return matching;
+}
+
+static bool checkChip(const char *name, Chip chip)
+{
+    resetModel(chip);
+    PTI2cExpander expander(i2c0, chip, ADDRESS, SDA_PIN, SCL_PIN, INT_PIN, INPUT_MASK);
+    PTExpanderButton button(expander, 0, 10);
+    PTExpanderButton second(expander, 1, 12);
+    PTExpanderGate gate(expander, 7, 11);
+    PTEventQueue queue;
+    button.setEventQueue(&queue);
+    second.setEventQueue(&queue);
+    gate.setEventQueue(&queue);
+
+    bool config_ok = expander.isPresent() && inputPins() == INPUT_MASK;
+    if (isMcp())
+        config_ok = config_ok && pair(EurorackExpander::MCP23017_GPPUA) == INPUT_MASK &&
+                    pair(EurorackExpander::MCP23017_GPINTENA) == INPUT_MASK &&
+                    model.regs[EurorackExpander::MCP23017_IOCON] == 0x44;
+
+    // Bouncing press and release: one event each, one read per edge the chip reports
+    uint32_t others = 0;
+    pico_host_advance(100000);
+    uint32_t reads_before = expander.getReadCount();
+    bounce(0, true);
+    uint32_t presses = drain(queue, PTEventType::BUTTON_PRESS, 10, others);
+    bool held = button.isPressed();
+    pico_host_advance(100000);
+    bounce(0, false);
+    uint32_t releases = drain(queue, PTEventType::BUTTON_RELEASE, 10, others);
+    uint32_t bounce_reads = expander.getReadCount() - reads_before;
+    bool button_ok = presses == 1 && releases == 1 && held && !button.isPressed() && others == 0;
+
+    // Gate falls and a button is pressed between two reads: one read, both events
+    pico_host_advance(100000);
+    reads_before = expander.getReadCount();
+    setPins((1u << 7) | (1u << 1), 0);
+    PTEvent first, next;
+    bool together_ok = expander.getReadCount() - reads_before == 1 && queue.size() == 2 && queue.pop(first) &&
+                       queue.pop(next) && first.type == PTEventType::BUTTON_PRESS && first.data == 12 &&
+                       next.type == PTEventType::GATE_FALLING && next.data == 11 && !gate.getState();
+    pico_host_advance(5000);
+    setPins(1u << 7, 1u << 7);
+    together_ok = together_ok && queue.pop(first) && first.type == PTEventType::GATE_RISING && gate.getState();
+    pico_host_advance(3000);
+    setPins(1u << 7, 0);
+    together_ok = together_ok && queue.pop(first) && first.type == PTEventType::GATE_FALLING &&
+                  gate.getGateDuration() == 3000 && queue.size() == 0;
+
+    // Five LEDs, one write; nothing changed, no write; input pins never driven
+    uint32_t before = transactions();
+    uint32_t writes_before = model.output_writes;
+    for (uint pin = 8; pin < 13; pin++)
+        expander.setOutput(pin, true);
+    expander.setOutput(3, true);
+    expander.update();
+    uint32_t led_transactions = transactions() - before;
+    uint16_t olat = isMcp() ? pair(EurorackExpander::MCP23017_OLATA) : pair(EurorackExpander::PCA9555_OUTPUT0);
+    before = transactions();
+    expander.update();
+    bool led_ok = led_transactions == 1 && model.output_writes - writes_before == 1 && (olat & 0xFF00) == 0x1F00 &&
+                  transactions() == before && inputPins() == INPUT_MASK && expander.getWriteCount() == 1;
+
+    // A NACKed read hangs until update() gives up on it, then succeeds
+    model.nacks_left = 1;
+    pico_host_advance(100000);
+    bounce(0, true, 0);
+    bool stuck = expander.isBusy() && queue.size() == 0;
+    pico_host_advance(PT_I2C_EXPANDER_TIMEOUT_US / 2);
+    expander.update();
+    bool early = expander.getErrorCount() == 0 && expander.isBusy();
+    pico_host_advance(PT_I2C_EXPANDER_TIMEOUT_US);
+    expander.update();
+    bool timeout_ok = stuck && early && expander.getErrorCount() == 1 && !expander.isBusy() && button.isPressed() &&
+                      queue.pop(first) && first.type == PTEventType::BUTTON_PRESS;
+
+    // A NACKed write is an error, not a write; the read after it goes through and resends it
+    model.nacks_left = 1;
+    writes_before = model.output_writes;
+    expander.setOutput(13, true);
+    expander.update();
+    bool refused = expander.getWriteCount() == 1 && model.output_writes == writes_before &&
+                   expander.getErrorCount() == 2 && !expander.isBusy();
+    pico_host_advance(100000);
+    bounce(0, false, 0);
+    bool read_through = !expander.isBusy() && !button.isPressed() && queue.pop(first) &&
+                        first.type == PTEventType::BUTTON_RELEASE;
+    before = transactions();
+    expander.update();
+    olat = isMcp() ? pair(EurorackExpander::MCP23017_OLATA) : pair(EurorackExpander::PCA9555_OUTPUT0);
+    bool nack_ok = refused && read_through && transactions() == before && expander.getWriteCount() == 2 &&
+                   model.output_writes - writes_before == 1 && (olat & 0xFF00) == 0x3F00 &&
+                   expander.getErrorCount() == 2;
+
+    bool ok = config_ok && button_ok && together_ok && led_ok && timeout_ok && nack_ok;
+    printf("%-9s config %s, bouncing button %s (%lu reads), together %s, leds %s, timeout %s, write nack %s  %s\n",
+           name, config_ok ? "ok" : "BAD", button_ok ? "ok" : "BAD", (unsigned long)bounce_reads,
+           together_ok ? "ok" : "BAD", led_ok ? "ok" : "BAD", timeout_ok ? "ok" : "BAD", nack_ok ? "ok" : "BAD",
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// ---- Bus load under button activity ----
+
+// SCL periods of the polled driver's transfers: a burst read, a one-pin write
+static const uint32_t READ_BITS = 1 + 9 + 9 + 1 + 9 + 9 + 9 + 1;
+static const uint32_t WRITE_BITS = 1 + 9 + 9 + 9 + 9 + 1;
+
+static void activity(uint32_t presses_per_second)
+{
+    resetModel(Chip::MCP23017);
+    PTI2cExpander expander(i2c0, Chip::MCP23017, ADDRESS, SDA_PIN, SCL_PIN, INT_PIN, INPUT_MASK);
+    PTExpanderButton *buttons[8];
+    PTEventQueue queue;
+    for (uint b = 0; b < 8; b++)
+    {
+        buttons[b] = new PTExpanderButton(expander, b, (uint8_t)b);
+        buttons[b]->setEventQueue(&queue);
+    }
+
+    const uint32_t seconds = 10;
+    const uint32_t frames = seconds * 1000;
+    uint32_t interval = presses_per_second ? 1000 / presses_per_second : 0;
+    uint32_t start_transactions = transactions();
+    uint64_t start_bits = pico_host_i2c[0].bits;
+    uint32_t led_changes = 0, events = 0, seed = 7;
+    uint16_t previous = expander.getOutputs();
+    int32_t release_at[8];
+    for (int32_t &r : release_at)
+        r = -1;
+
+    for (uint32_t frame = 0; frame < frames; frame++)
+    {
+        // Presses at random buttons, held for 80 ms
+        if (interval && frame % interval == 0)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            uint b = (seed >> 16) % 8;
+            if (release_at[b] < 0)
+            {
+                bounce(b, true);
+                release_at[b] = (int32_t)(frame + 80);
+            }
+        }
+        for (uint b = 0; b < 8; b++)
+        {
+            if (release_at[b] == (int32_t)frame)
+            {
+                bounce(b, false);
+                release_at[b] = -1;
+            }
+        }
+
+        // LEDs: one per button, a step LED moving 8 times a second
+        for (uint b = 0; b < 7; b++)
+            expander.setOutput(8 + b, buttons[b]->isPressed());
+        expander.setOutput(15, (frame / 125) % 2);
+        uint16_t diff = (uint16_t)(expander.getOutputs() ^ previous);
+        previous = expander.getOutputs();
+        while (diff)
+        {
+            led_changes += diff & 1;
+            diff >>= 1;
+        }
+        expander.update();
+
+        PTEvent event;
+        while (queue.pop(event))
+            events++;
+        pico_host_advance(1000 - (pico_host_time_us % 1000));
+    }
+
+    double per_second = 1.0 / seconds;
+    double read_rate = expander.getReadCount() * per_second;
+    double write_rate = expander.getWriteCount() * per_second;
+    double bus_rate = (transactions() - start_transactions) * per_second;
+    double busy = (pico_host_i2c[0].bits - start_bits) * per_second / 400000.0 * 100.0;
+    double polled_rate = 1000.0 + led_changes * per_second;
+    double polled_busy = (1000.0 * READ_BITS + led_changes * per_second * WRITE_BITS) / 400000.0 * 100.0;
+    printf("%9lu %8.1f %8.1f %9.1f %7.2f %9.1f %10.1f %8.2f\n", (unsigned long)presses_per_second,
+           events * per_second, read_rate, write_rate, busy, bus_rate, polled_rate, polled_busy);
+
+    for (PTExpanderButton *b : buttons)
+        delete b;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+    pico_host_virtual_time = true;
+
+    printf("Modelled chip check (inputs on pins 0-7, LEDs on 8-15)\n");
+    bool ok = checkChip("MCP23017", Chip::MCP23017);
+    ok &= checkChip("PCA9555", Chip::PCA9555);
+
+    printf("\nMCP23017 at 400kHz, 8 bouncing buttons, 8 LEDs, update() at 1kHz, 10 s\n");
+    printf("Polled: a read every 1 ms and a write per LED change\n");
+    printf("%9s %8s %8s %9s %7s %9s %10s %8s\n", "presses/s", "events/s", "reads/s", "writes/s", "bus_%",
+           "xfers/s", "polled/s", "polled_%");
+    static const uint32_t rates[] = {0, 1, 5, 20, 50};
+    for (uint32_t rate : rates)
+        activity(rate);
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,283 @@
+/**
+ * @file pt-latency-sim.cpp
+ * @brief Host simulation of ISR-to-thread event latency under mixed load
+ *
+ * Runs the real PTScheduler and PTEventQueue on a virtual clock. Simulated
+ * interrupt sources (gate clock, encoder bursts, buttons, MIDI clock and
+ * notes, CV changes) push events at their due times, including while a
+ * thread is busy, and the threads spend virtual time on each event and on
+ * periodic work (a blocking display refresh and a DSP block). The queue's
+ * latency histograms then give p50/p99/max per event type, and a
+ * PTMonitor line shows the load and queue depth behind them (stacks are
+ * not measured on the host). The reported idle time is checked against
+ * the work the threads did, including the event thread's work between
+ * two PT_WAIT_EVENT blocks.
+ *
+ * Usage: pt-latency-sim [--seconds=N] [--seed=N]
+ */
+
+#include "pt_thread.h"
+#include "pt_monitor.h"
+#include "pt_check.h"
+
+#include <cstdlib>
+#include <cstring>
+
+// ----------------------------------------------------------------------------
+// Simulated interrupt sources
+// ----------------------------------------------------------------------------
+
+static const uint32_t ISR_COST_US = 3;  // Handler time stolen from the running thread
+static const uint32_t LOOP_COST_US = 2; // One idle scheduler pass
+
+struct IrqSource
+{
+    PTEventType type;
+    uint32_t period_us;
+    uint32_t jitter_us;
+    uint8_t burst;         // Events per activation
+    uint32_t burst_gap_us; // Spacing inside a burst
+    uint64_t next_us;
+    uint8_t remaining;
+};
+
+static IrqSource sources[] = {
+    {PTEventType::GATE_RISING, 125000, 200, 1, 0, 0, 0},       // 16ths at 120 BPM
+    {PTEventType::ENCODER_TURN, 80000, 40000, 8, 1500, 0, 0},  // A quick turn
+    {PTEventType::BUTTON_PRESS, 700000, 300000, 1, 0, 0, 0},
+    {PTEventType::MIDI_CLOCK, 20833, 50, 1, 0, 0, 0},          // 24 PPQN at 120 BPM
+    {PTEventType::MIDI_NOTE_ON, 60000, 50000, 3, 960, 0, 0},   // Chords, one message per ms
+    {PTEventType::CV_CHANGE, 5000, 1000, 1, 0, 0, 0},
+};
+
+static const size_t SOURCE_COUNT = sizeof(sources) / sizeof(sources[0]);
+
+static PTScheduler scheduler;
+static PTMonitor monitor;
+static uint32_t random_state = 1;
+static uint32_t dropped_events = 0;
+static uint64_t work_us = 0; // Handling cost the threads asked for, without interrupts
+
+static uint32_t nextRandom(uint32_t range)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return range ? random_state % range : 0;
+}
+
+static void scheduleNext(IrqSource &source)
+{
+    if (source.remaining > 0)
+    {
+        source.next_us += source.burst_gap_us;
+        return;
+    }
+    source.remaining = source.burst;
+    source.next_us += source.period_us - source.jitter_us / 2 + nextRandom(source.jitter_us);
+}
+
+/**
+ * @brief Spend CPU time, delivering every interrupt that falls due meanwhile
+ */
+static void advance(uint32_t us)
+{
+    uint64_t end = pico_host_time_us + us;
+
+    while (true)
+    {
+        IrqSource *due = nullptr;
+        for (size_t i = 0; i < SOURCE_COUNT; i++)
+        {
+            if (sources[i].next_us <= end && (!due || sources[i].next_us < due->next_us))
+                due = &sources[i];
+        }
+        if (!due)
+            break;
+
+        if (due->next_us > pico_host_time_us)
+            pico_host_time_us = due->next_us;
+
+        // The handler stamps and pushes the event, as the hardware classes do
+        if (!scheduler.postEvent(due->type, due->remaining))
+            dropped_events++;
+        if (due->remaining > 0)
+            due->remaining--;
+        scheduleNext(*due);
+
+        pico_host_time_us += ISR_COST_US;
+        end += ISR_COST_US;
+    }
+
+    pico_host_time_us = end;
+}
+
+// ----------------------------------------------------------------------------
+// Threads
+// ----------------------------------------------------------------------------
+
+/**
+ * @brief Consumes every event, with a handling cost per type
+ */
+class EventThread : public PTThread
+{
+private:
+    PTEvent event;
+
+    static uint32_t costFor(PTEventType type)
+    {
+        switch (type)
+        {
+        case PTEventType::ENCODER_TURN:
+            return 40;
+        case PTEventType::BUTTON_PRESS:
+            return 200;
+        case PTEventType::GATE_RISING:
+            return 25;
+        case PTEventType::MIDI_CLOCK:
+            return 15;
+        case PTEventType::MIDI_NOTE_ON:
+            return 60;
+        default:
+            return 30;
+        }
+    }
+
+public:
+    EventThread() : PTThread("Events") {}
+
+    int run() override
+    {
+        PT_THREAD_BEGIN(this);
+        while (true)
+        {
+            PT_WAIT_EVENT(this, event);
+            work_us += costFor(event.type);
+            advance(costFor(event.type));
+        }
+        PT_THREAD_END(this);
+    }
+};
+
+/**
+ * @brief Fixed-rate job that blocks for its whole run time
+ */
+class PeriodicThread : public PTThread
+{
+private:
+    uint32_t period_us;
+    uint32_t cost_us;
+    uint64_t next_us;
+
+public:
+    PeriodicThread(const char *name, uint32_t period_us, uint32_t cost_us)
+        : PTThread(name), period_us(period_us), cost_us(cost_us), next_us(0)
+    {
+    }
+
+    int run() override
+    {
+        if (pico_host_time_us >= next_us)
+        {
+            work_us += cost_us;
+            advance(cost_us);
+            next_us += period_us;
+        }
+        return PT_YIELDED;
+    }
+};
+
+// ----------------------------------------------------------------------------
+// Report
+// ----------------------------------------------------------------------------
+
+static const char *typeName(PTEventType type)
+{
+    switch (type)
+    {
+    case PTEventType::GATE_RISING:
+        return "GATE_RISING";
+    case PTEventType::ENCODER_TURN:
+        return "ENCODER_TURN";
+    case PTEventType::BUTTON_PRESS:
+        return "BUTTON_PRESS";
+    case PTEventType::MIDI_CLOCK:
+        return "MIDI_CLOCK";
+    case PTEventType::MIDI_NOTE_ON:
+        return "MIDI_NOTE_ON";
+    case PTEventType::CV_CHANGE:
+        return "CV_CHANGE";
+    default:
+        return "OTHER";
+    }
+}
+
+int main(int argc, char **argv)
+{
+    monitor.paintStacks();
+    uint32_t seconds = 10;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--seconds=", 10) == 0)
+            seconds = (uint32_t)std::atoi(argv[i] + 10);
+        else if (std::strncmp(argv[i], "--seed=", 7) == 0)
+            random_state = (uint32_t)std::atoi(argv[i] + 7) | 1;
+        else
+        {
+            fprintf(stderr, "usage: %s [--seconds=N] [--seed=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    pico_host_virtual_time = true;
+    pico_host_time_us = 0;
+    for (size_t i = 0; i < SOURCE_COUNT; i++)
+    {
+        sources[i].next_us = nextRandom(sources[i].period_us);
+        sources[i].remaining = sources[i].burst;
+    }
+
+    static EventThread events;
+    static PeriodicThread display("Display", 33000, 6000); // Blocking OLED refresh
+    static PeriodicThread dsp("DSP", 1000, 150);           // 1kHz control-rate block
+    scheduler.addThread(&events);
+    scheduler.addThread(&display);
+    scheduler.addThread(&dsp);
+    monitor.watchCore(0, &scheduler);
+    monitor.watchQueue(scheduler.getEventQueue());
+
+    const uint64_t end_us = (uint64_t)seconds * 1000000;
+    while (pico_host_time_us < end_us)
+    {
+        scheduler.runOnce();
+        advance(LOOP_COST_US);
+    }
+
+    const PTLatencyHistogram &latency = scheduler.getEventQueue()->getLatency();
+
+    printf("Simulated %lu s: event thread + 6ms display every 33ms + 150us DSP every 1ms\n",
+           (unsigned long)seconds);
+    printf("%-14s %8s %8s %8s %8s\n", "event", "count", "p50_us", "p99_us", "max_us");
+    for (size_t i = 0; i < SOURCE_COUNT; i++)
+    {
+        PTEventType type = sources[i].type;
+        printf("%-14s %8lu %8lu %8lu %8lu\n", typeName(type),
+               (unsigned long)latency.getCount(type),
+               (unsigned long)latency.getPercentile(type, 500),
+               (unsigned long)latency.getPercentile(type, 990),
+               (unsigned long)latency.getMax(type));
+    }
+    printf("dropped (queue full): %lu\n", (unsigned long)dropped_events);
+    const PTMonitorSnapshot &snapshot = monitor.update();
+    monitor.report();
+
+    // Interrupts taken inside a thread add to its run, so the load may
+    // only exceed the requested work by their cost
+    uint32_t work_permille = (uint32_t)(work_us * 1000 / pico_host_time_us);
+    printf("requested work: %lu.%lu%%\n", (unsigned long)(work_permille / 10), (unsigned long)(work_permille % 10));
+    PTCheck::check(scheduler.getBusyTime() >= work_us, "busy time covers the threads' work");
+    PTCheck::check(snapshot.idle_permille[0] <= 1000 - work_permille, "idle excludes work done before PT_WAIT_EVENT blocks again");
+    PTCheck::check((uint32_t)snapshot.idle_permille[0] + 10 >= 1000 - work_permille, "idle within 1% of wall time minus the work");
+    return PTCheck::summary();
+}
@@ -0,0 +1,343 @@
+/**
+ * @file pt-midi-parser.cpp
+ * @brief Host check of PTMidiParser, PTMidiInput and the PTMidiUart RX ring and output
+ *
+ * Byte streams go through PTMidiParser and the messages that come out
+ * are compared with the expected ones:
+ *  - running status, including across note-offs sent as velocity 0
+ *  - realtime bytes (0xF8 clock, 0xFA start, 0xFC stop) in the middle of
+ *    a channel message and of a SysEx, which must be delivered at once
+ *    and leave the interrupted message intact
+ *  - SysEx cut short by a new status byte, and data after 0xF7
+ *  - stray data bytes after reset() and after system common messages,
+ *    which carry no running status
+ *
+ * PTMidiInput::processBytes() then turns a stream into queue events:
+ * velocity 0 note-ons become note-offs, the channel filter applies, and
+ * 24 PPQN clock in 16ths posts one MIDI_CLOCK per 6 ticks after start,
+ * and ticks that arrive two to a poll, with the same timestamp, still
+ * give the right tempo.
+ *
+ * PTMidiUart's DMA ring is fed through the host UART: exactly one ring of
+ * bytes between polls is parsed in full, while more than a ring is
+ * counted in getRxOverruns() and parsing resyncs at the next status byte.
+ * Its output is read back from the UART data register: each message
+ * carries exactly its data bytes, with running status, and a full
+ * transmit queue refuses whole messages, never part of one.
+ *
+ * Usage: pt-midi-parser (exit status 1 on a failed check)
+ */
+
+#include "eurorack_midi.h"
+#include "pt_check.h"
+
+#include <vector>
+
+using PTCheck::check;
+
+static std::vector<PTMidiMessage> parse(PTMidiParser &parser, const std::vector<uint8_t> &bytes)
+{
+    std::vector<PTMidiMessage> messages;
+    PTMidiMessage msg;
+    for (uint8_t byte : bytes)
+    {
+        if (parser.parse(byte, msg))
+            messages.push_back(msg);
+    }
+    return messages;
+}
+
+static bool same(const std::vector<PTMidiMessage> &got, const std::vector<PTMidiMessage> &expected)
+{
+    if (got.size() != expected.size())
+        return false;
+    for (size_t i = 0; i < got.size(); i++)
+    {
+        if (got[i].status != expected[i].status || got[i].data1 != expected[i].data1 ||
+            got[i].data2 != expected[i].data2)
+            return false;
+    }
+    return true;
+}
+
+static void checkParser()
+{
+    struct Case
+    {
+        const char *name;
+        std::vector<uint8_t> bytes;
+        std::vector<PTMidiMessage> expected;
+    };
+    static const Case cases[] = {
+        {"running status: three notes after one status byte",
+         {0x90, 60, 100, 62, 100, 64, 0},
+         {{0x90, 60, 100}, {0x90, 62, 100}, {0x90, 64, 0}}},
+        {"running status: one-byte messages (program change)",
+         {0xC3, 5, 6, 7},
+         {{0xC3, 5, 0}, {0xC3, 6, 0}, {0xC3, 7, 0}}},
+        {"running status survives a realtime byte",
+         {0xB0, 1, 10, 0xF8, 1, 20},
+         {{0xB0, 1, 10}, {0xF8, 0, 0}, {0xB0, 1, 20}}},
+        {"clock between status and first data byte",
+         {0x90, 0xF8, 60, 100},
+         {{0xF8, 0, 0}, {0x90, 60, 100}}},
+        {"start and stop between the two data bytes",
+         {0x90, 60, 0xFA, 0xFC, 100},
+         {{0xFA, 0, 0}, {0xFC, 0, 0}, {0x90, 60, 100}}},
+        {"realtime inside a SysEx: delivered, SysEx data still ignored",
+         {0xF0, 0x7E, 0xF8, 0x01, 0xFA, 0x02, 0xF7},
+         {{0xF8, 0, 0}, {0xFA, 0, 0}}},
+        {"SysEx cut short by a note-on: the note is parsed",
+         {0xF0, 0x7E, 0x01, 0x90, 60, 100},
+         {{0x90, 60, 100}}},
+        {"SysEx cut short by a status byte, then running status",
+         {0xF0, 0x7E, 0xB2, 7, 127, 7, 0},
+         {{0xB2, 7, 127}, {0xB2, 7, 0}}},
+        {"data after SysEx end is ignored (running status cleared)",
+         {0x90, 60, 100, 0xF0, 0x01, 0xF7, 62, 100},
+         {{0x90, 60, 100}}},
+        {"song position, then stray data: no running status for system common",
+         {0xF2, 0x10, 0x20, 0x30, 0x40},
+         {{0xF2, 0x10, 0x20}}},
+        {"tune request completes on its own and clears running status",
+         {0x90, 60, 100, 0xF6, 62, 100},
+         {{0x90, 60, 100}, {0xF6, 0, 0}}},
+        {"data before any status byte is ignored",
+         {60, 100, 0x80, 60, 0},
+         {{0x80, 60, 0}}},
+    };
+
+    for (const Case &c : cases)
+    {
+        PTMidiParser parser;
+        check(same(parse(parser, c.bytes), c.expected), c.name);
+    }
+
+    // reset() drops a message in progress and the running status
+    PTMidiParser parser;
+    parse(parser, {0x90, 60, 100, 62});
+    parser.reset();
+    bool stray_ignored = parse(parser, {100, 64, 100}).empty();
+    bool resumes = same(parse(parser, {0x91, 64, 100}), {{0x91, 64, 100}});
+    check(stray_ignored && resumes, "after reset(): stray data ignored until the next status byte");
+}
+
+/**
+ * @brief Drain a queue into a list of events
+ */
+static std::vector<PTEvent> drain(PTEventQueue &queue)
+{
+    std::vector<PTEvent> events;
+    PTEvent event;
+    while (queue.pop(event))
+        events.push_back(event);
+    return events;
+}
+
+static void checkInput()
+{
+    PTEventQueue queue;
+    PTMidiInput input;
+    input.setEventQueue(&queue);
+
+    // Note-on velocity 0 is a note-off; running status carries across
+    static const uint8_t notes[] = {0x92, 60, 100, 60, 0, 0xB2, 74, 33};
+    input.processBytes(notes, sizeof(notes), 1000);
+    std::vector<PTEvent> events = drain(queue);
+    bool ok = events.size() == 3 && events[0].type == PTEventType::MIDI_NOTE_ON &&
+              events[0].data == EurorackMidi::packEventData(2, 60, 100) &&
+              events[1].type == PTEventType::MIDI_NOTE_OFF && events[1].data == EurorackMidi::packEventData(2, 60, 0) &&
+              events[2].type == PTEventType::MIDI_CONTROL_CHANGE &&
+              events[2].data == EurorackMidi::packEventData(2, 74, 33) && events[2].timestamp == 1000;
+    check(ok, "processBytes(): note-on, velocity-0 note-off, CC with running status");
+
+    // Channel filter drops other channels but never realtime
+    input.setChannel(5);
+    static const uint8_t filtered[] = {0x90, 60, 100, 0xFA, 0x95, 61, 100};
+    input.processBytes(filtered, sizeof(filtered), 2000);
+    events = drain(queue);
+    ok = events.size() == 2 && events[0].type == PTEventType::MIDI_START &&
+         events[1].type == PTEventType::MIDI_NOTE_ON && events[1].data == EurorackMidi::packEventData(5, 61, 100);
+    check(ok, "channel filter: other channels dropped, start still delivered");
+    input.setChannel(EurorackMidi::OMNI);
+
+    // 48 ticks in 16ths after start: one step per 6 ticks, one tick inside a note
+    uint32_t clocks = 0, steps_ok = 1, notes_seen = 0;
+    for (uint32_t tick = 0; tick < 48; tick++)
+    {
+        static const uint8_t note_with_clock[] = {0x90, 48, 0xF8, 90};
+        static const uint8_t clock[] = {0xF8};
+        if (tick == 20)
+            input.processBytes(note_with_clock, sizeof(note_with_clock), 2000 + tick * 20833);
+        else
+            input.processBytes(clock, 1, 2000 + tick * 20833);
+        for (const PTEvent &e : drain(queue))
+        {
+            if (e.type == PTEventType::MIDI_CLOCK)
+            {
+                clocks++;
+                steps_ok &= e.data == clocks;
+            }
+            else if (e.type == PTEventType::MIDI_NOTE_ON && e.data == EurorackMidi::packEventData(0, 48, 90))
+                notes_seen++;
+        }
+    }
+    char line[96];
+    snprintf(line, sizeof(line), "48 clock ticks after start: %lu steps, note split by a tick intact",
+             (unsigned long)clocks);
+    check(clocks == 8 && steps_ok && notes_seen == 1, line);
+
+    // 120 BPM read by a poll every other tick: both ticks of a poll carry its timestamp
+    PTMidiInput polled;
+    static const uint8_t two_ticks[] = {0xF8, 0xF8};
+    for (uint32_t poll = 0; poll < 48; poll++)
+        polled.processBytes(two_ticks, sizeof(two_ticks), 5000 + poll * 41666);
+    uint32_t interval = polled.getClock().getTickIntervalUs();
+    float bpm = polled.getClock().getTempoBPM();
+    snprintf(line, sizeof(line), "two ticks per timestamp at 120 BPM: %.1f BPM (tick %lu us)", bpm,
+             (unsigned long)interval);
+    check(interval >= 20800 && interval <= 20866 && bpm > 119.8f && bpm < 120.2f, line);
+}
+
+static void send(uart_inst_t *uart, const std::vector<uint8_t> &bytes)
+{
+    for (uint8_t byte : bytes)
+        pico_host_uart_receive(uart, byte);
+}
+
+static void checkUartRing()
+{
+    PTEventQueue queue;
+    PTMidiUart midi(uart1, 4, 5);
+    midi.setEventQueue(&queue);
+    midi.init();
+
+    // Exactly one ring between polls: a note at each end around a SysEx,
+    // so losing either end, or taking the full ring for an empty one, shows
+    std::vector<uint8_t> ring = {0x90, 60, 100, 0xF0};
+    while (ring.size() < PTMidiUart::RX_BUFFER_SIZE - 4)
+        ring.push_back(0x11);
+    ring.insert(ring.end(), {0xF7, 0x90, 62, 100});
+    send(uart1, ring);
+    size_t parsed = midi.poll();
+    std::vector<PTEvent> notes = drain(queue);
+    check(parsed == PTMidiUart::RX_BUFFER_SIZE && notes.size() == 2 &&
+              EurorackMidi::eventData1(notes[0].data) == 60 && EurorackMidi::eventData1(notes[1].data) == 62 &&
+              midi.getRxOverruns() == 0,
+          "RX ring: exactly 256 bytes between polls, all parsed");
+
+    // 100 bytes more than the ring: counted, and no event from a torn message
+    std::vector<uint8_t> flood;
+    for (uint32_t i = 0; i < PTMidiUart::RX_BUFFER_SIZE + 100; i += 3)
+    {
+        flood.push_back(0xB1);
+        flood.push_back((uint8_t)(i % 100));
+        flood.push_back(0x55);
+    }
+    send(uart1, flood);
+    midi.poll();
+    bool clean = true;
+    for (const PTEvent &e : drain(queue))
+        clean &= e.type == PTEventType::MIDI_CONTROL_CHANGE && EurorackMidi::eventData2(e.data) == 0x55;
+    check(midi.getRxOverruns() == flood.size() - PTMidiUart::RX_BUFFER_SIZE && clean,
+          "RX ring lapped: overwritten bytes counted, parser resyncs");
+
+    // And carries on normally
+    send(uart1, {0x90, 61, 101});
+    midi.poll();
+    std::vector<PTEvent> events = drain(queue);
+    check(events.size() == 1 && events[0].data == EurorackMidi::packEventData(0, 61, 101),
+          "RX ring after an overrun: next message parsed");
+}
+
+static bool txBusy(uart_inst_t *uart)
+{
+    for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+    {
+        if (pico_host_dma[i].active && pico_host_dma[i].config.dreq == uart_get_dreq(uart, true))
+            return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Let the UART take everything queued, one TX DREQ per byte
+ */
+static std::vector<uint8_t> transmitted(PTMidiUart &midi, uart_inst_t *uart)
+{
+    std::vector<uint8_t> bytes;
+    while (true)
+    {
+        if (!txBusy(uart))
+        {
+            midi.flush();
+            if (!txBusy(uart))
+                break;
+        }
+        pico_host_dma_dreq(uart_get_dreq(uart, true));
+        bytes.push_back((uint8_t)uart_get_hw(uart)->dr);
+    }
+    return bytes;
+}
+
+static void checkUartSend()
+{
+    PTMidiUart midi(uart0, 0, 1);
+    midi.init();
+
+    midi.send({0x90, 60, 100});
+    midi.send({0x90, 62, 100});
+    midi.send({0xF8, 0, 0});
+    midi.send({0x90, 64, 100});
+    check(transmitted(midi, uart0) == std::vector<uint8_t>({0x90, 60, 100, 62, 100, 0xF8, 64, 100}),
+          "TX: running status, realtime in between keeps it");
+
+    midi.send({0xF6, 0, 0});
+    midi.send({0xF1, 0x12, 0x34});
+    midi.send({0xF3, 5, 6});
+    midi.send({0xF2, 1, 2});
+    midi.send({0x90, 64, 0});
+    midi.send({0xC3, 7, 8});
+    check(transmitted(midi, uart0) ==
+              std::vector<uint8_t>({0xF6, 0xF1, 0x12, 0xF3, 5, 0xF2, 1, 2, 0x90, 64, 0, 0xC3, 7}),
+          "TX: system common and program change carry only their data bytes");
+
+    // Control changes on alternating channels (3 bytes each) until the queue is full
+    uint32_t accepted = 0;
+    bool refused = false;
+    while (!refused)
+    {
+        refused = !midi.send({(uint8_t)(0xB0 | (accepted & 1)), (uint8_t)(accepted & 0x7F), 0x55});
+        if (!refused)
+            accepted++;
+    }
+    midi.send({0x91, 60, 100}); // Also refused: the queue has one byte left
+    uint32_t overflows = midi.getTxOverflows();
+    std::vector<uint8_t> bytes = transmitted(midi, uart0);
+    midi.send({0x92, 1, 2});
+    std::vector<uint8_t> after = transmitted(midi, uart0);
+
+    PTMidiParser parser;
+    std::vector<PTMidiMessage> got = parse(parser, bytes);
+    bool whole = bytes.size() == accepted * 3 && got.size() == accepted;
+    for (uint32_t i = 0; whole && i < accepted; i++)
+        whole = got[i].status == (0xB0 | (i & 1)) && got[i].data1 == (i & 0x7F) && got[i].data2 == 0x55;
+    check(whole && overflows == 2 && after == std::vector<uint8_t>({0x92, 1, 2}),
+          "TX queue full: whole messages refused and counted, nothing partial sent");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    checkParser();
+    checkInput();
+    checkUartRing();
+    checkUartSend();
+
+    return PTCheck::summary();
+}
@@ -0,0 +1,183 @@
+/**
+ * @file pt-modulation.cpp
+ * @brief Host check of PTEnvelope segment timing and PTLFO rates
+ *
+ * Envelope: at 1kHz, 8kHz and 48kHz control rates, and at the default,
+ * minimum and maximum curves, each attack, decay and release must take
+ * its configured time within one sample. The attack is also timed when
+ * retriggered from part way down the decay, since a segment is meant to
+ * take its full time from any starting level. Along the way every
+ * sample must stay within 0..32767 and move towards the segment's
+ * target, which also catches an overflowing overshoot. Curves outside
+ * the supported range (0, 100) must be clamped rather than ending the
+ * segment in one sample or wrapping.
+ *
+ * LFO: free-running and tempo-synced rates must run the expected number
+ * of cycles over 10 seconds, within 0.1%.
+ *
+ * Usage: pt-modulation (exit status 1 on a failed check)
+ */
+
+#include "eurorack_modulation.h"
+
+#include <cmath>
+#include <cstdlib>
+
+static int failures = 0;
+
+/**
+ * @brief Samples spent in a stage, one process() call per sample
+ * @param monotonic Cleared if the output moves away from the target or out of range
+ */
+static uint32_t runStage(PTEnvelope &env, PTEnvelope::Stage stage, bool rising, bool &monotonic,
+                         uint32_t stop_after = 0)
+{
+    uint32_t samples = 0;
+    int16_t previous = env.getOutput();
+    while (env.getStage() == stage && samples < 10000000)
+    {
+        int16_t out;
+        env.process(&out, 1);
+        samples++;
+        if (out < 0 || (rising ? out < previous : out > previous))
+            monotonic = false;
+        previous = out;
+        if (stop_after && samples == stop_after)
+            break;
+    }
+    return samples;
+}
+
+static bool within(uint32_t samples, float ms, float rate)
+{
+    float expected = ms * rate / 1000.0f;
+    return std::fabs((float)samples - expected) <= 1.0f;
+}
+
+static void checkTiming(float rate, float curve, const char *curve_name)
+{
+    const float attack_ms = 10.0f, decay_ms = 125.0f, release_ms = 2000.0f;
+    PTEnvelope env(rate);
+    env.setAttack(attack_ms, curve);
+    env.setDecay(decay_ms, curve);
+    env.setRelease(release_ms, curve);
+    env.setSustain(0.25f);
+
+    bool monotonic = true;
+    env.gate(true);
+    uint32_t attack = runStage(env, PTEnvelope::ATTACK, true, monotonic);
+    bool peak = env.getOutput() == 32767;
+    uint32_t decay = runStage(env, PTEnvelope::DECAY, false, monotonic);
+    bool sustain = env.getStage() == PTEnvelope::SUSTAIN;
+    env.gate(false);
+    uint32_t release = runStage(env, PTEnvelope::RELEASE, false, monotonic);
+    bool idle = env.getStage() == PTEnvelope::IDLE && env.getOutput() == 0;
+
+    // Retrigger from part way down a decay: the attack still takes its full time
+    env.trigger();
+    runStage(env, PTEnvelope::ATTACK, true, monotonic);
+    runStage(env, PTEnvelope::DECAY, false, monotonic, (uint32_t)(decay_ms * rate / 3000.0f));
+    int16_t from = env.getOutput();
+    env.trigger();
+    uint32_t retrigger = runStage(env, PTEnvelope::ATTACK, true, monotonic);
+
+    bool ok = within(attack, attack_ms, rate) && within(decay, decay_ms, rate) && within(release, release_ms, rate) &&
+              within(retrigger, attack_ms, rate) && peak && sustain && idle && monotonic;
+    printf("%6.0fHz curve %-7s attack %6lu decay %6lu release %6lu retrigger %6lu (from %5d)  %s\n", rate,
+           curve_name, (unsigned long)attack, (unsigned long)decay, (unsigned long)release, (unsigned long)retrigger,
+           from, ok ? "ok" : "FAILED");
+    if (!ok)
+        failures++;
+}
+
+static void checkClamp()
+{
+    // curve 0 used to end a segment after one sample; 100 overflowed the overshoot
+    bool ok = true;
+    static const float curves[] = {0.0f, -1.0f, 100.0f};
+    for (float curve : curves)
+    {
+        PTEnvelope env(1000.0f);
+        env.setAttack(50.0f, curve);
+        bool monotonic = true;
+        env.gate(true);
+        uint32_t attack = runStage(env, PTEnvelope::ATTACK, true, monotonic);
+        bool row_ok = within(attack, 50.0f, 1000.0f) && monotonic;
+        printf("curve %6.1f clamped: 50ms attack at 1kHz takes %lu samples  %s\n", curve, (unsigned long)attack,
+               row_ok ? "ok" : "FAILED");
+        ok &= row_ok;
+    }
+    if (!ok)
+        failures++;
+}
+
+static void checkLfo()
+{
+    struct Case
+    {
+        const char *name;
+        float rate;
+        float hz;
+        float bpm; // 0: free-running at hz
+        float beats;
+    };
+    static const Case cases[] = {
+        {"1kHz, 2Hz", 1000.0f, 2.0f, 0.0f, 0.0f},
+        {"1kHz, 0.1Hz", 1000.0f, 0.1f, 0.0f, 0.0f},
+        {"48kHz, 7Hz", 48000.0f, 7.0f, 0.0f, 0.0f},
+        {"1kHz, 120bpm / beat", 1000.0f, 0.0f, 120.0f, 1.0f},
+        {"1kHz, 90bpm / bar", 1000.0f, 0.0f, 90.0f, 4.0f},
+    };
+
+    for (const Case &c : cases)
+    {
+        PTLFO lfo(c.rate, c.hz > 0 ? c.hz : 1.0f, PTLFO::SAW_UP);
+        if (c.bpm > 0)
+            lfo.setTempo(c.bpm, c.beats);
+        float hz = c.bpm > 0 ? c.bpm / (60.0f * c.beats) : c.hz;
+
+        // Count phase wraps over 10 seconds
+        uint32_t samples = (uint32_t)(c.rate * 10.0f);
+        uint32_t cycles = 0;
+        for (uint32_t i = 0; i < samples; i++)
+        {
+            uint32_t previous = lfo.getPhase();
+            int16_t out;
+            lfo.process(&out, 1);
+            if (lfo.getPhase() < previous)
+                cycles++;
+        }
+
+        // Whole cycles plus where the phase ended, against the set rate within 0.1%
+        double measured = cycles + lfo.getPhase() / 4294967296.0;
+        double expected = hz * 10.0;
+        bool ok = std::fabs(measured - expected) <= expected * 0.001;
+        printf("LFO %-22s %8.3f cycles in 10s (expected %.3f)  %s\n", c.name, measured, expected,
+               ok ? "ok" : "FAILED");
+        if (!ok)
+            failures++;
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    printf("Envelope segment lengths in samples (10ms / 125ms / 2s, within +-1 sample)\n");
+    static const float rates[] = {1000.0f, 8000.0f, 48000.0f};
+    for (float rate : rates)
+    {
+        checkTiming(rate, 0.3f, "0.3");
+        checkTiming(rate, PTEnvelope::MIN_CURVE, "min");
+        checkTiming(rate, PTEnvelope::MAX_CURVE, "max");
+    }
+    checkClamp();
+    checkLfo();
+
+    printf("%s\n", failures == 0 ? "ok" : "FAILED");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,289 @@
+/**
+ * @file pt-mux-pots.cpp
+ * @brief Host check of PTMuxPots against an RC model of the multiplexer
+ *
+ * The model follows the address lines (gpio_put_masked) and answers ADC
+ * conversions (pico_host_adc_hook) with the mux output node: after each
+ * switch it moves from its old voltage towards the new pot's with time
+ * constant tau, as the wiper and switch resistance charge the mux and
+ * ADC capacitance. The scan runs on the repeating timer and the ADC FIFO
+ * interrupt in virtual time.
+ *
+ * Scan rate vs crosstalk: with neighbouring pots at opposite ends (every
+ * switch a full-scale step) it sweeps the settling time for three time
+ * constants and prints full scans/s, interrupts/s, the core 0 share they
+ * take, the worst sample error in LSB and the host time of one pot. A
+ * settling time of at least EurorackMux::settleTimeUs(tau) must stay
+ * within 1 LSB.
+ *
+ * Interrupt load: for several scan intervals it checks that the scanner
+ * takes two interrupts per pot per scan and prints their CPU share, next
+ * to scanning back to back with the conversion waited for in a timer
+ * interrupt.
+ *
+ * Events: static noisy pots push no POT_CHANGE after priming; turning
+ * one pot pushes events for that pot only.
+ *
+ * Usage: pt-mux-pots (exit status 1 on a failed check)
+ */
+
+#include "eurorack_mux.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+using EurorackMux::Chip;
+
+static const uint ADDRESS_PIN = 2;
+static const uint ADC_PIN = 26;
+
+// RP2040 at 125MHz, entry to exit (estimates)
+static const float TIMER_IRQ_US = 2.5f; // Alarm pool dispatch and rearm
+static const float ADC_IRQ_US = 1.0f;   // Shared handler, FIFO read, filter
+
+// ---- Mux model ----
+
+struct MuxModel
+{
+    float pots[16]; // Wiper positions, 0.0-1.0
+    float tau_us;
+    uint channel;
+    float start;        // Node voltage at the last switch
+    uint64_t switch_us; // When the last switch took effect
+    uint32_t noise_lsb; // Peak-to-peak noise added to each conversion
+    uint32_t seed;
+};
+
+static MuxModel model;
+
+static float nodeAt(uint64_t t)
+{
+    float target = model.pots[model.channel];
+    if (t <= model.switch_us || model.tau_us <= 0.0f)
+        return t <= model.switch_us ? model.start : target;
+    return target + (model.start - target) * expf(-(float)(t - model.switch_us) / model.tau_us);
+}
+
+static void onAddress(uint32_t mask, uint32_t value)
+{
+    if (mask != (0xFu << ADDRESS_PIN))
+        return;
+    // Switched from the ADC interrupt, once the conversion is done
+    uint64_t when = time_us_64();
+    model.start = nodeAt(when);
+    model.channel = (value >> ADDRESS_PIN) & 0xF;
+    model.switch_us = when;
+}
+
+static uint16_t onConvert(uint)
+{
+    float code = nodeAt(time_us_64()) * 4095.0f;
+    if (model.noise_lsb)
+    {
+        model.seed = model.seed * 1664525u + 1013904223u;
+        code += (float)(model.seed >> 16) / 65536.0f * model.noise_lsb - model.noise_lsb / 2.0f;
+    }
+    if (code < 0.0f)
+        code = 0.0f;
+    if (code > 4095.0f)
+        code = 4095.0f;
+    return (uint16_t)lroundf(code);
+}
+
+static void resetModel(float tau_us)
+{
+    model = MuxModel{};
+    model.tau_us = tau_us;
+    model.seed = 1;
+    pico_host_gpio_masked_hook = onAddress;
+    pico_host_adc_hook = onConvert;
+}
+
+/**
+ * @brief Core 0 share taken by the scanner's interrupts, percent
+ */
+static float cpuShare(float irq_per_s)
+{
+    return irq_per_s / 2 * (TIMER_IRQ_US + ADC_IRQ_US) / 1e4f;
+}
+
+static uint64_t nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+// ---- Scan rate vs crosstalk ----
+
+/**
+ * @return Worst sample error in LSB over the scans after priming
+ */
+static uint32_t crosstalk(float tau_us, uint32_t settle_us, double &step_ns, float &irq_per_s)
+{
+    resetModel(tau_us);
+    for (uint c = 0; c < 16; c++)
+        model.pots[c] = (c & 1) ? 1.0f : 0.0f;
+
+    PTMuxPots<> pots(Chip::CD4067, ADDRESS_PIN, ADC_PIN, settle_us);
+    pots.setFilter(0);
+    pots.start();
+
+    uint32_t worst = 0;
+    for (uint scan = 0; scan < 20; scan++)
+    {
+        pico_host_advance(pots.getScanUs());
+        if (scan < 2)
+            continue;
+        for (uint c = 0; c < 16; c++)
+        {
+            int32_t ideal = (int32_t)lroundf(model.pots[c] * 4095.0f);
+            uint32_t error = (uint32_t)abs((int32_t)pots.getRaw(c) - ideal);
+            if (error > worst)
+                worst = error;
+        }
+    }
+    irq_per_s = pots.getInterruptCount() * 1e6f / (20.0f * pots.getScanUs());
+
+    // Host cost of one pot, both interrupts and the model included
+    const uint32_t scans = 1000;
+    uint32_t interrupts = pots.getInterruptCount();
+    uint64_t start = nowNs();
+    pico_host_advance((uint64_t)pots.getScanUs() * scans);
+    step_ns = (double)(nowNs() - start) / ((pots.getInterruptCount() - interrupts) / 2);
+    pots.stop();
+    return worst;
+}
+
+static bool sweep()
+{
+    static const float taus[] = {0.5f, 2.0f, 10.0f}; // Bare 10k pot; with 1k/2nF; with 1k/10nF
+    static const uint32_t settles[] = {1, 2, 5, 10, 20, 50, 100, 200};
+    bool ok = true;
+
+    printf("%-7s %9s %8s %8s %6s %10s %9s %10s\n", "tau_us", "settle_us", "scans/s", "irq/s", "cpu%",
+           "error_lsb", "needed_us", "ns/pot");
+    for (float tau : taus)
+    {
+        uint32_t needed = EurorackMux::settleTimeUs(tau);
+        uint32_t previous = 0xFFFFFFFF;
+        for (uint32_t settle : settles)
+        {
+            double step_ns = 0;
+            float irq_per_s = 0;
+            uint32_t error = crosstalk(tau, settle, step_ns, irq_per_s);
+            uint32_t scan_us = (settle + PT_MUX_CONVERSION_US) * 16;
+            scan_us = scan_us > PT_MUX_SCAN_US ? scan_us : PT_MUX_SCAN_US;
+            bool row_ok = error <= previous && (settle < needed || error <= 1);
+            ok &= row_ok;
+            previous = error;
+            printf("%-7.1f %9lu %8.0f %8.0f %6.1f %10lu %9lu %10.1f%s\n", tau, (unsigned long)settle,
+                   1e6 / scan_us, irq_per_s, cpuShare(irq_per_s), (unsigned long)error, (unsigned long)needed,
+                   step_ns, row_ok ? "" : "  FAILED");
+        }
+    }
+    return ok;
+}
+
+// ---- Interrupt load ----
+
+static bool load()
+{
+    static const uint32_t intervals[] = {250, 500, 1000, 2000, 5000};
+    const uint32_t settle = 10;
+    bool ok = true;
+
+    resetModel(0.5f);
+    printf("%-8s %8s %8s %6s\n", "scan_us", "scans/s", "irq/s", "cpu%");
+    for (uint32_t interval : intervals)
+    {
+        PTMuxPots<> pots(Chip::CD4067, ADDRESS_PIN, ADC_PIN, settle);
+        pots.setScanInterval(interval);
+        pots.start();
+        const uint32_t seconds = 1;
+        pico_host_advance(seconds * 1000000);
+        float irq_per_s = (float)pots.getInterruptCount() / seconds;
+        pots.stop();
+
+        uint32_t scan_us = interval > pots.getStepUs() * 16 ? interval : pots.getStepUs() * 16;
+        float expected = 2 * 16 * 1e6f / scan_us;
+        bool row_ok = fabsf(irq_per_s - expected) <= 2 * 16;
+        ok &= row_ok;
+        printf("%-8lu %8.0f %8.0f %6.1f%s\n", (unsigned long)interval, 1e6f / scan_us, irq_per_s,
+               cpuShare(irq_per_s), row_ok ? "" : "  FAILED");
+    }
+
+    // What a timer interrupt per pot, back to back and waiting for the ADC, costs
+    float blocking_irq = 1e6f / (settle + PT_MUX_CONVERSION_US);
+    printf("back to back, conversion waited for in the timer interrupt: %.0f irq/s, %.1f%% cpu\n", blocking_irq,
+           blocking_irq * (TIMER_IRQ_US + PT_MUX_CONVERSION_US) / 1e4f);
+    return ok;
+}
+
+// ---- Events ----
+
+static bool events()
+{
+    resetModel(2.0f);
+    model.noise_lsb = 6;
+    for (uint c = 0; c < 16; c++)
+        model.pots[c] = 0.3f + c * 0.02f;
+
+    PTMuxPots<> pots(Chip::CD4067, ADDRESS_PIN, ADC_PIN, EurorackMux::settleTimeUs(2.0f));
+    PTEventQueue queue;
+    pots.setEventQueue(&queue);
+    pots.start();
+    uint64_t scan_us = pots.getScanUs();
+
+    // Static pots with +/-3 LSB of noise: silent after the priming scan
+    pico_host_advance(scan_us * 50);
+    size_t static_events = queue.size();
+
+    // Turn pot 7 from 0.2 to 0.8 over 200 scans
+    uint32_t turned = 0, others = 0;
+    for (uint scan = 0; scan < 200; scan++)
+    {
+        model.pots[7] = 0.2f + 0.6f * scan / 199.0f;
+        pico_host_advance(scan_us);
+        PTEvent event;
+        while (queue.pop(event))
+        {
+            if (event.type == PTEventType::POT_CHANGE && event.data == 7)
+                turned++;
+            else
+                others++;
+        }
+    }
+    pico_host_advance(scan_us * 20);
+    int32_t final_error = abs((int32_t)pots.getValue(7) - (int32_t)lroundf(0.8f * 4095.0f));
+    pots.stop();
+
+    bool ok = static_events == 0 && turned >= 10 && others == 0 && final_error <= 4;
+    printf("static noisy pots: %lu events; turning pot 7: %lu events, %lu on other pots, "
+           "final error %ld LSB  %s\n",
+           (unsigned long)static_events, (unsigned long)turned, (unsigned long)others, (long)final_error,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+    pico_host_virtual_time = true;
+
+    printf("CD4067, 16 pots alternating 0V/full scale, unfiltered samples\n");
+    printf("(cpu%%: %.1fus per timer and %.1fus per ADC interrupt on the RP2040, estimated)\n", TIMER_IRQ_US,
+           ADC_IRQ_US);
+    bool ok = sweep();
+    printf("\n");
+    ok &= load();
+    printf("\n");
+    ok &= events();
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
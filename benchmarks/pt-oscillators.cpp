@@ -0,0 +1,205 @@
+/**
+ * @file pt-oscillators.cpp
+ * @brief Host check of the oscillators: PolyBLEP aliasing against a naive saw
+ *
+ * Aliasing: each oscillator renders 4096 samples at 48kHz with a phase
+ * increment of exactly k cycles per 4096 samples (k odd), so every
+ * harmonic below Nyquist lands on a multiple of bin k and everything
+ * folded back above Nyquist lands between them. An FFT of the block
+ * (rectangular window, no leakage with an exact period) gives the
+ * aliased power relative to the harmonics. PTPolyBLEPOscillator's saw
+ * must come out at least MIN_IMPROVEMENT_DB below a naive ramp with the
+ * same phase accumulator, at every test frequency; the square is
+ * printed next to it.
+ *
+ * Also checks PTSineOscillator against std::sin, and that setTable()
+ * refuses table sizes the interpolation cannot address.
+ *
+ * Usage: pt-oscillators (exit status 1 on a failed check)
+ */
+
+#include "eurorack_oscillators.h"
+
+#include <cmath>
+#include <complex>
+#include <vector>
+
+static const size_t N = 4096;
+static const double SAMPLE_RATE = 48000.0;
+static const double MIN_IMPROVEMENT_DB = 10.0;
+
+/**
+ * @brief In-place radix-2 FFT
+ */
+static void fft(std::vector<std::complex<double>> &x)
+{
+    const size_t n = x.size();
+    for (size_t i = 1, j = 0; i < n; i++)
+    {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(x[i], x[j]);
+    }
+    for (size_t len = 2; len <= n; len <<= 1)
+    {
+        std::complex<double> w = std::polar(1.0, -2.0 * M_PI / (double)len);
+        for (size_t i = 0; i < n; i += len)
+        {
+            std::complex<double> wk = 1.0;
+            for (size_t k = 0; k < len / 2; k++)
+            {
+                std::complex<double> a = x[i + k];
+                std::complex<double> b = x[i + k + len / 2] * wk;
+                x[i + k] = a + b;
+                x[i + k + len / 2] = a - b;
+                wk *= w;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Aliased power relative to harmonic power, in dB
+ * @param k Fundamental bin
+ */
+static double aliasDb(const std::vector<int16_t> &samples, size_t k)
+{
+    std::vector<std::complex<double>> x(N);
+    for (size_t i = 0; i < N; i++)
+        x[i] = samples[i] / 32768.0;
+    fft(x);
+
+    double harmonic = 0.0;
+    double alias = 0.0;
+    for (size_t bin = 1; bin < N / 2; bin++)
+    {
+        double power = std::norm(x[bin]);
+        if (bin % k == 0)
+            harmonic += power;
+        else
+            alias += power;
+    }
+    return 10.0 * std::log10(alias / harmonic);
+}
+
+/**
+ * @brief Naive saw from the same phase accumulator as PTPolyBLEPOscillator
+ */
+static std::vector<int16_t> naiveSaw(uint32_t increment)
+{
+    std::vector<int16_t> out(N);
+    uint32_t phase = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        out[i] = (int16_t)((int32_t)(phase >> 16) - 32768);
+        phase += increment;
+    }
+    return out;
+}
+
+static std::vector<int16_t> polyBlep(PTPolyBLEPOscillator::Shape shape, uint32_t increment)
+{
+    PTPolyBLEPOscillator osc(shape, (float)SAMPLE_RATE);
+    osc.setIncrement(increment);
+    std::vector<int16_t> out(N);
+    osc.process(out.data(), N);
+    return out;
+}
+
+static std::vector<int16_t> naiveSquare(uint32_t increment)
+{
+    std::vector<int16_t> out(N);
+    uint32_t phase = 0;
+    for (size_t i = 0; i < N; i++)
+    {
+        out[i] = phase < 0x80000000u ? 32767 : -32768;
+        phase += increment;
+    }
+    return out;
+}
+
+static bool checkAliasing()
+{
+    // Odd bins, roughly 1.2kHz, 2.5kHz, 4.4kHz and 8kHz
+    static const size_t bins[] = {103, 211, 375, 683};
+    bool ok = true;
+
+    printf("Aliased / harmonic power, 4096-point FFT at 48kHz (dB)\n");
+    printf("%9s %10s %10s %8s %12s %12s\n", "freq_hz", "naive_saw", "blep_saw", "gain", "naive_square", "blep_square");
+    for (size_t k : bins)
+    {
+        uint32_t increment = (uint32_t)(k << 20); // k cycles per 4096 samples
+        double naive = aliasDb(naiveSaw(increment), k);
+        double blep = aliasDb(polyBlep(PTPolyBLEPOscillator::SAW, increment), k);
+        double naive_sq = aliasDb(naiveSquare(increment), k);
+        double blep_sq = aliasDb(polyBlep(PTPolyBLEPOscillator::SQUARE, increment), k);
+        bool row_ok = naive - blep >= MIN_IMPROVEMENT_DB;
+        ok &= row_ok;
+        printf("%9.0f %10.1f %10.1f %8.1f %12.1f %12.1f%s\n", k * SAMPLE_RATE / N, naive, blep, naive - blep,
+               naive_sq, blep_sq, row_ok ? "" : "  FAILED");
+    }
+    return ok;
+}
+
+static bool checkSine()
+{
+    PTSineOscillator osc((float)SAMPLE_RATE);
+    osc.setIncrement(37u << 20);
+    std::vector<int16_t> out(N);
+    osc.process(out.data(), N);
+
+    double worst = 0.0;
+    for (size_t i = 0; i < N; i++)
+    {
+        double expected = 32767.0 * std::sin(2.0 * M_PI * 37.0 * (double)i / N);
+        worst = std::max(worst, std::fabs(out[i] - expected));
+    }
+
+    // Linear interpolation of a 256-point table is off by up to (2pi/256)^2 / 8
+    // of full scale (2.5 LSB), plus table and output rounding
+    bool ok = worst < 4.0;
+    printf("sine: worst error %.1f LSB against std::sin  %s\n", worst, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static bool checkTableBits()
+{
+    static int16_t table[(1 << 4) + 1];
+    for (size_t i = 0; i <= 16; i++)
+        table[i] = (int16_t)(i * 1000);
+
+    PTWavetableOscillator osc(table, 4);
+    bool ok = osc.hasTable() && !osc.setTable(table, 18) && !osc.setTable(table, 0) &&
+              osc.setTable(table, PTWavetableOscillator::MAX_TABLE_BITS) && osc.setTable(table, 4);
+
+    PTWavetableOscillator bad(table, 20);
+    int16_t out[8] = {1, 1, 1, 1, 1, 1, 1, 1};
+    bad.setIncrement(1u << 28);
+    bad.process(out, 8);
+    bool silent = !bad.hasTable();
+    for (int16_t v : out)
+        silent &= v == 0;
+
+    ok &= silent;
+    printf("table bits: 0 and 18+ refused, oscillator without a table silent  %s\n", ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = checkAliasing();
+    ok &= checkSine();
+    ok &= checkTableBits();
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
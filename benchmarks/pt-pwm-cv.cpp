@@ -0,0 +1,242 @@
+/**
+ * @file pt-pwm-cv.cpp
+ * @brief Host check of PTCVOutputBank against a PWM model, and its cost per frame
+ *
+ * The host PWM model (host/pico_host.h) clocks the slices in system
+ * clock cycles and double-buffers CC as the chip does: a slice takes the
+ * levels written to it at its next wrap. A wrap hook sees what each
+ * period outputs.
+ *
+ * Same period: 1ms frames write a new level to four channels on slices
+ * 2 and 3 (GPIO 20-23), with 5000 cycles of other work between one
+ * channel and the next, as when each output is computed in turn. With
+ * PTCVOutput the two channels of a slice disagree for a period whenever a
+ * wrap falls between their writes; with the bank they never do, and
+ * slices started together also agree with each other.
+ *
+ * Lock-step: start() zeroes and enables the bank's slices in one write,
+ * so their counters stay equal, and leaves other slices running;
+ * PTCVOutputs set up 1000 cycles apart stay 1000 cycles apart. Calling
+ * start() again on a running bank, with each counter store taking a few
+ * cycles, must bring its slices back in step.
+ *
+ * It then prints CC stores and host ns per frame for 2, 4 and 8 channels,
+ * bank vs PTCVOutput. On the host a store is as cheap as the staging, so
+ * the ns are close; on the RP2040 each CC store is a bus write to the PWM
+ * block, and the bank makes half as many.
+ *
+ * Usage: pt-pwm-cv (exit status 1 on a failed check)
+ */
+
+#include "eurorack_hardware.h"
+
+#include <chrono>
+#include <vector>
+
+static const uint64_t FRAME_CYCLES = 125000; // 1ms at 125MHz
+static const uint64_t WORK_CYCLES = 5000;    // Between one channel's write and the next
+static const uint32_t FRAMES = 2000;
+
+static void resetPwm()
+{
+    pwm_set_mask_enabled(0);
+    pico_host_pwm_regs = pwm_hw_t{};
+    for (uint s = 0; s < NUM_PWM_SLICES; s++)
+        pico_host_pwm_active[s] = pico_host_pwm_wraps[s] = pico_host_pwm_frac[s] = 0;
+    pico_host_pwm_wrap_hook = nullptr;
+    pico_host_pwm_cc_writes = 0;
+}
+
+// ---- Same period ----
+
+static uint32_t split_periods; // A and B of one slice from different frames
+static uint32_t slice_skew;    // Slice 3 period not matching slice 2's
+
+static void onWrap(uint slice, uint32_t cc)
+{
+    if ((cc & 0xFFFF) != (cc >> 16))
+        split_periods++;
+    if (slice == 3 && cc != pico_host_pwm_active[2])
+        slice_skew++;
+}
+
+static uint16_t frameLevel(uint32_t frame) { return (uint16_t)(frame * 97 + 1); }
+
+static void samePeriodSingle(uint32_t &split, uint32_t &skew)
+{
+    resetPwm();
+    PTCVOutput outputs[4] = {PTCVOutput(20), PTCVOutput(21), PTCVOutput(22), PTCVOutput(23)};
+    split_periods = slice_skew = 0;
+    pico_host_pwm_wrap_hook = onWrap;
+
+    for (uint32_t f = 0; f < FRAMES; f++)
+    {
+        for (PTCVOutput &out : outputs)
+        {
+            out.setLevel(frameLevel(f));
+            pico_host_pwm_run(WORK_CYCLES);
+        }
+        pico_host_pwm_run(FRAME_CYCLES - 4 * WORK_CYCLES);
+    }
+    split = split_periods;
+    skew = slice_skew;
+}
+
+static void samePeriodBank(uint32_t &split, uint32_t &skew)
+{
+    resetPwm();
+    PTCVOutputBank<> bank;
+    for (uint pin = 20; pin < 24; pin++)
+        bank.add(pin);
+    bank.start();
+    split_periods = slice_skew = 0;
+    pico_host_pwm_wrap_hook = onWrap;
+
+    for (uint32_t f = 0; f < FRAMES; f++)
+    {
+        for (uint c = 0; c < 4; c++)
+        {
+            bank.setLevel(c, frameLevel(f));
+            pico_host_pwm_run(WORK_CYCLES);
+        }
+        bank.update();
+        pico_host_pwm_run(FRAME_CYCLES - 4 * WORK_CYCLES);
+    }
+    split = split_periods;
+    skew = slice_skew;
+}
+
+static bool checkSamePeriod()
+{
+    uint32_t single_split, single_skew, bank_split, bank_skew;
+    samePeriodSingle(single_split, single_skew);
+    samePeriodBank(bank_split, bank_skew);
+
+    bool ok = single_split > 0 && bank_split == 0 && bank_skew == 0;
+    printf("%lu frames, 4 channels on slices 2-3, %llu cycles between channel writes\n", (unsigned long)FRAMES,
+           (unsigned long long)WORK_CYCLES);
+    printf("  PTCVOutput:     %4lu periods with a slice's A/B from different frames, %4lu slices out of step\n",
+           (unsigned long)single_split, (unsigned long)single_skew);
+    printf("  PTCVOutputBank: %4lu periods with a slice's A/B from different frames, %4lu slices out of step  %s\n",
+           (unsigned long)bank_split, (unsigned long)bank_skew, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// ---- Lock-step ----
+
+static bool checkLockStep()
+{
+    resetPwm();
+    pwm_config config = pwm_get_default_config();
+    pwm_init(6, &config, true); // Someone else's slice, already running
+    pico_host_pwm_run(777);
+
+    PTCVOutputBank<> bank;
+    bank.add(20);
+    bank.add(22);
+    bank.add(5); // Slice 2 A, 3 A and 2 B (GPIO 5 shares slice 2 B with GPIO 21)
+    bank.start();
+    pico_host_pwm_run(123457);
+    bool bank_ok = pwm_get_counter(2) == pwm_get_counter(3) && pico_host_pwm_wraps[2] == pico_host_pwm_wraps[3] &&
+                   (pwm_hw->en & (1u << 6)) && bank.getSliceMask() == ((1u << 2) | (1u << 3)) &&
+                   bank.add(21) < 0 && bank.add(23) >= 0;
+
+    // Restart a running bank while the counter stores take time
+    pico_host_pwm_store_cycles = 4;
+    bank.start();
+    pico_host_pwm_store_cycles = 0;
+    pico_host_pwm_run(5555);
+    bool restart_ok = pwm_get_counter(2) == pwm_get_counter(3) && (pwm_hw->en & (1u << 6));
+
+    resetPwm();
+    PTCVOutput first(20);
+    pico_host_pwm_run(1000);
+    PTCVOutput second(22);
+    pico_host_pwm_run(123457);
+    uint32_t offset = (uint32_t)((pwm_get_counter(2) - pwm_get_counter(3)) & 0xFFFF);
+
+    bool ok = bank_ok && restart_ok && offset == 1000;
+    printf("lock-step: bank slices %s, %s after a restart, other slice kept running; "
+           "PTCVOutput slices %lu cycles apart  %s\n",
+           bank_ok ? "in step" : "NOT in step", restart_ok ? "in step" : "NOT in step", (unsigned long)offset,
+           ok ? "ok" : "FAILED");
+    return ok;
+}
+
+// ---- Cost per frame ----
+
+static uint64_t nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+static const uint32_t COST_FRAMES = 200000;
+
+static void costBank(uint n, double &ns, double &stores)
+{
+    resetPwm();
+    PTCVOutputBank<> bank;
+    for (uint pin = 0; pin < n; pin++)
+        bank.add(pin);
+    bank.start();
+
+    uint32_t before = pico_host_pwm_cc_writes;
+    uint64_t start = nowNs();
+    for (uint32_t f = 0; f < COST_FRAMES; f++)
+    {
+        for (uint c = 0; c < n; c++)
+            bank.setLevel(c, (uint16_t)(f + c));
+        bank.update();
+    }
+    ns = (double)(nowNs() - start) / COST_FRAMES;
+    stores = (double)(pico_host_pwm_cc_writes - before) / COST_FRAMES;
+}
+
+static void costSingle(uint n, double &ns, double &stores)
+{
+    resetPwm();
+    std::vector<PTCVOutput> outputs;
+    for (uint pin = 0; pin < n; pin++)
+        outputs.emplace_back(pin);
+
+    uint32_t before = pico_host_pwm_cc_writes;
+    uint64_t start = nowNs();
+    for (uint32_t f = 0; f < COST_FRAMES; f++)
+    {
+        for (uint c = 0; c < n; c++)
+            outputs[c].setLevel((uint16_t)(f + c));
+    }
+    ns = (double)(nowNs() - start) / COST_FRAMES;
+    stores = (double)(pico_host_pwm_cc_writes - before) / COST_FRAMES;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = checkSamePeriod();
+    ok &= checkLockStep();
+
+    printf("\nEvery channel changes every frame\n");
+    printf("%8s %12s %8s %14s %10s\n", "channels", "bank_stores", "bank_ns", "single_stores", "single_ns");
+    static const uint counts[] = {2, 4, 8};
+    for (uint n : counts)
+    {
+        double bank_ns, bank_stores, single_ns, single_stores;
+        costBank(n, bank_ns, bank_stores);
+        costSingle(n, single_ns, single_stores);
+        bool row_ok = bank_stores == n / 2 && single_stores == n;
+        ok &= row_ok;
+        printf("%8u %12.1f %8.1f %14.1f %10.1f%s\n", n, bank_stores, bank_ns, single_stores, single_ns,
+               row_ok ? "" : "  FAILED");
+    }
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file pt-quantizer.cpp
+ * @brief Exhaustive host check of PTQuantizer over all 4096 ADC codes
+ *
+ * For each scale (chromatic, major, minor, both pentatonics) and root
+ * (C, F, B):
+ *  - every ADC code, quantized with hysteresis off, must give the
+ *    allowed note nearest to the code's pitch (code * 120 / 4095
+ *    semitones above -5V; halfway goes to the lower note), found by
+ *    brute force over all 121 notes
+ *  - at every boundary between two notes, with 8 codes of hysteresis, a
+ *    rising input must switch exactly 8 codes above the boundary and a
+ *    falling one exactly 8 codes below it, and the output must not
+ *    change while the input jitters by up to 8 codes across it
+ *  - quantizePitch() must agree with the table for the pitch of every
+ *    code
+ *
+ * Usage: pt-quantizer (exit status 1 on a failed check)
+ */
+
+#include "eurorack_quantizer.h"
+
+#include <cmath>
+
+static const uint16_t HYSTERESIS = 8;
+
+static uint8_t nearestNote(uint16_t scale, uint8_t root, uint16_t code)
+{
+    double position = code * 120.0 / 4095.0;
+    int best = -1;
+    double best_distance = 1e9;
+    for (int n = 0; n < EurorackQuantizer::NOTE_COUNT; n++)
+    {
+        if (!((scale >> ((n - root + 12) % 12)) & 1))
+            continue;
+        double distance = std::fabs(n - position);
+        if (distance < best_distance - 1e-9) // Ties keep the lower note
+        {
+            best = n;
+            best_distance = distance;
+        }
+    }
+    return (uint8_t)best;
+}
+
+/**
+ * @brief Fresh quantizer state on the note of code
+ */
+static void settle(PTQuantizer &q, uint16_t code)
+{
+    q.setHysteresis(0);
+    q.quantizeNote(code);
+    q.setHysteresis(HYSTERESIS);
+}
+
+struct ScaleCase
+{
+    const char *name;
+    uint16_t mask;
+};
+
+static bool checkScale(const ScaleCase &scale, uint8_t root)
+{
+    PTQuantizer q(scale.mask, root, 0);
+
+    // Every code against brute force
+    uint32_t wrong = 0;
+    uint8_t notes[EurorackQuantizer::ADC_CODES];
+    for (uint32_t code = 0; code < EurorackQuantizer::ADC_CODES; code++)
+    {
+        notes[code] = q.quantizeNote((uint16_t)code);
+        if (notes[code] != nearestNote(scale.mask, root, (uint16_t)code))
+            wrong++;
+    }
+
+    // Hysteresis at every boundary away from the ends of the range
+    uint32_t boundaries = 0, bad_rise = 0, bad_fall = 0, bad_jitter = 0;
+    for (uint32_t b = HYSTERESIS + 1; b + HYSTERESIS < EurorackQuantizer::ADC_CODES; b++)
+    {
+        if (notes[b] == notes[b - 1])
+            continue;
+        boundaries++;
+        uint8_t below = notes[b - 1], above = notes[b];
+
+        settle(q, (uint16_t)(b - 1));
+        uint32_t rise = b - 1;
+        while (rise < EurorackQuantizer::ADC_CODES - 1 && q.quantizeNote((uint16_t)rise) == below)
+            rise++;
+        if (rise != b + HYSTERESIS || q.getCurrentNote() != above)
+            bad_rise++;
+
+        settle(q, (uint16_t)b);
+        int32_t fall = (int32_t)b;
+        while (fall > 0 && q.quantizeNote((uint16_t)fall) == above)
+            fall--;
+        if (fall != (int32_t)b - HYSTERESIS - 1 || q.getCurrentNote() != below)
+            bad_fall++;
+
+        // Jitter across the boundary from either side never moves the output
+        for (int side = 0; side < 2; side++)
+        {
+            uint8_t held = side ? above : below;
+            settle(q, (uint16_t)(side ? b : b - 1));
+            for (int32_t j = -HYSTERESIS; j < HYSTERESIS; j++)
+            {
+                if (q.quantizeNote((uint16_t)((int32_t)b + j)) != held)
+                {
+                    bad_jitter++;
+                    break;
+                }
+            }
+        }
+    }
+
+    // quantizePitch() at the pitch of each code
+    uint32_t bad_pitch = 0;
+    for (uint32_t code = 0; code < EurorackQuantizer::ADC_CODES; code++)
+    {
+        int32_t pitch_q16 = (int32_t)std::lround(code * 10.0 * 65536.0 / 4095.0) - 5 * 65536;
+        int32_t expected = EurorackQuantizer::NOTE_PITCH_Q16[notes[code]];
+        int32_t got = q.quantizePitch(pitch_q16);
+        // A pitch exactly on a boundary may land on the code either side of it
+        bool neighbour = (code > 0 && got == EurorackQuantizer::NOTE_PITCH_Q16[notes[code - 1]]) ||
+                         (code + 1 < EurorackQuantizer::ADC_CODES &&
+                          got == EurorackQuantizer::NOTE_PITCH_Q16[notes[code + 1]]);
+        if (got != expected && !neighbour)
+            bad_pitch++;
+    }
+
+    bool ok = wrong == 0 && bad_rise == 0 && bad_fall == 0 && bad_jitter == 0 && bad_pitch == 0;
+    static const char *const ROOTS[] = {"C", "C#", "D", "D#", "E", "F", "F#", "G", "G#", "A", "A#", "B"};
+    printf("%-16s %-2s %4lu codes wrong  %3lu boundaries: %lu bad rise, %lu bad fall, %lu jitter  %lu pitch  %s\n",
+           scale.name, ROOTS[root], (unsigned long)wrong, (unsigned long)boundaries, (unsigned long)bad_rise,
+           (unsigned long)bad_fall, (unsigned long)bad_jitter, (unsigned long)bad_pitch, ok ? "ok" : "FAILED");
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    static const ScaleCase scales[] = {
+        {"chromatic", EurorackQuantizer::CHROMATIC},
+        {"major", EurorackQuantizer::MAJOR},
+        {"minor", EurorackQuantizer::MINOR},
+        {"pentatonic major", EurorackQuantizer::PENTATONIC_MAJOR},
+        {"pentatonic minor", EurorackQuantizer::PENTATONIC_MINOR},
+    };
+    static const uint8_t roots[] = {0, 5, 11};
+
+    printf("All 4096 ADC codes against a brute-force nearest note; hysteresis %u codes\n", HYSTERESIS);
+    bool ok = true;
+    for (const ScaleCase &scale : scales)
+    {
+        for (uint8_t root : roots)
+            ok &= checkScale(scale, root);
+    }
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
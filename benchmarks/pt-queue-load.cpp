@@ -0,0 +1,211 @@
+/**
+ * @file pt-queue-load.cpp
+ * @brief Host load test of PTEventQueue overflow at increasing event rates
+ *
+ * Raises a mix of interrupt events (gates, encoder, buttons, MIDI clock,
+ * CV changes) at a swept average rate against one consumer thread, while
+ * a blocking display refresh and a DSP block compete for the CPU. For
+ * each rate it prints the queue's own telemetry: high-water mark, time
+ * spent full, and drops per type, so PT_EVENT_QUEUE_SIZE can be chosen
+ * from data. Rebuild with e.g. -DPT_EVENT_QUEUE_SIZE=64 to compare sizes.
+ *
+ * Usage: pt-queue-load [--seconds=N] [--handle-us=N]
+ */
+
+#include "pt_thread.h"
+
+#include <cstdlib>
+#include <cstring>
+
+static const uint32_t RATES[] = {250, 500, 1000, 2000, 4000, 8000, 16000};
+static const uint32_t BURST_MAX = 6; // Events per interrupt burst (encoder spins, chords)
+
+// Share of the event mix, per type
+struct Source
+{
+    PTEventType type;
+    const char *label;
+    uint32_t weight;
+};
+
+static const Source SOURCES[] = {
+    {PTEventType::GATE_RISING, "gate", 2},
+    {PTEventType::ENCODER_TURN, "enc", 4},
+    {PTEventType::BUTTON_PRESS, "btn", 1},
+    {PTEventType::MIDI_CLOCK, "midi", 3},
+    {PTEventType::CV_CHANGE, "cv", 4},
+};
+static const size_t SOURCE_COUNT = sizeof(SOURCES) / sizeof(SOURCES[0]);
+
+static PTEventQueue *queue = nullptr;
+static uint32_t random_state = 1;
+static uint32_t raised_events = 0;
+static uint32_t hook_calls = 0;
+
+// Next interrupt burst
+static uint64_t next_burst_us = 0;
+static uint32_t mean_gap_us = 0;
+
+static uint32_t nextRandom(uint32_t range)
+{
+    random_state ^= random_state << 13;
+    random_state ^= random_state >> 17;
+    random_state ^= random_state << 5;
+    return range ? random_state % range : 0;
+}
+
+static PTEventType randomType()
+{
+    uint32_t total = 0;
+    for (size_t i = 0; i < SOURCE_COUNT; i++)
+        total += SOURCES[i].weight;
+
+    uint32_t pick = nextRandom(total);
+    for (size_t i = 0; i < SOURCE_COUNT; i++)
+    {
+        if (pick < SOURCES[i].weight)
+            return SOURCES[i].type;
+        pick -= SOURCES[i].weight;
+    }
+    return SOURCES[0].type;
+}
+
+/**
+ * @brief Spend CPU time, raising every burst that falls due meanwhile
+ */
+static void advance(uint32_t us)
+{
+    uint64_t end = pico_host_time_us + us;
+    while (next_burst_us <= end)
+    {
+        if (next_burst_us > pico_host_time_us)
+            pico_host_time_us = next_burst_us;
+
+        PTEventType type = randomType();
+        uint32_t burst = 1 + nextRandom(BURST_MAX);
+        for (uint32_t i = 0; i < burst; i++)
+        {
+            queue->push(PTEvent(type, i)); // Drops are counted by the queue
+        }
+        raised_events += burst;
+
+        // Bursts arrive at random; the average event rate stays at the target
+        next_burst_us += 1 + nextRandom(mean_gap_us * (1 + BURST_MAX));
+    }
+    pico_host_time_us = end;
+}
+
+static void onOverflow(const PTEvent &)
+{
+    hook_calls++;
+}
+
+class ConsumerThread : public PTThread
+{
+private:
+    PTEvent event;
+    uint32_t cost_us;
+
+public:
+    ConsumerThread(uint32_t cost_us) : PTThread("Consumer"), cost_us(cost_us) {}
+
+    int run() override
+    {
+        PT_THREAD_BEGIN(this);
+        while (true)
+        {
+            PT_WAIT_EVENT(this, event);
+            advance(cost_us);
+        }
+        PT_THREAD_END(this);
+    }
+};
+
+class PeriodicThread : public PTThread
+{
+private:
+    uint32_t period_us;
+    uint32_t cost_us;
+    uint64_t next_us;
+
+public:
+    PeriodicThread(const char *name, uint32_t period_us, uint32_t cost_us)
+        : PTThread(name), period_us(period_us), cost_us(cost_us), next_us(pico_host_time_us)
+    {
+    }
+
+    int run() override
+    {
+        if (pico_host_time_us >= next_us)
+        {
+            advance(cost_us);
+            next_us += period_us;
+        }
+        return PT_YIELDED;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    uint32_t seconds = 5;
+    uint32_t handle_us = 20;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strncmp(argv[i], "--seconds=", 10) == 0)
+            seconds = (uint32_t)std::atoi(argv[i] + 10);
+        else if (std::strncmp(argv[i], "--handle-us=", 12) == 0)
+            handle_us = (uint32_t)std::atoi(argv[i] + 12);
+        else
+        {
+            fprintf(stderr, "usage: %s [--seconds=N] [--handle-us=N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    pico_host_virtual_time = true;
+
+    printf("Queue of %lu events, %lu us per event, 4ms display every 20ms, 150us DSP every 1ms, %lu s per rate\n",
+           (unsigned long)PTEventQueue::MAX_EVENTS, (unsigned long)handle_us, (unsigned long)seconds);
+    printf("%8s %8s %6s %7s %8s %6s", "rate/s", "events", "depth", "full_%", "dropped", "hook");
+    for (size_t i = 0; i < SOURCE_COUNT; i++)
+        printf(" %6s", SOURCES[i].label);
+    printf("\n");
+
+    for (uint32_t rate : RATES)
+    {
+        // Fresh scheduler and queue per rate
+        PTScheduler scheduler;
+        queue = scheduler.getEventQueue();
+        queue->setOverflowHook(onOverflow);
+        hook_calls = 0;
+        raised_events = 0;
+
+        ConsumerThread consumer(handle_us);
+        PeriodicThread display("Display", 20000, 4000);
+        PeriodicThread dsp("DSP", 1000, 150);
+        scheduler.addThread(&consumer);
+        scheduler.addThread(&display);
+        scheduler.addThread(&dsp);
+
+        uint64_t start_us = pico_host_time_us;
+        uint64_t end_us = start_us + (uint64_t)seconds * 1000000;
+        mean_gap_us = 1000000 / rate;
+        next_burst_us = start_us;
+        queue->resetStats();
+
+        while (pico_host_time_us < end_us)
+        {
+            scheduler.runOnce();
+            advance(2);
+        }
+
+        printf("%8lu %8lu %6lu %7.2f %8lu %6lu", (unsigned long)rate, (unsigned long)raised_events,
+               (unsigned long)queue->getMaxDepth(), 100.0 * queue->getFullTime() / (end_us - start_us),
+               (unsigned long)queue->getDroppedTotal(), (unsigned long)hook_calls);
+        for (size_t i = 0; i < SOURCE_COUNT; i++)
+            printf(" %6lu", (unsigned long)queue->getDropped(SOURCES[i].type));
+        printf("\n");
+    }
+    return 0;
+}
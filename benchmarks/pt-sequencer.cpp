@@ -0,0 +1,217 @@
+/**
+ * @file pt-sequencer.cpp
+ * @brief Host check of PTSequencer step order, gates and pattern switching
+ *
+ * The engine never reads the clock, so the program plays it on a virtual
+ * timeline: a 1ms loop calls gateAt() with the time into the current
+ * step and advance() at every 125ms step boundary (16ths at 120bpm), as
+ * pt-test-eurorack does with time_us_32(). Checks:
+ *  - steps wrap at the pattern length; a pattern chains to the next one
+ *    after its repeats
+ *  - gate high time per step follows the gate length; ties stay high,
+ *    rests stay low, ratchets split the step into equal sub-gates
+ *  - probability 8/16 fires about half the steps, 16/16 all of them
+ *  - queuePattern(PATTERN_END) on the last step, mid-pattern and from
+ *    the first step waits for the pattern end; NEXT_STEP switches at the
+ *    next advance, including on the last step
+ *  - PTPattern::isValid() rejects notes past 120 and bad lengths, and
+ *    setNote() clamps
+ *
+ * Usage: pt-sequencer (exit status 1 on a failed check)
+ */
+
+#include "eurorack_sequencer.h"
+#include "pt_check.h"
+
+#include <vector>
+
+static const uint32_t STEP_US = 125000;
+static const uint32_t TICK_US = 1000;
+
+using PTCheck::check;
+
+/**
+ * @brief Play steps on the virtual timeline
+ * @param high_us Gate high time per step, on the TICK_US grid
+ * @param rises Gate rising edges per step
+ */
+static std::vector<PTStepEvent> play(PTSequencer &seq, uint32_t steps, std::vector<uint32_t> *high_us = nullptr,
+                                     std::vector<uint32_t> *rises = nullptr)
+{
+    std::vector<PTStepEvent> events;
+    for (uint32_t s = 0; s < steps; s++)
+    {
+        events.push_back(seq.advance(STEP_US));
+        uint32_t high = 0, edges = 0;
+        bool previous = false;
+        for (uint32_t t = 0; t < STEP_US; t += TICK_US)
+        {
+            bool level = seq.gateAt(t);
+            high += level ? TICK_US : 0;
+            edges += level && !previous;
+            previous = level;
+        }
+        if (high_us)
+            high_us->push_back(high);
+        if (rises)
+            rises->push_back(edges);
+    }
+    return events;
+}
+
+static void checkOrderAndChain()
+{
+    PTSequencer seq;
+    PTPattern &a = seq.getPattern(0);
+    PTPattern &b = seq.getPattern(1);
+    a.length = 3;
+    a.repeats = 2;
+    a.next_pattern = 1;
+    b.length = 2;
+
+    std::vector<PTStepEvent> events = play(seq, 10);
+    static const uint8_t patterns[] = {0, 0, 0, 0, 0, 0, 1, 1, 1, 1};
+    static const uint8_t steps[] = {0, 1, 2, 0, 1, 2, 0, 1, 0, 1};
+    bool ok = true;
+    for (size_t i = 0; i < events.size(); i++)
+        ok &= events[i].pattern == patterns[i] && events[i].step == steps[i];
+    check(ok, "steps wrap at length 3, chain to pattern 1 after 2 repeats");
+}
+
+static void checkGates()
+{
+    PTSequencer seq;
+    PTPattern &p = seq.getPattern(0);
+    p.length = 4;
+    p.steps[0].gate = 128; // Half the step
+    p.steps[1].gate = 255; // Tie
+    p.steps[2].gate = 0;   // Rest
+    p.steps[3].gate = 128;
+    p.steps[3].setRatchets(4);
+
+    std::vector<uint32_t> high, rises;
+    std::vector<PTStepEvent> events = play(seq, 4, &high, &rises);
+    // Measured on the 1ms grid, so within one tick of the exact gate time
+    check(high[0] >= STEP_US / 2 && high[0] <= STEP_US / 2 + TICK_US && rises[0] == 1,
+          "gate 128: high for half the step");
+    check(high[1] == STEP_US && events[1].gate_us == STEP_US, "gate 255: tied, high for the whole step");
+    check(high[2] == 0 && !events[2].gate, "gate 0: rest");
+    // Four 31.25ms sub-steps, each high for half, seen on a 1ms grid
+    check(rises[3] == 4 && events[3].ratchet_us == STEP_US / 4 && high[3] >= 4 * 15000 && high[3] <= 4 * 16000,
+          "4 ratchets: four equal sub-gates");
+}
+
+static void checkProbability()
+{
+    PTSequencer seq;
+    PTPattern &p = seq.getPattern(0);
+    p.length = 2;
+    p.steps[0].setProbability(8);
+    p.steps[1].setProbability(16);
+    seq.setSeed(12345);
+
+    uint32_t fired[2] = {0, 0};
+    const uint32_t ROUNDS = 20000;
+    for (uint32_t i = 0; i < ROUNDS * 2; i++)
+    {
+        const PTStepEvent &e = seq.advance(STEP_US);
+        fired[e.step] += e.gate;
+    }
+    double half = (double)fired[0] / ROUNDS;
+    check(half > 0.48 && half < 0.52 && fired[1] == ROUNDS, "probability 8/16 fires ~50%, 16/16 always");
+}
+
+static void checkQueue()
+{
+    // PATTERN_END queued on the last step: the very next step is pattern 1's first
+    {
+        PTSequencer seq;
+        seq.getPattern(0).length = 4;
+        play(seq, 4); // Now on step 3 of 4
+        seq.queuePattern(1);
+        PTStepEvent e = seq.advance(STEP_US);
+        check(e.pattern == 1 && e.step == 0, "PATTERN_END queued on the last step: switches at the boundary");
+    }
+
+    // PATTERN_END queued mid-pattern and on the first step: finish the pattern first
+    static const uint32_t before[] = {2, 1};
+    static const char *const names[] = {"PATTERN_END queued mid-pattern: finishes the pattern first",
+                                        "PATTERN_END queued on the first step: finishes the pattern first"};
+    for (int c = 0; c < 2; c++)
+    {
+        PTSequencer seq;
+        seq.getPattern(0).length = 4;
+        play(seq, before[c]);
+        seq.queuePattern(1);
+        std::vector<PTStepEvent> events = play(seq, 4 - before[c] + 1);
+        bool ok = events.back().pattern == 1 && events.back().step == 0;
+        for (size_t i = 0; i + 1 < events.size(); i++)
+            ok &= events[i].pattern == 0 && events[i].step == before[c] + i;
+        check(ok, names[c]);
+    }
+
+    // NEXT_STEP, mid-pattern and on the last step
+    {
+        PTSequencer seq;
+        seq.getPattern(0).length = 4;
+        seq.getPattern(2).length = 4;
+        play(seq, 2);
+        seq.queuePattern(2, PTSequencer::NEXT_STEP);
+        PTStepEvent mid = seq.advance(STEP_US);
+        play(seq, 3); // Pattern 2 steps 1-3: on its last step
+        seq.queuePattern(0, PTSequencer::NEXT_STEP);
+        PTStepEvent last = seq.advance(STEP_US);
+        check(mid.pattern == 2 && mid.step == 0 && last.pattern == 0 && last.step == 0,
+              "NEXT_STEP: switches at the next advance, mid-pattern or on the last step");
+    }
+
+    // A queued switch overrides the chain, and the chain resumes from the new pattern
+    {
+        PTSequencer seq;
+        PTPattern &a = seq.getPattern(0);
+        a.length = 2;
+        a.next_pattern = 1;
+        seq.getPattern(3).length = 2;
+        play(seq, 1);
+        seq.queuePattern(3);
+        std::vector<PTStepEvent> events = play(seq, 3);
+        check(events[0].pattern == 0 && events[1].pattern == 3 && events[1].step == 0 && events[2].pattern == 3,
+              "queued switch at the pattern end takes priority over the chain");
+    }
+}
+
+static void checkValidation()
+{
+    PTPattern p;
+    p.clear();
+    bool ok = p.isValid();
+    p.steps[31].note = 121; // Beyond the 121-entry note table, even outside length
+    ok &= !p.isValid();
+    p.steps[31].setNote(200);
+    ok &= p.steps[31].note == PTSequencerStep::MAX_NOTE && p.isValid();
+    p.length = 0;
+    ok &= !p.isValid();
+    p.length = PTPattern::MAX_STEPS + 1;
+    ok &= !p.isValid();
+    p.length = 16;
+    p.repeats = 0;
+    ok &= !p.isValid();
+    check(ok, "isValid() rejects note > 120, length 0/33, 0 repeats; setNote() clamps");
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    checkOrderAndChain();
+    checkGates();
+    checkProbability();
+    checkQueue();
+    checkValidation();
+
+    return PTCheck::summary();
+}
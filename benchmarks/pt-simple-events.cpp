@@ -0,0 +1,207 @@
+/**
+ * @file pt-simple-events.cpp
+ * @brief Host simulation of polling vs event-driven SimpleThreads
+ *
+ * Replays the pt-test-eurorack loop on a virtual clock: an input thread
+ * turns hardware edges into events, a UI thread handles the encoder and
+ * a gate thread the clock input. In "poll" mode both drain one shared
+ * queue on every scheduler pass, as the example did before; in "event"
+ * mode they subscribe and the scheduler wakes them with a batch. Each
+ * mode runs an idle second followed by a busy one (encoder turns every
+ * 50ms, a gate every 250ms) and prints the scheduler passes, UI wakeups,
+ * UI CPU time and the gate edges each consumer saw.
+ *
+ * Usage: pt-simple-events (exit status 1 if the event mode loses edges
+ *        or wakes an idle UI)
+ */
+
+#include "pt_thread.h"
+#include "simple_threads.h"
+
+static const uint32_t PASS_US = 20;        // Rest of the loop: sequencer, CV, maintenance
+static const uint32_t DRAIN_US = 2;        // Locking and checking an empty queue
+static const uint32_t HANDLE_US = 15;      // Handling one event
+static const uint32_t ENCODER_PERIOD_US = 50000;
+static const uint32_t GATE_PERIOD_US = 250000;
+static const uint32_t PHASE_US = 1000000;
+
+enum EventType
+{
+    ENCODER_TURN = 1,
+    GATE_RISING = 4
+};
+
+static PTEventQueue input_queue;
+static bool event_mode = false;
+static SimpleScheduler *scheduler = nullptr;
+
+static void spend(uint32_t us)
+{
+    pico_host_advance(us);
+}
+
+/**
+ * @brief Stand-in for InputPollingThread: raises edges on a fixed script
+ */
+class InputThread : public SimpleThread
+{
+private:
+    uint64_t busy_from;
+    uint64_t next_encoder;
+    uint64_t next_gate;
+
+    void raise(EventType type)
+    {
+        if (event_mode)
+            scheduler->post(type, 1);
+        else
+            input_queue.push(PTEvent((PTEventType)type, 1));
+    }
+
+public:
+    uint32_t gates_raised;
+
+    InputThread(uint64_t busy_at)
+        : SimpleThread("Input"), busy_from(busy_at), next_encoder(busy_at), next_gate(busy_at), gates_raised(0)
+    {
+        setInterval(1);
+    }
+
+    void execute() override
+    {
+        uint64_t now = pico_host_time_us;
+        if (now < busy_from)
+            return;
+        if (now >= next_encoder)
+        {
+            raise(ENCODER_TURN);
+            next_encoder += ENCODER_PERIOD_US;
+        }
+        if (now >= next_gate)
+        {
+            raise(GATE_RISING);
+            gates_raised++;
+            next_gate += GATE_PERIOD_US;
+        }
+    }
+};
+
+/**
+ * @brief UI or gate consumer; handles only its own type, like the example
+ */
+class ConsumerThread : public SimpleThread
+{
+private:
+    EventType wanted;
+
+    void handle(uint32_t type)
+    {
+        spend(HANDLE_US);
+        if (type == (uint32_t)wanted)
+            seen++;
+    }
+
+public:
+    uint32_t wakeups;
+    uint32_t busy_us;
+    uint32_t seen;
+
+    ConsumerThread(const char *name, EventType type)
+        : SimpleThread(name), wanted(type), wakeups(0), busy_us(0), seen(0)
+    {
+        if (event_mode)
+            subscribe(SimpleEvent::bit(type));
+    }
+
+    void execute() override
+    {
+        uint32_t start = time_us_32();
+        wakeups++;
+        if (event_mode)
+        {
+            for (uint32_t i = 0; i < getEventCount(); i++)
+                handle(getEvents()[i].type);
+        }
+        else
+        {
+            PTEvent event;
+            spend(DRAIN_US);
+            while (input_queue.pop(event))
+                handle((uint32_t)event.type);
+        }
+        busy_us += time_us_32() - start;
+    }
+};
+
+struct PhaseResult
+{
+    uint32_t passes;
+    uint32_t ui_wakeups;
+    uint32_t ui_busy_us;
+    uint32_t gates_raised;
+    uint32_t gates_seen;
+};
+
+/**
+ * @brief Run one mode: an idle phase, then a busy one
+ */
+static void runMode(bool events, PhaseResult result[2])
+{
+    event_mode = events;
+    SimpleScheduler sched;
+    scheduler = &sched;
+
+    InputThread input(pico_host_time_us + PHASE_US);
+    ConsumerThread ui("UI", ENCODER_TURN);
+    ConsumerThread gate("GateInput", GATE_RISING);
+    sched.addThread(&input);
+    sched.addThread(&ui);
+    sched.addThread(&gate);
+
+    for (int phase = 0; phase < 2; phase++)
+    {
+        uint64_t end = pico_host_time_us + PHASE_US;
+        PhaseResult &r = result[phase];
+        r = {};
+        uint32_t wakeups = ui.wakeups, busy = ui.busy_us, raised = input.gates_raised, seen = gate.seen;
+        while (pico_host_time_us < end)
+        {
+            sched.run();
+            spend(PASS_US);
+            r.passes++;
+        }
+        r.ui_wakeups = ui.wakeups - wakeups;
+        r.ui_busy_us = ui.busy_us - busy;
+        r.gates_raised = input.gates_raised - raised;
+        r.gates_seen = gate.seen - seen;
+    }
+}
+
+static void print(const char *mode, const char *phase, const PhaseResult &r)
+{
+    printf("%-6s %-5s %8lu %9lu %8lu %7lu/%lu\n", mode, phase, (unsigned long)r.passes,
+           (unsigned long)r.ui_wakeups, (unsigned long)r.ui_busy_us,
+           (unsigned long)r.gates_seen, (unsigned long)r.gates_raised);
+}
+
+int main()
+{
+    pico_host_virtual_time = true;
+
+    PhaseResult poll[2], event[2];
+    runMode(false, poll);
+    runMode(true, event);
+
+    printf("%lu us per pass outside the UI, %lu us to drain an empty queue, %lu us per event\n",
+           (unsigned long)PASS_US, (unsigned long)DRAIN_US, (unsigned long)HANDLE_US);
+    printf("%-6s %-5s %8s %9s %8s %9s\n", "mode", "phase", "passes", "ui_wakes", "ui_us", "gates");
+    print("poll", "idle", poll[0]);
+    print("poll", "busy", poll[1]);
+    print("event", "idle", event[0]);
+    print("event", "busy", event[1]);
+
+    bool ok = event[0].ui_wakeups == 0 && event[1].gates_seen == event[1].gates_raised &&
+              event[1].ui_wakeups <= PHASE_US / ENCODER_PERIOD_US;
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/**
+ * @file pt-snapshot-stress.cpp
+ * @brief Host stress test of PTSnapshot and PTSeqSnapshot across two threads
+ *
+ * A writer thread publishes numbered parameter sets as fast as it can
+ * while a reader thread reads continuously. Every word of a set is
+ * derived from its number, so a read mixing two publishes is caught, as
+ * is one going back in time. Runs both variants at 16, 64 and 256 bytes
+ * and prints reads, distinct sets seen and seqlock retries.
+ *
+ * The publish/read cost per size is in pt-bench (snapshot/...).
+ *
+ * Usage: pt-snapshot-stress [--publishes=N] (exit status 1 on a torn or stale read)
+ */
+
+#include "pt_snapshot.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+static uint32_t publish_count = 2000000;
+
+template <size_t BYTES>
+struct Params
+{
+    uint32_t words[BYTES / 4];
+
+    void fill(uint32_t number)
+    {
+        for (size_t i = 0; i < BYTES / 4; i++)
+        {
+            words[i] = number * 2654435761u + (uint32_t)i;
+        }
+    }
+
+    bool consistent() const
+    {
+        uint32_t number_hash = words[0];
+        for (size_t i = 1; i < BYTES / 4; i++)
+        {
+            if (words[i] != number_hash + (uint32_t)i)
+                return false;
+        }
+        return true;
+    }
+};
+
+struct StressResult
+{
+    uint32_t reads;
+    uint32_t distinct;
+    uint32_t torn;
+    uint32_t backwards;
+};
+
+/**
+ * @brief Read one parameter set; the triple buffer hands out a reference
+ */
+template <typename T>
+static T readSet(PTSnapshot<T> &snapshot) { return snapshot.read(); }
+
+template <typename T>
+static T readSet(PTSeqSnapshot<T> &snapshot) { return snapshot.read(); }
+
+template <size_t BYTES, template <typename> class Snapshot>
+static StressResult stress(Snapshot<Params<BYTES>> &snapshot)
+{
+    // Set numbers are recovered from words[0] via this map; publish n uses number n
+    static uint32_t inverse = 0;
+    if (!inverse)
+    {
+        // Multiplicative inverse of the hash constant mod 2^32 (Newton iteration)
+        uint32_t x = 2654435761u;
+        for (int i = 0; i < 5; i++)
+            x *= 2 - 2654435761u * x;
+        inverse = x;
+    }
+
+    std::atomic<bool> done(false);
+    StressResult result = {};
+
+    Params<BYTES> initial;
+    initial.fill(0);
+    snapshot.publish(initial);
+
+    std::thread writer([&]()
+                       {
+        Params<BYTES> params;
+        for (uint32_t n = 1; n <= publish_count; n++)
+        {
+            params.fill(n);
+            snapshot.publish(params);
+        }
+        done.store(true); });
+
+    uint32_t last = 0;
+    while (!done.load())
+    {
+        Params<BYTES> params = readSet(snapshot);
+        result.reads++;
+        if (!params.consistent())
+        {
+            result.torn++;
+            continue;
+        }
+        uint32_t number = params.words[0] * inverse;
+        if (number < last)
+            result.backwards++;
+        else if (number != last)
+            result.distinct++;
+        last = number;
+    }
+    writer.join();
+
+    // After the writer is done the reader must see its final set
+    Params<BYTES> final_params = readSet(snapshot);
+    if (!final_params.consistent() || final_params.words[0] * inverse != publish_count)
+        result.backwards++;
+    return result;
+}
+
+template <size_t BYTES>
+static bool runSize()
+{
+    static PTSnapshot<Params<BYTES>> triple;
+    static PTSeqSnapshot<Params<BYTES>> seq;
+
+    StressResult t = stress<BYTES>(triple);
+    StressResult s = stress<BYTES>(seq);
+
+    printf("%-8s %5lu %10lu %10lu %6lu %6lu\n", "triple", (unsigned long)BYTES, (unsigned long)t.reads,
+           (unsigned long)t.distinct, (unsigned long)t.torn, (unsigned long)t.backwards);
+    printf("%-8s %5lu %10lu %10lu %6lu %6lu  retries %lu\n", "seqlock", (unsigned long)BYTES,
+           (unsigned long)s.reads, (unsigned long)s.distinct, (unsigned long)s.torn,
+           (unsigned long)s.backwards, (unsigned long)seq.getRetries());
+
+    return t.torn == 0 && t.backwards == 0 && s.torn == 0 && s.backwards == 0;
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strncmp(argv[i], "--publishes=", 12) == 0)
+        {
+            publish_count = (uint32_t)strtoul(argv[i] + 12, nullptr, 10);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--publishes=N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (publish_count == 0)
+        publish_count = 1;
+
+    printf("%lu publishes per run, reader spinning on the other thread\n", (unsigned long)publish_count);
+    if (std::thread::hardware_concurrency() < 2)
+        printf("Only one host CPU: overlaps happen only at preemption, so few are exercised\n");
+    printf("%-8s %5s %10s %10s %6s %6s\n", "variant", "bytes", "reads", "distinct", "torn", "stale");
+
+    bool ok = runSize<16>();
+    ok &= runSize<64>();
+    ok &= runSize<256>();
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file pt-spi-adc.cpp
+ * @brief Host check and benchmark of PTSpiAdc against modelled ADC chips
+ *
+ * The host SPI/DMA stand-ins (host/hardware/spi.h, dma.h) run the
+ * scanner's three DMA channels; this program plays the PWM slice by
+ * asserting its wrap DREQ once per conversion period (virtual time) and
+ * answers on MISO with a byte-level model of an MCP3208 or ADS8688,
+ * including the ADS8688's one-frame pipeline. CS is not modelled, so the
+ * models count 4-byte frames.
+ *
+ * Checks, per chip:
+ *  - every channel reads back its modelled input after a scan
+ *  - a change beyond the threshold pushes one CV_CHANGE, a smaller one none
+ *  - a poll() too late finds the ring overwritten, counts one overrun and
+ *    the next samples still land on the right channels
+ *  - scanning 3 channels rounds up to 4
+ *
+ * It then sweeps the scan rate and reports samples/second next to the
+ * CPU time poll() takes (polled every millisecond) and the share of the
+ * CPU a blocking SPI read of each sample would use instead. DMA moves
+ * every byte and there are no interrupts, so poll() is the only CPU
+ * cost. Host times are for comparing changes, not device figures.
+ *
+ * Usage: pt-spi-adc (exit status 1 on a wrong sample or event)
+ */
+
+#include "eurorack_spi_adc.h"
+
+#include <chrono>
+#include <cstring>
+
+using EurorackSpiAdc::Chip;
+
+static const uint SCK_PIN = 10;
+static const uint MOSI_PIN = 11;
+static const uint MISO_PIN = 12;
+static const uint CS_PIN = 13;
+
+typedef PTSpiAdc<10> Adc;
+
+// ---- ADC chip model ----
+
+struct ChipModel
+{
+    Chip chip;
+    uint16_t inputs[8]; // Input level as a 16-bit fraction of full scale
+    uint position;      // Byte within the 4-byte frame
+    uint8_t command[2];
+    uint selected; // ADS8688: channel commanded in the previous frame
+    uint16_t output;
+};
+
+static ChipModel model;
+
+static uint8_t reverseBits(uint8_t b)
+{
+    uint8_t r = 0;
+    for (int i = 0; i < 8; i++)
+        r |= (uint8_t)(((b >> i) & 1) << (7 - i));
+    return r;
+}
+
+static uint32_t mcp3208Byte(uint8_t mosi)
+{
+    switch (model.position)
+    {
+    case 0:
+        model.command[0] = mosi;
+        return 0xFF; // DOUT floats until the null bit
+    case 1:
+    {
+        uint channel = ((model.command[0] & 1u) << 2) | (mosi >> 6);
+        model.output = (model.command[0] & 0x06) == 0x06 ? model.inputs[channel] >> 4 : 0;
+        return 0xE0 | (model.output >> 8); // Floating, null bit, B11..B8
+    }
+    case 2:
+        return model.output & 0xFF;
+    default:
+        return reverseBits((uint8_t)model.output); // Extra clocks repeat the result LSB first
+    }
+}
+
+static uint32_t ads8688Byte(uint8_t mosi)
+{
+    switch (model.position)
+    {
+    case 0:
+        // CS falling: sample the channel selected in the previous frame
+        model.output = model.inputs[model.selected];
+        model.command[0] = mosi;
+        return 0;
+    case 1:
+        model.command[1] = mosi;
+        return 0;
+    case 2:
+        return model.output >> 8;
+    default:
+    {
+        uint16_t command = (uint16_t)((model.command[0] << 8) | model.command[1]);
+        if ((command & 0xE3FF) == 0xC000)
+            model.selected = (command >> 10) & 7;
+        return model.output & 0xFF;
+    }
+    }
+}
+
+static uint32_t deviceByte(uint, uint bits, uint32_t mosi)
+{
+    if (bits != 8)
+        return 0;
+    uint32_t miso = model.chip == Chip::ADS8688 ? ads8688Byte((uint8_t)mosi) : mcp3208Byte((uint8_t)mosi);
+    model.position = (model.position + 1) % EurorackSpiAdc::FRAME_BYTES;
+    return miso;
+}
+
+static void resetModel(Chip chip)
+{
+    model = ChipModel{};
+    model.chip = chip;
+    for (uint c = 0; c < 8; c++)
+        model.inputs[c] = (uint16_t)(0x1000 + c * 0x1C30);
+    pico_host_spi[1].rx_head = pico_host_spi[1].rx_tail = 0;
+}
+
+static uint16_t expected(Chip chip, uint16_t input)
+{
+    return chip == Chip::ADS8688 ? input : (uint16_t)(input & 0xFFF0);
+}
+
+/**
+ * @brief Conversion periods: the PWM wraps and CS frames one conversion each
+ */
+template <typename A>
+static void convert(A &adc, uint32_t conversions)
+{
+    for (uint32_t i = 0; i < conversions; i++)
+    {
+        pico_host_dma_dreq(pwm_get_dreq(adc.getPwmSlice()));
+    }
+}
+
+// ---- Checks ----
+
+static bool checkValues(Adc &adc, Chip chip, uint channels)
+{
+    for (uint c = 0; c < channels; c++)
+    {
+        if (adc.getRaw(c) != expected(chip, model.inputs[c]))
+        {
+            printf("  channel %u: read %04x, expected %04x\n", c, adc.getRaw(c), expected(chip, model.inputs[c]));
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool checkChip(const char *name, Chip chip)
+{
+    resetModel(chip);
+    Adc adc(spi1, chip, SCK_PIN, MOSI_PIN, MISO_PIN, CS_PIN, 1000);
+    PTEventQueue queue;
+    adc.setEventQueue(&queue);
+    uint channels = adc.getChannelCount();
+
+    // Two scans: every channel read, one CV_CHANGE each from the power-up zero
+    convert(adc, channels * 2 + 1);
+    adc.poll();
+    bool values_ok = checkValues(adc, chip, channels);
+    uint32_t first_events = (uint32_t)queue.size();
+    PTEvent event;
+    while (queue.pop(event))
+    {
+    }
+
+    // One change beyond the threshold, one below it
+    model.inputs[3] = (uint16_t)(model.inputs[3] + 2000);
+    model.inputs[5] = (uint16_t)(model.inputs[5] + 300);
+    convert(adc, channels * 2);
+    adc.poll();
+    bool change_ok = queue.size() == 1 && queue.pop(event) && event.type == PTEventType::CV_CHANGE &&
+                     event.data == 4 + 3 && adc.getValue(5) != adc.getRaw(5) && checkValues(adc, chip, channels);
+
+    // A late poll: the ring was overwritten while nobody read it
+    convert(adc, Adc::getRingSamples() + 37);
+    adc.poll();
+    model.inputs[0] = (uint16_t)(model.inputs[0] + 4000);
+    convert(adc, channels * 3);
+    adc.poll();
+    bool overrun_ok = adc.getOverrunCount() == 1 && checkValues(adc, chip, channels);
+
+    bool ok = values_ok && first_events == channels && change_ok && overrun_ok;
+    printf("%-10s %u ch  %7lu samples/s  values %s, events %s, overrun %s", name, channels,
+           (unsigned long)adc.getSampleRate(), values_ok ? "ok" : "BAD", change_ok ? "ok" : "BAD",
+           overrun_ok ? "ok" : "BAD");
+    return ok;
+}
+
+static bool checkSubset(Chip chip)
+{
+    // 3 channels scan as 4
+    resetModel(chip);
+    Adc adc(spi1, chip, SCK_PIN, MOSI_PIN, MISO_PIN, CS_PIN, 1000, 3);
+    convert(adc, 4 * 2 + 1);
+    adc.poll();
+    bool ok = adc.getChannelCount() == 4 && checkValues(adc, chip, 4) && adc.getRaw(4) == 0;
+    printf(", subset %s", ok ? "ok" : "BAD");
+    return ok;
+}
+
+// ---- Samples/second vs CPU ----
+
+static uint64_t nowNs()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+template <typename A>
+static void sweep(const char *name, Chip chip, const uint32_t *scan_rates, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        resetModel(chip);
+        A adc(spi1, chip, SCK_PIN, MOSI_PIN, MISO_PIN, CS_PIN, scan_rates[i]);
+        uint32_t rate = adc.getSampleRate();
+        uint32_t per_ms = rate / 1000 ? rate / 1000 : 1;
+        const uint32_t polls = 500; // Half a second of virtual time, one poll per ms
+
+        uint64_t poll_ns = 0;
+        uint32_t decoded = 0;
+        for (uint32_t p = 0; p < polls; p++)
+        {
+            // Moving inputs, so some polls push events
+            model.inputs[p % 8] = (uint16_t)(model.inputs[p % 8] + 97 * p);
+            convert(adc, per_ms);
+            uint64_t start = nowNs();
+            decoded += (uint32_t)adc.poll();
+            poll_ns += nowNs() - start;
+        }
+
+        double seconds = polls / 1000.0;
+        double blocking = rate * 32.0 / adc.getBaudrate() * 100.0;
+        printf("%-10s %8lu %9.0f %10lu %10.1f %10.1f %8.3f %10.1f %5lu\n", name, (unsigned long)scan_rates[i],
+               adc.getScanRate(), (unsigned long)(decoded / seconds), (double)poll_ns / polls,
+               (double)poll_ns / (decoded ? decoded : 1), poll_ns / (seconds * 1e9) * 100.0,
+               blocking > 100.0 ? 100.0 : blocking, (unsigned long)adc.getOverrunCount());
+    }
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+    {
+        fprintf(stderr, "usage: %s\n", argv[0]);
+        return 1;
+    }
+
+    pico_host_virtual_time = true;
+    pico_host_spi_device_hook = deviceByte;
+
+    printf("Modelled chip check (PTSpiAdc<10>: %lu-sample ring)\n", (unsigned long)Adc::getRingSamples());
+    bool ok = true;
+    static const Chip chips[] = {Chip::MCP3208, Chip::ADS8688};
+    static const char *names[] = {"MCP3208", "ADS8688"};
+    for (int i = 0; i < 2; i++)
+    {
+        bool chip_ok = checkChip(names[i], chips[i]);
+        chip_ok &= checkSubset(chips[i]);
+        printf("  %s\n", chip_ok ? "ok" : "FAILED");
+        ok &= chip_ok;
+    }
+
+    printf("\nScan rate sweep, 8 channels, poll() every 1 ms (ring: MCP3208 256, ADS8688 1024 samples)\n");
+    printf("No interrupts; the DMA starts TX and RX once per sample\n");
+    printf("%-10s %8s %9s %10s %10s %10s %8s %10s %5s\n", "chip", "scan_req", "scan_hz", "samples/s",
+           "ns/poll", "ns/sample", "cpu_%", "blocking_%", "ovr");
+    static const uint32_t mcp_rates[] = {250, 500, 1000, 2000, 4000};
+    static const uint32_t ads_rates[] = {1000, 5000, 10000, 25000, 50000};
+    sweep<PTSpiAdc<10>>("MCP3208", Chip::MCP3208, mcp_rates, 5);
+    sweep<PTSpiAdc<12>>("ADS8688", Chip::ADS8688, ads_rates, 5); // 388k samples/s need > 388 per 1 ms poll
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
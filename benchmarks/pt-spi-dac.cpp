@@ -0,0 +1,320 @@
+/**
+ * @file pt-spi-dac.cpp
+ * @brief Host check and benchmark of PTSpiDac against a recorded SPI bus
+ *
+ * The host SPI/DMA stand-ins (host/hardware/spi.h, dma.h) complete
+ * transfers at once and run the DMA interrupt synchronously; this
+ * program records every SPI frame and GPIO edge on one timeline and
+ * decodes it back into DAC writes. For MCP4822 and DAC8564 layouts of
+ * 2, 4 and 8 channels it checks that each frame carries exactly the
+ * changed channels with the right codes, framed by the right chip
+ * select, and that a single LDAC pulse follows the last word.
+ *
+ * It then times a full frame (every channel changed, staged and sent)
+ * for each layout next to PTCVOutput's PWM writes. The host time covers
+ * update() and the DMA interrupts it triggers; the table also gives the
+ * device-side counts that matter on the RP2040: DMA starts and
+ * interrupts per frame and the bus time at the chip's SPI clock.
+ *
+ * Usage: pt-spi-dac [--format=table|json|csv] (exit status 1 on a bad frame)
+ */
+
+#include "eurorack_spi_dac.h"
+#include "eurorack_hardware.h"
+#include "pt_benchmark.h"
+
+#include <chrono>
+#include <cstring>
+
+using EurorackSpiDac::Chip;
+
+static const uint SCK_PIN = 18;
+static const uint MOSI_PIN = 19;
+static const uint LDAC_PIN = 20;
+
+// Recorded bus: SPI frames and GPIO edges in order
+struct BusEvent
+{
+    bool spi;
+    uint pin_or_bits;
+    uint32_t value;
+};
+
+static BusEvent bus[256];
+static size_t bus_count = 0;
+static uint32_t irq_count = 0;
+
+static void recordGpio(uint gpio, bool value)
+{
+    if (bus_count < 256)
+        bus[bus_count++] = {false, gpio, value};
+}
+
+static void recordSpi(uint, uint bits, uint32_t value)
+{
+    if (bus_count < 256)
+        bus[bus_count++] = {true, bits, value};
+}
+
+static void countIrq()
+{
+    irq_count++;
+}
+
+struct Layout
+{
+    const char *name;
+    Chip chip;
+    uint cs_pin;
+    uint chips;
+    uint ldac_pin;
+};
+
+static const Layout LAYOUTS[] = {
+    {"mcp4822x1_2ch", Chip::MCP4822, 17, 1, LDAC_PIN}, // GPIO17 is SPI0 CSn: one DMA transfer
+    {"mcp4822x2_4ch", Chip::MCP4822, 21, 2, LDAC_PIN},
+    {"mcp4822x4_8ch", Chip::MCP4822, 21, 4, LDAC_PIN},
+    {"dac8564x1_4ch", Chip::DAC8564, 17, 1, LDAC_PIN},
+    {"dac8564x2_8ch", Chip::DAC8564, 17, 2, LDAC_PIN},
+    {"dac8564x2_8ch_noldac", Chip::DAC8564, 17, 2, EurorackSpiDac::NO_PIN},
+};
+
+struct Write
+{
+    uint chip;
+    uint channel;
+    uint16_t level; // Top bits only on 12-bit chips
+    bool load_all;
+};
+
+/**
+ * @brief Turn the recorded bus back into DAC writes
+ * @return false on a framing error (word outside CS, wrong length, CS left low)
+ */
+static bool decode(const Layout &layout, bool hardware_cs, Write *writes, size_t &count, int &ldac_pulses,
+                   bool &ldac_after_last)
+{
+    EurorackSpiDac::ChipInfo info = EurorackSpiDac::chipInfo(layout.chip);
+    count = 0;
+    ldac_pulses = 0;
+    ldac_after_last = true;
+
+    int selected = -1; // Chip index with CS low
+    uint32_t word = 0;
+    uint bits = 0;
+
+    for (size_t i = 0; i < bus_count; i++)
+    {
+        const BusEvent &e = bus[i];
+        if (!e.spi)
+        {
+            if (e.pin_or_bits == layout.ldac_pin)
+            {
+                if (!e.value)
+                {
+                    ldac_pulses++;
+                    if (selected >= 0 || i + 2 < bus_count)
+                        ldac_after_last = false; // Bus still busy after the latch
+                }
+                continue;
+            }
+
+            uint chip_index = layout.chip == Chip::DAC8564 ? 0 : e.pin_or_bits - layout.cs_pin;
+            if (!e.value)
+            {
+                if (selected >= 0)
+                    return false;
+                selected = (int)chip_index;
+                word = 0;
+                bits = 0;
+            }
+            else
+            {
+                if (selected < 0 || bits != info.word_bits)
+                    return false;
+                uint chip_index_word = layout.chip == Chip::DAC8564 ? (word >> 22) & 3 : (uint)selected;
+                writes[count++] = {chip_index_word, 0, 0, false};
+                Write &w = writes[count - 1];
+                if (layout.chip == Chip::DAC8564)
+                {
+                    w.channel = (word >> 17) & 3;
+                    w.level = (uint16_t)word;
+                    w.load_all = ((word >> 20) & 3) == 2;
+                }
+                else
+                {
+                    w.channel = (word >> 15) & 1;
+                    w.level = (uint16_t)((word & 0xFFF) << 4);
+                }
+                selected = -1;
+            }
+            continue;
+        }
+
+        if (hardware_cs)
+        {
+            // The SPI pulses CSn around every 16-bit frame
+            if (e.pin_or_bits != 16)
+                return false;
+            writes[count++] = {0, (e.value >> 15) & 1, (uint16_t)((e.value & 0xFFF) << 4), false};
+            continue;
+        }
+        if (selected < 0)
+            return false;
+        word = (word << e.pin_or_bits) | e.value;
+        bits += e.pin_or_bits;
+    }
+    return selected < 0;
+}
+
+/**
+ * @brief Send frames with all and then some channels changed, and check the bus
+ */
+static bool checkLayout(const Layout &layout)
+{
+    PTSpiDac<8> dac(spi0, layout.chip, SCK_PIN, MOSI_PIN, layout.cs_pin, layout.ldac_pin, layout.chips);
+    EurorackSpiDac::ChipInfo info = EurorackSpiDac::chipInfo(layout.chip);
+    uint channels = dac.getChannelCount();
+    uint16_t mask = info.bits == 12 ? 0xFFF0 : 0xFFFF;
+    bool ok = channels == info.channels * layout.chips;
+
+    for (int frame = 0; frame < 3 && ok; frame++)
+    {
+        // Frame 0: every channel; 1: odd channels; 2: only the last one
+        uint32_t changed = 0;
+        for (uint c = 0; c < channels; c++)
+        {
+            bool change = frame == 0 || (frame == 1 && (c & 1)) || (frame == 2 && c == channels - 1);
+            if (change)
+            {
+                dac.output((uint8_t)c).setLevel((uint16_t)(0x1234 * (c + 1) + frame * 0x0F00 + 0x10));
+                changed |= 1u << c;
+            }
+        }
+
+        bus_count = 0;
+        pico_host_gpio_put_hook = recordGpio;
+        pico_host_spi_frame_hook = recordSpi;
+        bool started = dac.update();
+        pico_host_gpio_put_hook = nullptr;
+        pico_host_spi_frame_hook = nullptr;
+
+        Write writes[16];
+        size_t count = 0;
+        int pulses = 0;
+        bool after_last = false;
+        bool framed = decode(layout, dac.usesHardwareCs(), writes, count, pulses, after_last);
+
+        ok = started && framed && !dac.isBusy() && count == (size_t)__builtin_popcount(changed);
+        ok = ok && (layout.ldac_pin == EurorackSpiDac::NO_PIN ? pulses == 0 : pulses == 1 && after_last);
+
+        uint32_t seen = 0;
+        for (size_t i = 0; i < count && ok; i++)
+        {
+            uint c = writes[i].chip * info.channels + writes[i].channel;
+            ok = c < channels && writes[i].level == (dac.getLevel(c) & mask);
+            seen |= 1u << c;
+
+            // Without LDAC a DAC8564 loads with the last word it gets in the frame
+            if (layout.chip == Chip::DAC8564 && layout.ldac_pin == EurorackSpiDac::NO_PIN)
+            {
+                bool last_for_chip = true;
+                for (size_t j = i + 1; j < count; j++)
+                    last_for_chip = last_for_chip && writes[j].chip != writes[i].chip;
+                ok = ok && writes[i].load_all == last_for_chip;
+            }
+        }
+        ok = ok && seen == changed;
+    }
+
+    ok = ok && !dac.update(); // Nothing staged: no frame
+    printf("%-22s %3u ch  %-8s %2lu frames  %s\n", layout.name, channels,
+           dac.usesHardwareCs() ? "hw CS" : "gpio CS", (unsigned long)dac.getFrameCount(), ok ? "ok" : "FAILED");
+    return ok;
+}
+
+static uint64_t hostTicks()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int main(int argc, char **argv)
+{
+    PTBenchmark::Format format = PTBenchmark::Format::TABLE;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--format=json") == 0)
+            format = PTBenchmark::Format::JSON;
+        else if (strcmp(argv[i], "--format=csv") == 0)
+            format = PTBenchmark::Format::CSV;
+        else if (strcmp(argv[i], "--format=table") != 0)
+        {
+            fprintf(stderr, "usage: %s [--format=table|json|csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    printf("Recorded bus check\n");
+    bool ok = true;
+    for (const Layout &layout : LAYOUTS)
+        ok &= checkLayout(layout);
+
+    // Device-side cost per full frame
+    printf("\n%-22s %8s %8s %10s\n", "layout", "dma/frm", "irq/frm", "bus_us");
+    irq_add_shared_handler(DMA_IRQ_0, countIrq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    for (const Layout &layout : LAYOUTS)
+    {
+        PTSpiDac<8> dac(spi0, layout.chip, SCK_PIN, MOSI_PIN, layout.cs_pin, layout.ldac_pin, layout.chips);
+        dac.update(); // Initial frame
+        uint32_t dma_before = pico_host_dma_transfers;
+        irq_count = 0;
+        for (uint c = 0; c < dac.getChannelCount(); c++)
+            dac.setLevel(c, (uint16_t)(dac.getLevel(c) + 0x100));
+        dac.update();
+        uint32_t bits = dac.getChannelCount() * EurorackSpiDac::chipInfo(layout.chip).word_bits;
+        printf("%-22s %8lu %8lu %10.2f\n", layout.name, (unsigned long)(pico_host_dma_transfers - dma_before) / 2,
+               (unsigned long)irq_count, bits * 1e6 / dac.getBaudrate());
+    }
+    printf("\n");
+
+    // Host CPU time per full frame: stage every channel, then update()
+    PTBenchmark::Runner runner(hostTicks, 1.0);
+    static const char *names[] = {"spi_dac/frame/mcp4822x1_2ch", "spi_dac/frame/mcp4822x2_4ch",
+                                  "spi_dac/frame/mcp4822x4_8ch", "spi_dac/frame/dac8564x1_4ch",
+                                  "spi_dac/frame/dac8564x2_8ch", "spi_dac/frame/dac8564x2_8ch_noldac"};
+    for (size_t l = 0; l < sizeof(LAYOUTS) / sizeof(LAYOUTS[0]); l++)
+    {
+        const Layout &layout = LAYOUTS[l];
+        PTSpiDac<8> dac(spi0, layout.chip, SCK_PIN, MOSI_PIN, layout.cs_pin, layout.ldac_pin, layout.chips);
+        uint channels = dac.getChannelCount();
+        uint16_t level = 0;
+        runner.run(names[l], [&]()
+                   {
+            level += 0x10;
+            for (uint c = 0; c < channels; c++)
+                dac.setLevel(c, level);
+            PTBenchmark::doNotOptimize(dac.update()); });
+    }
+
+    // PWM outputs for reference: one register write per channel, no framing
+    static const char *pwm_names[] = {"spi_dac/pwm_reference/2ch", "spi_dac/pwm_reference/4ch",
+                                      "spi_dac/pwm_reference/8ch"};
+    static PTCVOutput pwm[8] = {PTCVOutput(0), PTCVOutput(1), PTCVOutput(2), PTCVOutput(3),
+                                PTCVOutput(4), PTCVOutput(5), PTCVOutput(6), PTCVOutput(7)};
+    for (int n = 0; n < 3; n++)
+    {
+        uint channels = 2u << n;
+        uint16_t level = 0;
+        runner.run(pwm_names[n], [&]()
+                   {
+            level += 0x10;
+            for (uint c = 0; c < channels; c++)
+                pwm[c].setLevel(level); });
+    }
+    runner.report(format);
+
+    printf("%s\n", ok ? "ok" : "FAILED");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,286 @@
+/**
+ * @file pt-storage.cpp
+ * @brief Host check and benchmark of PTFlashStorage on an emulated flash
+ *
+ * The settings written are those of pt-test-eurorack: a tempo under key
+ * 0 and eight sequencer patterns under keys 1-8. Each round changes the
+ * tempo and one of the first three patterns and saves all nine keys, as
+ * saveSettings() does, so unchanged patterns are skipped and the other
+ * five must be carried forward at each sector erase. Checks, on a
+ * 4-sector region that the script wraps several times:
+ *  - power cut at every erase and program of the script, losing the
+ *    interrupted operation or tearing it inside the record header or
+ *    half way through the page: after power returns, mount()
+ *    succeeds and every key loads its last committed value (the save cut
+ *    short may have landed or not, but nothing older and nothing torn);
+ *    saving then carries on, changing only the tempo so the patterns are
+ *    kept alive by relocation alone through several sector erases, and
+ *    survives another mount()
+ *  - no program ever writes over unerased bits
+ *  - erases are spread evenly: every sector within one erase of the others
+ *
+ * It then times mount() and load() on the 16-sector region the firmware
+ * uses, and prints the flash bytes mount() reads, which is what bounds
+ * boot time on the RP2040 (XIP reads, not CPU).
+ *
+ * Usage: pt-storage [--format=table|json|csv] (exit status 1 on a failed check)
+ */
+
+#include "pt_flash_emulator.h"
+#include "eurorack_sequencer.h"
+#include "pt_benchmark.h"
+#include "pt_check.h"
+
+#include <chrono>
+#include <cstring>
+
+static const uint16_t KEY_TEMPO = 0;
+static const uint16_t KEY_PATTERN = 1; // Patterns use keys 1-8
+static const uint16_t KEYS = KEY_PATTERN + PTSequencer::MAX_PATTERNS;
+static const uint32_t ROUNDS = 120;
+
+using PTCheck::check;
+
+/**
+ * @brief Settings as the firmware keeps them, with the last value of each key
+ */
+struct Settings
+{
+    float tempo;
+    PTPattern patterns[PTSequencer::MAX_PATTERNS];
+
+    Settings() : tempo(120.0f)
+    {
+        for (PTPattern &p : patterns)
+            p.clear();
+    }
+
+    const void *value(uint16_t key) const
+    {
+        return key == KEY_TEMPO ? (const void *)&tempo : (const void *)&patterns[key - KEY_PATTERN];
+    }
+
+    uint16_t length(uint16_t key) const
+    {
+        return key == KEY_TEMPO ? (uint16_t)sizeof(tempo) : (uint16_t)sizeof(PTPattern);
+    }
+
+    void copyKey(uint16_t key, const Settings &from)
+    {
+        memcpy((void *)value(key), from.value(key), length(key));
+    }
+
+    /**
+     * @brief Round r's edit: a new tempo and, unless tempo_only, one step of one pattern
+     */
+    void edit(uint32_t round, bool tempo_only)
+    {
+        tempo = 90.0f + (float)(round % 97);
+        if (tempo_only)
+            return;
+        // Patterns 3-7 keep their first save, so they only survive the
+        // region wrapping by being relocated
+        PTPattern &p = patterns[round % 3];
+        p.steps[round % PTPattern::MAX_STEPS].setNote((uint8_t)(round % (PTSequencerStep::MAX_NOTE + 1)));
+        p.length = (uint8_t)(1 + round % PTPattern::MAX_STEPS);
+    }
+};
+
+/**
+ * @brief What survived a run of the script
+ */
+struct Outcome
+{
+    Settings committed; // Last value save() confirmed for each key
+    bool saved[KEYS];   // Key has a confirmed save
+    Settings in_flight; // Values of the save that failed, if any
+    int failed_key;     // -1 if every save completed
+
+    Outcome() : saved(), failed_key(-1) {}
+};
+
+/**
+ * @brief Run rounds of the script, stopping at the first failed save
+ */
+static void runScript(PTFlashStorage &storage, Settings &current, Outcome &outcome, uint32_t from, uint32_t to,
+                      bool tempo_only = false)
+{
+    for (uint32_t round = from; round < to; round++)
+    {
+        current.edit(round, tempo_only);
+        for (uint16_t key = 0; key < KEYS; key++)
+        {
+            if (!storage.save(key, current.value(key), current.length(key)))
+            {
+                outcome.in_flight = current;
+                outcome.failed_key = key;
+                return;
+            }
+            outcome.committed.copyKey(key, current);
+            outcome.saved[key] = true;
+        }
+    }
+}
+
+/**
+ * @brief Every key loads its committed value, or the failed save's new one
+ */
+static bool matches(PTFlashStorage &storage, const Outcome &outcome)
+{
+    for (uint16_t key = 0; key < KEYS; key++)
+    {
+        uint8_t buffer[sizeof(PTPattern)];
+        int length = storage.load(key, buffer, sizeof(buffer));
+        uint16_t expected = outcome.committed.length(key);
+        bool committed = length == expected && memcmp(buffer, outcome.committed.value(key), expected) == 0;
+        bool landed = outcome.failed_key == key && length == expected &&
+                      memcmp(buffer, outcome.in_flight.value(key), expected) == 0;
+        // Keys never saved before the cut are missing, apart from the one being saved
+        bool missing = length < 0 && !outcome.saved[key];
+        if (!committed && !landed && !missing)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Cut power after each erase/program of the script in turn
+ * @param operations Erases and programs the uninterrupted script makes
+ */
+static void checkPowerCuts(uint32_t operations, uint32_t torn, const char *name)
+{
+    uint32_t bad_mount = 0, bad_values = 0, bad_resume = 0, conflicts = 0;
+    for (uint32_t cut = 0; cut < operations; cut++)
+    {
+        PTFlashEmulator flash(4);
+        PTFlashStorage storage(flash);
+        storage.mount();
+        flash.cutPowerAfter(cut, torn);
+
+        Settings current;
+        Outcome outcome;
+        runScript(storage, current, outcome, 0, ROUNDS);
+
+        // Reboot
+        flash.powerOn();
+        PTFlashStorage rebooted(flash);
+        if (!rebooted.mount())
+            bad_mount++;
+        if (!matches(rebooted, outcome))
+            bad_values++;
+
+        // Carry on turning the tempo only, so the patterns survive through
+        // relocation alone, then reboot again
+        Settings resumed = outcome.committed;
+        Outcome after;
+        runScript(rebooted, resumed, after, ROUNDS, ROUNDS + 80, true);
+        PTFlashStorage again(flash);
+        if (after.failed_key >= 0 || !again.mount() || !matches(again, after))
+            bad_resume++;
+        conflicts += flash.getConflictCount();
+    }
+
+    char line[128];
+    snprintf(line, sizeof(line), "%s power cut at each of %lu operations: mount, values, resume",
+             name, (unsigned long)operations);
+    check(bad_mount == 0 && bad_values == 0 && bad_resume == 0, line);
+    if (bad_mount || bad_values || bad_resume)
+        printf("  %lu failed mounts, %lu wrong values, %lu failed resumes\n", (unsigned long)bad_mount,
+               (unsigned long)bad_values, (unsigned long)bad_resume);
+    snprintf(line, sizeof(line), "%s power cuts: no program over unerased bits (%lu)", name, (unsigned long)conflicts);
+    check(conflicts == 0, line);
+}
+
+/**
+ * @brief Run the script without a cut
+ * @return Erase/program operations it made
+ */
+static uint32_t checkWear()
+{
+    PTFlashEmulator flash(4);
+    PTFlashStorage storage(flash);
+    check(storage.mount() && !storage.has(KEY_TEMPO), "mount() of an erased region: empty");
+
+    Settings current;
+    Outcome outcome;
+    runScript(storage, current, outcome, 0, ROUNDS);
+    uint32_t operations = flash.getOperationCount();
+
+    PTFlashStorage rebooted(flash);
+    check(outcome.failed_key < 0 && rebooted.mount() && matches(rebooted, outcome),
+          "uninterrupted script: every key loads its last value");
+
+    uint32_t least = 0xFFFFFFFF, most = 0;
+    for (uint32_t s = 0; s < 4; s++)
+    {
+        least = std::min(least, flash.getSectorEraseCount(s));
+        most = std::max(most, flash.getSectorEraseCount(s));
+    }
+    char line[128];
+    snprintf(line, sizeof(line), "%lu rounds: %lu programs, %lu erases, %lu-%lu per sector",
+             (unsigned long)ROUNDS, (unsigned long)flash.getProgramCount(), (unsigned long)flash.getEraseCount(),
+             (unsigned long)least, (unsigned long)most);
+    check(most >= 2 && most - least <= 1 && flash.getConflictCount() == 0, line);
+    return operations;
+}
+
+static uint64_t hostTicks()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int main(int argc, char **argv)
+{
+    PTBenchmark::Format format = PTBenchmark::Format::TABLE;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--format=json") == 0)
+            format = PTBenchmark::Format::JSON;
+        else if (strcmp(argv[i], "--format=csv") == 0)
+            format = PTBenchmark::Format::CSV;
+        else if (strcmp(argv[i], "--format=table") != 0)
+        {
+            fprintf(stderr, "usage: %s [--format=table|json|csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    uint32_t operations = checkWear();
+    checkPowerCuts(operations, 0, "lost");
+    checkPowerCuts(operations, 8, "torn at 8 bytes");
+    checkPowerCuts(operations, EurorackStorage::PAGE_SIZE / 2, "torn at 128 bytes");
+
+    // Boot cost on the firmware's 16-sector region, filled by a long run
+    PTFlashEmulator flash(16);
+    PTFlashStorage storage(flash);
+    storage.mount();
+    Settings current;
+    Outcome outcome;
+    runScript(storage, current, outcome, 0, 1000);
+
+    uint64_t read_before = flash.getBytesRead();
+    uint32_t programs_before = flash.getProgramCount();
+    PTFlashStorage booted(flash);
+    bool mounted = booted.mount();
+    printf("\nmount() of a full 64KB region reads %lu bytes of flash\n",
+           (unsigned long)(flash.getBytesRead() - read_before));
+    check(mounted && flash.getProgramCount() == programs_before && matches(booted, outcome),
+          "mount() after a clean shutdown writes nothing and loads every key");
+    printf("\n");
+
+    PTBenchmark::Runner runner(hostTicks, 1.0);
+    runner.run("storage/mount_64k", [&]()
+               { PTBenchmark::doNotOptimize(booted.mount()); });
+    static uint8_t buffer[sizeof(PTPattern)];
+    runner.run("storage/load_pattern", [&]()
+               { PTBenchmark::doNotOptimize(booted.load(KEY_PATTERN + 3, buffer, sizeof(buffer))); });
+    runner.run("storage/load_all", [&]()
+               {
+        for (uint16_t key = 0; key < KEYS; key++)
+            PTBenchmark::doNotOptimize(booted.load(key, buffer, sizeof(buffer))); });
+    runner.report(format);
+
+    return PTCheck::summary();
+}
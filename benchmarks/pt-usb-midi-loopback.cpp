@@ -0,0 +1,252 @@
+/**
+ * @file pt-usb-midi-loopback.cpp
+ * @brief USB-MIDI loopback through PTMidiUsb: latency, events/s and batching
+ *
+ * The host USB stand-in (host/tusb.h) plays the computer: it sends 4-byte
+ * event packets (notes, note-offs, CCs) into the device's RX FIFO, one
+ * 1ms frame at a time, and records every packet that comes back. The
+ * device runs the firmware's loop in virtual time: poll() once per frame,
+ * which parses packets through PTMidiInput::processUsbPacket() into a
+ * PTEventQueue; the application pops each event and echoes it with
+ * sendNoteOn()/sendNoteOff()/sendControlChange(), and the next poll()
+ * hands the batch to tud_midi_stream_write().
+ *
+ * At 4, 16 and 24 events offered per frame it checks that every event
+ * comes back unchanged and in order, that no frame takes more than one
+ * bulk IN transfer, and that nothing is dropped on the way. It prints
+ * per-event round-trip latency (from the packet entering the RX FIFO to
+ * its echo leaving) and the events/s the link carries.
+ *
+ * It then times the device-side CPU cost with the benchmark runner: one
+ * packet through processUsbPacket() and the queue, and one event around
+ * the whole loop, with events/s the CPU could sustain.
+ *
+ * Usage: pt-usb-midi-loopback [--format=table|json|csv] (exit status 1 on a failed check)
+ */
+
+#include "eurorack_usb_midi.h"
+#include "pt_benchmark.h"
+#include "pt_check.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+static const uint32_t FRAME_US = 1000;
+static const uint32_t EVENTS = 960;
+
+using PTCheck::check;
+
+/**
+ * @brief Event i of the script: note-on, CC, note-off, CC across all channels
+ */
+static void scriptPacket(uint32_t i, uint8_t packet[4])
+{
+    uint8_t channel = (uint8_t)(i % 16);
+    uint8_t note = (uint8_t)(36 + (i / 4) % 48);
+    switch (i % 4)
+    {
+    case 0:
+        packet[1] = EurorackMidi::NOTE_ON | channel;
+        packet[2] = note;
+        packet[3] = (uint8_t)(1 + i % 127);
+        break;
+    case 2:
+        packet[1] = EurorackMidi::NOTE_OFF | channel;
+        packet[2] = note;
+        packet[3] = 0;
+        break;
+    default:
+        packet[1] = EurorackMidi::CONTROL_CHANGE | channel;
+        packet[2] = (uint8_t)(i % 120);
+        packet[3] = (uint8_t)(i % 128);
+        break;
+    }
+    packet[0] = packet[1] >> 4; // Cable 0, CIN = message type
+}
+
+/**
+ * @brief The application side: echo every event back to the computer
+ * @return Events echoed
+ */
+static uint32_t echo(PTEventQueue &queue, PTMidiUsb &usb)
+{
+    uint32_t count = 0;
+    PTEvent event;
+    while (queue.pop(event))
+    {
+        uint8_t channel = EurorackMidi::eventChannel(event.data);
+        uint8_t data1 = EurorackMidi::eventData1(event.data);
+        uint8_t data2 = EurorackMidi::eventData2(event.data);
+        switch (event.type)
+        {
+        case PTEventType::MIDI_NOTE_ON:
+            usb.sendNoteOn(channel, data1, data2);
+            break;
+        case PTEventType::MIDI_NOTE_OFF:
+            usb.sendNoteOff(channel, data1);
+            break;
+        case PTEventType::MIDI_CONTROL_CHANGE:
+            usb.sendControlChange(channel, data1, data2);
+            break;
+        default:
+            continue;
+        }
+        count++;
+    }
+    return count;
+}
+
+// What the computer got back
+static std::vector<uint32_t> received; // Packet bytes, packed
+static std::vector<uint64_t> received_at;
+
+static void onReceive(const uint8_t packet[4])
+{
+    uint32_t word;
+    memcpy(&word, packet, 4);
+    received.push_back(word);
+    received_at.push_back(pico_host_time_us);
+}
+
+static void runLoopback(uint32_t per_frame)
+{
+    PTEventQueue queue;
+    PTMidiUsb usb;
+    usb.setEventQueue(&queue);
+    usb.init();
+
+    received.clear();
+    received_at.clear();
+    pico_host_usb_midi_receive_hook = onReceive;
+    uint32_t transfers_before = pico_host_usb_in_transfers;
+
+    std::vector<uint64_t> sent_at(EVENTS);
+    uint32_t sent = 0, frames = 0, busiest = 0;
+    while (received.size() < EVENTS && frames < EVENTS * 4)
+    {
+        // The computer offers per_frame events; the RX FIFO takes what fits
+        for (uint32_t n = 0; n < per_frame && sent < EVENTS; n++)
+        {
+            uint8_t packet[4];
+            scriptPacket(sent, packet);
+            if (!pico_host_usb_midi_send(packet))
+                break;
+            sent_at[sent++] = pico_host_time_us;
+        }
+
+        uint32_t transfers = pico_host_usb_in_transfers;
+        usb.poll();
+        echo(queue, usb);
+        busiest = std::max(busiest, pico_host_usb_in_transfers - transfers);
+
+        pico_host_time_us += FRAME_US;
+        frames++;
+    }
+    // Let the last batch out
+    usb.poll();
+
+    bool intact = received.size() == EVENTS;
+    std::vector<uint32_t> latency;
+    for (uint32_t i = 0; intact && i < EVENTS; i++)
+    {
+        uint8_t expected[4];
+        scriptPacket(i, expected);
+        uint32_t word;
+        memcpy(&word, expected, 4);
+        intact = received[i] == word;
+        latency.push_back((uint32_t)(received_at[i] - sent_at[i]));
+    }
+    std::sort(latency.begin(), latency.end());
+
+    double seconds = (received_at.empty() ? 0 : received_at.back() - sent_at[0] + FRAME_US) / 1e6;
+    uint32_t transfers = pico_host_usb_in_transfers - transfers_before;
+    printf("%2lu events/frame offered: %6.0f events/s, latency min %5lu median %5lu max %5lu us, "
+           "%lu transfers in %lu frames\n",
+           (unsigned long)per_frame, intact ? EVENTS / seconds : 0.0, (unsigned long)(intact ? latency.front() : 0),
+           (unsigned long)(intact ? latency[latency.size() / 2] : 0), (unsigned long)(intact ? latency.back() : 0),
+           (unsigned long)transfers, (unsigned long)frames);
+
+    char line[96];
+    snprintf(line, sizeof(line), "%lu/frame: every event echoed unchanged and in order", (unsigned long)per_frame);
+    check(intact, line);
+    snprintf(line, sizeof(line), "%lu/frame: at most one bulk IN transfer per frame, nothing dropped",
+             (unsigned long)per_frame);
+    check(busiest <= 1 && usb.getTxOverflows() == 0 && usb.getDroppedEvents() == 0, line);
+    // Parsed in the frame it arrives, echoed on the next poll()
+    snprintf(line, sizeof(line), "%lu/frame: round trip of one frame", (unsigned long)per_frame);
+    check(intact && latency.back() <= FRAME_US, line);
+    pico_host_usb_midi_receive_hook = nullptr;
+}
+
+static uint64_t hostTicks()
+{
+    return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+int main(int argc, char **argv)
+{
+    PTBenchmark::Format format = PTBenchmark::Format::TABLE;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--format=json") == 0)
+            format = PTBenchmark::Format::JSON;
+        else if (strcmp(argv[i], "--format=csv") == 0)
+            format = PTBenchmark::Format::CSV;
+        else if (strcmp(argv[i], "--format=table") != 0)
+        {
+            fprintf(stderr, "usage: %s [--format=table|json|csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    pico_host_virtual_time = true;
+    printf("Loopback over 1ms frames, %lu events (latency: packet into the RX FIFO to echo out)\n",
+           (unsigned long)EVENTS);
+    static const uint32_t rates[] = {4, 16, 24};
+    for (uint32_t rate : rates)
+        runLoopback(rate);
+    printf("\n");
+
+    // Device-side CPU cost
+    PTBenchmark::Runner runner(hostTicks, 1.0);
+    static PTEventQueue queue;
+    static PTMidiUsb usb;
+    usb.setEventQueue(&queue);
+
+    static uint32_t index = 0;
+    runner.run("usb_midi/rx_packet", [&]()
+               {
+        uint8_t packet[4];
+        scriptPacket(index++, packet);
+        usb.processUsbPacket(packet, 0);
+        PTEvent event;
+        queue.pop(event);
+        PTBenchmark::doNotOptimize(event.data); });
+
+    // A full frame: 16 packets in, parsed, echoed, sent in one transfer
+    static const uint32_t BATCH = PICO_HOST_USB_MIDI_RX_PACKETS;
+    runner.run("usb_midi/loopback_event", [&]()
+               {
+        for (uint32_t n = 0; n < BATCH; n++)
+        {
+            uint8_t packet[4];
+            scriptPacket(index++, packet);
+            pico_host_usb_midi_send(packet);
+        }
+        usb.poll();
+        echo(queue, usb);
+        usb.flush(); }, BATCH);
+    runner.report(format);
+
+    for (uint32_t i = 0; i < runner.getResultCount(); i++)
+    {
+        const PTBenchmark::Result &r = runner.getResult(i);
+        printf("%-28s %10.0f events/s of CPU\n", r.name, 1e9 / r.median_ns);
+    }
+
+    return PTCheck::summary();
+}
@@ -0,0 +1,225 @@
+/**
+ * @file pt-watchdog-sim.cpp
+ * @brief Host simulation of thread budgets, deadline misses and runaway detection
+ *
+ * Runs PTScheduler and SimpleScheduler under PTWatchdog on a virtual
+ * clock. A slow display thread overruns its budget and makes a control
+ * thread miss its deadline; a sequencer thread then hangs. The check
+ * timer fires in virtual time and must flag the hang within one budget
+ * plus one check period, and the simulated hardware watchdog reset must
+ * find the hung thread in the scratch register.
+ *
+ * Usage: pt-watchdog-sim (exit status 1 if a hang goes undetected)
+ */
+
+#include "pt_thread.h"
+#include "simple_threads.h"
+
+static const uint32_t CHECK_PERIOD_US = 250;
+static const uint32_t WATCHDOG_TIMEOUT_MS = 200;
+static const uint32_t HANG_AFTER_US = 100000; // Into each scenario
+static const uint32_t HANG_BUDGET_US = 1000;
+
+// Simulated hardware watchdog: a feed writes the load register
+static uint64_t last_feed_us = 0;
+static bool reset_pending = false;
+static int32_t reset_thread = -1;
+
+static uint64_t hang_at_us = 0;    // The sequencer hangs on its first run after this
+static uint64_t hang_start_us = 0; // ...which starts here
+
+// Latest runaway report; the hang is the last one in each scenario
+static uint64_t runaway_at_us = 0;
+static const char *runaway_name = nullptr;
+
+static void onRunaway(int, const char *name, uint32_t)
+{
+    runaway_at_us = pico_host_time_us;
+    runaway_name = name;
+}
+
+/**
+ * @brief Spend CPU time; timers fire and the watchdog may expire meanwhile
+ */
+static void advance(uint32_t us)
+{
+    for (uint32_t step = 0; step < us && !reset_pending; step += 10)
+    {
+        pico_host_advance(10);
+        if (watchdog_hw->load)
+        {
+            last_feed_us = pico_host_time_us;
+            watchdog_hw->load = 0;
+        }
+        if (pico_host_time_us - last_feed_us > WATCHDOG_TIMEOUT_MS * 1000ull)
+        {
+            pico_host_watchdog_rebooted = true;
+            reset_thread = PTWatchdog::readResetThread();
+            reset_pending = true;
+        }
+    }
+}
+
+static void startScenario(PTWatchdog &watchdog)
+{
+    pico_host_timer_count = 0;
+    pico_host_watchdog_rebooted = false;
+    hang_at_us = pico_host_time_us + HANG_AFTER_US;
+    last_feed_us = pico_host_time_us;
+    reset_pending = false;
+    reset_thread = -1;
+    runaway_at_us = 0;
+    runaway_name = nullptr;
+
+    watchdog.setRunawayCallback(onRunaway);
+    watchdog.begin(WATCHDOG_TIMEOUT_MS, CHECK_PERIOD_US);
+}
+
+/**
+ * @brief Print the outcome of a scenario
+ * @return true if the hang was flagged in time and named by the reset
+ */
+static bool report(const char *hung_name, int32_t hung_index)
+{
+    bool in_time = runaway_name && runaway_at_us - hang_start_us <= HANG_BUDGET_US + CHECK_PERIOD_US;
+    printf("  runaway: %s flagged %lu us after hanging (budget %lu us, check every %lu us)%s\n",
+           runaway_name ? runaway_name : "nothing", (unsigned long)(runaway_at_us - hang_start_us),
+           (unsigned long)HANG_BUDGET_US, (unsigned long)CHECK_PERIOD_US, in_time ? "" : "  << LATE");
+    printf("  reset: watchdog %s, scratch names thread %ld (%s)\n\n",
+           reset_pending ? "expired" : "did not expire", (long)reset_thread, hung_name);
+    return in_time && reset_thread == hung_index;
+}
+
+// ----------------------------------------------------------------------------
+// PTScheduler
+// ----------------------------------------------------------------------------
+
+class LoadThread : public PTThread
+{
+private:
+    uint32_t period_us;
+    uint32_t cost_us;
+    uint64_t next_us;
+    bool hangs;
+
+public:
+    LoadThread(const char *name, uint32_t period_us, uint32_t cost_us, bool hangs = false)
+        : PTThread(name), period_us(period_us), cost_us(cost_us), next_us(pico_host_time_us), hangs(hangs)
+    {
+    }
+
+    int run() override
+    {
+        if (hangs && pico_host_time_us >= hang_at_us)
+        {
+            hang_start_us = pico_host_time_us;
+            while (!reset_pending) // Missing yield
+                advance(50);
+            return PT_YIELDED;
+        }
+        if (pico_host_time_us >= next_us)
+        {
+            advance(cost_us);
+            next_us += period_us;
+        }
+        return PT_YIELDED;
+    }
+};
+
+static bool runProtothreads()
+{
+    static PTWatchdog watchdog;
+    static PTScheduler scheduler;
+    static LoadThread control("Control", 0, 50);
+    static LoadThread display("Display", 20000, 3000);
+    static LoadThread sequencer("Sequencer", 1000, 100, true);
+
+    startScenario(watchdog);
+    control.setDeadline(2000);
+    display.setBudget(2000);
+    sequencer.setBudget(HANG_BUDGET_US);
+    scheduler.addThread(&control);
+    scheduler.addThread(&display);
+    scheduler.addThread(&sequencer);
+    scheduler.setWatchdog(&watchdog);
+
+    while (!reset_pending)
+    {
+        scheduler.runOnce();
+        advance(2);
+    }
+
+    printf("PTScheduler\n");
+    printf("  Display: budget %lu us, max run %lu us, %lu overruns\n", (unsigned long)display.getBudget(),
+           (unsigned long)display.getMaxRunTime(), (unsigned long)display.getOverrunCount());
+    printf("  Control: deadline %lu us, %lu misses\n", (unsigned long)control.getDeadline(),
+           (unsigned long)control.getDeadlineMisses());
+    return report(sequencer.getName(), 2) && display.getOverrunCount() > 0 && control.getDeadlineMisses() > 0;
+}
+
+// ----------------------------------------------------------------------------
+// SimpleScheduler
+// ----------------------------------------------------------------------------
+
+class SimpleLoadThread : public SimpleThread
+{
+private:
+    uint32_t cost_us;
+    bool hangs;
+
+public:
+    SimpleLoadThread(const char *name, uint32_t interval_ms, uint32_t cost_us, bool hangs = false)
+        : SimpleThread(name), cost_us(cost_us), hangs(hangs)
+    {
+        setInterval(interval_ms);
+    }
+
+    void execute() override
+    {
+        if (hangs && pico_host_time_us >= hang_at_us)
+        {
+            hang_start_us = pico_host_time_us;
+            while (!reset_pending) // Never returns to the scheduler
+                advance(50);
+        }
+        advance(cost_us);
+    }
+};
+
+static bool runSimpleThreads()
+{
+    static PTWatchdog watchdog;
+    static SimpleScheduler scheduler;
+    static SimpleLoadThread control("Control", 1, 50);
+    static SimpleLoadThread display("Display", 20, 3000);
+    static SimpleLoadThread sequencer("Sequencer", 1, 100, true);
+
+    startScenario(watchdog);
+    display.setBudget(2000);
+    sequencer.setBudget(HANG_BUDGET_US);
+    scheduler.addThread(&control);
+    scheduler.addThread(&display);
+    scheduler.addThread(&sequencer);
+    scheduler.setWatchdog(&watchdog);
+
+    while (!reset_pending)
+    {
+        scheduler.run();
+        advance(2);
+    }
+
+    printf("SimpleScheduler\n");
+    printf("  Display: budget %lu us, max run %lu us, %lu overruns\n", (unsigned long)display.getBudget(),
+           (unsigned long)display.getMaxRunTime(), (unsigned long)display.getOverrunCount());
+    printf("  Control: interval 1 ms, %lu deadline misses\n", (unsigned long)control.getDeadlineMisses());
+    return report(sequencer.getName(), 2) && display.getOverrunCount() > 0 && control.getDeadlineMisses() > 0;
+}
+
+int main()
+{
+    pico_host_virtual_time = true;
+
+    bool ok = runProtothreads();
+    ok = runSimpleThreads() && ok;
+    return ok ? 0 : 1;
+}
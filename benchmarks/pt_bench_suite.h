@@ -0,0 +1,651 @@
+/**
+ * @file pt_bench_suite.h
+ * @brief Framework hot-path benchmarks shared by the host and target runners
+ *
+ * Benchmark names are stable identifiers: pt-bench (host) and
+ * pt-bench-target (RP2040) report the same set, so their outputs can be
+ * compared line by line with pt-bench --compare.
+ */
+
+#ifndef __PT_BENCH_SUITE_H__
+#define __PT_BENCH_SUITE_H__
+
+#include "pt_thread.h"
+#include "simple_threads.h"
+#include "eurorack_hardware.h"
+#include "eurorack_utils.h"
+#include "eurorack_oscillators.h"
+#include "eurorack_modulation.h"
+#include "eurorack_quantizer.h"
+#include "eurorack_sequencer.h"
+#include "eurorack_midi.h"
+#include "pt_snapshot.h"
+
+#include "pt_benchmark.h"
+
+namespace PTBenchSuite
+{
+    using PTBenchmark::doNotOptimize;
+
+    /**
+     * @brief Thread that never blocks, so every scheduler pass resumes it
+     */
+    class SpinThread : public PTThread
+    {
+    public:
+        uint32_t passes;
+
+        SpinThread() : PTThread("Spin"), passes(0) {}
+
+        int run() override
+        {
+            passes++;
+            return PT_YIELDED;
+        }
+    };
+
+    /**
+     * @brief Protothread parked on a wait condition
+     */
+    class WaitThread : public PTThread
+    {
+    public:
+        volatile bool ready;
+        uint32_t wakeups;
+
+        WaitThread() : PTThread("Wait"), ready(false), wakeups(0) {}
+
+        int run() override
+        {
+            PT_THREAD_BEGIN(this);
+            while (true)
+            {
+                PT_THREAD_WAIT_UNTIL(this, ready);
+                ready = false;
+                wakeups++;
+            }
+            PT_THREAD_END(this);
+        }
+    };
+
+    /**
+     * @brief SimpleThread with a trivial body
+     */
+    class CountThread : public SimpleThread
+    {
+    public:
+        uint32_t count;
+
+        CountThread() : SimpleThread("Count"), count(0) {}
+
+        void execute() override { count++; }
+    };
+
+    /**
+     * @brief UI-style SimpleThread that drains a shared queue on every pass
+     */
+    class PollingUIThread : public SimpleThread
+    {
+    public:
+        PTEventQueue &queue;
+        uint32_t handled;
+
+        PollingUIThread(PTEventQueue &q) : SimpleThread("PollingUI"), queue(q), handled(0) {}
+
+        void execute() override
+        {
+            PTEvent event;
+            while (queue.pop(event))
+            {
+                handled += event.data;
+            }
+        }
+    };
+
+    /**
+     * @brief The same thread subscribed to encoder events instead
+     */
+    class EventUIThread : public SimpleThread
+    {
+    public:
+        uint32_t handled;
+
+        EventUIThread() : SimpleThread("EventUI"), handled(0)
+        {
+            subscribe(SimpleEvent::bit((uint32_t)PTEventType::ENCODER_TURN));
+        }
+
+        void execute() override
+        {
+            for (uint32_t i = 0; i < getEventCount(); i++)
+            {
+                handled += getEvents()[i].data;
+            }
+        }
+    };
+
+    inline void benchBaseline(PTBenchmark::Runner &runner)
+    {
+        // PTEvent, PTThread::execute and SimpleThread::shouldRun read the
+        // clock on every call; on the host this is the stand-in's cost
+        runner.run("baseline/time_us_32", [&]()
+                   { doNotOptimize(time_us_32()); });
+    }
+
+    inline void benchEventQueue(PTBenchmark::Runner &runner)
+    {
+        static PTEventQueue queue;
+        static PTEvent event(PTEventType::TIMER_TICK, 1);
+
+        runner.run("event_queue/push_pop", [&]()
+                   {
+            queue.push(event);
+            PTEvent out;
+            queue.pop(out);
+            doNotOptimize(out); });
+
+        runner.run("event_queue/fill_drain_32", [&]()
+                   {
+            while (queue.push(event))
+            {
+            }
+            PTEvent out;
+            while (queue.pop(out))
+            {
+                doNotOptimize(out);
+            } }, 64);
+
+        runner.run("event_queue/construct_event", [&]()
+                   {
+            PTEvent e(PTEventType::CV_CHANGE, 2);
+            doNotOptimize(e); });
+    }
+
+    inline void benchPTScheduler(PTBenchmark::Runner &runner)
+    {
+        static const char *names[] = {"pt_scheduler/run_once/1", "pt_scheduler/run_once/4", "pt_scheduler/run_once/16"};
+        static const size_t counts[] = {1, 4, 16};
+        static SpinThread threads[16];
+
+        for (size_t c = 0; c < 3; c++)
+        {
+            PTScheduler scheduler;
+            for (size_t i = 0; i < counts[c]; i++)
+            {
+                scheduler.addThread(&threads[i]);
+            }
+            runner.run(names[c], [&]()
+                       { scheduler.runOnce(); });
+        }
+    }
+
+    inline void benchSimpleScheduler(PTBenchmark::Runner &runner)
+    {
+        static const char *run_names[] = {"simple_scheduler/run/1", "simple_scheduler/run/4", "simple_scheduler/run/16"};
+        static const char *idle_names[] = {"simple_scheduler/idle/1", "simple_scheduler/idle/4", "simple_scheduler/idle/16"};
+        static const int counts[] = {1, 4, 16};
+        static CountThread threads[16];
+
+        for (int c = 0; c < 3; c++)
+        {
+            SimpleScheduler scheduler;
+            for (int i = 0; i < counts[c]; i++)
+            {
+                threads[i].setInterval(0); // Due on every pass
+                scheduler.addThread(&threads[i]);
+            }
+            runner.run(run_names[c], [&]()
+                       { scheduler.run(); });
+
+            for (int i = 0; i < counts[c]; i++)
+            {
+                threads[i].setInterval(60000); // Never due: interval check only
+            }
+            runner.run(idle_names[c], [&]()
+                       { scheduler.run(); });
+        }
+    }
+
+    /**
+     * @brief Scheduler pass with an idle UI: polling a queue vs sleeping on events
+     */
+    inline void benchSimpleEvents(PTBenchmark::Runner &runner)
+    {
+        static PTEventQueue queue;
+        static PollingUIThread polling_ui(queue);
+        static PollingUIThread polling_gate(queue);
+        static EventUIThread event_ui;
+        static EventUIThread event_gate;
+        const uint32_t turn = (uint32_t)PTEventType::ENCODER_TURN;
+
+        SimpleScheduler polling;
+        polling.addThread(&polling_ui);
+        polling.addThread(&polling_gate);
+        runner.run("simple_events/idle_pass/poll", [&]()
+                   { polling.run(); });
+
+        SimpleScheduler events;
+        events.addThread(&event_ui);
+        events.addThread(&event_gate);
+        runner.run("simple_events/idle_pass/event", [&]()
+                   { events.run(); });
+
+        runner.run("simple_events/post", [&]()
+                   {
+            doNotOptimize(events.post(turn, 1));
+            events.run(); });
+
+        runner.run("simple_events/batch_4", [&]()
+                   {
+            for (uint32_t i = 0; i < 4; i++)
+            {
+                events.post(turn, i);
+            }
+            events.run(); });
+
+        doNotOptimize(polling_ui.handled + polling_gate.handled);
+        doNotOptimize(event_ui.handled + event_gate.handled);
+    }
+
+    /**
+     * @brief Parameter set of BYTES bytes
+     */
+    template <size_t BYTES>
+    struct SnapshotParams
+    {
+        uint32_t words[BYTES / 4];
+    };
+
+    template <size_t BYTES>
+    inline void benchSnapshotSize(PTBenchmark::Runner &runner, const char *const names[4])
+    {
+        static PTSnapshot<SnapshotParams<BYTES>> triple;
+        static PTSeqSnapshot<SnapshotParams<BYTES>> seq;
+        static SnapshotParams<BYTES> params;
+
+        runner.run(names[0], [&]()
+                   {
+            params.words[0]++;
+            triple.publish(params); });
+        runner.run(names[1], [&]()
+                   { doNotOptimize(triple.read().words[BYTES / 4 - 1]); });
+        runner.run(names[2], [&]()
+                   {
+            params.words[0]++;
+            seq.publish(params); });
+        runner.run(names[3], [&]()
+                   { doNotOptimize(seq.read().words[BYTES / 4 - 1]); });
+    }
+
+    /**
+     * @brief Publish/read cost of the snapshot handoffs for 16-256 byte parameter sets
+     */
+    inline void benchSnapshot(PTBenchmark::Runner &runner)
+    {
+        static const char *const names16[] = {"snapshot/triple/publish/16", "snapshot/triple/read/16",
+                                              "snapshot/seqlock/publish/16", "snapshot/seqlock/read/16"};
+        static const char *const names64[] = {"snapshot/triple/publish/64", "snapshot/triple/read/64",
+                                              "snapshot/seqlock/publish/64", "snapshot/seqlock/read/64"};
+        static const char *const names256[] = {"snapshot/triple/publish/256", "snapshot/triple/read/256",
+                                               "snapshot/seqlock/publish/256", "snapshot/seqlock/read/256"};
+        benchSnapshotSize<16>(runner, names16);
+        benchSnapshotSize<64>(runner, names64);
+        benchSnapshotSize<256>(runner, names256);
+    }
+
+    inline void benchProtothread(PTBenchmark::Runner &runner)
+    {
+        static WaitThread waiter;
+
+        runner.run("protothread/resume_blocked", [&]()
+                   { doNotOptimize(waiter.execute()); });
+
+        runner.run("protothread/resume_wake", [&]()
+                   {
+            waiter.ready = true;
+            doNotOptimize(waiter.execute()); });
+    }
+
+    inline void benchCV(PTBenchmark::Runner &runner)
+    {
+        static volatile uint16_t adc = 1234;
+        static volatile float volts = 1.5f;
+
+        runner.run("cv/adc_to_eurorack_voltage", [&]()
+                   { doNotOptimize(EurorackUtils::CV::adcToEurorackVoltage(adc)); });
+
+        runner.run("cv/eurorack_voltage_to_dac", [&]()
+                   { doNotOptimize(EurorackUtils::CV::eurorackVoltageToDAC(volts)); });
+
+        runner.run("cv/dac_to_eurorack_voltage", [&]()
+                   { doNotOptimize(EurorackUtils::CV::dacToEurorackVoltage(adc)); });
+
+        runner.run("cv/adc_to_pitch_q16", [&]()
+                   { doNotOptimize(EurorackUtils::Fixed::adcToPitchQ16(adc)); });
+
+        static uint32_t base_increment = EurorackUtils::Fixed::frequencyToIncrement(261.63f, 48000.0f);
+        runner.run("cv/pitch_to_increment", [&]()
+                   { doNotOptimize(EurorackUtils::Fixed::pitchToIncrement(base_increment, EurorackUtils::Fixed::adcToPitchQ16(adc))); });
+    }
+
+    static const size_t OSC_BLOCK = 64;
+
+    /**
+     * @brief Per-sample cost of each oscillator, rendering 64-sample blocks
+     *
+     * Samples/s per core is 1e9 / median_ns.
+     */
+    inline void benchOscillators(PTBenchmark::Runner &runner)
+    {
+        static int16_t block[OSC_BLOCK];
+        static int16_t saw_table[(1 << 10) + 1];
+        for (size_t i = 0; i <= 1024; i++)
+            saw_table[i] = (int16_t)((int32_t)((i & 1023) * 64) - 32768);
+
+        static PTSineOscillator sine;
+        static PTWavetableOscillator wavetable(saw_table, 10);
+        static PTPolyBLEPOscillator saw(PTPolyBLEPOscillator::SAW);
+        static PTPolyBLEPOscillator square(PTPolyBLEPOscillator::SQUARE);
+        sine.setFrequency(440.0f);
+        wavetable.setFrequency(440.0f);
+        saw.setFrequency(440.0f);
+        square.setFrequency(440.0f);
+
+        runner.run("oscillator/sine", [&]()
+                   {
+            sine.process(block, OSC_BLOCK);
+            doNotOptimize(block[OSC_BLOCK - 1]); }, OSC_BLOCK);
+        runner.run("oscillator/wavetable_1024", [&]()
+                   {
+            wavetable.process(block, OSC_BLOCK);
+            doNotOptimize(block[OSC_BLOCK - 1]); }, OSC_BLOCK);
+        runner.run("oscillator/polyblep_saw", [&]()
+                   {
+            saw.process(block, OSC_BLOCK);
+            doNotOptimize(block[OSC_BLOCK - 1]); }, OSC_BLOCK);
+        runner.run("oscillator/polyblep_square", [&]()
+                   {
+            square.process(block, OSC_BLOCK);
+            doNotOptimize(block[OSC_BLOCK - 1]); }, OSC_BLOCK);
+    }
+
+    /**
+     * @brief Per-sample cost of the envelope and LFOs, 64-sample blocks
+     *
+     * On the target, cycles per sample = median_ns * cpu_hz / 1e9.
+     */
+    inline void benchModulation(PTBenchmark::Runner &runner)
+    {
+        static int16_t block[OSC_BLOCK];
+        static PTEnvelope envelope(48000.0f);
+        static PTLFO sine_lfo(1000.0f, 2.0f, PTLFO::SINE);
+        static PTLFO triangle_lfo(1000.0f, 2.0f, PTLFO::TRIANGLE);
+        static PTLFO sh_lfo(1000.0f, 50.0f, PTLFO::SAMPLE_HOLD);
+
+        // Long segments so nearly every sample steps an exponential segment,
+        // not the sustain or idle hold
+        envelope.setAttack(1000.0f);
+        envelope.setDecay(1000.0f);
+        envelope.setRelease(1000.0f);
+
+        runner.run("modulation/envelope", [&]()
+                   {
+            if (envelope.getStage() == PTEnvelope::SUSTAIN)
+                envelope.gate(false);
+            else if (envelope.getStage() == PTEnvelope::IDLE)
+                envelope.gate(true);
+            envelope.process(block, OSC_BLOCK);
+            doNotOptimize(block[OSC_BLOCK - 1]); }, OSC_BLOCK);
+        runner.run("modulation/lfo_sine", [&]()
+                   {
+            sine_lfo.process(block, OSC_BLOCK);
+            doNotOptimize(block[OSC_BLOCK - 1]); }, OSC_BLOCK);
+        runner.run("modulation/lfo_triangle", [&]()
+                   {
+            triangle_lfo.process(block, OSC_BLOCK);
+            doNotOptimize(block[OSC_BLOCK - 1]); }, OSC_BLOCK);
+        runner.run("modulation/lfo_sample_hold", [&]()
+                   {
+            sh_lfo.process(block, OSC_BLOCK);
+            doNotOptimize(block[OSC_BLOCK - 1]); }, OSC_BLOCK);
+    }
+
+    /**
+     * @brief Quantizer throughput, and the cost of a scale change (table rebuild)
+     */
+    inline void benchQuantizer(PTBenchmark::Runner &runner)
+    {
+        static PTQuantizer quantizer(EurorackQuantizer::MAJOR);
+        static uint32_t noise = 0x2545F491u;
+        static int32_t pitch = 0;
+
+        // A noisy input crosses note boundaries, so the hysteresis check runs too
+        runner.run("quantizer/quantize", [&]()
+                   {
+            noise = noise * 1664525u + 1013904223u;
+            doNotOptimize(quantizer.quantize((uint16_t)(noise >> 20))); });
+
+        runner.run("quantizer/quantize_pitch", [&]()
+                   {
+            pitch = (pitch + 5471) & 0x7FFFF;
+            doNotOptimize(quantizer.quantizePitch(pitch - 5 * 65536)); });
+
+        static uint8_t root = 0;
+        runner.run("quantizer/set_scale", [&]()
+                   {
+            root = (root + 1) % 12;
+            quantizer.setScale(EurorackQuantizer::PENTATONIC_MINOR, root); });
+    }
+
+    inline void benchSequencer(PTBenchmark::Runner &runner)
+    {
+        static PTSequencer sequencer;
+        static bool set_up = false;
+        if (!set_up)
+        {
+            // Ratchets and probability on some steps, so every branch of the step evaluation runs
+            PTPattern &p = sequencer.getPattern(0);
+            p.steps[3].setRatchets(3);
+            p.steps[5].setProbability(8);
+            p.steps[9].gate = 255;
+            p.next_pattern = 1;
+            set_up = true;
+        }
+
+        runner.run("sequencer/advance", [&]()
+                   { doNotOptimize(sequencer.advance(125000).gate_us); });
+
+        static uint32_t elapsed = 0;
+        runner.run("sequencer/gate_at", [&]()
+                   {
+            elapsed = (elapsed + 997) % 125000;
+            doNotOptimize(sequencer.gateAt(elapsed)); });
+    }
+
+    /**
+     * @brief Per-byte cost of MIDI input: median_ns is 1e9 / bytes per second
+     */
+    inline void benchMidi(PTBenchmark::Runner &runner)
+    {
+        // A busy bar: notes on and off under running status, a CC sweep and clock
+        static const uint8_t stream[] = {
+            0x90, 60, 100, 64, 90, 67, 80, 0xF8, 60, 0, 64, 0, 67, 0,
+            0xB0, 74, 10, 74, 20, 0xF8, 74, 30, 74, 40, 0xF8,
+            0x91, 36, 127, 0xF8, 36, 0, 0xF0, 0x7E, 0x01, 0x02, 0xF7, 0xF8};
+        static const uint32_t STREAM_BYTES = sizeof(stream);
+
+        static PTMidiParser parser;
+        runner.run("midi/parser_byte", [&]()
+                   {
+            PTMidiMessage msg;
+            uint32_t complete = 0;
+            for (uint32_t i = 0; i < STREAM_BYTES; i++)
+                complete += parser.parse(stream[i], msg);
+            doNotOptimize(complete); }, STREAM_BYTES);
+
+        // Through PTMidiInput to the event queue, drained as a thread would
+        static PTEventQueue queue;
+        static PTMidiInput input;
+        input.setEventQueue(&queue);
+        input.getClock().start();
+        runner.run("midi/input_byte", [&]()
+                   {
+            input.processBytes(stream, STREAM_BYTES, 0);
+            PTEvent event;
+            while (queue.pop(event))
+                doNotOptimize(event.data); }, STREAM_BYTES);
+    }
+
+    static const uint PIN_A = 2;
+    static const uint PIN_B = 3;
+    static const uint PIN_BUTTON = 5;
+    static const uint PIN_GATE = 7;
+
+    // Compile-time pin variants; PTFixedDispatch takes them by reference
+    inline PTFixedEncoder<PIN_A, PIN_B> fixed_encoder;
+    inline PTFixedButton<PIN_BUTTON> fixed_button(0, 0);
+    inline PTFixedGateInput<PIN_GATE> fixed_gate;
+
+    // The SDK reaches the GPIO callback through a pointer; calling through
+    // volatile ones keeps the compiler from inlining either path into the loop
+    inline gpio_irq_callback_t volatile runtime_isr = PTBoard::dispatch;
+    inline gpio_irq_callback_t volatile fixed_encoder_isr = PTFixedDispatch<fixed_encoder>::irq;
+    inline gpio_irq_callback_t volatile fixed_button_isr = PTFixedDispatch<fixed_button>::irq;
+    inline gpio_irq_callback_t volatile fixed_gate_isr = PTFixedDispatch<fixed_gate>::irq;
+    inline gpio_irq_callback_t volatile fixed_shared_isr = PTFixedDispatch<fixed_encoder, fixed_button, fixed_gate>::irq;
+
+    inline void benchEncoder(PTBenchmark::Runner &runner)
+    {
+        static PTEncoder encoder(PIN_A, PIN_B);
+        static PTEventQueue queue;
+
+        // Drive the encoder pins as outputs; gpio_get() still reads the pad level.
+        // The edge interrupt is turned off so only the benchmark decodes.
+        gpio_set_irq_enabled(PIN_A, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, false);
+        gpio_set_dir(PIN_A, GPIO_OUT);
+        gpio_set_dir(PIN_B, GPIO_OUT);
+
+        // Clockwise quadrature sequence (A, B): 00 -> 10 -> 11 -> 01
+        static const bool SEQ_A[4] = {false, true, true, false};
+        static const bool SEQ_B[4] = {false, false, true, true};
+        static uint32_t phase = 0;
+
+        runner.run("encoder/quadrature_decode", [&]()
+                   {
+            phase = (phase + 1) & 3;
+            gpio_put(PIN_A, SEQ_A[phase]);
+            gpio_put(PIN_B, SEQ_B[phase]);
+            encoder.handleEncoderChange(); });
+
+        encoder.setEventQueue(&queue);
+        runner.run("encoder/quadrature_decode_event", [&]()
+                   {
+            phase = (phase + 1) & 3;
+            gpio_put(PIN_A, SEQ_A[phase]);
+            gpio_put(PIN_B, SEQ_B[phase]);
+            encoder.handleEncoderChange();
+            PTEvent out;
+            while (queue.pop(out))
+            {
+                doNotOptimize(out);
+            } });
+        encoder.setEventQueue(nullptr);
+
+        // Whole interrupt path: GPIO callback, lookup, decode. The runtime
+        // class goes through the board table; the fixed one is inlined.
+        runner.run("encoder/isr_runtime", [&]()
+                   {
+            phase = (phase + 1) & 3;
+            gpio_put(PIN_A, SEQ_A[phase]);
+            gpio_put(PIN_B, SEQ_B[phase]);
+            runtime_isr(PIN_A, GPIO_IRQ_EDGE_RISE); });
+
+        fixed_encoder.latch();
+        runner.run("encoder/isr_fixed", [&]()
+                   {
+            phase = (phase + 1) & 3;
+            gpio_put(PIN_A, SEQ_A[phase]);
+            gpio_put(PIN_B, SEQ_B[phase]);
+            fixed_encoder_isr(PIN_A, GPIO_IRQ_EDGE_RISE); });
+        doNotOptimize(fixed_encoder.getPosition());
+    }
+
+    /**
+     * @brief Button and gate interrupt paths, runtime vs compile-time pins
+     *
+     * Each run toggles the pin, so every call sees a change.
+     */
+    inline void benchInputIsr(PTBenchmark::Runner &runner)
+    {
+        static PTButton button(PIN_BUTTON, true, 0, false);
+        static PTGateInput gate(PIN_GATE, true, false);
+
+        // Registered in the dispatch table with the interrupts left off;
+        // the pins are driven as outputs and read back
+        button.attach();
+        gate.attach();
+        gpio_set_irq_enabled(PIN_BUTTON, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, false);
+        gpio_set_irq_enabled(PIN_GATE, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, false);
+        gpio_set_dir(PIN_BUTTON, GPIO_OUT);
+        gpio_set_dir(PIN_GATE, GPIO_OUT);
+
+        static bool level = false;
+
+        runner.run("button/isr_runtime", [&]()
+                   {
+            level = !level;
+            gpio_put(PIN_BUTTON, level);
+            runtime_isr(PIN_BUTTON, GPIO_IRQ_EDGE_RISE); });
+
+        runner.run("button/isr_fixed", [&]()
+                   {
+            level = !level;
+            gpio_put(PIN_BUTTON, level);
+            fixed_button_isr(PIN_BUTTON, GPIO_IRQ_EDGE_RISE); });
+
+        runner.run("gate/isr_runtime", [&]()
+                   {
+            level = !level;
+            gpio_put(PIN_GATE, level);
+            runtime_isr(PIN_GATE, GPIO_IRQ_EDGE_RISE); });
+
+        runner.run("gate/isr_fixed", [&]()
+                   {
+            level = !level;
+            gpio_put(PIN_GATE, level);
+            fixed_gate_isr(PIN_GATE, GPIO_IRQ_EDGE_RISE); });
+
+        // The gate last in a callback shared with an encoder and a button
+        runner.run("gate/isr_fixed_shared", [&]()
+                   {
+            level = !level;
+            gpio_put(PIN_GATE, level);
+            fixed_shared_isr(PIN_GATE, GPIO_IRQ_EDGE_RISE); });
+        doNotOptimize(gate.getState());
+        doNotOptimize(fixed_gate.getState());
+    }
+
+    /**
+     * @brief Run every framework benchmark
+     */
+    inline void runAll(PTBenchmark::Runner &runner)
+    {
+        benchBaseline(runner);
+        benchEventQueue(runner);
+        benchPTScheduler(runner);
+        benchSimpleScheduler(runner);
+        benchSimpleEvents(runner);
+        benchSnapshot(runner);
+        benchProtothread(runner);
+        benchCV(runner);
+        benchOscillators(runner);
+        benchModulation(runner);
+        benchQuantizer(runner);
+        benchSequencer(runner);
+        benchMidi(runner);
+        benchEncoder(runner);
+        benchInputIsr(runner);
+    }
+}
+
+#endif // __PT_BENCH_SUITE_H__
@@ -0,0 +1,282 @@
+/**
+ * @file pt_benchmark.h
+ * @brief Micro-benchmark harness with machine-readable output
+ *
+ * Each benchmark body is calibrated until one sample takes at least
+ * min_sample_ns, then timed over a fixed number of samples. Results are
+ * reported per operation as min / median / mean / stddev / p90, so the
+ * median can be compared between runs while the spread shows how noisy
+ * the machine was.
+ *
+ * The harness only needs a tick counter and printf, so the same code
+ * and output format run on the host and on the target. parseJSON()
+ * reads that output back, e.g. to compare a target run with the host.
+ */
+
+#ifndef __PT_BENCHMARK_H__
+#define __PT_BENCHMARK_H__
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+namespace PTBenchmark
+{
+    /**
+     * @brief Keep a value alive without adding work to the measured loop
+     */
+    template <typename T>
+    inline void doNotOptimize(T const &value)
+    {
+        asm volatile("" : : "r,m"(value) : "memory");
+    }
+
+    inline void clobberMemory()
+    {
+        asm volatile("" : : : "memory");
+    }
+
+    enum class Format
+    {
+        TABLE,
+        JSON,
+        CSV
+    };
+
+    struct Result
+    {
+        const char *name;
+        uint64_t iterations; // Body calls per sample
+        uint32_t samples;
+        double min_ns;
+        double median_ns;
+        double mean_ns;
+        double stddev_ns;
+        double p90_ns;
+    };
+
+    /**
+     * @brief Runs benchmarks and collects their results
+     */
+    class Runner
+    {
+    public:
+        static const uint32_t MAX_SAMPLES = 64;
+        static const uint32_t MAX_RESULTS = 128; // Suite plus target placement kernels, with room to grow
+
+        typedef uint64_t (*TickFunction)();
+
+    private:
+        TickFunction now;
+        double ns_per_tick;
+        uint32_t sample_count;
+        uint64_t min_sample_ticks;
+        const char *filter;
+        const char *platform;
+        uint32_t cpu_hz;
+
+        Result results[MAX_RESULTS];
+        uint32_t result_count;
+        uint32_t dropped; // Benchmarks not run because results[] was full
+        double samples[MAX_SAMPLES];
+
+        template <typename F>
+        uint64_t timeIterations(F &body, uint64_t iterations)
+        {
+            uint64_t start = now();
+            for (uint64_t i = 0; i < iterations; i++)
+            {
+                body();
+            }
+            clobberMemory();
+            return now() - start;
+        }
+
+    public:
+        /**
+         * @param now Monotonic tick counter
+         * @param ns_per_tick Tick period in nanoseconds
+         */
+        Runner(TickFunction now, double ns_per_tick)
+            : now(now), ns_per_tick(ns_per_tick), sample_count(21),
+              min_sample_ticks((uint64_t)(2000000.0 / ns_per_tick)), filter(nullptr),
+              platform("host"), cpu_hz(0), result_count(0), dropped(0)
+        {
+        }
+
+        void setSamples(uint32_t count) { sample_count = std::min(std::max(count, 3u), MAX_SAMPLES); }
+        void setMinSampleTime(double ns) { min_sample_ticks = (uint64_t)(ns / ns_per_tick) + 1; }
+
+        /**
+         * @brief Only run benchmarks whose name contains this substring
+         */
+        void setFilter(const char *substring) { filter = substring; }
+
+        /**
+         * @brief Describe the machine in the report
+         * @param hz Core clock, 0 if unknown (cycles = ns * hz / 1e9)
+         */
+        void setContext(const char *name, uint32_t hz)
+        {
+            platform = name;
+            cpu_hz = hz;
+        }
+
+        /**
+         * @brief Time a benchmark body
+         * @param name Stable identifier, e.g. "event_queue/push_pop"
+         * @param body Callable performing ops_per_call operations
+         * @param ops_per_call Operations per body call, for per-op results
+         */
+        template <typename F>
+        void run(const char *name, F body, uint32_t ops_per_call = 1)
+        {
+            if (filter && !std::strstr(name, filter))
+                return;
+            if (result_count >= MAX_RESULTS)
+            {
+                // Never lose a result quietly: say which, and count it for the exit status
+                fprintf(stderr, "pt-benchmark: result buffer full (%lu), %s not run\n", (unsigned long)MAX_RESULTS, name);
+                dropped++;
+                return;
+            }
+
+            // Warm up, then grow the iteration count until a sample is long enough
+            timeIterations(body, 16);
+            uint64_t iterations = 1;
+            while (timeIterations(body, iterations) < min_sample_ticks && iterations < (1ull << 40))
+            {
+                iterations *= 2;
+            }
+
+            double ops = (double)iterations * ops_per_call;
+            double sum = 0.0;
+            for (uint32_t s = 0; s < sample_count; s++)
+            {
+                samples[s] = timeIterations(body, iterations) * ns_per_tick / ops;
+                sum += samples[s];
+            }
+            std::sort(samples, samples + sample_count);
+
+            Result &r = results[result_count++];
+            r.name = name;
+            r.iterations = iterations;
+            r.samples = sample_count;
+            r.min_ns = samples[0];
+            r.median_ns = samples[sample_count / 2];
+            r.mean_ns = sum / sample_count;
+            r.p90_ns = samples[(sample_count * 9) / 10];
+
+            double variance = 0.0;
+            for (uint32_t s = 0; s < sample_count; s++)
+            {
+                double d = samples[s] - r.mean_ns;
+                variance += d * d;
+            }
+            r.stddev_ns = std::sqrt(variance / (sample_count - 1));
+        }
+
+        uint32_t getResultCount() const { return result_count; }
+        const Result &getResult(uint32_t index) const { return results[index]; }
+
+        /**
+         * @brief Benchmarks skipped because MAX_RESULTS was reached; a runner
+         *        should treat anything but 0 as a failed run
+         */
+        uint32_t getDroppedCount() const { return dropped; }
+
+        /**
+         * @brief Print all results
+         */
+        void report(Format format) const
+        {
+            switch (format)
+            {
+            case Format::TABLE:
+                printf("# %s, cpu_hz %lu\n", platform, (unsigned long)cpu_hz);
+                printf("%-36s %12s %10s %10s %10s %10s %10s\n",
+                       "benchmark", "iterations", "median_ns", "min_ns", "mean_ns", "stddev_ns", "p90_ns");
+                for (uint32_t i = 0; i < result_count; i++)
+                {
+                    const Result &r = results[i];
+                    printf("%-36s %12llu %10.2f %10.2f %10.2f %10.2f %10.2f\n", r.name,
+                           (unsigned long long)r.iterations, r.median_ns, r.min_ns, r.mean_ns, r.stddev_ns, r.p90_ns);
+                }
+                break;
+
+            case Format::CSV:
+                printf("name,iterations,samples,median_ns,min_ns,mean_ns,stddev_ns,p90_ns\n");
+                for (uint32_t i = 0; i < result_count; i++)
+                {
+                    const Result &r = results[i];
+                    printf("%s,%llu,%u,%.3f,%.3f,%.3f,%.3f,%.3f\n", r.name, (unsigned long long)r.iterations,
+                           (unsigned)r.samples, r.median_ns, r.min_ns, r.mean_ns, r.stddev_ns, r.p90_ns);
+                }
+                break;
+
+            case Format::JSON:
+                printf("{\n  \"context\": {\"platform\": \"%s\", \"cpu_hz\": %lu},\n", platform, (unsigned long)cpu_hz);
+                printf("  \"benchmarks\": [\n");
+                for (uint32_t i = 0; i < result_count; i++)
+                {
+                    const Result &r = results[i];
+                    printf("    {\"name\": \"%s\", \"iterations\": %llu, \"samples\": %u, "
+                           "\"median_ns\": %.3f, \"min_ns\": %.3f, \"mean_ns\": %.3f, "
+                           "\"stddev_ns\": %.3f, \"p90_ns\": %.3f}%s\n",
+                           r.name, (unsigned long long)r.iterations, (unsigned)r.samples, r.median_ns,
+                           r.min_ns, r.mean_ns, r.stddev_ns, r.p90_ns, i + 1 < result_count ? "," : "");
+                }
+                printf("  ]\n}\n");
+                break;
+            }
+        }
+    };
+
+    /**
+     * @brief Read results back from JSON written by Runner::report()
+     *
+     * Lines other than result entries are skipped, so console output
+     * captured around a target run can be passed as is. Names point
+     * into text, which is modified in place.
+     *
+     * @return Number of results, or -1 if an entry is malformed
+     */
+    inline int parseJSON(char *text, Result *out, uint32_t max)
+    {
+        static const char KEY[] = "{\"name\": \"";
+        uint32_t count = 0;
+        char *cursor = text;
+
+        while ((cursor = std::strstr(cursor, KEY)) != nullptr && count < max)
+        {
+            char *name = cursor + sizeof(KEY) - 1;
+            char *name_end = std::strchr(name, '"');
+            if (!name_end)
+                return -1;
+            *name_end = '\0';
+
+            Result &r = out[count];
+            unsigned long long iterations = 0;
+            unsigned samples = 0;
+            int end = -1; // Set only if the closing brace matched, so a capture cut off mid-number fails
+            int fields = sscanf(name_end + 1,
+                                ", \"iterations\": %llu, \"samples\": %u, \"median_ns\": %lf, \"min_ns\": %lf, "
+                                "\"mean_ns\": %lf, \"stddev_ns\": %lf, \"p90_ns\": %lf}%n",
+                                &iterations, &samples, &r.median_ns, &r.min_ns, &r.mean_ns, &r.stddev_ns, &r.p90_ns,
+                                &end);
+            if (fields != 7 || end < 0 || samples == 0 || !(r.min_ns <= r.median_ns && r.median_ns <= r.p90_ns))
+                return -1;
+
+            r.name = name;
+            r.iterations = iterations;
+            r.samples = samples;
+            count++;
+            cursor = name_end + 1;
+        }
+        return (int)count;
+    }
+}
+
+#endif // __PT_BENCHMARK_H__
@@ -0,0 +1,39 @@
+/**
+ * @file pt_check.h
+ * @brief Pass/fail lines and exit status for the host check programs
+ *
+ * Each check prints its description padded to a column and "ok" or
+ * "FAILED"; summary() prints the overall verdict and returns the exit
+ * status, 1 if any check failed.
+ */
+
+#ifndef __PT_CHECK_H__
+#define __PT_CHECK_H__
+
+#include <cstdio>
+
+namespace PTCheck
+{
+    const int COLUMN = 72; // Width of the description column
+
+    inline int failures = 0;
+
+    inline void check(bool ok, const char *what)
+    {
+        printf("%-*s %s\n", COLUMN, what, ok ? "ok" : "FAILED");
+        if (!ok)
+            failures++;
+    }
+
+    /**
+     * @brief Print "ok" or "FAILED" for the whole run
+     * @return Exit status for main()
+     */
+    inline int summary()
+    {
+        printf("%s\n", failures == 0 ? "ok" : "FAILED");
+        return failures == 0 ? 0 : 1;
+    }
+}
+
+#endif // __PT_CHECK_H__
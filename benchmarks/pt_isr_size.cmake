@@ -0,0 +1,11 @@
+# Code size of the input interrupt paths in the benchmark builds, runtime
+# pins (board dispatch table + class handler) vs compile-time pins
+# (PTFixedDispatch with the decode inlined). Passed to tools/pt_placement.py.
+set(PT_ISR_SIZE_GROUPS
+        "--group=encoder runtime=^PTBoard::dispatch\\(|^PTEncoder::(onEdge|handle)"
+        "--group=encoder fixed=^PTFixedDispatch<PTBenchSuite::fixed_encoder>::"
+        "--group=button runtime=^PTBoard::dispatch\\(|^PTButton::(onEdge|handle)"
+        "--group=button fixed=^PTFixedDispatch<PTBenchSuite::fixed_button>::"
+        "--group=gate runtime=^PTBoard::dispatch\\(|^PTGateInput::(onEdge|handle)"
+        "--group=gate fixed=^PTFixedDispatch<PTBenchSuite::fixed_gate>::"
+        "--group=shared fixed (3 devices)=^PTFixedDispatch<PTBenchSuite::fixed_encoder, ")
@@ -0,0 +1,564 @@
+/**
+ * @file eurorack_board.h
+ * @brief Compile-time board description: pin map, validation and setup
+ *
+ * A module's wiring is described once, as a constexpr list of pins with
+ * their role, channel and polarity. Everything else is derived from it:
+ * - Pin numbers for the firmware (board.gpio(Role::GATE_IN, 0))
+ * - Compile-time checks (PT_BOARD_CHECK): pins in range, no pin used
+ *   twice, CV inputs on ADC pins, no two CV outputs on the same PWM
+ *   slice channel, encoders with both phases
+ * - One init() routine that sets up every pin, the ADC once and each
+ *   PWM slice once, called from main() rather than from constructors
+ * - One GPIO interrupt callback for the whole board, dispatching by pin
+ *   through a table, so classes that need edge interrupts do not
+ *   replace each other's callback
+ * - The dispatch table itself: makeEdgeTable() places a handler bound to
+ *   each role's channel on that channel's pin at compile time, and
+ *   PT_EDGE_CHECK rejects a table that misses an input pin, puts two
+ *   handlers on one pin or binds a channel the board does not have
+ *
+ * init(board, table) installs the table. onEdge() adds or replaces a
+ * single pin's handler at run time, for pins outside the description
+ * (an expander's INT line) or objects that attach() themselves.
+ *
+ * Usage:
+ *
+ *     using namespace PTBoard;
+ *     constexpr auto BOARD = makeBoard(
+ *         encoderA(2), encoderB(3), encoderButton(4),
+ *         gateIn(7), cvIn(26), cvOut(20), led(25));
+ *     PT_BOARD_CHECK(BOARD);
+ *
+ *     PTEncoder encoder(2, 3, 4, false);
+ *     PTGateInput gate(7, true, false);
+ *     constexpr auto EDGES = makeEdgeTable(BOARD,
+ *         bind(Role::ENCODER_A, 0, PTEncoder::onEdge, &encoder),
+ *         bind(Role::ENCODER_BUTTON, 0, PTEncoder::onEdge, &encoder),
+ *         bind(Role::GATE_IN, 0, PTGateInput::onEdge, &gate));
+ *     PT_EDGE_CHECK(BOARD, EDGES);
+ *
+ *     int main() {
+ *         PTBoard::init(BOARD, EDGES);
+ *     }
+ */
+
+#ifndef __EURORACK_BOARD_H__
+#define __EURORACK_BOARD_H__
+
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/adc.h"
+#include "hardware/pwm.h"
+
+#include "pt_time_critical.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+namespace PTBoard
+{
+    static constexpr uint NUM_PINS = 30; // RP2040 bank 0
+    static constexpr uint NO_PIN = UINT_MAX;
+    static constexpr uint ADC_FIRST_PIN = 26; // ADC0-ADC3 are GPIO 26-29
+    static constexpr uint ADC_LAST_PIN = 29;
+    static constexpr uint PWM_SLICES = 8;
+    static constexpr uint16_t PWM_WRAP = 65535; // 16-bit CV resolution, as PTCVOutput
+
+    enum class Role : uint8_t
+    {
+        ENCODER_A,
+        ENCODER_B,
+        ENCODER_BUTTON,
+        BUTTON,
+        GATE_IN,
+        GATE_OUT,
+        CV_IN,
+        CV_OUT,
+        LED
+    };
+
+    /**
+     * @brief One wired pin
+     */
+    struct Pin
+    {
+        uint8_t gpio;
+        Role role;
+        uint8_t channel; // Which encoder/button/gate/CV of that role
+        bool active_low;
+
+        constexpr bool isInput() const
+        {
+            return role != Role::GATE_OUT && role != Role::CV_OUT && role != Role::LED;
+        }
+
+        constexpr bool isAdc() const { return gpio >= ADC_FIRST_PIN && gpio <= ADC_LAST_PIN; }
+        constexpr uint adcInput() const { return gpio - ADC_FIRST_PIN; }
+        constexpr uint pwmSlice() const { return (gpio >> 1) & 7; }
+        constexpr uint pwmChannel() const { return gpio & 1; }
+    };
+
+    // Pin factories; defaults match the hardware classes
+    constexpr Pin encoderA(uint8_t gpio, uint8_t channel = 0) { return {gpio, Role::ENCODER_A, channel, true}; }
+    constexpr Pin encoderB(uint8_t gpio, uint8_t channel = 0) { return {gpio, Role::ENCODER_B, channel, true}; }
+    constexpr Pin encoderButton(uint8_t gpio, uint8_t channel = 0) { return {gpio, Role::ENCODER_BUTTON, channel, true}; }
+    constexpr Pin button(uint8_t gpio, uint8_t channel = 0, bool active_low = true) { return {gpio, Role::BUTTON, channel, active_low}; }
+    constexpr Pin gateIn(uint8_t gpio, uint8_t channel = 0, bool active_low = false) { return {gpio, Role::GATE_IN, channel, active_low}; }
+    constexpr Pin gateOut(uint8_t gpio, uint8_t channel = 0, bool active_low = false) { return {gpio, Role::GATE_OUT, channel, active_low}; }
+    constexpr Pin cvIn(uint8_t gpio, uint8_t channel = 0) { return {gpio, Role::CV_IN, channel, false}; }
+    constexpr Pin cvOut(uint8_t gpio, uint8_t channel = 0) { return {gpio, Role::CV_OUT, channel, false}; }
+    constexpr Pin led(uint8_t gpio, uint8_t channel = 0, bool active_low = false) { return {gpio, Role::LED, channel, active_low}; }
+
+    /**
+     * @brief A module's complete pin map
+     */
+    template <size_t N>
+    struct Board
+    {
+        Pin pins[N];
+
+        static constexpr size_t size() { return N; }
+
+        /**
+         * @brief GPIO of a role's channel, NO_PIN if the board has none
+         */
+        constexpr uint gpio(Role role, uint8_t channel = 0) const
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                if (pins[i].role == role && pins[i].channel == channel)
+                    return pins[i].gpio;
+            }
+            return NO_PIN;
+        }
+
+        constexpr bool activeLow(Role role, uint8_t channel = 0) const
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                if (pins[i].role == role && pins[i].channel == channel)
+                    return pins[i].active_low;
+            }
+            return false;
+        }
+
+        constexpr size_t count(Role role) const
+        {
+            size_t total = 0;
+            for (size_t i = 0; i < N; i++)
+            {
+                if (pins[i].role == role)
+                    total++;
+            }
+            return total;
+        }
+
+        /**
+         * @brief GPIO mask of every pin with a role, for the *_masked SDK calls
+         */
+        constexpr uint32_t mask(Role role) const
+        {
+            uint32_t bits = 0;
+            for (size_t i = 0; i < N; i++)
+            {
+                if (pins[i].role == role && pins[i].gpio < NUM_PINS)
+                    bits |= 1u << pins[i].gpio;
+            }
+            return bits;
+        }
+
+        /**
+         * @brief Bit per PWM slice used by a CV output
+         */
+        constexpr uint32_t pwmSlices() const
+        {
+            uint32_t bits = 0;
+            for (size_t i = 0; i < N; i++)
+            {
+                if (pins[i].role == Role::CV_OUT)
+                    bits |= 1u << pins[i].pwmSlice();
+            }
+            return bits;
+        }
+
+        /**
+         * @brief GPIO mask of the edge inputs: encoder phases, buttons, gates
+         */
+        constexpr uint32_t edgeMask() const
+        {
+            return mask(Role::ENCODER_A) | mask(Role::ENCODER_B) | mask(Role::ENCODER_BUTTON) |
+                   mask(Role::BUTTON) | mask(Role::GATE_IN);
+        }
+
+        /**
+         * @brief GPIO mask of the pins that take edge interrupts
+         *
+         * The edge inputs less phase B, which is read on phase A's edges.
+         */
+        constexpr uint32_t irqMask() const
+        {
+            return edgeMask() & ~mask(Role::ENCODER_B);
+        }
+    };
+
+    template <typename... Pins>
+    constexpr Board<sizeof...(Pins)> makeBoard(Pins... pins)
+    {
+        return Board<sizeof...(Pins)>{{pins...}};
+    }
+
+    // ------------------------------------------------------------------------
+    // Compile-time validation (see PT_BOARD_CHECK)
+    // ------------------------------------------------------------------------
+
+    template <size_t N>
+    constexpr bool pinsInRange(const Board<N> &board)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            if (board.pins[i].gpio >= NUM_PINS)
+                return false;
+        }
+        return true;
+    }
+
+    template <size_t N>
+    constexpr bool noPinCollisions(const Board<N> &board)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+            {
+                if (board.pins[i].gpio == board.pins[j].gpio)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Each role's channels are numbered once
+     */
+    template <size_t N>
+    constexpr bool uniqueChannels(const Board<N> &board)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+            {
+                if (board.pins[i].role == board.pins[j].role && board.pins[i].channel == board.pins[j].channel)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    template <size_t N>
+    constexpr bool cvInputsOnAdcPins(const Board<N> &board)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            if (board.pins[i].role == Role::CV_IN && !board.pins[i].isAdc())
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief No two CV outputs drive the same slice channel
+     *
+     * GPIO n and n+16 share a PWM slice and channel, so they would always
+     * output the same level.
+     */
+    template <size_t N>
+    constexpr bool noPwmConflicts(const Board<N> &board)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            for (size_t j = i + 1; j < N; j++)
+            {
+                const Pin &a = board.pins[i];
+                const Pin &b = board.pins[j];
+                if (a.role == Role::CV_OUT && b.role == Role::CV_OUT &&
+                    a.pwmSlice() == b.pwmSlice() && a.pwmChannel() == b.pwmChannel())
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Every encoder has both phases; a button needs its encoder
+     */
+    template <size_t N>
+    constexpr bool encodersComplete(const Board<N> &board)
+    {
+        for (size_t i = 0; i < N; i++)
+        {
+            uint8_t channel = board.pins[i].channel;
+            switch (board.pins[i].role)
+            {
+            case Role::ENCODER_A:
+            case Role::ENCODER_BUTTON:
+                if (board.gpio(Role::ENCODER_B, channel) == NO_PIN)
+                    return false;
+                break;
+            case Role::ENCODER_B:
+                if (board.gpio(Role::ENCODER_A, channel) == NO_PIN)
+                    return false;
+                break;
+            default:
+                break;
+            }
+        }
+        return true;
+    }
+
+    template <size_t N>
+    constexpr bool isValid(const Board<N> &board)
+    {
+        return pinsInRange(board) && noPinCollisions(board) && uniqueChannels(board) &&
+               cvInputsOnAdcPins(board) && noPwmConflicts(board) && encodersComplete(board);
+    }
+
+    // ------------------------------------------------------------------------
+    // Runtime setup
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief Configure every pin on the board; call once from main()
+     *
+     * Inputs get a pull towards their inactive level, outputs start
+     * inactive, the ADC is initialised once and each PWM slice used by a
+     * CV output is configured once. Edge interrupts are enabled by
+     * init(board, table), or per pin by onEdge().
+     */
+    template <size_t N>
+    void init(const Board<N> &board)
+    {
+        bool adc_ready = false;
+        uint32_t slices_ready = 0;
+
+        for (size_t i = 0; i < N; i++)
+        {
+            const Pin &pin = board.pins[i];
+            switch (pin.role)
+            {
+            case Role::CV_IN:
+                if (!adc_ready)
+                {
+                    adc_init();
+                    adc_ready = true;
+                }
+                adc_gpio_init(pin.gpio);
+                break;
+
+            case Role::CV_OUT:
+                gpio_set_function(pin.gpio, GPIO_FUNC_PWM);
+                if (!(slices_ready & (1u << pin.pwmSlice())))
+                {
+                    pwm_config config = pwm_get_default_config();
+                    pwm_config_set_clkdiv(&config, 1.0f);
+                    pwm_config_set_wrap(&config, PWM_WRAP);
+                    pwm_init(pin.pwmSlice(), &config, true);
+                    slices_ready |= 1u << pin.pwmSlice();
+                }
+                break;
+
+            case Role::GATE_OUT:
+            case Role::LED:
+                gpio_init(pin.gpio);
+                gpio_set_dir(pin.gpio, GPIO_OUT);
+                gpio_put(pin.gpio, pin.active_low); // Inactive
+                break;
+
+            default:
+                gpio_init(pin.gpio);
+                gpio_set_dir(pin.gpio, GPIO_IN);
+                if (pin.active_low)
+                    gpio_pull_up(pin.gpio);
+                else
+                    gpio_pull_down(pin.gpio);
+                break;
+            }
+        }
+    }
+
+    /**
+     * @brief Edge interrupt handler for one pin
+     * @param context Object registered with onEdge()
+     */
+    typedef void (*EdgeHandler)(void *context, uint gpio, uint32_t events);
+
+    struct EdgeSlot
+    {
+        EdgeHandler handler;
+        void *context;
+    };
+
+    // Installed by init(board, table); onEdge()/offEdge() change single pins
+    inline EdgeSlot edge_slots[NUM_PINS];
+
+    /**
+     * @brief The board's single GPIO interrupt callback
+     */
+    inline void PT_TIME_CRITICAL(dispatch)(uint gpio, uint32_t events)
+    {
+        if (gpio >= NUM_PINS)
+            return;
+        const EdgeSlot &slot = edge_slots[gpio];
+        if (slot.handler)
+        {
+            slot.handler(slot.context, gpio, events);
+        }
+    }
+
+    /**
+     * @brief The GPIO callback every pin is registered with
+     *
+     * dispatch() unless a PTFixedDispatch has taken over, in which case
+     * that callback handles its own pins and passes the rest to dispatch().
+     */
+    inline gpio_irq_callback_t irq_callback = dispatch;
+
+    /**
+     * @brief Route a pin's edge interrupts to a handler
+     *
+     * All pins share one GPIO callback, so any number of objects can take
+     * edge interrupts without displacing each other.
+     */
+    inline void onEdge(uint gpio, EdgeHandler handler, void *context,
+                       uint32_t events = GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL)
+    {
+        if (gpio >= NUM_PINS)
+            return;
+        edge_slots[gpio] = {handler, context};
+        gpio_set_irq_enabled_with_callback(gpio, events, true, irq_callback);
+    }
+
+    /**
+     * @brief Stop a pin's edge interrupts
+     * @param context If given, only if the pin is still routed to this object
+     */
+    inline void offEdge(uint gpio, const void *context = nullptr)
+    {
+        if (gpio >= NUM_PINS || (context && edge_slots[gpio].context != context))
+            return;
+        gpio_set_irq_enabled(gpio, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, false);
+        edge_slots[gpio] = {nullptr, nullptr};
+    }
+
+    // ------------------------------------------------------------------------
+    // Dispatch table generated from the board (see PT_EDGE_CHECK)
+    // ------------------------------------------------------------------------
+
+    /**
+     * @brief A handler for the edges of one role's channel
+     */
+    struct EdgeBinding
+    {
+        Role role;
+        uint8_t channel;
+        EdgeHandler handler;
+        void *context;
+    };
+
+    constexpr EdgeBinding bind(Role role, uint8_t channel, EdgeHandler handler, void *context)
+    {
+        return {role, channel, handler, context};
+    }
+
+    /**
+     * @brief The dispatch table for a board, built at compile time
+     */
+    struct EdgeTable
+    {
+        EdgeSlot slots[NUM_PINS];
+        uint32_t mask;     // Pins with a handler
+        uint32_t doubled;  // Pins bound more than once
+        uint32_t unplaced; // Bindings for a channel the board does not have
+    };
+
+    /**
+     * @brief Place each binding on the pin of its role's channel
+     */
+    template <size_t N, typename... Bindings>
+    constexpr EdgeTable makeEdgeTable(const Board<N> &board, Bindings... bindings)
+    {
+        const EdgeBinding list[] = {bindings...};
+        EdgeTable table = {};
+        for (const EdgeBinding &binding : list)
+        {
+            uint gpio = board.gpio(binding.role, binding.channel);
+            if (gpio >= NUM_PINS)
+            {
+                table.unplaced++;
+                continue;
+            }
+            if (table.mask & (1u << gpio))
+                table.doubled |= 1u << gpio;
+            table.mask |= 1u << gpio;
+            table.slots[gpio] = {binding.handler, binding.context};
+        }
+        return table;
+    }
+
+    constexpr bool edgeBindingsPlaced(const EdgeTable &table) { return table.unplaced == 0; }
+    constexpr bool oneHandlerPerPin(const EdgeTable &table) { return table.doubled == 0; }
+
+    /**
+     * @brief Every pin that takes edge interrupts has a handler, and no other pin
+     */
+    template <size_t N>
+    constexpr bool edgeInputsCovered(const Board<N> &board, const EdgeTable &table)
+    {
+        return table.mask == board.irqMask();
+    }
+
+    /**
+     * @brief Configure every pin, then install a generated dispatch table
+     *
+     * Enables both edges on each pin of the table, through irq_callback.
+     * Handlers run from the first edge after this, so objects built with
+     * auto_init = false must have their event queue set beforehand.
+     */
+    template <size_t N>
+    void init(const Board<N> &board, const EdgeTable &table)
+    {
+        init(board);
+        for (uint gpio = 0; gpio < NUM_PINS; gpio++)
+        {
+            if (table.mask & (1u << gpio))
+            {
+                edge_slots[gpio] = table.slots[gpio];
+                gpio_set_irq_enabled_with_callback(gpio, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true,
+                                                   irq_callback);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Reject an invalid board at compile time, naming the rule it breaks
+ */
+#define PT_BOARD_CHECK(board)                                                                        \
+    static_assert(PTBoard::pinsInRange(board), #board ": GPIO number out of range (0-29)");          \
+    static_assert(PTBoard::noPinCollisions(board), #board ": GPIO assigned twice");                  \
+    static_assert(PTBoard::uniqueChannels(board), #board ": channel numbered twice for a role");     \
+    static_assert(PTBoard::cvInputsOnAdcPins(board), #board ": CV input not on an ADC pin (26-29)"); \
+    static_assert(PTBoard::noPwmConflicts(board), #board ": CV outputs share a PWM slice channel");  \
+    static_assert(PTBoard::encodersComplete(board), #board ": encoder missing its A or B phase")
+
+/**
+ * @brief Reject a dispatch table that does not match its board
+ */
+#define PT_EDGE_CHECK(board, table)                                                                   \
+    static_assert(PTBoard::edgeBindingsPlaced(table), #table ": handler bound to a channel " #board  \
+                                                      " does not have");                             \
+    static_assert(PTBoard::oneHandlerPerPin(table), #table ": two handlers bound to one pin");       \
+    static_assert(PTBoard::edgeInputsCovered(board, table), #table ": an edge input of " #board      \
+                                                            " has no handler")
+
+#endif // __EURORACK_BOARD_H__
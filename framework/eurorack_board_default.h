@@ -0,0 +1,39 @@
+/**
+ * @file eurorack_board_default.h
+ * @brief Pin map of the example module used by the pt-test programs
+ *
+ * Copy this file and edit the pin list to describe your own hardware;
+ * PT_BOARD_CHECK rejects a wiring mistake at compile time.
+ */
+
+#ifndef __EURORACK_BOARD_DEFAULT_H__
+#define __EURORACK_BOARD_DEFAULT_H__
+
+#include "eurorack_board.h"
+
+namespace EurorackBoards
+{
+    constexpr auto DEFAULT_BOARD = PTBoard::makeBoard(
+        PTBoard::encoderA(2),
+        PTBoard::encoderB(3),
+        PTBoard::encoderButton(4),
+
+        PTBoard::button(5, 0),
+        PTBoard::button(6, 1),
+
+        PTBoard::led(25, 0), // Onboard LED
+        PTBoard::led(15, 1), // External LEDs
+        PTBoard::led(16, 2),
+
+        PTBoard::cvIn(26, 0), // ADC0
+        PTBoard::cvIn(27, 1), // ADC1
+        PTBoard::cvOut(20, 0), // PWM slice 2 A
+        PTBoard::cvOut(21, 1), // PWM slice 2 B
+
+        PTBoard::gateIn(7),
+        PTBoard::gateOut(8));
+
+    PT_BOARD_CHECK(DEFAULT_BOARD);
+}
+
+#endif // __EURORACK_BOARD_DEFAULT_H__
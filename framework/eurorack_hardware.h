@@ -5,16 +5,28 @@
  * This header provides high-level C++ interfaces for common Eurorack
  * hardware components using the Raspberry Pi Pico SDK and protothreads.
  * Designed specifically for interrupt-driven, event-based programming.
+ *
+ * Constructors set up their pins by default. With a board description
+ * (eurorack_board.h), pass auto_init = false so nothing touches the
+ * hardware before main(), then run PTBoard::init(board, table) with a
+ * dispatch table bound to their onEdge() handlers, or PTBoard::init(board)
+ * and attach() the classes that take edge interrupts.
+ *
+ * PTFixedEncoder, PTFixedButton and PTFixedGateInput take their pins as
+ * template arguments instead, for the cheapest interrupt path (see
+ * PTFixedDispatch).
  */
 
 #ifndef __EURORACK_HARDWARE_H__
 #define __EURORACK_HARDWARE_H__
 
 #include "pt_thread.h"
+#include "eurorack_board.h"
 #include "eurorack_utils.h"
 #include <functional>
 #include <climits>
 #include <cstdlib>
+#include <type_traits>
 
 /**
  * @brief Encoder interface with interrupt support
@@ -28,35 +40,40 @@ private:
     volatile uint32_t last_change_time;
     PTEventQueue *event_queue;
     bool button_enabled;
+    bool last_a; // Phase A at the previous edge
 
-    // Interrupt handlers
-    static void gpio_irq_handler(uint gpio, uint32_t events);
-    static PTEncoder *instances[4]; // Support up to 4 encoders
+    // Order of construction, sent as the event data so a thread can tell
+    // instances apart; interrupts are routed by pin through PTBoard
     static uint8_t instance_count;
     uint8_t instance_id;
 
 public:
-    PTEncoder(uint pin_a, uint pin_b, uint pin_button = UINT_MAX)
+    /**
+     * @brief Edge handler for phase A and the button, for attach() or a
+     *        PTBoard::makeEdgeTable() binding
+     */
+    static void PT_TIME_CRITICAL(onEdge)(void *encoder, uint gpio, uint32_t)
+    {
+        PTEncoder *self = static_cast<PTEncoder *>(encoder);
+        if (gpio == self->pin_button)
+            self->handleButtonChange();
+        else
+            self->handleEncoderChange();
+    }
+
+    PTEncoder(uint pin_a, uint pin_b, uint pin_button = UINT_MAX, bool auto_init = true)
         : pin_a(pin_a), pin_b(pin_b), pin_button(pin_button),
           position(0), button_state(false), last_change_time(0),
-          event_queue(nullptr), button_enabled(pin_button != UINT_MAX),
+          event_queue(nullptr), button_enabled(pin_button != UINT_MAX), last_a(true),
           instance_id(instance_count++)
     {
-
-        if (instance_count <= 4)
+        if (auto_init)
         {
-            instances[instance_id] = this;
+            init();
         }
-        init();
     }
 
-    ~PTEncoder()
-    {
-        if (instance_id < 4)
-        {
-            instances[instance_id] = nullptr;
-        }
-    }
+    ~PTEncoder() { detach(); }
 
     void init()
     {
@@ -74,14 +91,31 @@ public:
             gpio_init(pin_button);
             gpio_set_dir(pin_button, GPIO_IN);
             gpio_pull_up(pin_button);
+        }
+
+        attach();
+    }
 
-            gpio_set_irq_enabled_with_callback(pin_button,
-                                               GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, gpio_irq_handler);
+    /**
+     * @brief Take edge interrupts on phase A and the button
+     */
+    void attach()
+    {
+        last_a = gpio_get(pin_a);
+        PTBoard::onEdge(pin_a, onEdge, this);
+        if (button_enabled)
+        {
+            PTBoard::onEdge(pin_button, onEdge, this);
         }
+    }
 
-        // Enable interrupts for encoder pins
-        gpio_set_irq_enabled_with_callback(pin_a,
-                                           GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, gpio_irq_handler);
+    void detach()
+    {
+        PTBoard::offEdge(pin_a, this);
+        if (button_enabled)
+        {
+            PTBoard::offEdge(pin_button, this);
+        }
     }
 
     void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
@@ -90,13 +124,12 @@ public:
     void setPosition(int32_t pos) { position = pos; }
     bool getButtonState() const { return button_state; }
 
-    void handleEncoderChange()
+    void PT_TIME_CRITICAL(handleEncoderChange)()
     {
         bool a_state = gpio_get(pin_a);
         bool b_state = gpio_get(pin_b);
 
         // Simple quadrature decoding
-        static bool last_a = false;
         if (a_state != last_a)
         {
             if (a_state == b_state)
@@ -117,7 +150,7 @@ public:
         last_a = a_state;
     }
 
-    void handleButtonChange()
+    void PT_TIME_CRITICAL(handleButtonChange)()
     {
         if (!button_enabled)
             return;
@@ -152,33 +185,30 @@ private:
     uint32_t debounce_time_us;
     bool active_low;
 
-    static void gpio_irq_handler(uint gpio, uint32_t events);
-    static PTButton *instances[8]; // Support up to 8 buttons
+    // Event data only, as PTEncoder
     static uint8_t instance_count;
     uint8_t instance_id;
 
 public:
-    PTButton(uint pin, bool active_low = true, uint32_t debounce_us = 50000)
+    // Edge handler, as PTEncoder::onEdge
+    static void PT_TIME_CRITICAL(onEdge)(void *button, uint, uint32_t)
+    {
+        static_cast<PTButton *>(button)->handleChange();
+    }
+
+    PTButton(uint pin, bool active_low = true, uint32_t debounce_us = 50000, bool auto_init = true)
         : pin(pin), current_state(false), last_state(false),
           last_change_time(0), press_time(0), event_queue(nullptr),
           debounce_time_us(debounce_us), active_low(active_low),
           instance_id(instance_count++)
     {
-
-        if (instance_count <= 8)
+        if (auto_init)
         {
-            instances[instance_id] = this;
+            init();
         }
-        init();
     }
 
-    ~PTButton()
-    {
-        if (instance_id < 8)
-        {
-            instances[instance_id] = nullptr;
-        }
-    }
+    ~PTButton() { detach(); }
 
     void init()
     {
@@ -186,16 +216,18 @@ public:
         gpio_set_dir(pin, GPIO_IN);
         gpio_pull_up(pin);
 
-        gpio_set_irq_enabled_with_callback(pin,
-                                           GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, gpio_irq_handler);
+        attach();
     }
 
+    void attach() { PTBoard::onEdge(pin, onEdge, this); }
+    void detach() { PTBoard::offEdge(pin, this); }
+
     void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
 
     bool isPressed() const { return current_state; }
     uint32_t getPressTime() const { return press_time; }
 
-    void handleChange()
+    void PT_TIME_CRITICAL(handleChange)()
     {
         uint32_t now = time_us_32();
         bool raw_state = gpio_get(pin);
@@ -238,32 +270,29 @@ private:
     PTEventQueue *event_queue;
     bool active_high;
 
-    static void gpio_irq_handler(uint gpio, uint32_t events);
-    static PTGateInput *instances[4];
+    // Event data only, as PTEncoder
     static uint8_t instance_count;
     uint8_t instance_id;
 
 public:
-    PTGateInput(uint pin, bool active_high = true)
+    // Edge handler, as PTEncoder::onEdge
+    static void PT_TIME_CRITICAL(onEdge)(void *gate, uint, uint32_t)
+    {
+        static_cast<PTGateInput *>(gate)->handleEdge();
+    }
+
+    PTGateInput(uint pin, bool active_high = true, bool auto_init = true)
         : pin(pin), current_state(false), last_edge_time(0), gate_duration(0),
           event_queue(nullptr), active_high(active_high),
           instance_id(instance_count++)
     {
-
-        if (instance_count <= 4)
+        if (auto_init)
         {
-            instances[instance_id] = this;
+            init();
         }
-        init();
     }
 
-    ~PTGateInput()
-    {
-        if (instance_id < 4)
-        {
-            instances[instance_id] = nullptr;
-        }
-    }
+    ~PTGateInput() { detach(); }
 
     void init()
     {
@@ -271,17 +300,19 @@ public:
         gpio_set_dir(pin, GPIO_IN);
         gpio_pull_down(pin); // Typically no pull for gate inputs
 
-        gpio_set_irq_enabled_with_callback(pin,
-                                           GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, gpio_irq_handler);
+        attach();
     }
 
+    void attach() { PTBoard::onEdge(pin, onEdge, this); }
+    void detach() { PTBoard::offEdge(pin, this); }
+
     void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
 
     bool getState() const { return current_state; }
     uint32_t getLastEdgeTime() const { return last_edge_time; }
     uint32_t getGateDuration() const { return gate_duration; }
 
-    void handleEdge()
+    void PT_TIME_CRITICAL(handleEdge)()
     {
         uint32_t now = time_us_32();
         bool raw_state = gpio_get(pin);
@@ -322,7 +353,7 @@ private:
     uint16_t change_threshold;
 
 public:
-    PTCVInput(uint adc_pin, uint16_t threshold = 50)
+    PTCVInput(uint adc_pin, uint16_t threshold = 50, bool auto_init = true)
         : adc_pin(adc_pin), current_value(0), last_value(0),
           last_read_time(0), event_queue(nullptr), change_threshold(threshold)
     {
@@ -341,7 +372,10 @@ public:
             adc_input = 0; // Default to ADC0
         }
 
-        init();
+        if (auto_init)
+        {
+            init();
+        }
     }
 
     void init()
@@ -358,6 +392,10 @@ public:
     {
         return EurorackUtils::CV::adcToEurorackVoltage(current_value);
     }
+    int32_t getPitchQ16() const
+    {
+        return EurorackUtils::Fixed::adcToPitchQ16(current_value);
+    }
 
     void update()
     {
@@ -391,16 +429,18 @@ private:
     uint16_t current_level;
 
 public:
-    PTCVOutput(uint pin) : pin(pin), current_level(0)
+    PTCVOutput(uint pin, bool auto_init = true)
+        : pin(pin), slice(pwm_gpio_to_slice_num(pin)), channel(pwm_gpio_to_channel(pin)), current_level(0)
     {
-        init();
+        if (auto_init)
+        {
+            init();
+        }
     }
 
     void init()
     {
         gpio_set_function(pin, GPIO_FUNC_PWM);
-        slice = pwm_gpio_to_slice_num(pin);
-        channel = pwm_gpio_to_channel(pin);
 
         pwm_config config = pwm_get_default_config();
         pwm_config_set_clkdiv(&config, 1.0f);
@@ -427,6 +467,165 @@ public:
     }
 };
 
+/**
+ * @brief PWM CV outputs written a slice at a time, their slices running in step
+ *
+ * The two channels of a PWM slice (GPIO 20 and 21 share slice 2) share
+ * one CC register, which the slice only takes at its wrap. PTCVOutput
+ * writes each channel's half on its own, so a pair written one after the
+ * other can straddle a wrap and move a PWM period apart. A bank stages
+ * levels with the same setVoltage()/setLevel() calls, and update() writes
+ * each changed slice's two levels in one CC store (pwm_set_both_levels()),
+ * so a pair always changes in the same period.
+ *
+ * start() zeroes the counters of the bank's slices and enables them with
+ * one pwm_set_mask_enabled(), so their periods line up and the channels
+ * of different slices also take their levels at the same wrap, unless
+ * update() itself runs across it.
+ *
+ *         PTCVOutputBank<> cv;
+ *         int pitch = cv.add(20);   // Slice 2 A
+ *         int mod = cv.add(21);     // Slice 2 B
+ *         cv.start();
+ *         ...
+ *         cv.setVoltage(pitch, v);
+ *         cv.setVoltage(mod, m);
+ *         cv.update();              // One store, same period
+ */
+template <size_t MAX_CHANNELS = 8>
+class PTCVOutputBank
+{
+private:
+    uint8_t channel_slice[MAX_CHANNELS];
+    uint8_t channel_half[MAX_CHANNELS]; // 0: A, 1: B
+    uint channels;
+
+    uint16_t levels[NUM_PWM_SLICES][2];
+    uint32_t slice_mask; // Slices with a channel in the bank
+    uint32_t dirty;      // Slices whose levels changed since update()
+    uint32_t writes;
+
+public:
+    PTCVOutputBank()
+        : channel_slice(), channel_half(), channels(0), levels(), slice_mask(0), dirty(0), writes(0)
+    {
+    }
+
+    /**
+     * @brief Add a CV output pin; its slice is set up (stopped) on first use
+     *
+     * The bank owns whole slices: update() also writes the other channel
+     * of the pin's slice, at 0 unless it is added too.
+     * @return Channel index for setVoltage()/setLevel(), or -1 if the bank is
+     *         full or the pin's slice channel is already in it
+     */
+    int add(uint pin)
+    {
+        if (channels >= MAX_CHANNELS || pin >= PTBoard::NUM_PINS)
+            return -1;
+        uint slice = pwm_gpio_to_slice_num(pin);
+        uint half = pwm_gpio_to_channel(pin);
+        for (uint c = 0; c < channels; c++)
+        {
+            if (channel_slice[c] == slice && channel_half[c] == half)
+                return -1;
+        }
+
+        gpio_set_function(pin, GPIO_FUNC_PWM);
+        if (!(slice_mask & (1u << slice)))
+        {
+            pwm_config config = pwm_get_default_config();
+            pwm_config_set_clkdiv(&config, 1.0f);
+            pwm_config_set_wrap(&config, PTBoard::PWM_WRAP);
+            pwm_init(slice, &config, false);
+            slice_mask |= 1u << slice;
+        }
+
+        channel_slice[channels] = (uint8_t)slice;
+        channel_half[channels] = (uint8_t)half;
+        return (int)channels++;
+    }
+
+    /**
+     * @brief Start every slice in the bank on the same clock cycle
+     *
+     * Slices outside the bank keep running. A running bank is stopped
+     * first, so calling start() again restarts it in step.
+     */
+    void start()
+    {
+        pwm_set_mask_enabled(pwm_hw->en & ~slice_mask);
+        for (uint s = 0; s < NUM_PWM_SLICES; s++)
+        {
+            if (slice_mask & (1u << s))
+                pwm_set_counter(s, 0);
+        }
+        pwm_set_mask_enabled(pwm_hw->en | slice_mask);
+    }
+
+    // ---- Staging (PTCVOutput interface, per channel) ----
+
+    void setVoltage(uint channel, float voltage)
+    {
+        setLevel(channel, EurorackUtils::CV::eurorackVoltageToDAC(voltage));
+    }
+
+    void setLevel(uint channel, uint16_t level)
+    {
+        if (channel >= channels)
+            return;
+        uint16_t &staged = levels[channel_slice[channel]][channel_half[channel]];
+        if (staged != level)
+        {
+            staged = level;
+            dirty |= 1u << channel_slice[channel];
+        }
+    }
+
+    uint16_t getLevel(uint channel) const
+    {
+        return channel < channels ? levels[channel_slice[channel]][channel_half[channel]] : 0;
+    }
+
+    float getVoltage(uint channel) const
+    {
+        return EurorackUtils::CV::dacToEurorackVoltage(getLevel(channel));
+    }
+
+    /**
+     * @brief Write every changed slice, both channels in one CC store
+     * @return Slices written
+     */
+    uint update()
+    {
+        uint written = 0;
+        uint32_t pending = dirty;
+        dirty = 0;
+        for (uint s = 0; pending; s++, pending >>= 1)
+        {
+            if (pending & 1)
+            {
+                pwm_set_both_levels(s, levels[s][0], levels[s][1]);
+                written++;
+            }
+        }
+        writes += written;
+        return written;
+    }
+
+    uint getChannelCount() const { return channels; }
+
+    /**
+     * @brief Bit per PWM slice used by the bank
+     */
+    uint32_t getSliceMask() const { return slice_mask; }
+
+    /**
+     * @brief CC register stores made by update() so far
+     */
+    uint32_t getWriteCount() const { return writes; }
+};
+
 /**
  * @brief Gate output with timing control
  */
@@ -440,11 +639,14 @@ private:
     bool active_high;
 
 public:
-    PTGateOutput(uint pin, bool active_high = true, uint32_t duration_us = 10000)
+    PTGateOutput(uint pin, bool active_high = true, uint32_t duration_us = 10000, bool auto_init = true)
         : pin(pin), current_state(false), gate_start_time(0),
           gate_duration_us(duration_us), active_high(active_high)
     {
-        init();
+        if (auto_init)
+        {
+            init();
+        }
     }
 
     void init()
@@ -491,56 +693,531 @@ public:
     uint32_t getDuration() const { return gate_duration_us; }
 };
 
-// Static member initializations (must be defined in a .cpp file in practice)
-PTEncoder *PTEncoder::instances[4] = {nullptr};
-uint8_t PTEncoder::instance_count = 0;
+/**
+ * @brief Gate outputs that change together, in one SIO write per step
+ *
+ * PTGateOutput writes its pin on its own, so triggers fired in the same
+ * step leave their jacks a few cycles apart and cost a write each. A bank
+ * stages the step's changes with trigger()/setHigh()/setLow(), and
+ * commit() applies them all at once: gpio_set_mask() or gpio_clr_mask()
+ * when every change goes the same way, gpio_put_masked() otherwise.
+ *
+ * A trigger's falling edge is scheduled at commit time plus its length.
+ * update() lowers every gate that has come due in one more write, so
+ * triggers of the same length that rose together also fall together.
+ *
+ *         PTGateBank<> gates;
+ *         int kick = gates.add(8);         // 10ms triggers
+ *         int hat = gates.add(9, 2000);    // 2ms triggers
+ *         ...
+ *         gates.trigger(kick);
+ *         gates.trigger(hat);
+ *         gates.commit();                  // Both rise in the same write
+ *         ...
+ *         gates.update();                  // From the loop: due falls in one write
+ */
+template <size_t MAX_GATES = 16>
+class PTGateBank
+{
+    static_assert(MAX_GATES <= 32, "a bank holds up to 32 gates");
 
-PTButton *PTButton::instances[8] = {nullptr};
-uint8_t PTButton::instance_count = 0;
+private:
+    uint32_t pin_masks[MAX_GATES];
+    uint32_t durations[MAX_GATES];
+    uint32_t fall_times[MAX_GATES];
+    uint gates;
+
+    uint32_t used_mask;    // Pins of all gates
+    uint32_t invert_mask;  // Active-low pins
+    uint32_t state;        // Active pins, as last written
+    uint32_t pending_high; // Pins staged to go active at commit()
+    uint32_t pending_low;  // Pins staged to go inactive at commit()
+    uint32_t triggered;    // Gates staged as triggers (bit per gate)
+    uint32_t timed;        // Gates with a falling edge scheduled
+    uint32_t writes;
+
+    /**
+     * @brief Move the pins from state to active, in one SIO write
+     */
+    void write(uint32_t active)
+    {
+        uint32_t rise = active & ~state;
+        uint32_t fall = state & ~active;
+        uint32_t set = (rise & ~invert_mask) | (fall & invert_mask);
+        uint32_t clear = (fall & ~invert_mask) | (rise & invert_mask);
+        state = active;
+        if (set == 0 && clear == 0)
+            return;
 
-PTGateInput *PTGateInput::instances[4] = {nullptr};
-uint8_t PTGateInput::instance_count = 0;
+        if (clear == 0)
+            gpio_set_mask(set);
+        else if (set == 0)
+            gpio_clr_mask(clear);
+        else
+            gpio_put_masked(set | clear, set);
+        writes++;
+    }
+
+public:
+    PTGateBank()
+        : pin_masks(), durations(), fall_times(), gates(0), used_mask(0), invert_mask(0), state(0), pending_high(0),
+          pending_low(0), triggered(0), timed(0), writes(0)
+    {
+    }
+
+    /**
+     * @brief Add a gate output and set its pin up, inactive
+     * @param duration_us Trigger length
+     * @return Gate index for trigger()/setHigh()/setLow(), or -1 if the bank is full
+     *         or already drives the pin
+     */
+    int add(uint pin, uint32_t duration_us = 10000, bool active_high = true)
+    {
+        if (gates >= MAX_GATES || pin >= PTBoard::NUM_PINS || (used_mask & (1u << pin)))
+            return -1;
+
+        uint32_t mask = 1u << pin;
+        used_mask |= mask;
+        pin_masks[gates] = mask;
+        durations[gates] = duration_us;
+        if (!active_high)
+            invert_mask |= mask;
+
+        gpio_init(pin);
+        gpio_set_dir(pin, GPIO_OUT);
+        gpio_put(pin, !active_high); // Start inactive
+        return (int)gates++;
+    }
+
+    // ---- Staging: nothing moves until commit() ----
+
+    /**
+     * @brief Rise at commit(), fall a trigger length later
+     */
+    void trigger(uint gate)
+    {
+        if (gate >= gates)
+            return;
+        pending_high |= pin_masks[gate];
+        pending_low &= ~pin_masks[gate];
+        triggered |= 1u << gate;
+    }
+
+    /**
+     * @brief Go active at commit() and stay there
+     */
+    void setHigh(uint gate)
+    {
+        if (gate >= gates)
+            return;
+        pending_high |= pin_masks[gate];
+        pending_low &= ~pin_masks[gate];
+        triggered &= ~(1u << gate);
+    }
+
+    void setLow(uint gate)
+    {
+        if (gate >= gates)
+            return;
+        pending_low |= pin_masks[gate];
+        pending_high &= ~pin_masks[gate];
+        triggered &= ~(1u << gate);
+    }
+
+    /**
+     * @brief Apply every staged change in one write and schedule the triggers' falls
+     * @return true if any pin changed
+     */
+    bool commit()
+    {
+        uint32_t now = time_us_32();
+        uint32_t staged = pending_high | pending_low;
+        uint32_t before = writes;
+
+        // Gates set or cleared directly lose their scheduled fall
+        for (uint g = 0; g < gates; g++)
+        {
+            if (staged & pin_masks[g])
+                timed &= ~(1u << g);
+            if (triggered & (1u << g))
+                fall_times[g] = now + durations[g];
+        }
+        timed |= triggered;
+
+        write((state | pending_high) & ~pending_low);
+        pending_high = pending_low = triggered = 0;
+        return writes != before;
+    }
+
+    /**
+     * @brief Lower every trigger that has come due, in one write
+     * @return true if any gate fell
+     */
+    bool update()
+    {
+        if (timed == 0)
+            return false;
+
+        uint32_t now = time_us_32();
+        uint32_t due = 0;
+        for (uint g = 0; g < gates; g++)
+        {
+            if ((timed & (1u << g)) && (int32_t)(now - fall_times[g]) >= 0)
+            {
+                due |= pin_masks[g];
+                timed &= ~(1u << g);
+            }
+        }
+        if (due == 0)
+            return false;
+
+        write(state & ~due);
+        return true;
+    }
+
+    bool getState(uint gate) const { return gate < gates && (state & pin_masks[gate]); }
+
+    void setDuration(uint gate, uint32_t duration_us)
+    {
+        if (gate < gates)
+            durations[gate] = duration_us;
+    }
+    uint32_t getDuration(uint gate) const { return gate < gates ? durations[gate] : 0; }
+
+    uint getGateCount() const { return gates; }
+
+    /**
+     * @brief SIO writes made so far, one per commit() or update() that moved a pin
+     */
+    uint32_t getWriteCount() const { return writes; }
+};
+
+// ----------------------------------------------------------------------------
+// Compile-time pin variants
+// ----------------------------------------------------------------------------
 
-// Interrupt handler implementations
-void PTEncoder::gpio_irq_handler(uint gpio, uint32_t events)
+/**
+ * @brief PTEncoder with its pins fixed at compile time
+ *
+ * The pin masks are constants, so an edge costs one read of every GPIO
+ * input (gpio_get_all()) and a few masks, and PTFixedDispatch can inline
+ * the decode into the interrupt callback. Events match PTEncoder's.
+ * The constructor never touches the hardware.
+ */
+template <uint PinA, uint PinB, uint PinButton = PTBoard::NO_PIN>
+class PTFixedEncoder
 {
-    for (uint8_t i = 0; i < instance_count; i++)
+public:
+    static constexpr bool HAS_BUTTON = PinButton < PTBoard::NUM_PINS;
+
+    static_assert(PinA < PTBoard::NUM_PINS && PinB < PTBoard::NUM_PINS, "encoder pin out of range");
+    static_assert(PinA != PinB && PinA != PinButton && PinB != PinButton, "encoder pins must differ");
+
+    static constexpr uint32_t MASK_A = 1u << PinA;
+    static constexpr uint32_t MASK_B = 1u << PinB;
+    static constexpr uint32_t MASK_BUTTON = HAS_BUTTON ? 1u << (PinButton % 32) : 0;
+    static constexpr uint32_t IRQ_MASK = MASK_A | MASK_BUTTON; // Phase B is read on A's edges
+
+private:
+    volatile int32_t position;
+    volatile bool button_state;
+    volatile uint32_t last_change_time;
+    PTEventQueue *event_queue;
+    uint32_t last_in; // GPIO inputs at the previous edge
+    uint8_t id;
+
+    static void PT_TIME_CRITICAL(onEdge)(void *encoder, uint, uint32_t)
+    {
+        static_cast<PTFixedEncoder *>(encoder)->update(gpio_get_all());
+    }
+
+public:
+    explicit PTFixedEncoder(uint8_t id = 0)
+        : position(0), button_state(false), last_change_time(0), event_queue(nullptr),
+          last_in(MASK_A | MASK_B | MASK_BUTTON), id(id)
+    {
+    }
+
+    void init()
+    {
+        const uint pins[] = {PinA, PinB, PinButton};
+        for (uint pin : pins)
+        {
+            if (pin < PTBoard::NUM_PINS)
+            {
+                gpio_init(pin);
+                gpio_set_dir(pin, GPIO_IN);
+                gpio_pull_up(pin);
+            }
+        }
+    }
+
+    /**
+     * @brief Take the current pin levels as the starting point for the decode
+     */
+    void latch() { last_in = gpio_get_all(); }
+
+    /**
+     * @brief Take edge interrupts through the board's dispatch table
+     *
+     * PTFixedDispatch is the faster alternative: it inlines update().
+     */
+    void attach()
+    {
+        latch();
+        PTBoard::onEdge(PinA, onEdge, this);
+        if (HAS_BUTTON)
+        {
+            PTBoard::onEdge(PinButton, onEdge, this);
+        }
+    }
+
+    void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
+
+    int32_t getPosition() const { return position; }
+    void setPosition(int32_t pos) { position = pos; }
+    bool getButtonState() const { return button_state; }
+
+    /**
+     * @brief Decode from one snapshot of the GPIO inputs (interrupt context)
+     */
+    inline void update(uint32_t in)
     {
-        if (instances[i] && (instances[i]->pin_a == gpio || instances[i]->pin_b == gpio))
+        uint32_t changed = (in ^ last_in) & IRQ_MASK;
+        last_in = in;
+
+        if (changed & MASK_A)
         {
-            instances[i]->handleEncoderChange();
-            break;
+            // Same rule as PTEncoder: A == B after an A edge is a step up
+            bool a = in & MASK_A;
+            bool b = in & MASK_B;
+            position += a == b ? 1 : -1;
+            last_change_time = time_us_32();
+
+            if (event_queue)
+            {
+                event_queue->push(PTEvent(PTEventType::ENCODER_TURN, position));
+            }
         }
-        else if (instances[i] && instances[i]->button_enabled && instances[i]->pin_button == gpio)
+
+        if (HAS_BUTTON && (changed & MASK_BUTTON))
         {
-            instances[i]->handleButtonChange();
-            break;
+            bool pressed = !(in & MASK_BUTTON); // Active low
+            button_state = pressed;
+            last_change_time = time_us_32();
+
+            if (event_queue)
+            {
+                PTEventType event_type = pressed ? PTEventType::BUTTON_PRESS : PTEventType::BUTTON_RELEASE;
+                event_queue->push(PTEvent(event_type, id));
+            }
         }
     }
-}
+};
 
-void PTButton::gpio_irq_handler(uint gpio, uint32_t events)
+/**
+ * @brief PTButton with its pin and polarity fixed at compile time
+ */
+template <uint Pin, bool ActiveLow = true>
+class PTFixedButton
 {
-    for (uint8_t i = 0; i < instance_count; i++)
+public:
+    static_assert(Pin < PTBoard::NUM_PINS, "button pin out of range");
+
+    static constexpr uint32_t MASK = 1u << Pin;
+    static constexpr uint32_t IRQ_MASK = MASK;
+
+private:
+    volatile bool current_state;
+    volatile uint32_t last_change_time;
+    volatile uint32_t press_time;
+    PTEventQueue *event_queue;
+    uint32_t debounce_time_us;
+    uint8_t id;
+
+    static void PT_TIME_CRITICAL(onEdge)(void *button, uint, uint32_t)
+    {
+        static_cast<PTFixedButton *>(button)->update(gpio_get_all());
+    }
+
+public:
+    explicit PTFixedButton(uint8_t id = 0, uint32_t debounce_us = 50000)
+        : current_state(false), last_change_time(0), press_time(0), event_queue(nullptr),
+          debounce_time_us(debounce_us), id(id)
+    {
+    }
+
+    void init()
     {
-        if (instances[i] && instances[i]->pin == gpio)
+        gpio_init(Pin);
+        gpio_set_dir(Pin, GPIO_IN);
+        if (ActiveLow)
+            gpio_pull_up(Pin);
+        else
+            gpio_pull_down(Pin);
+    }
+
+    void latch() {}
+    void attach() { PTBoard::onEdge(Pin, onEdge, this); }
+
+    void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
+
+    bool isPressed() const { return current_state; }
+    uint32_t getPressTime() const { return press_time; }
+
+    inline void update(uint32_t in)
+    {
+        bool raw_state = in & MASK;
+        bool new_state = ActiveLow ? !raw_state : raw_state;
+        uint32_t now = time_us_32();
+
+        // Debouncing, as PTButton
+        if (new_state != current_state && now - last_change_time > debounce_time_us)
         {
-            instances[i]->handleChange();
-            break;
+            current_state = new_state;
+            last_change_time = now;
+            if (new_state)
+            {
+                press_time = now;
+            }
+
+            if (event_queue)
+            {
+                PTEventType event_type = new_state ? PTEventType::BUTTON_PRESS : PTEventType::BUTTON_RELEASE;
+                event_queue->push(PTEvent(event_type, id));
+            }
         }
     }
-}
+};
 
-void PTGateInput::gpio_irq_handler(uint gpio, uint32_t events)
+/**
+ * @brief PTGateInput with its pin and polarity fixed at compile time
+ */
+template <uint Pin, bool ActiveHigh = true>
+class PTFixedGateInput
 {
-    for (uint8_t i = 0; i < instance_count; i++)
+public:
+    static_assert(Pin < PTBoard::NUM_PINS, "gate pin out of range");
+
+    static constexpr uint32_t MASK = 1u << Pin;
+    static constexpr uint32_t IRQ_MASK = MASK;
+
+private:
+    volatile bool current_state;
+    volatile uint32_t last_edge_time;
+    volatile uint32_t gate_duration;
+    PTEventQueue *event_queue;
+    uint8_t id;
+
+    static void PT_TIME_CRITICAL(onEdge)(void *gate, uint, uint32_t)
+    {
+        static_cast<PTFixedGateInput *>(gate)->update(gpio_get_all());
+    }
+
+public:
+    explicit PTFixedGateInput(uint8_t id = 0)
+        : current_state(false), last_edge_time(0), gate_duration(0), event_queue(nullptr), id(id)
+    {
+    }
+
+    void init()
     {
-        if (instances[i] && instances[i]->pin == gpio)
+        gpio_init(Pin);
+        gpio_set_dir(Pin, GPIO_IN);
+        if (ActiveHigh)
+            gpio_pull_down(Pin);
+        else
+            gpio_pull_up(Pin);
+    }
+
+    void latch() {}
+    void attach() { PTBoard::onEdge(Pin, onEdge, this); }
+
+    void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
+
+    bool getState() const { return current_state; }
+    uint32_t getLastEdgeTime() const { return last_edge_time; }
+    uint32_t getGateDuration() const { return gate_duration; }
+
+    inline void update(uint32_t in)
+    {
+        bool raw_state = in & MASK;
+        bool new_state = ActiveHigh ? raw_state : !raw_state;
+        if (new_state == current_state)
+            return;
+
+        uint32_t now = time_us_32();
+        if (current_state)
+        {
+            // Falling edge - calculate gate duration
+            gate_duration = now - last_edge_time;
+        }
+        current_state = new_state;
+        last_edge_time = now;
+
+        if (event_queue)
+        {
+            PTEventType event_type = new_state ? PTEventType::GATE_RISING : PTEventType::GATE_FALLING;
+            event_queue->push(PTEvent(event_type, id));
+        }
+    }
+};
+
+/**
+ * @brief GPIO interrupt callback generated for a fixed set of devices
+ *
+ * Each device's update() is inlined behind a constant mask test, so an
+ * edge costs one input read and a short branch chain instead of a table
+ * lookup and an indirect call. Pins not owned by the devices fall back
+ * to PTBoard::dispatch(), so runtime classes can share the bank.
+ *
+ *     PTFixedEncoder<2, 3, 4> encoder;
+ *     PTFixedGateInput<7> gate;
+ *     ...
+ *     PTFixedDispatch<encoder, gate>::attach();
+ */
+template <auto &...Devices>
+struct PTFixedDispatch
+{
+    static constexpr uint32_t IRQ_MASK = (0u | ... | std::remove_reference_t<decltype(Devices)>::IRQ_MASK);
+
+    static_assert((0 + ... + __builtin_popcount(std::remove_reference_t<decltype(Devices)>::IRQ_MASK)) ==
+                      __builtin_popcount(IRQ_MASK),
+                  "two devices take interrupts on the same pin");
+
+    static void PT_TIME_CRITICAL(irq)(uint gpio, uint32_t events)
+    {
+        uint32_t bit = 1u << gpio;
+        if (!(bit & IRQ_MASK))
+        {
+            PTBoard::dispatch(gpio, events);
+            return;
+        }
+
+        uint32_t in = gpio_get_all();
+        ((bit & std::remove_reference_t<decltype(Devices)>::IRQ_MASK ? Devices.update(in) : void()), ...);
+    }
+
+    /**
+     * @brief Enable edge interrupts on the devices' pins and make irq() the GPIO callback
+     */
+    static void attach()
+    {
+        (Devices.latch(), ...);
+        PTBoard::irq_callback = irq;
+        for (uint pin = 0; pin < PTBoard::NUM_PINS; pin++)
         {
-            instances[i]->handleEdge();
-            break;
+            if (IRQ_MASK & (1u << pin))
+            {
+                gpio_set_irq_enabled_with_callback(pin, GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL, true, irq);
+            }
         }
     }
-}
+};
+
+// Static member initializations (must be defined in a .cpp file in practice)
+uint8_t PTEncoder::instance_count = 0;
+uint8_t PTButton::instance_count = 0;
+uint8_t PTGateInput::instance_count = 0;
 
 #endif // __EURORACK_HARDWARE_H__
@@ -0,0 +1,760 @@
+/**
+ * @file eurorack_i2c_expander.h
+ * @brief Panel buttons, gates and LEDs on an MCP23017/PCA9555 I2C GPIO expander
+ *
+ * PTI2cExpander only reads the expander when it has something to say: the
+ * chip's INT line falls when an input changes, and that edge starts one
+ * DMA burst read of both input ports (register address, repeated start,
+ * two bytes). The read's completion interrupt diffs the ports against the
+ * previous read and hands each changed pin to the PTExpanderButton or
+ * PTExpanderGate attached to it, which push the same events as PTButton
+ * and PTGateInput. With the panel untouched the bus stays idle, where a
+ * polled expander needs a read every millisecond for the same latency.
+ *
+ * Outputs (LEDs) are staged with setOutput() and written by update() in
+ * one transaction carrying both output ports, however many pins changed,
+ * and none at all if nothing did. Call it once per frame.
+ *
+ *         PTI2cExpander expander(i2c0, EurorackExpander::Chip::MCP23017, 0x20, 4, 5, 6, 0x00FF);
+ *         PTExpanderButton shift(expander, 0, 10); // GPA0, event data 10
+ *         PTExpanderGate clock(expander, 7, 11);   // GPA7
+ *         shift.setEventQueue(&global_event_queue);
+ *         ...
+ *         expander.setOutput(8, step == 0);        // LED on GPB0
+ *         expander.update();                       // Once per frame
+ *
+ * Reads and writes share two DMA channels and take turns on the bus; a
+ * read asked for during a write starts when the write is done, and reads
+ * go first. If INT is still low when a read completes (an input changed
+ * while it ran) it reads again. A write is done at the controller's
+ * STOP_DET, not when its DMA has filled the TX FIFO: a write the chip
+ * NACKs raises TX_ABRT instead, is counted in getErrorCount() and sent
+ * again by the next update(). A read the chip does not answer (the
+ * controller aborts on the NACK and the read never completes) is
+ * abandoned by update() after PT_I2C_EXPANDER_TIMEOUT_US, counted in
+ * getErrorCount() and retried.
+ *
+ * The target address is set before each transfer, so other devices can
+ * share the bus, but a blocking call to one of them must not overlap an
+ * expander transfer.
+ */
+
+#ifndef __EURORACK_I2C_EXPANDER_H__
+#define __EURORACK_I2C_EXPANDER_H__
+
+#include "pico/stdlib.h"
+#include "hardware/i2c.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+
+#include "pt_thread.h"
+#include "pt_time_critical.h"
+#include "eurorack_board.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef PT_I2C_EXPANDER_TIMEOUT_US
+#define PT_I2C_EXPANDER_TIMEOUT_US 2000 // A 4-byte transfer takes ~120us at 400kHz
+#endif
+
+namespace EurorackExpander
+{
+    const uint PINS = 16; // Port 0/A on pins 0-7, port 1/B on pins 8-15
+
+    enum class Chip : uint8_t
+    {
+        MCP23017, // Pull-ups and INT open-drain configured, up to 1.7MHz
+        PCA9555   // Fixed 100k pull-ups, open-drain INT, up to 400kHz
+    };
+
+    // MCP23017 registers with IOCON.BANK = 0 (port A and B interleaved)
+    const uint8_t MCP23017_IODIRA = 0x00;
+    const uint8_t MCP23017_GPINTENA = 0x04;
+    const uint8_t MCP23017_IOCON = 0x0A;
+    const uint8_t MCP23017_GPPUA = 0x0C;
+    const uint8_t MCP23017_GPIOA = 0x12;
+    const uint8_t MCP23017_OLATA = 0x14;
+    const uint8_t MCP23017_IOCON_MIRROR = 0x40; // INTA and INTB both report either port
+    const uint8_t MCP23017_IOCON_ODR = 0x04;    // Open-drain INT
+
+    // PCA9555 registers
+    const uint8_t PCA9555_INPUT0 = 0x00;
+    const uint8_t PCA9555_OUTPUT0 = 0x02;
+    const uint8_t PCA9555_CONFIG0 = 0x06;
+
+    struct ChipInfo
+    {
+        uint8_t input_reg;  // First input port; the second follows it
+        uint8_t output_reg; // First output latch; the second follows it
+        uint32_t max_baud;
+    };
+
+    constexpr ChipInfo chipInfo(Chip chip)
+    {
+        return chip == Chip::PCA9555 ? ChipInfo{PCA9555_INPUT0, PCA9555_OUTPUT0, 400000}
+                                     : ChipInfo{MCP23017_GPIOA, MCP23017_OLATA, 1000000}; // RP2040 limit
+    }
+}
+
+class PTI2cExpander;
+
+/**
+ * @brief PTButton on an expander input
+ */
+class PTExpanderButton
+{
+private:
+    PTI2cExpander &expander;
+    uint pin;
+    volatile bool current_state;
+    volatile uint32_t last_change_time;
+    volatile uint32_t press_time;
+    PTEventQueue *event_queue;
+    uint32_t debounce_time_us;
+    bool active_low;
+    uint8_t id;
+
+public:
+    /**
+     * @param pin Expander pin, 0-15
+     * @param id Event data of its BUTTON_PRESS/RELEASE events
+     */
+    PTExpanderButton(PTI2cExpander &expander, uint pin, uint8_t id = 0, bool active_low = true,
+                     uint32_t debounce_us = 50000, bool auto_init = true)
+        : expander(expander), pin(pin), current_state(false), last_change_time(0), press_time(0),
+          event_queue(nullptr), debounce_time_us(debounce_us), active_low(active_low), id(id)
+    {
+        if (auto_init)
+        {
+            attach();
+        }
+    }
+
+    ~PTExpanderButton() { detach(); }
+
+    inline void attach();
+    inline void detach();
+
+    void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
+
+    bool isPressed() const { return current_state; }
+    uint32_t getPressTime() const { return press_time; }
+
+    /**
+     * @brief The pin's level changed in a read completed at now
+     */
+    void PT_TIME_CRITICAL(handleLevel)(bool level, uint32_t now)
+    {
+        bool new_state = active_low ? !level : level;
+
+        // Debouncing, as PTButton
+        if (now - last_change_time > debounce_time_us && new_state != current_state)
+        {
+            current_state = new_state;
+            last_change_time = now;
+            if (new_state)
+            {
+                press_time = now;
+            }
+
+            if (event_queue)
+            {
+                PTEventType event_type = new_state ? PTEventType::BUTTON_PRESS : PTEventType::BUTTON_RELEASE;
+                event_queue->push(PTEvent(event_type, id));
+            }
+        }
+    }
+};
+
+/**
+ * @brief PTGateInput on an expander input
+ *
+ * Edge times are those of the read that saw the edge, a transfer time
+ * (~120us at 400kHz) after it: fine for gates and slow clocks, not for
+ * audio-rate or tightly timed triggers.
+ */
+class PTExpanderGate
+{
+private:
+    PTI2cExpander &expander;
+    uint pin;
+    volatile bool current_state;
+    volatile uint32_t last_edge_time;
+    volatile uint32_t gate_duration;
+    PTEventQueue *event_queue;
+    bool active_high;
+    uint8_t id;
+
+public:
+    /**
+     * @param pin Expander pin, 0-15
+     * @param id Event data of its GATE_RISING/FALLING events
+     */
+    PTExpanderGate(PTI2cExpander &expander, uint pin, uint8_t id = 0, bool active_high = true,
+                   bool auto_init = true)
+        : expander(expander), pin(pin), current_state(false), last_edge_time(0), gate_duration(0),
+          event_queue(nullptr), active_high(active_high), id(id)
+    {
+        if (auto_init)
+        {
+            attach();
+        }
+    }
+
+    ~PTExpanderGate() { detach(); }
+
+    inline void attach();
+    inline void detach();
+
+    void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
+
+    bool getState() const { return current_state; }
+    uint32_t getLastEdgeTime() const { return last_edge_time; }
+    uint32_t getGateDuration() const { return gate_duration; }
+
+    void PT_TIME_CRITICAL(handleLevel)(bool level, uint32_t now)
+    {
+        bool new_state = active_high ? level : !level;
+
+        if (new_state != current_state)
+        {
+            if (current_state)
+            {
+                gate_duration = now - last_edge_time;
+            }
+
+            current_state = new_state;
+            last_edge_time = now;
+
+            if (event_queue)
+            {
+                PTEventType event_type = new_state ? PTEventType::GATE_RISING : PTEventType::GATE_FALLING;
+                event_queue->push(PTEvent(event_type, id));
+            }
+        }
+    }
+};
+
+/**
+ * @brief MCP23017/PCA9555 expander read on INT and written once per frame, by DMA
+ */
+class PTI2cExpander
+{
+private:
+    enum class Transfer : uint8_t
+    {
+        NONE,
+        READ,
+        WRITE
+    };
+
+    i2c_inst_t *i2c;
+    EurorackExpander::Chip chip;
+    EurorackExpander::ChipInfo info;
+    uint8_t address;
+    uint sda_pin;
+    uint scl_pin;
+    uint int_pin;
+    uint16_t input_mask;
+    uint baud;
+    bool present;
+
+    // IC_DATA_CMD words: register address, then the data bytes or read commands
+    uint32_t read_cmds[3];
+    uint32_t write_cmds[3];
+    uint8_t rx[2];
+
+    volatile uint16_t inputs;  // Levels of the last read
+    volatile uint16_t outputs; // Staged output levels
+    uint16_t written;          // Output levels last sent (or waiting to be)
+    uint16_t acknowledged;     // Output levels of the last write the chip took
+
+    volatile Transfer transfer;
+    volatile bool read_pending;
+    volatile bool write_pending;
+    volatile uint32_t transfer_start;
+
+    int tx_channel;
+    int rx_channel;
+
+    PTExpanderButton *buttons[EurorackExpander::PINS];
+    PTExpanderGate *gates[EurorackExpander::PINS];
+
+    volatile uint32_t reads;
+    volatile uint32_t writes;
+    uint32_t errors;
+
+    static inline PTI2cExpander *owners[NUM_DMA_CHANNELS];
+
+    void PT_TIME_CRITICAL(setTarget)()
+    {
+        i2c_hw_t *hw = i2c_get_hw(i2c);
+        if (hw->tar != address)
+        {
+            hw->enable = 0;
+            hw->tar = address;
+            hw->enable = 1;
+        }
+    }
+
+    /**
+     * @brief Put the next waiting transfer on the bus, reads first
+     */
+    void PT_TIME_CRITICAL(startNext)()
+    {
+        if (transfer != Transfer::NONE)
+            return;
+
+        if (read_pending)
+        {
+            read_pending = false;
+            transfer = Transfer::READ;
+            transfer_start = time_us_32();
+            setTarget();
+            dma_channel_set_write_addr(rx_channel, rx, false);
+            dma_channel_set_trans_count(rx_channel, 2, false);
+            dma_channel_set_read_addr(tx_channel, read_cmds, false);
+            dma_channel_set_trans_count(tx_channel, 3, false);
+            dma_start_channel_mask((1u << tx_channel) | (1u << rx_channel));
+        }
+        else if (write_pending)
+        {
+            write_pending = false;
+            transfer = Transfer::WRITE;
+            transfer_start = time_us_32();
+            setTarget();
+            // Done at its STOP or abort; the last read's STOP_DET must not pass for it
+            i2c_hw_t *hw = i2c_get_hw(i2c);
+            (void)(uint32_t)hw->clr_stop_det;
+            hw->intr_mask = I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS;
+            dma_channel_set_read_addr(tx_channel, write_cmds, false);
+            dma_channel_set_trans_count(tx_channel, 3, true);
+        }
+    }
+
+    /**
+     * @brief Both input ports arrived: route the changed pins
+     */
+    void PT_TIME_CRITICAL(onReadDone)()
+    {
+        uint32_t now = time_us_32();
+        uint16_t levels = (uint16_t)(rx[0] | (rx[1] << 8));
+        uint16_t changed = (uint16_t)((levels ^ inputs) & input_mask);
+        inputs = levels;
+        reads++;
+        transfer = Transfer::NONE;
+        dma_channel_acknowledge_irq0(tx_channel); // Its completion must not pass for the next write's
+
+        for (uint pin = 0; changed; pin++, changed >>= 1)
+        {
+            if (!(changed & 1))
+                continue;
+            bool level = (levels >> pin) & 1;
+            if (buttons[pin])
+                buttons[pin]->handleLevel(level, now);
+            else if (gates[pin])
+                gates[pin]->handleLevel(level, now);
+        }
+
+        // Changed again while the read ran: INT was re-armed by it, and no new edge comes
+        if (!gpio_get(int_pin))
+            read_pending = true;
+        startNext();
+    }
+
+    /**
+     * @brief The controller raised STOP_DET or TX_ABRT during a write
+     */
+    void PT_TIME_CRITICAL(onWriteDone)()
+    {
+        i2c_hw_t *hw = i2c_get_hw(i2c);
+        uint32_t raw = hw->raw_intr_stat;
+        if (raw & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)
+        {
+            // NACKed: reading IC_CLR_TX_ABRT releases the flushed TX FIFO. The write waits
+            // for the next read or update(), so an absent chip is not hammered from here
+            hw->intr_mask = 0;
+            (void)(uint32_t)hw->clr_tx_abrt;
+            (void)(uint32_t)hw->clr_stop_det;
+            written = acknowledged;
+            write_pending = true;
+            errors++;
+            transfer = Transfer::NONE;
+            if (read_pending)
+                startNext();
+            return;
+        }
+        if (!(raw & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS))
+            return;
+
+        (void)(uint32_t)hw->clr_stop_det;
+        // The last read's STOP while the write is still queued: wait for the write's own
+        if (dma_channel_is_busy(tx_channel) || !(hw->status & I2C_IC_STATUS_TFE_BITS))
+            return;
+
+        hw->intr_mask = 0;
+        acknowledged = (uint16_t)((write_cmds[1] & 0xFF) | ((write_cmds[2] & 0xFF) << 8));
+        written = acknowledged; // Already, unless a resend after a NACK went out behind a read
+        writes++;
+        transfer = Transfer::NONE;
+        startNext();
+    }
+
+    static void PT_TIME_CRITICAL(onInt)(void *expander, uint, uint32_t)
+    {
+        PTI2cExpander *self = static_cast<PTI2cExpander *>(expander);
+        self->read_pending = true;
+        self->startNext();
+    }
+
+    static void PT_TIME_CRITICAL(dmaIrq)()
+    {
+        for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+        {
+            PTI2cExpander *expander = owners[i];
+            if (expander && dma_channel_get_irq0_status(i))
+            {
+                dma_channel_acknowledge_irq0(i);
+                if ((int)i == expander->rx_channel && expander->transfer == Transfer::READ)
+                {
+                    expander->onReadDone();
+                }
+                // A write's TX completion only means its commands are queued: onWriteDone() ends it
+            }
+        }
+    }
+
+    static void PT_TIME_CRITICAL(i2cIrq)()
+    {
+        for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+        {
+            PTI2cExpander *expander = owners[i];
+            if (expander && (int)i == expander->tx_channel && expander->transfer == Transfer::WRITE)
+                expander->onWriteDone();
+        }
+    }
+
+    /**
+     * @brief Give up on a transfer the chip never answered and queue it again
+     */
+    void abandon()
+    {
+        // Aborting can raise the completion interrupt (RP2040-E13): keep it off meanwhile
+        dma_channel_set_irq0_enabled(tx_channel, false);
+        dma_channel_set_irq0_enabled(rx_channel, false);
+        dma_channel_abort(tx_channel);
+        dma_channel_abort(rx_channel);
+        dma_channel_acknowledge_irq0(tx_channel);
+        dma_channel_acknowledge_irq0(rx_channel);
+        dma_channel_set_irq0_enabled(tx_channel, true);
+        dma_channel_set_irq0_enabled(rx_channel, true);
+
+        // Reading IC_CLR_TX_ABRT releases the TX FIFO the NACK left flushed
+        i2c_hw_t *hw = i2c_get_hw(i2c);
+        hw->intr_mask = 0;
+        (void)(uint32_t)hw->clr_tx_abrt;
+        uint8_t stale;
+        while (i2c_get_read_available(i2c))
+            i2c_read_raw_blocking(i2c, &stale, 1);
+
+        if (transfer == Transfer::READ)
+        {
+            read_pending = true;
+        }
+        else
+        {
+            written = acknowledged;
+            write_pending = true;
+        }
+        transfer = Transfer::NONE;
+        errors++;
+    }
+
+    bool writeRegisters(uint8_t reg, uint16_t value, bool pair = true)
+    {
+        uint8_t bytes[3] = {reg, (uint8_t)value, (uint8_t)(value >> 8)};
+        size_t length = pair ? 3 : 2;
+        return i2c_write_blocking(i2c, address, bytes, length, false) == (int)length;
+    }
+
+    bool configure()
+    {
+        bool ok;
+        if (chip == EurorackExpander::Chip::MCP23017)
+        {
+            ok = writeRegisters(EurorackExpander::MCP23017_IOCON,
+                                EurorackExpander::MCP23017_IOCON_MIRROR | EurorackExpander::MCP23017_IOCON_ODR,
+                                false);
+            ok = ok && writeRegisters(EurorackExpander::MCP23017_OLATA, outputs);
+            ok = ok && writeRegisters(EurorackExpander::MCP23017_IODIRA, input_mask);
+            ok = ok && writeRegisters(EurorackExpander::MCP23017_GPPUA, input_mask);
+            ok = ok && writeRegisters(EurorackExpander::MCP23017_GPINTENA, input_mask); // Change vs previous value
+        }
+        else
+        {
+            ok = writeRegisters(EurorackExpander::PCA9555_OUTPUT0, outputs);
+            ok = ok && writeRegisters(EurorackExpander::PCA9555_CONFIG0, input_mask);
+        }
+
+        // Prime the inputs; the read also releases INT
+        uint8_t reg = info.input_reg;
+        ok = ok && i2c_write_blocking(i2c, address, &reg, 1, true) == 1;
+        ok = ok && i2c_read_blocking(i2c, address, rx, 2, false) == 2;
+        if (ok)
+        {
+            inputs = (uint16_t)(rx[0] | (rx[1] << 8));
+            written = acknowledged = (uint16_t)(outputs & ~input_mask);
+        }
+        return ok;
+    }
+
+public:
+    /**
+     * @param address 7-bit address (0x20-0x27 for both chips)
+     * @param int_pin GPIO wired to INT (INTA or INTB on an MCP23017), pulled up here
+     * @param input_mask Pins used as inputs (bit per pin); the rest are outputs
+     * @param baud Bus speed (0: the chip's maximum)
+     */
+    PTI2cExpander(i2c_inst_t *i2c, EurorackExpander::Chip chip, uint8_t address, uint sda_pin, uint scl_pin,
+                  uint int_pin, uint16_t input_mask = 0xFFFF, uint baud = 400000, bool auto_init = true)
+        : i2c(i2c), chip(chip), info(EurorackExpander::chipInfo(chip)), address(address), sda_pin(sda_pin),
+          scl_pin(scl_pin), int_pin(int_pin), input_mask(input_mask), baud(baud), present(false), read_cmds(),
+          write_cmds(), rx(), inputs(0), outputs(0), written(0), acknowledged(0), transfer(Transfer::NONE),
+          read_pending(false),
+          write_pending(false), transfer_start(0), tx_channel(-1), rx_channel(-1), buttons(), gates(), reads(0),
+          writes(0), errors(0)
+    {
+        if (this->baud == 0 || this->baud > info.max_baud)
+            this->baud = info.max_baud;
+
+        read_cmds[0] = info.input_reg;
+        read_cmds[1] = I2C_IC_DATA_CMD_CMD_BITS | I2C_IC_DATA_CMD_RESTART_BITS;
+        read_cmds[2] = I2C_IC_DATA_CMD_CMD_BITS | I2C_IC_DATA_CMD_STOP_BITS;
+        write_cmds[0] = info.output_reg;
+        write_cmds[2] = I2C_IC_DATA_CMD_STOP_BITS;
+
+        if (auto_init)
+        {
+            init();
+        }
+    }
+
+    ~PTI2cExpander()
+    {
+        if (rx_channel >= 0)
+        {
+            PTBoard::offEdge(int_pin, this);
+            i2c_get_hw(i2c)->intr_mask = 0;
+            dma_channel_set_irq0_enabled(tx_channel, false);
+            dma_channel_set_irq0_enabled(rx_channel, false);
+            dma_channel_abort(tx_channel);
+            dma_channel_abort(rx_channel);
+            owners[tx_channel] = nullptr;
+            owners[rx_channel] = nullptr;
+            dma_channel_unclaim(rx_channel);
+            dma_channel_unclaim(tx_channel);
+        }
+    }
+
+    void init()
+    {
+        baud = i2c_init(i2c, baud);
+        gpio_set_function(sda_pin, GPIO_FUNC_I2C);
+        gpio_set_function(scl_pin, GPIO_FUNC_I2C);
+        gpio_pull_up(sda_pin); // Weak; the bus still wants its own pull-ups
+        gpio_pull_up(scl_pin);
+        gpio_init(int_pin);
+        gpio_set_dir(int_pin, GPIO_IN);
+        gpio_pull_up(int_pin);
+
+        present = configure();
+
+        // TX: command words -> IC_DATA_CMD (the controller takes the low 11 bits)
+        tx_channel = dma_claim_unused_channel(true);
+        dma_channel_config tx_config = dma_channel_get_default_config(tx_channel);
+        channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_32);
+        channel_config_set_read_increment(&tx_config, true);
+        channel_config_set_write_increment(&tx_config, false);
+        channel_config_set_dreq(&tx_config, i2c_get_dreq(i2c, true));
+        dma_channel_configure(tx_channel, &tx_config, &i2c_get_hw(i2c)->data_cmd, read_cmds, 0, false);
+
+        // RX: the two port bytes
+        rx_channel = dma_claim_unused_channel(true);
+        dma_channel_config rx_config = dma_channel_get_default_config(rx_channel);
+        channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx_config, false);
+        channel_config_set_write_increment(&rx_config, true);
+        channel_config_set_dreq(&rx_config, i2c_get_dreq(i2c, false));
+        dma_channel_configure(rx_channel, &rx_config, rx, &i2c_get_hw(i2c)->data_cmd, 0, false);
+
+        static bool handler_installed = false;
+        if (!handler_installed)
+        {
+            irq_add_shared_handler(DMA_IRQ_0, dmaIrq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(DMA_IRQ_0, true);
+            handler_installed = true;
+        }
+        static bool i2c_handler_installed[2] = {false, false};
+        uint i2c_index = i2c_get_index(i2c);
+        if (!i2c_handler_installed[i2c_index])
+        {
+            uint i2c_irq = i2c_index ? I2C1_IRQ : I2C0_IRQ;
+            irq_add_shared_handler(i2c_irq, i2cIrq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(i2c_irq, true);
+            i2c_handler_installed[i2c_index] = true;
+        }
+        owners[tx_channel] = this;
+        owners[rx_channel] = this;
+        dma_channel_set_irq0_enabled(tx_channel, true);
+        dma_channel_set_irq0_enabled(rx_channel, true);
+
+        PTBoard::onEdge(int_pin, onInt, this, GPIO_IRQ_EDGE_FALL);
+        if (!gpio_get(int_pin))
+        {
+            read_pending = true;
+            startNext();
+        }
+    }
+
+    // ---- Inputs ----
+
+    /**
+     * @brief Route a pin's changes to a button (replaces a gate on it)
+     * @return false for a pin out of range or not an input
+     */
+    bool attach(uint pin, PTExpanderButton *button)
+    {
+        if (pin >= EurorackExpander::PINS || !(input_mask & (1u << pin)))
+            return false;
+        gates[pin] = nullptr;
+        buttons[pin] = button;
+        return true;
+    }
+
+    bool attach(uint pin, PTExpanderGate *gate)
+    {
+        if (pin >= EurorackExpander::PINS || !(input_mask & (1u << pin)))
+            return false;
+        buttons[pin] = nullptr;
+        gates[pin] = gate;
+        return true;
+    }
+
+    /**
+     * @param input If given, only if the pin is still routed to this object
+     */
+    void detach(uint pin, const void *input = nullptr)
+    {
+        if (pin >= EurorackExpander::PINS)
+            return;
+        if (!input || buttons[pin] == input)
+            buttons[pin] = nullptr;
+        if (!input || gates[pin] == input)
+            gates[pin] = nullptr;
+    }
+
+    /**
+     * @brief Pin levels of the last read, bit per pin
+     */
+    uint16_t getInputs() const { return inputs; }
+    bool getInput(uint pin) const { return pin < EurorackExpander::PINS && ((inputs >> pin) & 1); }
+
+    // ---- Outputs ----
+
+    /**
+     * @brief Stage an output level; update() sends it
+     */
+    void setOutput(uint pin, bool level)
+    {
+        if (pin >= EurorackExpander::PINS)
+            return;
+        if (level)
+            outputs = (uint16_t)(outputs | (1u << pin));
+        else
+            outputs = (uint16_t)(outputs & ~(1u << pin));
+    }
+
+    /**
+     * @brief Stage every output at once, bit per pin
+     */
+    void setOutputs(uint16_t levels) { outputs = levels; }
+
+    uint16_t getOutputs() const { return outputs; }
+
+    /**
+     * @brief Send the staged outputs if they changed, in one transaction, and
+     *        abandon a transfer the chip has not answered in time
+     * @return true if a write was started or queued behind a read
+     */
+    bool update()
+    {
+        uint32_t irq_state = save_and_disable_interrupts();
+
+        if (transfer != Transfer::NONE && time_us_32() - transfer_start > PT_I2C_EXPANDER_TIMEOUT_US)
+        {
+            abandon();
+            startNext();
+        }
+
+        // A write on the bus is still reading write_cmds: the change waits for the next frame.
+        // A NACKed write left write_pending set and written at the chip's levels: resend it
+        bool queued = false;
+        uint16_t levels = (uint16_t)(outputs & ~input_mask);
+        if ((levels != written || write_pending) && transfer != Transfer::WRITE)
+        {
+            write_cmds[1] = levels & 0xFF;
+            write_cmds[2] = (uint32_t)(levels >> 8) | I2C_IC_DATA_CMD_STOP_BITS;
+            written = levels;
+            write_pending = true;
+            queued = true;
+            startNext();
+        }
+
+        restore_interrupts(irq_state);
+        return queued;
+    }
+
+    bool isBusy() const { return transfer != Transfer::NONE; }
+
+    /**
+     * @brief The chip answered its configuration in init()
+     */
+    bool isPresent() const { return present; }
+
+    uint32_t getBaudrate() const { return baud; }
+
+    /**
+     * @brief Burst reads of the input ports completed
+     */
+    uint32_t getReadCount() const { return reads; }
+
+    /**
+     * @brief Output writes the chip acknowledged
+     */
+    uint32_t getWriteCount() const { return writes; }
+
+    /**
+     * @brief Writes the chip NACKed, and transfers abandoned after PT_I2C_EXPANDER_TIMEOUT_US
+     */
+    uint32_t getErrorCount() const { return errors; }
+};
+
+inline void PTExpanderButton::attach()
+{
+    current_state = active_low ? !expander.getInput(pin) : expander.getInput(pin);
+    expander.attach(pin, this);
+}
+
+inline void PTExpanderButton::detach() { expander.detach(pin, this); }
+
+inline void PTExpanderGate::attach()
+{
+    current_state = active_high ? expander.getInput(pin) : !expander.getInput(pin);
+    expander.attach(pin, this);
+}
+
+inline void PTExpanderGate::detach() { expander.detach(pin, this); }
+
+#endif // __EURORACK_I2C_EXPANDER_H__
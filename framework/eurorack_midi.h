@@ -0,0 +1,577 @@
+/**
+ * @file eurorack_midi.h
+ * @brief MIDI input/output with event-queue integration
+ *
+ * Incoming bytes are parsed in place, one at a time, by PTMidiParser:
+ * running status is honoured and realtime bytes (clock, start, stop...)
+ * are delivered immediately even when they arrive in the middle of
+ * another message. PTMidiInput turns parsed messages into PTEvents and
+ * divides the 24 PPQN MIDI clock down to sequencer steps.
+ *
+ * PTMidiUart feeds the parser from a DMA ring buffer on a UART, so no
+ * interrupt fires per byte; call poll() from a thread often enough that
+ * the ring (256 bytes, ~80ms of saturated MIDI) does not overrun. If it
+ * does, poll() counts the overwritten bytes and restarts the parser on
+ * the oldest byte still in the ring.
+ */
+
+#ifndef __EURORACK_MIDI_H__
+#define __EURORACK_MIDI_H__
+
+#include "pt_thread.h"
+#include "hardware/uart.h"
+#include "hardware/dma.h"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace EurorackMidi
+{
+    // Channel voice messages (upper nibble)
+    const uint8_t NOTE_OFF = 0x80;
+    const uint8_t NOTE_ON = 0x90;
+    const uint8_t POLY_PRESSURE = 0xA0;
+    const uint8_t CONTROL_CHANGE = 0xB0;
+    const uint8_t PROGRAM_CHANGE = 0xC0;
+    const uint8_t CHANNEL_PRESSURE = 0xD0;
+    const uint8_t PITCH_BEND = 0xE0;
+
+    // System messages
+    const uint8_t SYSEX_START = 0xF0;
+    const uint8_t SYSEX_END = 0xF7;
+    const uint8_t CLOCK = 0xF8;
+    const uint8_t START = 0xFA;
+    const uint8_t CONTINUE = 0xFB;
+    const uint8_t STOP = 0xFC;
+
+    const uint8_t PPQN = 24;
+    const uint32_t MIN_TICK_INTERVAL_US = 1000;   // 2500 BPM; closer ticks were stamped by one poll
+    const uint32_t MAX_TICK_INTERVAL_US = 250000; // 10 BPM; longer gaps mean the clock stopped
+    const uint8_t OMNI = 0xFF;
+
+    /**
+     * @brief Pack a channel message into PTEvent::data
+     */
+    inline uint32_t packEventData(uint8_t channel, uint8_t data1, uint8_t data2)
+    {
+        return ((uint32_t)channel << 16) | ((uint32_t)data1 << 8) | data2;
+    }
+
+    inline uint8_t eventChannel(uint32_t data) { return (data >> 16) & 0x0F; }
+    inline uint8_t eventData1(uint32_t data) { return (data >> 8) & 0x7F; }
+    inline uint8_t eventData2(uint32_t data) { return data & 0x7F; }
+}
+
+/**
+ * @brief A complete MIDI message (sysex excluded)
+ */
+struct PTMidiMessage
+{
+    uint8_t status;
+    uint8_t data1;
+    uint8_t data2;
+
+    uint8_t type() const { return status < 0xF0 ? (status & 0xF0) : status; }
+    uint8_t channel() const { return status & 0x0F; }
+};
+
+/**
+ * @brief Streaming MIDI byte parser with running status
+ */
+class PTMidiParser
+{
+private:
+    uint8_t running_status; // 0 = none
+    uint8_t data[2];
+    uint8_t data_count;
+    uint8_t data_expected;
+    bool in_sysex;
+
+public:
+    /**
+     * @brief Number of data bytes following a status byte
+     */
+    static uint8_t dataLength(uint8_t status)
+    {
+        if (status < 0xF0)
+        {
+            uint8_t type = status & 0xF0;
+            return (type == EurorackMidi::PROGRAM_CHANGE || type == EurorackMidi::CHANNEL_PRESSURE) ? 1 : 2;
+        }
+        switch (status)
+        {
+        case 0xF1: // MTC quarter frame
+        case 0xF3: // Song select
+            return 1;
+        case 0xF2: // Song position
+            return 2;
+        default:
+            return 0;
+        }
+    }
+
+    PTMidiParser() { reset(); }
+
+    void reset()
+    {
+        running_status = 0;
+        data_count = 0;
+        data_expected = 0;
+        in_sysex = false;
+    }
+
+    /**
+     * @brief Feed one byte
+     * @return true when msg holds a complete message
+     */
+    bool parse(uint8_t byte, PTMidiMessage &msg)
+    {
+        if (byte >= 0xF8)
+        {
+            // Realtime: deliver now, leave any message in progress untouched
+            msg.status = byte;
+            msg.data1 = msg.data2 = 0;
+            return true;
+        }
+
+        if (byte & 0x80)
+        {
+            in_sysex = (byte == EurorackMidi::SYSEX_START);
+            data_count = 0;
+
+            if (byte >= 0xF0)
+            {
+                // System common clears running status
+                running_status = 0;
+                data_expected = dataLength(byte);
+                if (data_expected > 0)
+                {
+                    running_status = byte; // Held only until its data arrives
+                }
+                else if (byte == 0xF6) // Tune request
+                {
+                    msg.status = byte;
+                    msg.data1 = msg.data2 = 0;
+                    return true;
+                }
+                return false;
+            }
+
+            running_status = byte;
+            data_expected = dataLength(byte);
+            return false;
+        }
+
+        // Data byte
+        if (in_sysex || running_status == 0)
+            return false;
+
+        data[data_count++] = byte;
+        if (data_count < data_expected)
+            return false;
+
+        msg.status = running_status;
+        msg.data1 = data[0];
+        msg.data2 = data_expected > 1 ? data[1] : 0;
+        data_count = 0;
+        if (running_status >= 0xF0)
+            running_status = 0; // No running status for system common
+        return true;
+    }
+};
+
+/**
+ * @brief Divides MIDI clock (24 PPQN) into sequencer steps and tracks tempo
+ */
+class PTMidiClock
+{
+private:
+    uint8_t ticks_per_step;
+    uint8_t tick_count;
+    uint32_t step_count;
+    uint32_t last_tick_time;
+    uint32_t tick_interval_us; // Smoothed, 0 until two ticks have arrived
+    uint8_t bunched_ticks;     // Ticks since last_tick_time stamped with (nearly) its time
+    bool running;
+
+public:
+    PTMidiClock(uint8_t ticks_per_step = 6) // 6 ticks = 16th notes
+        : ticks_per_step(ticks_per_step), tick_count(0), step_count(0),
+          last_tick_time(0), tick_interval_us(0), bunched_ticks(0), running(false)
+    {
+    }
+
+    void setTicksPerStep(uint8_t ticks) { ticks_per_step = ticks ? ticks : 1; }
+
+    void start()
+    {
+        tick_count = 0;
+        step_count = 0;
+        running = true;
+    }
+
+    void stop() { running = false; }
+    void resume() { running = true; }
+    bool isRunning() const { return running; }
+
+    /**
+     * @brief Handle one clock tick
+     *
+     * Ticks closer than MIN_TICK_INTERVAL_US (e.g. two 0xF8 bytes stamped
+     * by one PTMidiUart::poll()) give no interval of their own; the next
+     * interval is shared out among them instead.
+     *
+     * @return true if the tick starts a new step
+     */
+    bool tick(uint32_t now_us)
+    {
+        if (last_tick_time == 0)
+        {
+            last_tick_time = now_us;
+        }
+        else if (now_us - last_tick_time < EurorackMidi::MIN_TICK_INTERVAL_US)
+        {
+            if (bunched_ticks < 255)
+                bunched_ticks++;
+        }
+        else
+        {
+            uint32_t interval = (now_us - last_tick_time) / (bunched_ticks + 1u);
+            // Ignore gaps (clock stopped); otherwise smooth over ~8 ticks
+            if (interval < EurorackMidi::MAX_TICK_INTERVAL_US)
+            {
+                tick_interval_us = tick_interval_us ? tick_interval_us + ((int32_t)(interval - tick_interval_us) >> 3) : interval;
+            }
+            last_tick_time = now_us;
+            bunched_ticks = 0;
+        }
+
+        if (!running)
+            return false;
+
+        bool step = (tick_count == 0);
+        if (++tick_count >= ticks_per_step)
+            tick_count = 0;
+        if (step)
+            step_count++;
+        return step;
+    }
+
+    uint32_t getStepCount() const { return step_count; }
+    uint32_t getTickIntervalUs() const { return tick_interval_us; }
+
+    /**
+     * @brief Step length for PTSequencer::advance()
+     */
+    uint32_t getStepIntervalUs() const { return tick_interval_us * ticks_per_step; }
+
+    float getTempoBPM() const
+    {
+        return tick_interval_us ? 60000000.0f / (tick_interval_us * EurorackMidi::PPQN) : 0.0f;
+    }
+};
+
+/**
+ * @brief Transport-independent MIDI input posting typed events
+ */
+class PTMidiInput
+{
+protected:
+    PTMidiParser parser;
+    PTMidiClock clock;
+    PTEventQueue *event_queue;
+    uint8_t channel_filter;
+    uint32_t dropped_events;
+
+    void post(PTEventType type, uint32_t data, uint32_t timestamp)
+    {
+        if (!event_queue)
+            return;
+
+        PTEvent event(type, data);
+        event.timestamp = timestamp;
+        if (!event_queue->push(event))
+            dropped_events++;
+    }
+
+public:
+    PTMidiInput()
+        : event_queue(nullptr), channel_filter(EurorackMidi::OMNI), dropped_events(0)
+    {
+    }
+
+    void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
+
+    /**
+     * @brief Only accept channel messages on one channel (0-15), or OMNI
+     */
+    void setChannel(uint8_t channel) { channel_filter = channel; }
+
+    PTMidiClock &getClock() { return clock; }
+    uint32_t getDroppedEvents() const { return dropped_events; }
+
+    /**
+     * @brief Route one complete message to the event queue
+     */
+    void dispatch(const PTMidiMessage &msg, uint32_t timestamp)
+    {
+        uint8_t type = msg.type();
+        if (type < 0xF0 && channel_filter != EurorackMidi::OMNI && msg.channel() != channel_filter)
+            return;
+
+        switch (type)
+        {
+        case EurorackMidi::NOTE_ON:
+            post(msg.data2 ? PTEventType::MIDI_NOTE_ON : PTEventType::MIDI_NOTE_OFF,
+                 EurorackMidi::packEventData(msg.channel(), msg.data1, msg.data2), timestamp);
+            break;
+        case EurorackMidi::NOTE_OFF:
+            post(PTEventType::MIDI_NOTE_OFF, EurorackMidi::packEventData(msg.channel(), msg.data1, msg.data2), timestamp);
+            break;
+        case EurorackMidi::CONTROL_CHANGE:
+            post(PTEventType::MIDI_CONTROL_CHANGE, EurorackMidi::packEventData(msg.channel(), msg.data1, msg.data2), timestamp);
+            break;
+        case EurorackMidi::CLOCK:
+            if (clock.tick(timestamp))
+                post(PTEventType::MIDI_CLOCK, clock.getStepCount(), timestamp);
+            break;
+        case EurorackMidi::START:
+            clock.start();
+            post(PTEventType::MIDI_START, 0, timestamp);
+            break;
+        case EurorackMidi::CONTINUE:
+            clock.resume();
+            post(PTEventType::MIDI_CONTINUE, 0, timestamp);
+            break;
+        case EurorackMidi::STOP:
+            clock.stop();
+            post(PTEventType::MIDI_STOP, 0, timestamp);
+            break;
+        default:
+            break;
+        }
+    }
+
+    /**
+     * @brief Parse one 4-byte USB-MIDI event packet (cable/CIN + 3 bytes)
+     */
+    void processUsbPacket(const uint8_t packet[4], uint32_t timestamp)
+    {
+        // Bytes carried per Code Index Number; 0x0/0x1 are reserved
+        static const uint8_t CIN_LENGTH[16] = {0, 0, 2, 3, 3, 1, 2, 3, 3, 3, 3, 3, 2, 2, 3, 1};
+        processBytes(packet + 1, CIN_LENGTH[packet[0] & 0x0F], timestamp);
+    }
+
+    /**
+     * @brief Parse bytes straight from a receive buffer
+     */
+    void processBytes(const uint8_t *bytes, size_t length, uint32_t timestamp)
+    {
+        PTMidiMessage msg;
+        for (size_t i = 0; i < length; i++)
+        {
+            if (parser.parse(bytes[i], msg))
+                dispatch(msg, timestamp);
+        }
+    }
+};
+
+/**
+ * @brief MIDI over UART (31250 baud) with DMA receive and transmit
+ */
+class PTMidiUart : public PTMidiInput
+{
+public:
+    static const uint32_t RX_BUFFER_BITS = 8;
+    static const uint32_t RX_BUFFER_SIZE = 1 << RX_BUFFER_BITS;
+    static const uint32_t TX_BUFFER_SIZE = 128;
+
+private:
+    // DMA ring wrapping needs the buffer aligned to its size
+    alignas(RX_BUFFER_SIZE) uint8_t rx_buffer[RX_BUFFER_SIZE];
+    uint8_t tx_buffer[TX_BUFFER_SIZE];
+
+    uart_inst_t *uart;
+    uint tx_pin, rx_pin;
+    int rx_channel;
+    int tx_channel;
+    uint32_t rx_count;    // RX transfer count at the last poll; the DMA counts it down
+    uint32_t rx_received; // Bytes written by the DMA, wrapping
+    uint32_t rx_consumed; // Bytes handed to the parser, wrapping
+    uint32_t rx_overruns; // Bytes overwritten before poll() read them
+    uint32_t tx_head, tx_tail, tx_in_flight;
+    uint8_t tx_running_status;
+    uint32_t tx_overflows;
+
+    bool queueByte(uint8_t byte)
+    {
+        uint32_t next = (tx_head + 1) % TX_BUFFER_SIZE;
+        if (next == tx_tail)
+        {
+            tx_overflows++;
+            return false;
+        }
+        tx_buffer[tx_head] = byte;
+        tx_head = next;
+        return true;
+    }
+
+public:
+    PTMidiUart(uart_inst_t *uart, uint tx_pin, uint rx_pin)
+        : uart(uart), tx_pin(tx_pin), rx_pin(rx_pin), rx_channel(-1), tx_channel(-1),
+          rx_count(0xFFFFFFFF), rx_received(0), rx_consumed(0), rx_overruns(0), tx_head(0), tx_tail(0), tx_in_flight(0), tx_running_status(0), tx_overflows(0)
+    {
+    }
+
+    void init()
+    {
+        uart_init(uart, 31250);
+        gpio_set_function(tx_pin, GPIO_FUNC_UART);
+        gpio_set_function(rx_pin, GPIO_FUNC_UART);
+        uart_set_fifo_enabled(uart, true);
+
+        // RX: UART data register -> ring buffer, wrapping in hardware
+        rx_channel = dma_claim_unused_channel(true);
+        dma_channel_config rx_config = dma_channel_get_default_config(rx_channel);
+        channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx_config, false);
+        channel_config_set_write_increment(&rx_config, true);
+        channel_config_set_ring(&rx_config, true, RX_BUFFER_BITS);
+        channel_config_set_dreq(&rx_config, uart_get_dreq(uart, false));
+        dma_channel_configure(rx_channel, &rx_config, rx_buffer, &uart_get_hw(uart)->dr, 0xFFFFFFFF, true);
+
+        // TX: contiguous runs of the transmit queue -> UART data register
+        tx_channel = dma_claim_unused_channel(true);
+        dma_channel_config tx_config = dma_channel_get_default_config(tx_channel);
+        channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_8);
+        channel_config_set_read_increment(&tx_config, true);
+        channel_config_set_write_increment(&tx_config, false);
+        channel_config_set_dreq(&tx_config, uart_get_dreq(uart, true));
+        dma_channel_configure(tx_channel, &tx_config, &uart_get_hw(uart)->dr, tx_buffer, 0, false);
+    }
+
+    /**
+     * @brief Parse everything received since the last call and kick pending output
+     * @return Number of bytes parsed
+     */
+    size_t poll()
+    {
+        uint32_t now = time_us_32();
+
+        // The transfer count, unlike the write address, tells a full lap
+        // of the ring from no progress
+        uint32_t count = dma_channel_hw_addr(rx_channel)->transfer_count;
+        rx_received += rx_count - count;
+        rx_count = count;
+
+        uint32_t pending = rx_received - rx_consumed;
+        if (pending > RX_BUFFER_SIZE)
+        {
+            // Lapped: the oldest bytes are gone, so the parser's message in
+            // progress is too; resync on the next status byte
+            rx_overruns += pending - RX_BUFFER_SIZE;
+            parser.reset();
+            pending = RX_BUFFER_SIZE;
+        }
+        size_t total = pending;
+
+        // Zero-copy: hand the ring segments to the parser directly
+        uint32_t read = (rx_received - pending) & (RX_BUFFER_SIZE - 1);
+        if (read + pending > RX_BUFFER_SIZE)
+        {
+            processBytes(rx_buffer + read, RX_BUFFER_SIZE - read, now);
+            pending -= RX_BUFFER_SIZE - read;
+            read = 0;
+        }
+        processBytes(rx_buffer + read, pending, now);
+        rx_consumed = rx_received;
+
+        // Re-arm after ~2^32 bytes; the UART FIFO holds input meanwhile
+        if (!dma_channel_is_busy(rx_channel))
+        {
+            dma_channel_set_trans_count(rx_channel, 0xFFFFFFFF, true);
+            rx_count = 0xFFFFFFFF;
+        }
+
+        flush();
+        return total;
+    }
+
+    /**
+     * @brief Queue a message for output, using running status
+     * @return false, queuing nothing, if the whole message does not fit
+     */
+    bool send(const PTMidiMessage &msg)
+    {
+        if (msg.status >= 0xF8)
+            return queueByte(msg.status); // Realtime does not affect running status
+
+        uint32_t length = PTMidiParser::dataLength(msg.status);
+        bool with_status = msg.status != tx_running_status || msg.status >= 0xF0;
+        uint32_t room = (tx_tail + TX_BUFFER_SIZE - tx_head - 1) % TX_BUFFER_SIZE;
+        if (room < length + (with_status ? 1 : 0))
+        {
+            tx_overflows++;
+            return false;
+        }
+
+        if (with_status)
+            queueByte(msg.status);
+        tx_running_status = msg.status < 0xF0 ? msg.status : 0;
+        if (length > 0)
+            queueByte(msg.data1);
+        if (length > 1)
+            queueByte(msg.data2);
+        return true;
+    }
+
+    bool sendNoteOn(uint8_t channel, uint8_t note, uint8_t velocity)
+    {
+        return send({(uint8_t)(EurorackMidi::NOTE_ON | (channel & 0x0F)), (uint8_t)(note & 0x7F), (uint8_t)(velocity & 0x7F)});
+    }
+
+    bool sendNoteOff(uint8_t channel, uint8_t note)
+    {
+        // Note-on with velocity 0 keeps running status across on/off pairs
+        return send({(uint8_t)(EurorackMidi::NOTE_ON | (channel & 0x0F)), (uint8_t)(note & 0x7F), 0});
+    }
+
+    bool sendControlChange(uint8_t channel, uint8_t controller, uint8_t value)
+    {
+        return send({(uint8_t)(EurorackMidi::CONTROL_CHANGE | (channel & 0x0F)), (uint8_t)(controller & 0x7F), (uint8_t)(value & 0x7F)});
+    }
+
+    bool sendClock() { return send({EurorackMidi::CLOCK, 0, 0}); }
+
+    /**
+     * @brief Start a DMA transfer for queued output if the channel is idle
+     */
+    void flush()
+    {
+        if (tx_channel < 0 || dma_channel_is_busy(tx_channel))
+            return;
+
+        // Previous transfer finished
+        tx_tail = (tx_tail + tx_in_flight) % TX_BUFFER_SIZE;
+        tx_in_flight = 0;
+
+        if (tx_head == tx_tail)
+            return;
+
+        // One contiguous run per transfer; the wrapped remainder goes next time
+        tx_in_flight = (tx_head > tx_tail) ? tx_head - tx_tail : TX_BUFFER_SIZE - tx_tail;
+        dma_channel_transfer_from_buffer_now(tx_channel, tx_buffer + tx_tail, tx_in_flight);
+    }
+
+    /**
+     * @brief Messages dropped because the transmit queue had no room for them
+     */
+    uint32_t getTxOverflows() const { return tx_overflows; }
+
+    /**
+     * @brief Received bytes lost because poll() fell a full ring behind
+     */
+    uint32_t getRxOverruns() const { return rx_overruns; }
+};
+
+#endif // __EURORACK_MIDI_H__
@@ -0,0 +1,340 @@
+/**
+ * @file eurorack_modulation.h
+ * @brief Envelope and LFO generators for CV outputs
+ *
+ * Generators render blocks of signed Q15 samples at a fixed control
+ * rate chosen by the caller (e.g. 1kHz from a SimpleThread, or the
+ * sample rate of a streaming output). Unipolar envelopes use 0..32767,
+ * so EurorackUtils::Fixed::sampleToDAC() maps them onto 0V..+5V.
+ *
+ * Exponential segments are computed incrementally: each sample scales
+ * the remaining distance to an overshoot target by a per-segment
+ * coefficient, which is only recomputed when a time parameter changes.
+ */
+
+#ifndef __EURORACK_MODULATION_H__
+#define __EURORACK_MODULATION_H__
+
+#include "eurorack_utils.h"
+#include "eurorack_oscillators.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief ADSR / AD envelope generator with exponential segments
+ *
+ * Each segment reaches its target in exactly its configured time,
+ * whatever level it starts from, by aiming at a target placed beyond
+ * the real one (curve * span) and stopping when the real one is crossed.
+ */
+class PTEnvelope
+{
+public:
+    // Curve range. Towards 0 the coefficient goes to 0 and a segment ends
+    // after one sample; above MAX_CURVE the overshoot of a full-scale span
+    // no longer fits the int32 level.
+    static constexpr float MIN_CURVE = 1.0f / 64.0f;
+    static constexpr float MAX_CURVE = 4.0f;
+
+    enum Mode
+    {
+        ADSR, // Sustains while the gate is high
+        AD    // Runs attack then decay on every trigger, ignores gate length
+    };
+
+    enum Stage
+    {
+        IDLE,
+        ATTACK,
+        DECAY,
+        SUSTAIN,
+        RELEASE
+    };
+
+private:
+    static const int32_t FULL_SCALE = 1 << 28; // Internal level resolution
+
+    struct Segment
+    {
+        uint32_t coeff;     // Per-sample distance multiplier, Q32
+        uint32_t curve_q24; // Overshoot as a fraction of the span, Q24
+        uint32_t time_samples;
+    };
+
+    Mode mode;
+    Stage stage;
+    float sample_rate;
+    Segment attack, decay, release;
+    int32_t sustain_level;
+
+    int32_t level;
+    int32_t target;
+    int32_t overshoot;
+    uint32_t distance;     // |overshoot - level|
+    uint32_t end_distance; // |overshoot - target|
+    bool rising;
+    bool gate_high;
+
+    void configure(Segment &segment, float ms, float curve)
+    {
+        curve = EurorackUtils::Math::constrain(curve, MIN_CURVE, MAX_CURVE);
+        float samples = ms * sample_rate / 1000.0f;
+        segment.time_samples = samples < 1.0f ? 1 : (uint32_t)samples;
+        // Distance shrinks from (1 + curve) * span to curve * span in time_samples
+        double ratio = std::pow((double)curve / (1.0 + curve), 1.0 / segment.time_samples);
+        double coeff = std::floor(ratio * 4294967296.0 + 0.5);
+        segment.coeff = coeff > 4294967295.0 ? 0xFFFFFFFFu : (uint32_t)coeff;
+        // Place the end on the quantized coefficient's own curve, or the Q32
+        // rounding adds up to several samples over a long segment
+        double end = std::pow(segment.coeff / 4294967296.0, (double)segment.time_samples);
+        segment.curve_q24 = (uint32_t)std::ceil(end / (1.0 - end) * 16777216.0); // Round up so the segment ends on time
+    }
+
+    void enterSegment(Stage next, const Segment &segment, int32_t new_target)
+    {
+        stage = next;
+        target = new_target;
+        rising = target > level;
+        uint32_t span = rising ? (uint32_t)(target - level) : (uint32_t)(level - target);
+        end_distance = (uint32_t)(((uint64_t)span * segment.curve_q24) >> 24); // Integer only: runs inside process()
+        distance = span + end_distance;
+        overshoot = rising ? target + (int32_t)end_distance : target - (int32_t)end_distance;
+
+        if (span == 0)
+            finishSegment();
+    }
+
+    void finishSegment()
+    {
+        level = target;
+        switch (stage)
+        {
+        case ATTACK:
+            enterSegment(DECAY, decay, mode == AD ? 0 : sustain_level);
+            break;
+        case DECAY:
+            stage = (mode == AD) ? IDLE : SUSTAIN;
+            break;
+        case RELEASE:
+            stage = IDLE;
+            break;
+        default:
+            break;
+        }
+    }
+
+    inline void step()
+    {
+        // Rounded: truncating loses up to one LSB per sample, which ends long,
+        // shallow segments early
+        distance = (uint32_t)(((uint64_t)distance * coeffFor(stage) + 0x80000000u) >> 32);
+        if (distance <= end_distance)
+        {
+            finishSegment();
+            return;
+        }
+        level = rising ? overshoot - (int32_t)distance : overshoot + (int32_t)distance;
+    }
+
+    inline uint32_t coeffFor(Stage s) const
+    {
+        return s == ATTACK ? attack.coeff : (s == DECAY ? decay.coeff : release.coeff);
+    }
+
+public:
+    PTEnvelope(float sample_rate = 1000.0f, Mode mode = ADSR)
+        : mode(mode), stage(IDLE), sample_rate(sample_rate),
+          sustain_level(FULL_SCALE / 2), level(0), target(0), overshoot(0),
+          distance(0), end_distance(0), rising(false), gate_high(false)
+    {
+        setAttack(5.0f);
+        setDecay(200.0f);
+        setRelease(300.0f);
+    }
+
+    /**
+     * @brief Segment times in milliseconds
+     * @param curve Overshoot ratio, clamped to MIN_CURVE..MAX_CURVE: small
+     *              values give a strongly exponential shape, large values
+     *              approach a straight line
+     */
+    void setAttack(float ms, float curve = 0.3f) { configure(attack, ms, curve); }
+    void setDecay(float ms, float curve = 0.01f) { configure(decay, ms, curve); }
+    void setRelease(float ms, float curve = 0.01f) { configure(release, ms, curve); }
+
+    /**
+     * @brief Sustain level (0.0 - 1.0)
+     */
+    void setSustain(float sustain)
+    {
+        sustain_level = (int32_t)(EurorackUtils::Math::constrain(sustain, 0.0f, 1.0f) * FULL_SCALE);
+    }
+
+    void setMode(Mode new_mode) { mode = new_mode; }
+    Mode getMode() const { return mode; }
+    Stage getStage() const { return stage; }
+    bool isActive() const { return stage != IDLE; }
+
+    /**
+     * @brief Gate input: rising edge starts the attack, falling edge releases (ADSR)
+     */
+    void gate(bool high)
+    {
+        if (high && !gate_high)
+        {
+            enterSegment(ATTACK, attack, FULL_SCALE);
+        }
+        else if (!high && gate_high && mode == ADSR && stage != IDLE)
+        {
+            enterSegment(RELEASE, release, 0);
+        }
+        gate_high = high;
+    }
+
+    /**
+     * @brief Retrigger the attack regardless of gate state
+     */
+    void trigger()
+    {
+        enterSegment(ATTACK, attack, FULL_SCALE);
+    }
+
+    /**
+     * @brief Current output in Q15 (0 - 32767)
+     */
+    int16_t getOutput() const
+    {
+        int32_t out = level >> 13;
+        return (int16_t)(out > 32767 ? 32767 : out);
+    }
+
+    /**
+     * @brief Render a block of unipolar Q15 samples
+     */
+    void PT_TIME_CRITICAL(process)(int16_t *out, size_t count)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            if (stage == ATTACK || stage == DECAY || stage == RELEASE)
+                step();
+            out[i] = getOutput();
+        }
+    }
+};
+
+/**
+ * @brief Multi-shape LFO with free-running and tempo-synced rates
+ */
+class PTLFO : public PTOscillator
+{
+public:
+    enum Shape
+    {
+        SINE,
+        TRIANGLE,
+        SAW_UP,
+        SAW_DOWN,
+        SQUARE,
+        SAMPLE_HOLD
+    };
+
+private:
+    Shape shape;
+    int32_t depth; // Q15 output scale
+    uint32_t random_state;
+    int16_t held_value;
+
+    inline int32_t render(uint32_t p, bool wrapped)
+    {
+        switch (shape)
+        {
+        case SINE:
+        {
+            uint32_t index = p >> (32 - EurorackOscillators::SINE_TABLE_BITS);
+            int32_t frac = (p >> (32 - EurorackOscillators::SINE_TABLE_BITS - 15)) & 0x7FFF;
+            int32_t a = EurorackOscillators::SINE_TABLE[index];
+            int32_t b = EurorackOscillators::SINE_TABLE[index + 1];
+            return a + (((b - a) * frac) >> 15);
+        }
+        case TRIANGLE:
+        {
+            // Fold the ramp: 0 -> +1 -> 0 -> -1 -> 0 over one cycle
+            int32_t t = (int32_t)((p + 0x40000000u) >> 15) - 65536; // -65536..65535
+            int32_t tri = 32768 - (t < 0 ? -t : t);
+            return tri > 32767 ? 32767 : tri;
+        }
+        case SAW_UP:
+            return (int32_t)(p >> 16) - 32768;
+        case SAW_DOWN:
+            return 32767 - (int32_t)(p >> 16);
+        case SQUARE:
+            return p < 0x80000000u ? 32767 : -32768;
+        case SAMPLE_HOLD:
+            if (wrapped)
+            {
+                // xorshift32, one new value per cycle
+                random_state ^= random_state << 13;
+                random_state ^= random_state >> 17;
+                random_state ^= random_state << 5;
+                held_value = (int16_t)(random_state >> 16);
+            }
+            return held_value;
+        }
+        return 0;
+    }
+
+public:
+    PTLFO(float sample_rate = 1000.0f, float hz = 1.0f, Shape shape = SINE)
+        : PTOscillator(sample_rate, hz), shape(shape), depth(32767),
+          random_state(0x12345678u), held_value(0)
+    {
+    }
+
+    void setShape(Shape new_shape) { shape = new_shape; }
+    Shape getShape() const { return shape; }
+
+    /**
+     * @brief Output scale (0.0 - 1.0)
+     */
+    void setDepth(float new_depth)
+    {
+        depth = (int32_t)(EurorackUtils::Math::constrain(new_depth, 0.0f, 1.0f) * 32767.0f);
+    }
+
+    /**
+     * @brief Lock the rate to a tempo
+     * @param bpm Tempo in beats per minute
+     * @param beats_per_cycle LFO cycle length in beats (e.g. 4 = one bar of 4/4)
+     */
+    void setTempo(float bpm, float beats_per_cycle = 1.0f)
+    {
+        setFrequency(bpm / (60.0f * beats_per_cycle));
+    }
+
+    /**
+     * @brief Restart the cycle, e.g. on a clock or reset gate
+     */
+    void sync() { reset(0); }
+
+    /**
+     * @brief Render a block of bipolar Q15 samples
+     */
+    void PT_TIME_CRITICAL(process)(int16_t *out, size_t count)
+    {
+        uint32_t p = phase;
+        const uint32_t inc = increment;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            // p < inc only on the first sample of a new cycle
+            out[i] = (int16_t)((render(p, p < inc) * depth) >> 15);
+            p += inc;
+        }
+
+        phase = p;
+    }
+};
+
+#endif // __EURORACK_MODULATION_H__
@@ -0,0 +1,367 @@
+/**
+ * @file eurorack_mux.h
+ * @brief Panel pots behind 4051/4067 analog multiplexers on one ADC pin
+ *
+ * PTMuxPots scans up to 16 pots through one CD4051 (8:1) or CD4067
+ * (16:1) whose address lines are consecutive GPIOs and whose output
+ * feeds an ADC pin. Each pot takes two short interrupts: a repeating
+ * timer starts the conversion of the channel that has been settling, and
+ * the ADC FIFO interrupt collects the sample, switches the address to the
+ * next channel straight away, then filters and checks it. The next
+ * conversion comes a full settling time after the switch, so the mux
+ * output has recovered from the previous pot's voltage (crosstalk) before
+ * it is sampled. Nothing waits for the ADC inside an interrupt.
+ *
+ * The pots of one scan are converted back to back; the timer then idles
+ * until the next scan is due, every PT_MUX_SCAN_US (setScanInterval()).
+ * Panel pots need no more than about 1kHz, which for 16 pots is 32k
+ * short interrupts a second.
+ *
+ * The settling time needed depends on the source: after a full-scale
+ * step the node moves with tau = (wiper resistance + switch resistance)
+ * x (mux and ADC input capacitance, plus any filter capacitor).
+ * EurorackMux::settleTimeUs() gives the time to get within half an LSB.
+ *
+ * Each pot has a one-pole low-pass filter and a change threshold on the
+ * filtered value; a change beyond it pushes PTEventType::POT_CHANGE with
+ * the pot index. The first full scan primes the filters silently.
+ *
+ *         PTMuxPots<> pots(EurorackMux::Chip::CD4067, 2, 26);  // A0-A3 on GPIO 2-5, COM on ADC0
+ *         pots.setEventQueue(&global_event_queue);
+ *         pots.start();
+ *         ...
+ *         float depth = pots.getPosition(5);
+ *
+ * The scanner owns the ADC and its FIFO while running; stop() the scan
+ * around reads of other ADC inputs.
+ *
+ * The SIO that drives the address lines is out of reach of the DMA, so
+ * address sequencing cannot be chained in DMA.
+ */
+
+#ifndef __EURORACK_MUX_H__
+#define __EURORACK_MUX_H__
+
+#include "pico/stdlib.h"
+#include "hardware/adc.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+
+#include "pt_thread.h"
+#include "pt_time_critical.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#ifndef PT_MUX_CONVERSION_US
+#define PT_MUX_CONVERSION_US 2 // One ADC conversion: 96 cycles of the 48MHz ADC clock
+#endif
+
+#ifndef PT_MUX_SCAN_US
+#define PT_MUX_SCAN_US 1000 // Default time from one full scan to the next (1kHz)
+#endif
+
+namespace EurorackMux
+{
+    enum class Chip : uint8_t
+    {
+        CD4051, // 8 channels, address A/B/C
+        CD4067  // 16 channels, address S0-S3
+    };
+
+    constexpr uint channels(Chip chip) { return chip == Chip::CD4067 ? 16 : 8; }
+    constexpr uint addressBits(Chip chip) { return chip == Chip::CD4067 ? 4 : 3; }
+
+    /**
+     * @brief Settling time to within half an LSB after a full-scale step
+     * @param tau_us RC time constant seen by the mux output
+     * @param bits ADC resolution
+     */
+    inline uint32_t settleTimeUs(float tau_us, uint bits = 12)
+    {
+        return (uint32_t)ceilf(tau_us * logf((float)(2u << bits)));
+    }
+}
+
+/**
+ * @brief Timer-driven scan of the pots on one analog multiplexer
+ * @tparam MAX_POTS Pots scanned at most (16 fits a CD4067)
+ */
+template <size_t MAX_POTS = 16>
+class PTMuxPots
+{
+private:
+    EurorackMux::Chip chip;
+    uint address_pin;
+    uint32_t address_mask;
+    uint adc_pin;
+    uint adc_input;
+    uint pots;
+    uint32_t settle_us;
+    uint32_t scan_us;
+
+    repeating_timer_t timer;
+    bool running;
+
+    volatile uint current;    // Channel the mux is switched to
+    volatile bool converting; // Set by convert(), so a conversion left over from stop() is dropped
+    volatile uint32_t scans;
+    volatile uint32_t interrupts;
+
+    int32_t state[MAX_POTS]; // Filter state, 12-bit value << 4
+    volatile uint16_t raw[MAX_POTS];
+    volatile uint16_t values[MAX_POTS];
+    uint16_t reported[MAX_POTS];
+    uint8_t filter_shift;
+    uint16_t change_threshold;
+    uint32_t event_base;
+    PTEventQueue *event_queue;
+
+    static inline PTMuxPots *owner = nullptr; // Scanner running on the ADC
+
+    static bool PT_TIME_CRITICAL(onTimer)(repeating_timer_t *rt)
+    {
+        PTMuxPots *self = static_cast<PTMuxPots *>(rt->user_data);
+        // After the last pot, wait out the rest of the scan interval
+        rt->delay_us = -(int64_t)(self->current + 1 < self->pots ? self->getStepUs() : self->gapUs());
+        self->convert();
+        return true;
+    }
+
+    static void PT_TIME_CRITICAL(onAdcFifo)()
+    {
+        if (!owner)
+            return;
+        if (owner->converting)
+            owner->step();
+        else
+            adc_fifo_drain();
+    }
+
+    /**
+     * @brief Timer period from the last pot's conversion to the first pot's
+     */
+    uint32_t gapUs() const
+    {
+        uint32_t used = getStepUs() * (pots - 1);
+        return scan_us > used + getStepUs() ? scan_us - used : getStepUs();
+    }
+
+public:
+    /**
+     * @param address_pin First address GPIO (A0/S0); the others follow it
+     * @param adc_pin ADC GPIO (26-28) the mux output is wired to
+     * @param settle_us Minimum time from an address switch to the conversion
+     * @param pots Pots on channels 0.. (0: every channel)
+     */
+    PTMuxPots(EurorackMux::Chip chip, uint address_pin, uint adc_pin, uint32_t settle_us = 10, uint pots = 0,
+              bool auto_init = true)
+        : chip(chip), address_pin(address_pin),
+          address_mask(((1u << EurorackMux::addressBits(chip)) - 1) << address_pin), adc_pin(adc_pin),
+          adc_input(adc_pin >= 26 && adc_pin <= 29 ? adc_pin - 26 : 0), pots(pots), settle_us(settle_us),
+          scan_us(PT_MUX_SCAN_US), timer(), running(false), current(0), converting(false), scans(0), interrupts(0),
+          state(), raw(), values(), reported(), filter_shift(2), change_threshold(8), event_base(0),
+          event_queue(nullptr)
+    {
+        uint max_pots = EurorackMux::channels(chip) < MAX_POTS ? EurorackMux::channels(chip) : MAX_POTS;
+        if (this->pots == 0 || this->pots > max_pots)
+            this->pots = max_pots;
+
+        if (auto_init)
+        {
+            init();
+        }
+    }
+
+    ~PTMuxPots() { stop(); }
+
+    void init()
+    {
+        adc_init();
+        adc_gpio_init(adc_pin);
+        gpio_init_mask(address_mask);
+        gpio_set_dir_out_masked(address_mask);
+        gpio_put_masked(address_mask, 0);
+        current = 0;
+    }
+
+    /**
+     * @brief Start scanning: pots every settle_us + PT_MUX_CONVERSION_US, a full scan every scan interval
+     * @return false if no timer slot was free or another scanner has the ADC
+     */
+    bool start()
+    {
+        if (running)
+            return true;
+        if (owner)
+            return false;
+
+        static bool handler_installed = false;
+        if (!handler_installed)
+        {
+            irq_add_shared_handler(ADC_IRQ_FIFO, onAdcFifo, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            handler_installed = true;
+        }
+        adc_select_input(adc_input);
+        adc_fifo_setup(true, false, 1, false, false); // IRQ as soon as one sample is in
+        adc_fifo_drain();
+        owner = this;
+        adc_irq_set_enabled(true);
+        irq_set_enabled(ADC_IRQ_FIFO, true);
+
+        scans = 0;
+        interrupts = 0;
+        converting = false;
+        running = add_repeating_timer_us(-(int64_t)getStepUs(), onTimer, this, &timer);
+        if (!running)
+            stop();
+        return running;
+    }
+
+    void stop()
+    {
+        if (running)
+        {
+            cancel_repeating_timer(&timer);
+            running = false;
+        }
+        if (owner == this)
+        {
+            irq_set_enabled(ADC_IRQ_FIFO, false);
+            adc_irq_set_enabled(false);
+            adc_fifo_setup(false, false, 0, false, false);
+            adc_fifo_drain();
+            owner = nullptr;
+        }
+    }
+
+    /**
+     * @brief Start converting the settled channel; step() runs when the sample is in
+     *
+     * Called from the timer interrupt.
+     */
+    void PT_TIME_CRITICAL(convert)()
+    {
+        interrupts++;
+        converting = true;
+        hw_set_bits(&adc_hw->cs, ADC_CS_START_ONCE_BITS);
+    }
+
+    /**
+     * @brief One pot: take the sample from the FIFO, switch to the next channel, filter
+     *
+     * Called from the ADC FIFO interrupt.
+     */
+    void PT_TIME_CRITICAL(step)()
+    {
+        interrupts++;
+        converting = false;
+        uint16_t sample = adc_fifo_get();
+
+        // Switch first: the next channel settles while the rest runs
+        uint pot = current;
+        uint next = pot + 1 < pots ? pot + 1 : 0;
+        gpio_put_masked(address_mask, next << address_pin);
+        current = next;
+
+        raw[pot] = sample;
+        int32_t target = (int32_t)sample << 4;
+        bool priming = scans == 0;
+        if (priming)
+            state[pot] = target;
+        else
+            state[pot] += (target - state[pot]) >> filter_shift;
+
+        uint16_t value = (uint16_t)((state[pot] + 8) >> 4);
+        values[pot] = value;
+        if (priming)
+        {
+            reported[pot] = value;
+        }
+        else if (abs((int32_t)value - (int32_t)reported[pot]) > change_threshold)
+        {
+            reported[pot] = value;
+            if (event_queue)
+            {
+                event_queue->push(PTEvent(PTEventType::POT_CHANGE, event_base + pot));
+            }
+        }
+
+        if (next == 0)
+            scans++;
+    }
+
+    void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
+
+    /**
+     * @brief POT_CHANGE data of pot 0 (the rest follow), to tell several scanners apart
+     */
+    void setEventBase(uint32_t base) { event_base = base; }
+
+    /**
+     * @brief Filter strength: each sample moves the value by 1/2^shift of the difference (0: off)
+     */
+    void setFilter(uint8_t shift) { filter_shift = shift < 8 ? shift : 7; }
+
+    /**
+     * @brief Filtered change, in 12-bit counts, that pushes a POT_CHANGE event
+     */
+    void setThreshold(uint16_t threshold) { change_threshold = threshold; }
+
+    // ---- Values ----
+
+    /**
+     * @brief Filtered value, 12-bit
+     */
+    uint16_t getValue(uint pot) const { return pot < pots ? values[pot] : 0; }
+
+    /**
+     * @brief Latest unfiltered sample, 12-bit
+     */
+    uint16_t getRaw(uint pot) const { return pot < pots ? raw[pot] : 0; }
+
+    /**
+     * @brief Filtered value as 0.0-1.0
+     */
+    float getPosition(uint pot) const { return getValue(pot) / 4095.0f; }
+
+    // ---- Scan ----
+
+    uint getPotCount() const { return pots; }
+    uint32_t getSettleUs() const { return settle_us; }
+    uint32_t getStepUs() const { return settle_us + PT_MUX_CONVERSION_US; }
+
+    /**
+     * @brief Time from one full scan to the next; shorter than pots x getStepUs() scans back to back
+     *
+     * Takes effect from the next scan.
+     */
+    void setScanInterval(uint32_t us) { scan_us = us; }
+    uint32_t getScanInterval() const { return scan_us; }
+
+    /**
+     * @brief Time a full scan actually takes
+     */
+    uint32_t getScanUs() const { return getStepUs() * (pots - 1) + gapUs(); }
+
+    /**
+     * @brief Full scans per second
+     */
+    float getScanRate() const { return 1000000.0f / getScanUs(); }
+
+    /**
+     * @brief Timer and ADC interrupts taken since start(), two per pot
+     */
+    uint32_t getInterruptCount() const { return interrupts; }
+
+    /**
+     * @brief Full scans completed since start()
+     */
+    uint32_t getScanCount() const { return scans; }
+
+    bool isRunning() const { return running; }
+};
+
+#endif // __EURORACK_MUX_H__
@@ -0,0 +1,309 @@
+/**
+ * @file eurorack_oscillators.h
+ * @brief Fixed-point oscillators for CV and audio-rate outputs
+ *
+ * All oscillators are 32-bit phase accumulators producing signed Q15
+ * samples a whole block at a time. Pitch follows 1V/octave in Q16.16
+ * volts (see EurorackUtils::Fixed), so a PTCVInput reading can drive an
+ * oscillator without touching floating point:
+ *
+ *   osc.setPitch(cv_in.getPitchQ16());
+ *   osc.process(block, BLOCK_SIZE);
+ *
+ * Floating point is only used by the setup-time frequency helpers.
+ */
+
+#ifndef __EURORACK_OSCILLATORS_H__
+#define __EURORACK_OSCILLATORS_H__
+
+#include "eurorack_utils.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace EurorackOscillators
+{
+    const size_t SINE_TABLE_BITS = 8;
+    const size_t SINE_TABLE_SIZE = 1 << SINE_TABLE_BITS;
+
+    namespace detail
+    {
+        constexpr double sinSeries(double x)
+        {
+            double sum = x;
+            double term = x;
+            for (int n = 1; n < 16; n++)
+            {
+                term *= -x * x / ((2 * n) * (2 * n + 1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr std::array<int16_t, SINE_TABLE_SIZE + 1> makeSineTable()
+        {
+            std::array<int16_t, SINE_TABLE_SIZE + 1> table{};
+            const double pi = 3.14159265358979323846;
+            for (size_t i = 0; i <= SINE_TABLE_SIZE; i++)
+            {
+                // Reduce to [-pi, pi] so the series converges quickly
+                double x = 2.0 * pi * i / SINE_TABLE_SIZE;
+                if (x > pi)
+                    x -= 2.0 * pi;
+                double value = sinSeries(x) * 32767.0;
+                table[i] = (int16_t)(value < 0 ? value - 0.5 : value + 0.5);
+            }
+            return table;
+        }
+    }
+
+    /**
+     * @brief One sine cycle in Q15 plus a guard sample for interpolation (SRAM, read by PTLfo::process())
+     */
+    inline constexpr std::array<int16_t, SINE_TABLE_SIZE + 1> PT_TIME_CRITICAL_DATA(SINE_TABLE) =
+        detail::makeSineTable();
+}
+
+/**
+ * @brief Phase accumulator shared by all oscillator types
+ */
+class PTOscillator
+{
+protected:
+    uint32_t phase;
+    uint32_t increment;
+    uint32_t base_increment; // Increment at 0V pitch
+    float sample_rate;
+
+public:
+    PTOscillator(float sample_rate = 48000.0f, float base_hz = 261.63f)
+        : phase(0), increment(0), base_increment(0), sample_rate(sample_rate)
+    {
+        setBaseFrequency(base_hz);
+    }
+
+    /**
+     * @brief Set the frequency that corresponds to 0V pitch
+     */
+    void setBaseFrequency(float hz)
+    {
+        base_increment = EurorackUtils::Fixed::frequencyToIncrement(hz, sample_rate);
+        increment = base_increment;
+    }
+
+    /**
+     * @brief Set an absolute frequency, bypassing the pitch input
+     */
+    void setFrequency(float hz)
+    {
+        increment = EurorackUtils::Fixed::frequencyToIncrement(hz, sample_rate);
+    }
+
+    /**
+     * @brief Set pitch relative to the base frequency (1V/octave)
+     * @param pitch_q16 Pitch in Q16.16 volts, e.g. PTCVInput::getPitchQ16()
+     */
+    void setPitch(int32_t pitch_q16)
+    {
+        increment = EurorackUtils::Fixed::pitchToIncrement(base_increment, pitch_q16);
+    }
+
+    void setIncrement(uint32_t inc) { increment = inc; }
+    uint32_t getIncrement() const { return increment; }
+
+    void reset(uint32_t start_phase = 0) { phase = start_phase; }
+    uint32_t getPhase() const { return phase; }
+    float getSampleRate() const { return sample_rate; }
+};
+
+/**
+ * @brief Wavetable oscillator with linear interpolation
+ *
+ * The table holds (1 << table_bits) samples of one cycle followed by a
+ * copy of the first sample, so interpolation never wraps. The 15-bit
+ * interpolation fraction is taken from the phase bits below the index,
+ * which limits tables to MAX_TABLE_BITS.
+ */
+class PTWavetableOscillator : public PTOscillator
+{
+public:
+    static const uint32_t MIN_TABLE_BITS = 1;
+    static const uint32_t MAX_TABLE_BITS = 32 - 15;
+
+private:
+    const int16_t *table;
+    uint32_t index_shift;
+    uint32_t frac_shift;
+
+public:
+    PTWavetableOscillator(const int16_t *wavetable, uint32_t table_bits,
+                          float sample_rate = 48000.0f, float base_hz = 261.63f)
+        : PTOscillator(sample_rate, base_hz), table(nullptr), index_shift(32 - MIN_TABLE_BITS),
+          frac_shift(32 - MIN_TABLE_BITS - 15)
+    {
+        setTable(wavetable, table_bits);
+    }
+
+    /**
+     * @brief Switch to another table
+     * @return false, keeping the current table, if table_bits is outside
+     *         MIN_TABLE_BITS..MAX_TABLE_BITS; an oscillator without a
+     *         valid table renders silence
+     */
+    bool setTable(const int16_t *wavetable, uint32_t table_bits)
+    {
+        if (table_bits < MIN_TABLE_BITS || table_bits > MAX_TABLE_BITS)
+            return false;
+        table = wavetable;
+        index_shift = 32 - table_bits;
+        frac_shift = index_shift - 15;
+        return true;
+    }
+
+    bool hasTable() const { return table != nullptr; }
+
+    /**
+     * @brief Render a block of Q15 samples
+     */
+    void PT_TIME_CRITICAL(process)(int16_t *out, size_t count)
+    {
+        if (!table)
+        {
+            for (size_t i = 0; i < count; i++)
+                out[i] = 0;
+            return;
+        }
+
+        uint32_t p = phase;
+        const uint32_t inc = increment;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            uint32_t index = p >> index_shift;
+            int32_t frac = (p >> frac_shift) & 0x7FFF;
+            int32_t a = table[index];
+            int32_t b = table[index + 1];
+            out[i] = (int16_t)(a + (((b - a) * frac) >> 15));
+            p += inc;
+        }
+
+        phase = p;
+    }
+};
+
+/**
+ * @brief Sine oscillator backed by the shared compile-time sine table
+ */
+class PTSineOscillator : public PTWavetableOscillator
+{
+public:
+    PTSineOscillator(float sample_rate = 48000.0f, float base_hz = 261.63f)
+        : PTWavetableOscillator(EurorackOscillators::SINE_TABLE.data(),
+                                EurorackOscillators::SINE_TABLE_BITS,
+                                sample_rate, base_hz)
+    {
+    }
+};
+
+/**
+ * @brief Band-limited saw/square oscillator using PolyBLEP correction
+ *
+ * The naive waveform is corrected by a two-sample polynomial step
+ * residual around each discontinuity. The correction costs one
+ * reciprocal per block; samples away from an edge are a plain ramp.
+ */
+class PTPolyBLEPOscillator : public PTOscillator
+{
+public:
+    enum Shape
+    {
+        SAW,
+        SQUARE
+    };
+
+private:
+    Shape shape;
+    uint32_t pulse_width; // Phase of the falling edge for SQUARE
+
+    /**
+     * @brief PolyBLEP residual in Q15
+     * @param t Phase position relative to the discontinuity (top 16 bits)
+     * @param dt Phase increment (top 16 bits), non-zero
+     * @param recip (1 << 31) / dt
+     */
+    static inline int32_t polyBlep(uint32_t t, uint32_t dt, uint32_t recip)
+    {
+        if (t < dt)
+        {
+            // Just after the edge: 2x - x^2 - 1
+            int32_t x = (int32_t)((t * recip) >> 16);
+            return 2 * x - ((x * x) >> 15) - 32768;
+        }
+        if (t > 65535 - dt)
+        {
+            // Just before the edge: x^2 + 2x + 1, with x = (t - 1) / dt
+            int32_t x = -(int32_t)(((65536 - t) * recip) >> 16);
+            return ((x * x) >> 15) + 2 * x + 32768;
+        }
+        return 0;
+    }
+
+public:
+    PTPolyBLEPOscillator(Shape shape = SAW, float sample_rate = 48000.0f, float base_hz = 261.63f)
+        : PTOscillator(sample_rate, base_hz), shape(shape), pulse_width(0x80000000u)
+    {
+    }
+
+    void setShape(Shape new_shape) { shape = new_shape; }
+    Shape getShape() const { return shape; }
+
+    /**
+     * @brief Set pulse width for SQUARE (0x80000000 = 50%)
+     */
+    void setPulseWidth(uint32_t width) { pulse_width = width; }
+
+    /**
+     * @brief Render a block of Q15 samples
+     */
+    void PT_TIME_CRITICAL(process)(int16_t *out, size_t count)
+    {
+        uint32_t p = phase;
+        const uint32_t inc = increment;
+        const uint32_t dt = inc >> 16;
+        // Below ~0.7Hz at 48kHz the step is under one LSB; skip the correction
+        const uint32_t recip = dt ? (1u << 31) / dt : 0;
+
+        if (shape == SAW)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                uint32_t t = p >> 16;
+                int32_t value = (int32_t)t - 32768;
+                if (recip)
+                    value -= polyBlep(t, dt, recip);
+                out[i] = (int16_t)EurorackUtils::Math::clamp(value, (int32_t)-32768, (int32_t)32767);
+                p += inc;
+            }
+        }
+        else
+        {
+            const uint32_t width = pulse_width;
+            for (size_t i = 0; i < count; i++)
+            {
+                int32_t value = (p < width) ? 32767 : -32768;
+                if (recip)
+                {
+                    value += polyBlep(p >> 16, dt, recip);
+                    value -= polyBlep((p - width) >> 16, dt, recip);
+                }
+                out[i] = (int16_t)EurorackUtils::Math::clamp(value, (int32_t)-32768, (int32_t)32767);
+                p += inc;
+            }
+        }
+
+        phase = p;
+    }
+};
+
+#endif // __EURORACK_OSCILLATORS_H__
@@ -0,0 +1,176 @@
+/**
+ * @file eurorack_quantizer.h
+ * @brief Scale quantizer for 1V/octave pitch CV
+ *
+ * Scales are 12-bit masks where bit n enables the note n semitones above
+ * the root. Setting a scale or root rebuilds a 4096-entry table mapping
+ * every ADC code to its nearest allowed note, so quantizing a reading is
+ * a single lookup plus a hysteresis check.
+ */
+
+#ifndef __EURORACK_QUANTIZER_H__
+#define __EURORACK_QUANTIZER_H__
+
+#include "eurorack_utils.h"
+
+#include <array>
+#include <cstdint>
+
+namespace EurorackQuantizer
+{
+    const uint16_t CHROMATIC = 0x0FFF;
+    const uint16_t MAJOR = 0x0AB5;            // 0 2 4 5 7 9 11
+    const uint16_t MINOR = 0x05AD;            // 0 2 3 5 7 8 10
+    const uint16_t PENTATONIC_MAJOR = 0x0295; // 0 2 4 7 9
+    const uint16_t PENTATONIC_MINOR = 0x04A9; // 0 3 5 7 10
+
+    const uint8_t NOTE_COUNT = 121; // -5V to +5V in semitones
+    const uint16_t ADC_CODES = 4096;
+
+    namespace detail
+    {
+        constexpr std::array<int32_t, NOTE_COUNT> makeNotePitchTable()
+        {
+            std::array<int32_t, NOTE_COUNT> table{};
+            for (int n = 0; n < NOTE_COUNT; n++)
+            {
+                table[n] = (n * 65536 + 6) / 12 - 5 * 65536;
+            }
+            return table;
+        }
+    }
+
+    /**
+     * @brief Pitch of each note index in Q16.16 volts (note 0 = -5V), in SRAM for the quantizer
+     */
+    inline constexpr std::array<int32_t, NOTE_COUNT> PT_TIME_CRITICAL_DATA(NOTE_PITCH_Q16) =
+        detail::makeNotePitchTable();
+}
+
+/**
+ * @brief Table-driven pitch quantizer with root transposition and hysteresis
+ */
+class PTQuantizer
+{
+private:
+    uint8_t table[EurorackQuantizer::ADC_CODES]; // ADC code -> note index
+    uint16_t scale_mask;
+    uint8_t root;
+    uint16_t hysteresis; // In ADC codes
+    uint8_t current_note;
+
+    bool isAllowed(int note) const
+    {
+        return (scale_mask >> ((note - root + 12) % 12)) & 1;
+    }
+
+    void rebuild()
+    {
+        // Collect allowed notes in ascending order
+        uint8_t allowed[EurorackQuantizer::NOTE_COUNT];
+        int allowed_count = 0;
+        for (int n = 0; n < EurorackQuantizer::NOTE_COUNT; n++)
+        {
+            if (isAllowed(n))
+                allowed[allowed_count++] = (uint8_t)n;
+        }
+
+        // Sweep ADC codes, advancing to the next allowed note once it is closer.
+        // Positions are compared in units of 1/4095 semitone: code * 120 vs note * 4095.
+        int k = 0;
+        for (uint32_t code = 0; code < EurorackQuantizer::ADC_CODES; code++)
+        {
+            int32_t position = (int32_t)(code * 120);
+            while (k + 1 < allowed_count &&
+                   (allowed[k + 1] * 4095 - position) < (position - allowed[k] * 4095))
+            {
+                k++;
+            }
+            table[code] = allowed[k];
+        }
+    }
+
+public:
+    PTQuantizer(uint16_t scale = EurorackQuantizer::CHROMATIC, uint8_t root_note = 0, uint16_t hysteresis_codes = 8)
+        : scale_mask(0), root(0), hysteresis(hysteresis_codes), current_note(60)
+    {
+        setScale(scale, root_note);
+    }
+
+    /**
+     * @brief Select scale and root (rebuilds the lookup table)
+     * @param scale 12-bit note mask relative to the root, 0 = chromatic
+     * @param root_note Root semitone (0 = C ... 11 = B)
+     */
+    void setScale(uint16_t scale, uint8_t root_note = 0)
+    {
+        scale_mask = (scale & 0x0FFF) ? (scale & 0x0FFF) : EurorackQuantizer::CHROMATIC;
+        root = root_note % 12;
+        rebuild();
+    }
+
+    void setRoot(uint8_t root_note) { setScale(scale_mask, root_note); }
+
+    uint16_t getScale() const { return scale_mask; }
+    uint8_t getRoot() const { return root; }
+
+    /**
+     * @brief Distance in ADC codes the input must move past a note boundary
+     * before the output changes (~34 codes per semitone)
+     */
+    void setHysteresis(uint16_t codes) { hysteresis = codes; }
+
+    /**
+     * @brief Quantize an ADC reading to a note index (0-120, 60 = 0V)
+     */
+    uint8_t PT_TIME_CRITICAL(quantizeNote)(uint16_t adc_value)
+    {
+        adc_value &= 0x0FFF;
+        uint8_t note = table[adc_value];
+
+        if (note != current_note && hysteresis)
+        {
+            // Stay on the current note until the input is clearly past the boundary
+            uint16_t low = adc_value > hysteresis ? adc_value - hysteresis : 0;
+            uint16_t high = adc_value + hysteresis < 4095 ? adc_value + hysteresis : 4095;
+            if (table[low] == current_note || table[high] == current_note)
+                return current_note;
+        }
+
+        current_note = note;
+        return note;
+    }
+
+    /**
+     * @brief Quantize an ADC reading to Q16.16 volts
+     */
+    int32_t quantize(uint16_t adc_value)
+    {
+        return EurorackQuantizer::NOTE_PITCH_Q16[quantizeNote(adc_value)];
+    }
+
+    /**
+     * @brief Quantize a Q16.16 pitch (e.g. from a sequence or LFO)
+     * Stateless: hysteresis only applies to the continuous ADC input
+     */
+    int32_t quantizePitch(int32_t pitch_q16) const
+    {
+        int32_t offset = EurorackUtils::Math::clamp(pitch_q16 + 5 * EurorackUtils::Fixed::ONE_VOLT_Q16,
+                                                    (int32_t)0, 10 * EurorackUtils::Fixed::ONE_VOLT_Q16);
+        // 4095 / (10 * 65536) == 819 / 2^17
+        uint32_t code = ((uint32_t)offset * 819u) >> 17;
+        return EurorackQuantizer::NOTE_PITCH_Q16[table[code]];
+    }
+
+    /**
+     * @brief Quantize a voltage (setup and display helper)
+     */
+    float quantizeVolts(float volts) const
+    {
+        return EurorackUtils::Fixed::q16ToVolts(quantizePitch(EurorackUtils::Fixed::voltsToQ16(volts)));
+    }
+
+    uint8_t getCurrentNote() const { return current_note; }
+};
+
+#endif // __EURORACK_QUANTIZER_H__
@@ -0,0 +1,289 @@
+/**
+ * @file eurorack_sequencer.h
+ * @brief Multi-pattern step sequencer engine
+ *
+ * Patterns are arrays of packed 4-byte steps (note, gate length,
+ * velocity, probability/ratchet) held in place; switching or chaining
+ * patterns only moves an index, so nothing is copied at step time.
+ *
+ * The engine never reads the clock itself. The caller advances it at
+ * each step boundary and asks for the gate level at a time offset into
+ * the step, which keeps it independent of the timer and easy to drive
+ * from an internal tempo, an external clock or a MIDI clock.
+ */
+
+#ifndef __EURORACK_SEQUENCER_H__
+#define __EURORACK_SEQUENCER_H__
+
+#include "eurorack_utils.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief One sequencer step, packed into 4 bytes
+ */
+struct PTSequencerStep
+{
+    uint8_t note;     // Note index 0-120, 60 = 0V (see EurorackQuantizer::NOTE_PITCH_Q16)
+    uint8_t gate;     // Gate length as a fraction of the step (0 = rest, 255 = tie)
+    uint8_t velocity; // 0-127
+    uint8_t flags;    // Bits 0-3: probability, bits 4-6: ratchets - 1
+
+    static const uint8_t MAX_NOTE = 120; // Last entry of EurorackQuantizer::NOTE_PITCH_Q16 (+5V)
+    static const uint8_t PROBABILITY_MASK = 0x0F;
+    static const uint8_t RATCHET_SHIFT = 4;
+    static const uint8_t RATCHET_MASK = 0x70;
+
+    /**
+     * @brief Set the note, clamped to 0-MAX_NOTE
+     */
+    void setNote(uint8_t new_note) { note = new_note > MAX_NOTE ? MAX_NOTE : new_note; }
+
+    /**
+     * @brief Probability of the step firing, in sixteenths (1-16)
+     */
+    uint8_t getProbability() const { return (flags & PROBABILITY_MASK) + 1; }
+    void setProbability(uint8_t sixteenths)
+    {
+        sixteenths = EurorackUtils::Math::clamp<uint8_t>(sixteenths, 1, 16);
+        flags = (flags & ~PROBABILITY_MASK) | (sixteenths - 1);
+    }
+
+    /**
+     * @brief Number of gate repeats within the step (1-8)
+     */
+    uint8_t getRatchets() const { return ((flags & RATCHET_MASK) >> RATCHET_SHIFT) + 1; }
+    void setRatchets(uint8_t count)
+    {
+        count = EurorackUtils::Math::clamp<uint8_t>(count, 1, 8);
+        flags = (flags & ~RATCHET_MASK) | ((count - 1) << RATCHET_SHIFT);
+    }
+};
+
+static_assert(sizeof(PTSequencerStep) == 4, "PTSequencerStep must stay packed");
+
+/**
+ * @brief A pattern of up to MAX_STEPS steps with chaining information
+ */
+struct PTPattern
+{
+    static const uint8_t MAX_STEPS = 32;
+    static const uint8_t NO_CHAIN = 0xFF;
+
+    PTSequencerStep steps[MAX_STEPS];
+    uint8_t length;       // Active steps (1-MAX_STEPS)
+    uint8_t next_pattern; // Pattern to chain to, or NO_CHAIN to loop
+    uint8_t repeats;      // Plays before chaining (1-255)
+    uint8_t reserved;
+
+    /**
+     * @brief Reset to a full-probability, single-hit pattern on one note
+     */
+    void clear(uint8_t note = 60)
+    {
+        for (uint8_t i = 0; i < MAX_STEPS; i++)
+        {
+            steps[i].setNote(note);
+            steps[i].gate = 128;
+            steps[i].velocity = 100;
+            steps[i].flags = PTSequencerStep::PROBABILITY_MASK; // 16/16, 1 ratchet
+        }
+        length = 16;
+        next_pattern = NO_CHAIN;
+        repeats = 1;
+        reserved = 0;
+    }
+
+    /**
+     * @brief Check a pattern read back from storage before playing it
+     *
+     * An old or corrupt record must not index past the note table or run
+     * past the step array.
+     */
+    bool isValid() const
+    {
+        if (length < 1 || length > MAX_STEPS || repeats < 1)
+            return false;
+        for (uint8_t i = 0; i < MAX_STEPS; i++)
+        {
+            if (steps[i].note > PTSequencerStep::MAX_NOTE)
+                return false;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Result of evaluating one step
+ */
+struct PTStepEvent
+{
+    uint8_t pattern;
+    uint8_t step;
+    uint8_t note;
+    uint8_t velocity;
+    bool gate;          // Step fires (not a rest, passed its probability roll)
+    uint8_t ratchets;
+    uint32_t ratchet_us; // Length of each ratchet sub-step
+    uint32_t gate_us;    // High time within each ratchet sub-step
+};
+
+/**
+ * @brief Step sequencer engine over a bank of patterns
+ */
+class PTSequencer
+{
+public:
+    static const uint8_t MAX_PATTERNS = 8;
+
+    enum SwitchMode
+    {
+        NEXT_STEP,  // Jump to the queued pattern at the next step boundary
+        PATTERN_END // Wait until the current pattern has finished
+    };
+
+private:
+    PTPattern patterns[MAX_PATTERNS];
+    uint8_t current_pattern;
+    uint8_t current_step;
+    uint8_t repeat_count;
+    bool started;
+    volatile uint8_t queued_pattern;
+    volatile SwitchMode queued_mode;
+    uint32_t random_state;
+    PTStepEvent event;
+
+    uint32_t nextRandom()
+    {
+        // xorshift32
+        random_state ^= random_state << 13;
+        random_state ^= random_state >> 17;
+        random_state ^= random_state << 5;
+        return random_state;
+    }
+
+    void moveToNextStep()
+    {
+        if (!started)
+        {
+            started = true;
+            return;
+        }
+
+        uint8_t queued = queued_pattern;
+        if (queued != PTPattern::NO_CHAIN && queued_mode == NEXT_STEP)
+        {
+            jumpTo(queued);
+            return;
+        }
+
+        current_step++;
+        if (current_step < patterns[current_pattern].length)
+            return;
+
+        // Pattern finished: queued switch, then chain, then loop
+        current_step = 0;
+        repeat_count++;
+        if (queued != PTPattern::NO_CHAIN)
+        {
+            jumpTo(queued);
+        }
+        else if (repeat_count >= patterns[current_pattern].repeats &&
+                 patterns[current_pattern].next_pattern < MAX_PATTERNS)
+        {
+            current_pattern = patterns[current_pattern].next_pattern;
+            repeat_count = 0;
+        }
+    }
+
+    void jumpTo(uint8_t pattern)
+    {
+        current_pattern = pattern;
+        current_step = 0;
+        repeat_count = 0;
+        queued_pattern = PTPattern::NO_CHAIN;
+    }
+
+public:
+    PTSequencer()
+        : current_pattern(0), current_step(0), repeat_count(0), started(false),
+          queued_pattern(PTPattern::NO_CHAIN), queued_mode(PATTERN_END),
+          random_state(0x9E3779B9u), event()
+    {
+        for (uint8_t i = 0; i < MAX_PATTERNS; i++)
+        {
+            patterns[i].clear();
+        }
+    }
+
+    PTPattern &getPattern(uint8_t index) { return patterns[index % MAX_PATTERNS]; }
+    PTPattern &getCurrentPattern() { return patterns[current_pattern]; }
+    uint8_t getCurrentPatternIndex() const { return current_pattern; }
+    uint8_t getCurrentStep() const { return current_step; }
+
+    /**
+     * @brief Switch pattern at a step boundary
+     */
+    void queuePattern(uint8_t index, SwitchMode mode = PATTERN_END)
+    {
+        if (index >= MAX_PATTERNS)
+            return;
+        queued_mode = mode;
+        queued_pattern = index;
+    }
+
+    /**
+     * @brief Restart from the first step of a pattern on the next advance()
+     */
+    void reset(uint8_t pattern = 0)
+    {
+        jumpTo(pattern % MAX_PATTERNS);
+        started = false;
+    }
+
+    void setSeed(uint32_t seed) { random_state = seed ? seed : 1; }
+
+    /**
+     * @brief Move to the next step and evaluate it
+     * @param step_us Length of the step in microseconds
+     * @return Step event, valid until the next call
+     */
+    const PTStepEvent &advance(uint32_t step_us)
+    {
+        moveToNextStep();
+
+        const PTSequencerStep &step = patterns[current_pattern].steps[current_step];
+        uint8_t ratchets = step.getRatchets();
+
+        event.pattern = current_pattern;
+        event.step = current_step;
+        event.note = step.note;
+        event.velocity = step.velocity;
+        event.gate = step.gate != 0 && (nextRandom() & 0x0F) < step.getProbability();
+        event.ratchets = ratchets;
+        event.ratchet_us = step_us / ratchets;
+        event.gate_us = (uint32_t)(((uint64_t)event.ratchet_us * step.gate) >> 8);
+        if (step.gate == 255)
+            event.gate_us = event.ratchet_us; // Tie into the next step
+
+        return event;
+    }
+
+    /**
+     * @brief Gate level for the current step
+     * @param elapsed_us Time since the step started
+     */
+    bool gateAt(uint32_t elapsed_us) const
+    {
+        if (!event.gate || event.ratchet_us == 0)
+            return false;
+        if (event.ratchets == 1)
+            return elapsed_us < event.gate_us || event.gate_us == event.ratchet_us;
+        return (elapsed_us % event.ratchet_us) < event.gate_us;
+    }
+
+    const PTStepEvent &getLastEvent() const { return event; }
+};
+
+#endif // __EURORACK_SEQUENCER_H__
@@ -0,0 +1,436 @@
+/**
+ * @file eurorack_spi_adc.h
+ * @brief CV inputs on external SPI ADCs, scanned by DMA at a fixed rate
+ *
+ * PTSpiAdc reads MCP3208 (8 x 12-bit) and ADS8688 (8 x 16-bit, +/-10.24V
+ * inputs) class converters without CPU work per sample. Three DMA
+ * channels do the scan:
+ *  - pace: paced by the wrap DREQ of the PWM slice that also generates
+ *    CS, it writes the TX and RX channels' bits to the DMA multi-channel
+ *    trigger once per conversion
+ *  - TX: sends the next 4-byte command from a table of one command per
+ *    channel, wrapping over it with the DMA read ring
+ *  - RX: stores the 4 bytes clocked back into a ring buffer, wrapping
+ *    with the DMA write ring
+ *
+ * CS is the PWM output itself, low for the 32 clocks of a conversion and
+ * high for the rest of the period, so conversions land at an exact rate
+ * with no interrupts at all. poll() then decodes whatever arrived, from a
+ * thread like PTCVInput::update(): each channel keeps its latest sample
+ * and a thresholded value, and a change beyond the threshold pushes
+ * PTEventType::CV_CHANGE to the event queue, exactly as PTCVInput does.
+ *
+ *         PTSpiAdc<> adc(spi1, EurorackSpiAdc::Chip::MCP3208, 10, 11, 12, 13, 2000);
+ *         adc.setEventQueue(&global_event_queue);   // CV_CHANGE data: 4 + channel
+ *         ...
+ *         adc.poll();                               // From a thread, every few ms
+ *         float cv = adc.getVoltage(3);
+ *
+ * The CS pin's PWM slice belongs to the scanner; the other pin of that
+ * slice can only be a plain GPIO.
+ */
+
+#ifndef __EURORACK_SPI_ADC_H__
+#define __EURORACK_SPI_ADC_H__
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/pwm.h"
+#include "hardware/clocks.h"
+#include "hardware/gpio.h"
+
+#include "pt_thread.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+
+#ifndef PT_SPI_ADC_CS_MARGIN_NS
+#define PT_SPI_ADC_CS_MARGIN_NS 200 // CS low time beyond the 32 clocks: DMA trigger latency and CS setup
+#endif
+
+namespace EurorackSpiAdc
+{
+    const uint FRAME_BYTES = 4; // Every conversion is one 32-clock frame
+
+    enum class Chip : uint8_t
+    {
+        MCP3208, // 8 x 12-bit, single-ended 0-Vref, up to ~1MHz SPI at 3.3V
+        ADS8688  // 8 x 16-bit, +/-10.24V default range, up to 17MHz SPI
+    };
+
+    struct ChipInfo
+    {
+        uint8_t channels;
+        uint8_t bits;      // Resolution
+        uint8_t spi_mode;  // CPOL << 1 | CPHA
+        uint8_t latency;   // Frames between a channel's command and its result
+        uint32_t max_baud;
+        uint32_t cs_high_ns; // Minimum CS high time between conversions
+        float min_volts;     // Voltage at code 0 (after the input stage for the MCP3208)
+        float max_volts;     // Voltage at full scale
+    };
+
+    constexpr ChipInfo chipInfo(Chip chip)
+    {
+        return chip == Chip::ADS8688 ? ChipInfo{8, 16, 1, 1, 17000000, 500, -10.24f, 10.24f}
+                                     : ChipInfo{8, 12, 0, 0, 1000000, 500, -5.0f, 5.0f};
+    }
+
+    /**
+     * @brief 32-bit frame converting one channel, first byte in the top bits
+     */
+    constexpr uint32_t commandFrame(Chip chip, uint8_t channel)
+    {
+        switch (chip)
+        {
+        case Chip::ADS8688:
+            // MAN_Ch_n: manual channel select; its result comes out in the next frame
+            return (0xC000u | ((uint32_t)(channel & 7) << 10)) << 16;
+        case Chip::MCP3208:
+        default:
+            // Start bit, single-ended, D2 | D1 D0; B11..B8 and B7..B0 come back in bytes 1 and 2
+            return ((0x06u | ((channel & 7u) >> 2)) << 24) | (((uint32_t)(channel & 3) << 6) << 16);
+        }
+    }
+
+    /**
+     * @brief Sample in a received frame, scaled to 16 bits
+     */
+    inline uint16_t decodeFrame(Chip chip, const volatile uint8_t *frame)
+    {
+        if (chip == Chip::ADS8688)
+            return (uint16_t)((frame[2] << 8) | frame[3]);
+        return (uint16_t)((((frame[1] & 0x0Fu) << 8) | frame[2]) << 4);
+    }
+}
+
+/**
+ * @brief Fixed-rate round-robin scan of one external SPI ADC
+ * @tparam RING_BITS Log2 of the receive ring size in bytes (4 bytes per sample)
+ */
+template <uint RING_BITS = 10>
+class PTSpiAdc
+{
+    static_assert(RING_BITS >= 5 && RING_BITS <= 15, "PTSpiAdc ring must hold 8 to 8192 samples");
+
+public:
+    /**
+     * @brief One channel with the PTCVInput read interface
+     */
+    class Input
+    {
+    private:
+        PTSpiAdc *adc;
+        uint8_t channel;
+
+    public:
+        Input(PTSpiAdc *adc, uint8_t channel) : adc(adc), channel(channel) {}
+
+        uint16_t getValue() const { return adc->getValue(channel); }
+        uint16_t getRaw() const { return adc->getRaw(channel); }
+        float getVoltage() const { return adc->getVoltage(channel); }
+    };
+
+private:
+    static const uint32_t RING_SIZE = 1u << RING_BITS;
+    static const uint32_t RING_FRAMES = RING_SIZE / EurorackSpiAdc::FRAME_BYTES;
+    static const uint MAX_CHANNELS = 8;
+
+    alignas(RING_SIZE) volatile uint8_t ring[RING_SIZE];
+    alignas(MAX_CHANNELS * EurorackSpiAdc::FRAME_BYTES) uint8_t commands[MAX_CHANNELS * EurorackSpiAdc::FRAME_BYTES];
+
+    spi_inst_t *spi;
+    EurorackSpiAdc::Chip chip;
+    EurorackSpiAdc::ChipInfo info;
+    uint sck_pin;
+    uint mosi_pin;
+    uint miso_pin;
+    uint cs_pin;
+    uint channels;
+    uint32_t scan_hz;
+    uint32_t baud;
+
+    uint pwm_slice;
+    uint32_t sample_hz;
+    uint32_t trigger_mask; // Read by the pace channel
+
+    int pace_channel;
+    int tx_channel;
+    int rx_channel;
+
+    // Reader side
+    uint32_t read_offset;
+    uint32_t decoded;  // Frames taken out of the ring, including skipped and dropped ones
+    uint32_t armed;    // Pace transfers in earlier arms of the pace channel
+    uint32_t skip;     // Frames before the first valid result
+    uint32_t samples;  // Samples decoded
+    uint32_t overruns; // poll() calls that found the ring overwritten
+
+    uint16_t raw[MAX_CHANNELS];
+    uint16_t values[MAX_CHANNELS];
+    uint16_t change_threshold;
+    uint32_t event_base;
+    PTEventQueue *event_queue;
+
+    /**
+     * @brief Conversions triggered so far (wraps)
+     */
+    uint32_t conversionsStarted() const
+    {
+        return armed + (0xFFFFFFFFu - dma_channel_hw_addr(pace_channel)->transfer_count);
+    }
+
+    void decodeFrame(uint32_t offset)
+    {
+        if (skip)
+        {
+            skip--;
+            return;
+        }
+
+        uint channel = (offset / EurorackSpiAdc::FRAME_BYTES + channels - info.latency) & (channels - 1);
+        uint16_t sample = EurorackSpiAdc::decodeFrame(chip, &ring[offset]);
+        raw[channel] = sample;
+        samples++;
+
+        // Same change detection as PTCVInput::update()
+        if (abs((int32_t)sample - (int32_t)values[channel]) > change_threshold)
+        {
+            values[channel] = sample;
+            if (event_queue)
+            {
+                event_queue->push(PTEvent(PTEventType::CV_CHANGE, event_base + channel));
+            }
+        }
+    }
+
+public:
+    /**
+     * @param cs_pin Driven by its PWM slice, not by the SPI
+     * @param scan_hz Full scans (every channel once) per second; limited by the chip's timing
+     * @param channels Channels scanned from 0, rounded up to 1, 2, 4 or 8 (0: all)
+     * @param threshold Change threshold in 16-bit counts (800 = PTCVInput's 50 of 4096)
+     */
+    PTSpiAdc(spi_inst_t *spi, EurorackSpiAdc::Chip chip, uint sck_pin, uint mosi_pin, uint miso_pin, uint cs_pin,
+             uint32_t scan_hz, uint channels = 0, uint32_t baud = 0, uint16_t threshold = 800, bool auto_init = true)
+        : ring(), commands(), spi(spi), chip(chip), info(EurorackSpiAdc::chipInfo(chip)), sck_pin(sck_pin),
+          mosi_pin(mosi_pin), miso_pin(miso_pin), cs_pin(cs_pin), channels(1), scan_hz(scan_hz), baud(baud),
+          pwm_slice(pwm_gpio_to_slice_num(cs_pin)), sample_hz(0), trigger_mask(0), pace_channel(-1),
+          tx_channel(-1), rx_channel(-1), read_offset(0), decoded(0), armed(0), skip(0), samples(0),
+          overruns(0), raw(), values(), change_threshold(threshold), event_base(4), event_queue(nullptr)
+    {
+        // The command table is a DMA read ring, so its size is a power of two
+        if (channels == 0 || channels > info.channels)
+            channels = info.channels;
+        while (this->channels < channels)
+            this->channels <<= 1;
+        if (this->scan_hz == 0)
+            this->scan_hz = 1;
+        if (this->baud == 0 || this->baud > info.max_baud)
+            this->baud = info.max_baud;
+
+        if (auto_init)
+        {
+            init();
+        }
+    }
+
+    ~PTSpiAdc()
+    {
+        if (pace_channel >= 0)
+        {
+            pwm_set_enabled(pwm_slice, false);
+            dma_channel_abort(pace_channel);
+            dma_channel_abort(tx_channel);
+            dma_channel_abort(rx_channel);
+            dma_channel_unclaim(pace_channel);
+            dma_channel_unclaim(tx_channel);
+            dma_channel_unclaim(rx_channel);
+        }
+    }
+
+    void init()
+    {
+        baud = spi_init(spi, baud);
+        spi_cpol_t cpol = (info.spi_mode & 2) ? SPI_CPOL_1 : SPI_CPOL_0;
+        spi_cpha_t cpha = (info.spi_mode & 1) ? SPI_CPHA_1 : SPI_CPHA_0;
+        spi_set_format(spi, 8, cpol, cpha, SPI_MSB_FIRST);
+        gpio_set_function(sck_pin, GPIO_FUNC_SPI);
+        gpio_set_function(mosi_pin, GPIO_FUNC_SPI);
+        gpio_set_function(miso_pin, GPIO_FUNC_SPI);
+
+        // The TX ring wraps over the first `channels` commands
+        for (uint c = 0; c < MAX_CHANNELS; c++)
+        {
+            uint32_t frame = EurorackSpiAdc::commandFrame(chip, (uint8_t)c);
+            for (uint b = 0; b < EurorackSpiAdc::FRAME_BYTES; b++)
+            {
+                commands[c * EurorackSpiAdc::FRAME_BYTES + b] = (uint8_t)(frame >> (8 * (3 - b)));
+            }
+        }
+        uint command_bits = 2; // log2(FRAME_BYTES)
+        while ((1u << command_bits) < channels * EurorackSpiAdc::FRAME_BYTES)
+            command_bits++;
+
+        // CS period: 32 clocks plus margin low, then the chip's minimum high time
+        uint32_t sys_hz = clock_get_hz(clk_sys);
+        uint64_t cs_low_ns = 32ull * 1000000000ull / baud + PT_SPI_ADC_CS_MARGIN_NS;
+        uint64_t max_sample_hz = 1000000000ull / (cs_low_ns + info.cs_high_ns);
+        uint64_t wanted_hz = (uint64_t)scan_hz * channels;
+        if (wanted_hz > max_sample_hz)
+            wanted_hz = max_sample_hz;
+
+        uint32_t period = (uint32_t)(sys_hz / wanted_hz);
+        uint32_t div = (period + 65535) / 65536;
+        if (div < 1)
+            div = 1;
+        if (div > 255)
+            div = 255;
+        uint32_t top = period / div - 1;
+        if (top > 65535)
+            top = 65535;
+        uint32_t level = (uint32_t)((cs_low_ns * sys_hz / div + 999999999ull) / 1000000000ull);
+        sample_hz = sys_hz / (div * (top + 1));
+
+        // RX: SPI data register -> sample ring, 4 bytes per trigger
+        rx_channel = dma_claim_unused_channel(true);
+        dma_channel_config rx_config = dma_channel_get_default_config(rx_channel);
+        channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx_config, false);
+        channel_config_set_write_increment(&rx_config, true);
+        channel_config_set_ring(&rx_config, true, RING_BITS);
+        channel_config_set_dreq(&rx_config, spi_get_dreq(spi, false));
+        dma_channel_configure(rx_channel, &rx_config, ring, &spi_get_hw(spi)->dr, EurorackSpiAdc::FRAME_BYTES, false);
+
+        // TX: next command of the table -> SPI data register, 4 bytes per trigger
+        tx_channel = dma_claim_unused_channel(true);
+        dma_channel_config tx_config = dma_channel_get_default_config(tx_channel);
+        channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_8);
+        channel_config_set_read_increment(&tx_config, true);
+        channel_config_set_write_increment(&tx_config, false);
+        channel_config_set_ring(&tx_config, false, command_bits);
+        channel_config_set_dreq(&tx_config, spi_get_dreq(spi, true));
+        dma_channel_configure(tx_channel, &tx_config, &spi_get_hw(spi)->dr, commands, EurorackSpiAdc::FRAME_BYTES, false);
+
+        // Pace: one trigger of TX and RX per PWM wrap, i.e. per CS falling edge
+        pace_channel = dma_claim_unused_channel(true);
+        trigger_mask = (1u << tx_channel) | (1u << rx_channel);
+        dma_channel_config pace_config = dma_channel_get_default_config(pace_channel);
+        channel_config_set_transfer_data_size(&pace_config, DMA_SIZE_32);
+        channel_config_set_read_increment(&pace_config, false);
+        channel_config_set_write_increment(&pace_config, false);
+        channel_config_set_dreq(&pace_config, pwm_get_dreq(pwm_slice));
+        dma_channel_configure(pace_channel, &pace_config, &dma_hw->multi_channel_trigger, &trigger_mask,
+                              0xFFFFFFFF, true);
+
+        read_offset = 0;
+        decoded = 0;
+        armed = 0;
+        skip = info.latency;
+
+        // CS: inverted PWM output, low while the counter is below the level
+        uint cs_channel = pwm_gpio_to_channel(cs_pin);
+        pwm_config config = pwm_get_default_config();
+        pwm_config_set_clkdiv_int(&config, div);
+        pwm_config_set_wrap(&config, (uint16_t)top);
+        pwm_config_set_output_polarity(&config, cs_channel == 0, cs_channel == 1);
+        gpio_set_function(cs_pin, GPIO_FUNC_PWM);
+        pwm_init(pwm_slice, &config, false);
+        pwm_set_chan_level(pwm_slice, cs_channel, (uint16_t)level);
+        pwm_set_enabled(pwm_slice, true);
+    }
+
+    void setEventQueue(PTEventQueue *queue) { event_queue = queue; }
+
+    /**
+     * @brief CV_CHANGE event data of channel 0 (the rest follow); default 4,
+     *        after the RP2040's own ADC inputs 0-3
+     */
+    void setEventBase(uint32_t base) { event_base = base; }
+
+    void setThreshold(uint16_t threshold) { change_threshold = threshold; }
+
+    /**
+     * @brief Decode every sample received since the last call
+     * @return Samples taken from the ring
+     *
+     * Call at least every getRingSamples() / getSampleRate() seconds; a
+     * later call finds the ring overwritten, counts an overrun and resumes
+     * with the newest samples.
+     */
+    size_t poll()
+    {
+        uint32_t write = (dma_channel_hw_addr(rx_channel)->write_addr - (uint32_t)(uintptr_t)ring) & (RING_SIZE - 1);
+        write &= ~(EurorackSpiAdc::FRAME_BYTES - 1);
+
+        uint32_t started = conversionsStarted();
+        if ((int32_t)(started - decoded) > (int32_t)RING_FRAMES)
+        {
+            overruns++;
+            decoded = started;
+            read_offset = write;
+        }
+
+        size_t count = 0;
+        while (read_offset != write)
+        {
+            decodeFrame(read_offset);
+            read_offset = (read_offset + EurorackSpiAdc::FRAME_BYTES) & (RING_SIZE - 1);
+            count++;
+        }
+        decoded += (uint32_t)count;
+
+        // Re-arm after ~2^32 conversions; the scan pauses until then
+        if (!dma_channel_is_busy(pace_channel))
+        {
+            armed += 0xFFFFFFFFu;
+            dma_channel_set_trans_count(pace_channel, 0xFFFFFFFF, true);
+        }
+        return count;
+    }
+
+    // ---- Values (PTCVInput interface, per channel) ----
+
+    /**
+     * @brief Value as of the last change beyond the threshold, 16-bit
+     */
+    uint16_t getValue(uint channel) const { return channel < channels ? values[channel] : 0; }
+
+    /**
+     * @brief Latest sample, 16-bit
+     */
+    uint16_t getRaw(uint channel) const { return channel < channels ? raw[channel] : 0; }
+
+    float getVoltage(uint channel) const
+    {
+        return info.min_volts + getValue(channel) * ((info.max_volts - info.min_volts) / 65535.0f);
+    }
+
+    Input input(uint8_t channel) { return Input(this, channel); }
+
+    // ---- Scan ----
+
+    uint getChannelCount() const { return channels; }
+    uint32_t getBaudrate() const { return baud; }
+
+    /**
+     * @brief Conversions per second over all channels, after the chip and PWM limits
+     */
+    uint32_t getSampleRate() const { return sample_hz; }
+
+    float getScanRate() const { return (float)sample_hz / channels; }
+
+    static constexpr uint32_t getRingSamples() { return RING_FRAMES; }
+
+    /**
+     * @brief PWM slice generating CS and pacing the scan
+     */
+    uint getPwmSlice() const { return pwm_slice; }
+
+    uint32_t getSampleCount() const { return samples; }
+    uint32_t getOverrunCount() const { return overruns; }
+};
+
+#endif // __EURORACK_SPI_ADC_H__
@@ -0,0 +1,446 @@
+/**
+ * @file eurorack_spi_dac.h
+ * @brief CV outputs on external SPI DACs, one DMA-driven frame per update
+ *
+ * PTSpiDac drives MCP4822/MCP4922 (2 x 12-bit) and DAC8564 (4 x 16-bit)
+ * class converters. Channel levels are staged with the same
+ * setVoltage()/setLevel() calls as PTCVOutput; update() then sends every
+ * changed channel in one frame and pulses LDAC, so all outputs move at
+ * the same instant (a pitch CV and its gate-synchronised partner never
+ * disagree for a word time).
+ *
+ * Transfers run on two DMA channels (TX words, RX drain). With a single
+ * 16-bit chip whose CS is the SPI's own CSn pin, the SPI frames every
+ * word itself and the whole frame is one DMA transfer. Otherwise (24-bit
+ * words, several chips) CS is a GPIO and the next word is started from
+ * the RX completion interrupt, a few cycles of work per channel.
+ *
+ * Without an LDAC pin, MCP48x2 channels change as each word arrives and
+ * DAC8564 chips load all their channels with the last word they get.
+ *
+ *         PTSpiDac<> dac(spi0, EurorackSpiDac::Chip::DAC8564, 18, 19, 17, 20);
+ *         dac.setVoltage(0, pitch);
+ *         dac.setVoltage(1, mod);
+ *         dac.update();                        // One frame, one LDAC pulse
+ */
+
+#ifndef __EURORACK_SPI_DAC_H__
+#define __EURORACK_SPI_DAC_H__
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#include "hardware/gpio.h"
+
+#include "pt_time_critical.h"
+#include "eurorack_utils.h"
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef PT_SPI_DAC_LDAC_CYCLES
+#define PT_SPI_DAC_LDAC_CYCLES 16 // LDAC low time, cycles (>= 100ns for the MCP4822 at 133MHz)
+#endif
+
+namespace EurorackSpiDac
+{
+    const uint NO_PIN = UINT_MAX;
+
+    enum class Chip : uint8_t
+    {
+        MCP4822, // 2 x 12-bit, internal 2.048V reference, 16-bit words
+        MCP4922, // 2 x 12-bit, external reference, 16-bit words
+        DAC8564  // 4 x 16-bit, 24-bit words, address pins A1/A0
+    };
+
+    struct ChipInfo
+    {
+        uint8_t channels;
+        uint8_t bits;      // Resolution
+        uint8_t word_bits; // Command word length
+        uint8_t spi_mode;  // CPOL << 1 | CPHA
+        uint32_t max_baud;
+    };
+
+    constexpr ChipInfo chipInfo(Chip chip)
+    {
+        return chip == Chip::DAC8564 ? ChipInfo{4, 16, 24, 1, 50000000}
+                                     : ChipInfo{2, 12, 16, 0, 20000000};
+    }
+
+    /**
+     * @brief Command word writing one channel
+     * @param address Chip address on a shared CS (DAC8564 A1/A0), 0 otherwise
+     * @param level 16-bit level; low bits are dropped on 12-bit chips
+     * @param load_all DAC8564: update every channel of the chip with this word
+     */
+    constexpr uint32_t commandWord(Chip chip, uint8_t address, uint8_t channel, uint16_t level, bool load_all)
+    {
+        switch (chip)
+        {
+        case Chip::MCP4822:
+            // A/B, gain 2x (0-4.096V), active
+            return ((uint32_t)(channel & 1) << 15) | (1u << 12) | (level >> 4);
+        case Chip::MCP4922:
+            // A/B, unbuffered reference, gain 1x, active
+            return ((uint32_t)(channel & 1) << 15) | (1u << 13) | (1u << 12) | (level >> 4);
+        case Chip::DAC8564:
+        default:
+            // A1 A0 | LD1 LD0 (00 store, 10 load all) | 0 | DAC select | PD0=0 | data
+            return ((uint32_t)(address & 3) << 22) | ((load_all ? 2u : 0u) << 20) |
+                   ((uint32_t)(channel & 3) << 17) | level;
+        }
+    }
+
+    /**
+     * @brief Whether a GPIO is the hardware CSn of an SPI instance
+     */
+    constexpr bool isSpiCsPin(uint gpio, uint spi_index)
+    {
+        return gpio < 30 && (gpio % 4) == 1 && ((gpio / 8) % 2) == spi_index;
+    }
+}
+
+/**
+ * @brief CV outputs on one SPI bus of identical DAC chips
+ * @tparam MAX_CHANNELS Channels over all chips
+ */
+template <size_t MAX_CHANNELS = 8>
+class PTSpiDac
+{
+public:
+    /**
+     * @brief One channel with the PTCVOutput interface; changes go out on update()
+     */
+    class Output
+    {
+    private:
+        PTSpiDac *dac;
+        uint8_t channel;
+
+    public:
+        Output(PTSpiDac *dac, uint8_t channel) : dac(dac), channel(channel) {}
+
+        void setVoltage(float voltage) { dac->setVoltage(channel, voltage); }
+        void setLevel(uint16_t level) { dac->setLevel(channel, level); }
+        uint16_t getLevel() const { return dac->getLevel(channel); }
+        float getVoltage() const { return dac->getVoltage(channel); }
+    };
+
+private:
+    static const size_t MAX_WORD_BYTES = 3;
+
+    spi_inst_t *spi;
+    EurorackSpiDac::Chip chip;
+    EurorackSpiDac::ChipInfo info;
+    uint sck_pin;
+    uint mosi_pin;
+    uint cs_pin;
+    uint ldac_pin;
+    uint chips;
+    uint32_t baud;
+    bool hardware_cs;
+
+    uint16_t levels[MAX_CHANNELS];
+    uint32_t dirty; // Bit per channel staged since the last frame
+
+    // Frame being sent: 16-bit words for hardware CS, MSB-first bytes otherwise
+    uint16_t words[MAX_CHANNELS];
+    uint8_t bytes[MAX_CHANNELS * MAX_WORD_BYTES];
+    uint8_t word_cs[MAX_CHANNELS];
+    uint32_t word_count;
+    volatile uint32_t word_index;
+    volatile bool busy;
+    uint32_t rx_dummy;
+
+    int tx_channel;
+    int rx_channel;
+
+    volatile uint32_t frames;
+    uint32_t skipped;
+
+    static inline PTSpiDac *owners[NUM_DMA_CHANNELS];
+
+    uint channelCount() const { return info.channels * chips; }
+
+    uint chipCs(uint chip_index) const
+    {
+        // MCP48x2: one CS per chip on consecutive pins; DAC8564: shared CS, addressed
+        return chip == EurorackSpiDac::Chip::DAC8564 ? cs_pin : cs_pin + chip_index;
+    }
+
+    void PT_TIME_CRITICAL(startWord)(uint32_t index)
+    {
+        const uint32_t word_bytes = info.word_bits / 8;
+        gpio_put(word_cs[index], false);
+        dma_channel_set_read_addr(tx_channel, &bytes[index * word_bytes], false);
+        dma_channel_set_trans_count(tx_channel, word_bytes, false);
+        dma_channel_set_write_addr(rx_channel, &rx_dummy, false);
+        dma_channel_set_trans_count(rx_channel, word_bytes, false);
+        dma_start_channel_mask((1u << tx_channel) | (1u << rx_channel));
+    }
+
+    /**
+     * @brief RX drained: the last word has left the shift register
+     */
+    void PT_TIME_CRITICAL(onTransferDone)()
+    {
+        if (!hardware_cs)
+        {
+            gpio_put(word_cs[word_index], true);
+            if (++word_index < word_count)
+            {
+                startWord(word_index);
+                return;
+            }
+        }
+
+        if (ldac_pin != EurorackSpiDac::NO_PIN)
+        {
+            gpio_put(ldac_pin, false);
+            busy_wait_at_least_cycles(PT_SPI_DAC_LDAC_CYCLES);
+            gpio_put(ldac_pin, true);
+        }
+        frames++;
+        busy = false;
+    }
+
+    static void PT_TIME_CRITICAL(dmaIrq)()
+    {
+        for (uint i = 0; i < NUM_DMA_CHANNELS; i++)
+        {
+            PTSpiDac *dac = owners[i];
+            if (dac && dma_channel_get_irq0_status(i))
+            {
+                dma_channel_acknowledge_irq0(i);
+                dac->onTransferDone();
+            }
+        }
+    }
+
+public:
+    /**
+     * @param cs_pin CS of the first chip; further MCP48x2 chips use the next pins,
+     *        DAC8564 chips share it and are told apart by their A1/A0 strapping
+     * @param ldac_pin Shared LDAC, or EurorackSpiDac::NO_PIN
+     * @param chips Identical chips on the bus
+     */
+    PTSpiDac(spi_inst_t *spi, EurorackSpiDac::Chip chip, uint sck_pin, uint mosi_pin, uint cs_pin,
+             uint ldac_pin = EurorackSpiDac::NO_PIN, uint chips = 1, uint32_t baud = 0, bool auto_init = true)
+        : spi(spi), chip(chip), info(EurorackSpiDac::chipInfo(chip)), sck_pin(sck_pin), mosi_pin(mosi_pin),
+          cs_pin(cs_pin), ldac_pin(ldac_pin), chips(chips), baud(baud), hardware_cs(false),
+          levels(), dirty(0), words(), bytes(), word_cs(), word_count(0), word_index(0), busy(false),
+          rx_dummy(0), tx_channel(-1), rx_channel(-1), frames(0), skipped(0)
+    {
+        // Never more chips than channels fit
+        uint max_chips = MAX_CHANNELS / info.channels;
+        if (chip == EurorackSpiDac::Chip::DAC8564 && max_chips > 4)
+            max_chips = 4; // Two address pins
+        if (this->chips < 1)
+            this->chips = 1;
+        if (this->chips > max_chips)
+            this->chips = max_chips;
+        if (this->baud == 0 || this->baud > info.max_baud)
+            this->baud = info.max_baud;
+
+        // The SPI can frame 16-bit words itself on its own CSn pin
+        hardware_cs = info.word_bits == 16 && info.spi_mode == 0 && this->chips == 1 &&
+                      EurorackSpiDac::isSpiCsPin(cs_pin, spi_get_index(spi));
+
+        if (auto_init)
+        {
+            init();
+        }
+    }
+
+    ~PTSpiDac()
+    {
+        if (rx_channel >= 0)
+        {
+            dma_channel_set_irq0_enabled(rx_channel, false);
+            owners[rx_channel] = nullptr;
+            dma_channel_unclaim(rx_channel);
+            dma_channel_unclaim(tx_channel);
+        }
+    }
+
+    void init()
+    {
+        baud = spi_init(spi, baud);
+        gpio_set_function(sck_pin, GPIO_FUNC_SPI);
+        gpio_set_function(mosi_pin, GPIO_FUNC_SPI);
+
+        spi_cpol_t cpol = (info.spi_mode & 2) ? SPI_CPOL_1 : SPI_CPOL_0;
+        spi_cpha_t cpha = (info.spi_mode & 1) ? SPI_CPHA_1 : SPI_CPHA_0;
+        if (hardware_cs)
+        {
+            // CPHA 0 makes the SPI raise CSn between 16-bit words
+            spi_set_format(spi, 16, cpol, cpha, SPI_MSB_FIRST);
+            gpio_set_function(cs_pin, GPIO_FUNC_SPI);
+        }
+        else
+        {
+            spi_set_format(spi, 8, cpol, cpha, SPI_MSB_FIRST);
+            for (uint i = 0; i < chips; i++)
+            {
+                gpio_init(chipCs(i));
+                gpio_set_dir(chipCs(i), GPIO_OUT);
+                gpio_put(chipCs(i), true);
+            }
+        }
+        if (ldac_pin != EurorackSpiDac::NO_PIN)
+        {
+            gpio_init(ldac_pin);
+            gpio_set_dir(ldac_pin, GPIO_OUT);
+            gpio_put(ldac_pin, true);
+        }
+
+        enum dma_channel_transfer_size size = hardware_cs ? DMA_SIZE_16 : DMA_SIZE_8;
+
+        // TX: frame buffer -> SPI data register
+        tx_channel = dma_claim_unused_channel(true);
+        dma_channel_config tx_config = dma_channel_get_default_config(tx_channel);
+        channel_config_set_transfer_data_size(&tx_config, size);
+        channel_config_set_read_increment(&tx_config, true);
+        channel_config_set_write_increment(&tx_config, false);
+        channel_config_set_dreq(&tx_config, spi_get_dreq(spi, true));
+        dma_channel_configure(tx_channel, &tx_config, &spi_get_hw(spi)->dr, words, 0, false);
+
+        // RX: drain received data; its completion marks the end of the last bit
+        rx_channel = dma_claim_unused_channel(true);
+        dma_channel_config rx_config = dma_channel_get_default_config(rx_channel);
+        channel_config_set_transfer_data_size(&rx_config, size);
+        channel_config_set_read_increment(&rx_config, false);
+        channel_config_set_write_increment(&rx_config, false);
+        channel_config_set_dreq(&rx_config, spi_get_dreq(spi, false));
+        dma_channel_configure(rx_channel, &rx_config, &rx_dummy, &spi_get_hw(spi)->dr, 0, false);
+
+        // One shared DMA_IRQ_0 handler per template instance
+        static bool handler_installed = false;
+        if (!handler_installed)
+        {
+            irq_add_shared_handler(DMA_IRQ_0, dmaIrq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(DMA_IRQ_0, true);
+            handler_installed = true;
+        }
+        owners[rx_channel] = this;
+        dma_channel_set_irq0_enabled(rx_channel, true);
+
+        dirty = (channelCount() >= 32) ? 0xFFFFFFFFu : (1u << channelCount()) - 1; // First frame sets all
+    }
+
+    // ---- Staging (PTCVOutput interface, per channel) ----
+
+    void setVoltage(uint channel, float voltage)
+    {
+        setLevel(channel, EurorackUtils::CV::eurorackVoltageToDAC(voltage));
+    }
+
+    void setLevel(uint channel, uint16_t level)
+    {
+        if (channel >= channelCount())
+            return;
+        if (levels[channel] != level)
+        {
+            levels[channel] = level;
+            dirty |= 1u << channel;
+        }
+    }
+
+    uint16_t getLevel(uint channel) const { return channel < channelCount() ? levels[channel] : 0; }
+
+    float getVoltage(uint channel) const
+    {
+        return EurorackUtils::CV::dacToEurorackVoltage(getLevel(channel));
+    }
+
+    Output output(uint8_t channel) { return Output(this, channel); }
+
+    // ---- Frames ----
+
+    /**
+     * @brief Send every changed channel as one frame, latched together by LDAC
+     * @return true if a frame was started; false if nothing changed or the
+     *         previous frame is still on the bus (changes wait for the next call)
+     */
+    bool update()
+    {
+        if (dirty == 0)
+            return false;
+        if (busy)
+        {
+            skipped++;
+            return false;
+        }
+
+        uint32_t pending = dirty;
+        dirty = 0;
+        const uint32_t word_bytes = info.word_bits / 8;
+        bool dac8564 = chip == EurorackSpiDac::Chip::DAC8564;
+        word_count = 0;
+
+        for (uint c = 0; c < channelCount(); c++)
+        {
+            if (!(pending & (1u << c)))
+                continue;
+
+            uint chip_index = c / info.channels;
+            uint8_t local = c % info.channels;
+
+            // Without LDAC, a DAC8564 loads all its channels with its last word of the frame
+            uint32_t later = pending >> (c + 1);
+            uint32_t chip_rest = (chip_index + 1) * info.channels - (c + 1);
+            bool last_of_chip = (later & ((1u << chip_rest) - 1)) == 0;
+            bool load_all = dac8564 && ldac_pin == EurorackSpiDac::NO_PIN && last_of_chip;
+
+            uint32_t word = EurorackSpiDac::commandWord(chip, (uint8_t)chip_index, local, levels[c], load_all);
+            words[word_count] = (uint16_t)word;
+            for (uint32_t b = 0; b < word_bytes; b++)
+            {
+                bytes[word_count * word_bytes + b] = (uint8_t)(word >> (8 * (word_bytes - 1 - b)));
+            }
+            word_cs[word_count] = (uint8_t)chipCs(chip_index);
+            word_count++;
+        }
+
+        busy = true;
+        word_index = 0;
+        if (hardware_cs)
+        {
+            dma_channel_set_read_addr(tx_channel, words, false);
+            dma_channel_set_trans_count(tx_channel, word_count, false);
+            dma_channel_set_write_addr(rx_channel, &rx_dummy, false);
+            dma_channel_set_trans_count(rx_channel, word_count, false);
+            dma_start_channel_mask((1u << tx_channel) | (1u << rx_channel));
+        }
+        else
+        {
+            startWord(0);
+        }
+        return true;
+    }
+
+    bool isBusy() const { return busy; }
+
+    /**
+     * @brief Whole frame in one DMA transfer (single 16-bit chip on the SPI's CSn)
+     */
+    bool usesHardwareCs() const { return hardware_cs; }
+
+    uint getChannelCount() const { return channelCount(); }
+    uint32_t getBaudrate() const { return baud; }
+
+    /**
+     * @brief Frames latched so far
+     */
+    uint32_t getFrameCount() const { return frames; }
+
+    /**
+     * @brief update() calls that found the previous frame still sending
+     */
+    uint32_t getSkippedCount() const { return skipped; }
+};
+
+#endif // __EURORACK_SPI_DAC_H__
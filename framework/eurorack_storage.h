@@ -0,0 +1,520 @@
+/**
+ * @file eurorack_storage.h
+ * @brief Wear-levelled key/value persistence in on-board flash
+ *
+ * Presets and patterns are appended as CRC-protected records to a log
+ * that rotates through a reserved region at the end of flash, so every
+ * sector is erased equally often. The newest valid record for a key
+ * wins; a record interrupted by power loss fails its CRC and the
+ * previous copy is used instead.
+ *
+ * Record layout (page aligned, never crossing a sector):
+ *
+ *   | magic | sequence | key | length | crc32 | payload ... | 0xFF pad |
+ *
+ * Before a sector is written, the live records of the sector after it
+ * are copied into it, so the following erase never destroys the only
+ * copy of anything. This requires the live data (all keys, rounded up
+ * to pages) to fit in one sector minus the largest record.
+ */
+
+#ifndef __EURORACK_STORAGE_H__
+#define __EURORACK_STORAGE_H__
+
+#include "pico/stdlib.h"
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "hardware/sync.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace EurorackStorage
+{
+    const uint32_t SECTOR_SIZE = 4096;
+    const uint32_t PAGE_SIZE = 256;
+    const uint32_t RECORD_MAGIC = 0x54535450; // "PTST"
+    const uint32_t NO_RECORD = 0xFFFFFFFF;
+
+    struct RecordHeader
+    {
+        uint32_t magic;
+        uint32_t sequence;
+        uint16_t key;
+        uint16_t length;
+        uint32_t crc; // Over sequence, key, length and payload
+    };
+
+    static_assert(sizeof(RecordHeader) == 16, "RecordHeader must stay packed");
+
+    const uint32_t MAX_PAYLOAD = SECTOR_SIZE - sizeof(RecordHeader);
+
+    namespace detail
+    {
+        constexpr std::array<uint32_t, 256> makeCrcTable()
+        {
+            std::array<uint32_t, 256> table{};
+            for (uint32_t i = 0; i < 256; i++)
+            {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++)
+                {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                table[i] = c;
+            }
+            return table;
+        }
+    }
+
+    inline constexpr std::array<uint32_t, 256> CRC_TABLE = detail::makeCrcTable();
+
+    /**
+     * @brief CRC-32 (IEEE), chainable: pass the previous result as crc
+     */
+    inline uint32_t crc32(const void *data, size_t length, uint32_t crc = 0)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        crc = ~crc;
+        for (size_t i = 0; i < length; i++)
+        {
+            crc = CRC_TABLE[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+}
+
+/**
+ * @brief Raw flash region used by PTFlashStorage
+ *
+ * Offsets are relative to the start of the region. Erase works on whole
+ * sectors, program on whole pages of erased flash.
+ */
+class PTFlashDevice
+{
+public:
+    virtual ~PTFlashDevice() = default;
+
+    virtual uint32_t size() const = 0;
+    virtual void read(uint32_t offset, void *dst, size_t length) = 0;
+    virtual bool eraseSector(uint32_t offset) = 0;
+    virtual bool programPage(uint32_t offset, const uint8_t *page) = 0;
+};
+
+/**
+ * @brief RP2040 on-board QSPI flash, region reserved at the end of flash
+ *
+ * While a sector is erased or a page programmed, XIP is unavailable. By
+ * default the other core is parked with flash_safe_execute() (it must
+ * have called flash_safe_execute_core_init() / multicore_lockout_victim_init()
+ * or not be running). If the other core only ever executes from RAM, pass
+ * other_core_in_ram = true: only this core's interrupts are masked and the
+ * other core (e.g. a core1 audio loop) keeps running throughout. XIP data
+ * reads stall too, so "only from RAM" covers the tables it reads: the
+ * framework's (Fixed::EXP2_TABLE, NOTE_PITCH_Q16, SINE_TABLE) are placed in
+ * SRAM with PT_TIME_CRITICAL_DATA, and tools/pt_placement.py lists any
+ * still in flash.
+ */
+class PTPicoFlashDevice : public PTFlashDevice
+{
+private:
+    uint32_t base; // Offset of the region from the start of flash
+    uint32_t region_size;
+    bool other_core_in_ram;
+
+    struct Operation
+    {
+        uint32_t offset;
+        const uint8_t *data; // nullptr = erase
+    };
+
+    static void __not_in_flash_func(runOperation)(void *param)
+    {
+        const Operation *op = static_cast<const Operation *>(param);
+        if (op->data == nullptr)
+        {
+            flash_range_erase(op->offset, FLASH_SECTOR_SIZE);
+        }
+        else
+        {
+            flash_range_program(op->offset, op->data, FLASH_PAGE_SIZE);
+        }
+    }
+
+    bool execute(Operation &op)
+    {
+        if (other_core_in_ram)
+        {
+            uint32_t irq_state = save_and_disable_interrupts();
+            runOperation(&op);
+            restore_interrupts(irq_state);
+            return true;
+        }
+        return flash_safe_execute(runOperation, &op, 100) == PICO_OK;
+    }
+
+public:
+    PTPicoFlashDevice(uint32_t sectors = 16, bool other_core_in_ram = false)
+        : base(PICO_FLASH_SIZE_BYTES - sectors * FLASH_SECTOR_SIZE),
+          region_size(sectors * FLASH_SECTOR_SIZE),
+          other_core_in_ram(other_core_in_ram)
+    {
+    }
+
+    uint32_t size() const override { return region_size; }
+
+    void read(uint32_t offset, void *dst, size_t length) override
+    {
+        // Memory-mapped through XIP; the SDK flushes the cache after programming
+        memcpy(dst, (const void *)(XIP_BASE + base + offset), length);
+    }
+
+    bool eraseSector(uint32_t offset) override
+    {
+        Operation op = {base + offset, nullptr};
+        return execute(op);
+    }
+
+    bool programPage(uint32_t offset, const uint8_t *page) override
+    {
+        Operation op = {base + offset, page};
+        return execute(op);
+    }
+};
+
+/**
+ * @brief Log-structured key/value store on a PTFlashDevice
+ */
+class PTFlashStorage
+{
+public:
+    static const uint16_t MAX_KEYS = 16;
+
+private:
+    PTFlashDevice &flash;
+    uint32_t latest[MAX_KEYS]; // Offset of newest record per key
+    uint32_t write_offset;
+    uint32_t next_sequence;
+    uint32_t erase_count;
+    bool sector_open; // write_offset's sector is erased past write_offset and ready
+    bool mounted;
+    uint8_t page[EurorackStorage::PAGE_SIZE]; // Program staging buffer (must be in RAM)
+
+    static uint32_t recordPages(uint32_t length)
+    {
+        return (sizeof(EurorackStorage::RecordHeader) + length + EurorackStorage::PAGE_SIZE - 1) /
+               EurorackStorage::PAGE_SIZE;
+    }
+
+    uint32_t sectorCount() const { return flash.size() / EurorackStorage::SECTOR_SIZE; }
+
+    uint32_t nextSector(uint32_t offset) const
+    {
+        uint32_t sector = offset / EurorackStorage::SECTOR_SIZE + 1;
+        return (sector % sectorCount()) * EurorackStorage::SECTOR_SIZE;
+    }
+
+    /**
+     * @brief Read and validate the record at offset
+     */
+    bool readHeader(uint32_t offset, EurorackStorage::RecordHeader &header, bool check_crc)
+    {
+        flash.read(offset, &header, sizeof(header));
+        if (header.magic != EurorackStorage::RECORD_MAGIC || header.key >= MAX_KEYS ||
+            header.length > EurorackStorage::MAX_PAYLOAD)
+            return false;
+
+        uint32_t offset_in_sector = offset % EurorackStorage::SECTOR_SIZE;
+        if (offset_in_sector + recordPages(header.length) * EurorackStorage::PAGE_SIZE > EurorackStorage::SECTOR_SIZE)
+            return false;
+
+        if (!check_crc)
+            return true;
+
+        uint32_t crc = EurorackStorage::crc32(&header.sequence, 8);
+        uint32_t position = offset + sizeof(header);
+        uint32_t remaining = header.length;
+        while (remaining > 0)
+        {
+            uint32_t chunk = remaining < sizeof(page) ? remaining : sizeof(page);
+            flash.read(position, page, chunk);
+            crc = EurorackStorage::crc32(page, chunk, crc);
+            position += chunk;
+            remaining -= chunk;
+        }
+        return crc == header.crc;
+    }
+
+    bool isErased(uint32_t offset, uint32_t length)
+    {
+        while (length > 0)
+        {
+            uint32_t chunk = length < sizeof(page) ? length : sizeof(page);
+            flash.read(offset, page, chunk);
+            for (uint32_t i = 0; i < chunk; i++)
+            {
+                if (page[i] != 0xFF)
+                    return false;
+            }
+            offset += chunk;
+            length -= chunk;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Append a record; payload comes from RAM or, for relocation, from flash
+     */
+    bool writeRecord(uint16_t key, const uint8_t *data, uint32_t flash_source, uint16_t length)
+    {
+        EurorackStorage::RecordHeader header;
+        header.magic = EurorackStorage::RECORD_MAGIC;
+        header.sequence = next_sequence;
+        header.key = key;
+        header.length = length;
+
+        // CRC pass, reading the payload the same way it will be programmed
+        header.crc = EurorackStorage::crc32(&header.sequence, 8);
+        for (uint32_t done = 0; done < length;)
+        {
+            uint32_t chunk = (length - done) < sizeof(page) ? (length - done) : sizeof(page);
+            if (data)
+                memcpy(page, data + done, chunk);
+            else
+                flash.read(flash_source + done, page, chunk);
+            header.crc = EurorackStorage::crc32(page, chunk, header.crc);
+            done += chunk;
+        }
+
+        uint32_t offset = write_offset;
+        uint32_t total = sizeof(header) + length;
+        for (uint32_t done = 0; done < total; done += EurorackStorage::PAGE_SIZE)
+        {
+            memset(page, 0xFF, sizeof(page));
+            uint32_t fill = 0;
+            if (done == 0)
+            {
+                memcpy(page, &header, sizeof(header));
+                fill = sizeof(header);
+            }
+
+            uint32_t payload_start = done + fill - sizeof(header);
+            uint32_t chunk = EurorackStorage::PAGE_SIZE - fill;
+            if (payload_start + chunk > length)
+                chunk = length - payload_start;
+            if (data)
+                memcpy(page + fill, data + payload_start, chunk);
+            else
+                flash.read(flash_source + payload_start, page + fill, chunk);
+
+            if (!flash.programPage(offset + done, page))
+                return false;
+        }
+
+        latest[key] = offset;
+        next_sequence++;
+        write_offset = offset + recordPages(length) * EurorackStorage::PAGE_SIZE;
+        if (write_offset % EurorackStorage::SECTOR_SIZE == 0)
+        {
+            // Sector full; the next one must be opened before use
+            write_offset %= flash.size();
+            sector_open = false;
+        }
+        return true;
+    }
+
+    bool hasLiveRecords(uint32_t sector_start) const
+    {
+        for (uint16_t key = 0; key < MAX_KEYS; key++)
+        {
+            if (latest[key] != EurorackStorage::NO_RECORD && latest[key] >= sector_start &&
+                latest[key] < sector_start + EurorackStorage::SECTOR_SIZE)
+                return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief Copy the live records of a sector to write_offset
+     */
+    bool pullLiveRecords(uint32_t sector_start)
+    {
+        for (uint16_t key = 0; key < MAX_KEYS; key++)
+        {
+            uint32_t offset = latest[key];
+            if (offset == EurorackStorage::NO_RECORD || offset < sector_start ||
+                offset >= sector_start + EurorackStorage::SECTOR_SIZE)
+                continue;
+
+            EurorackStorage::RecordHeader header;
+            flash.read(offset, &header, sizeof(header));
+            uint32_t used = write_offset % EurorackStorage::SECTOR_SIZE;
+            if (!sector_open || used + recordPages(header.length) * EurorackStorage::PAGE_SIZE > EurorackStorage::SECTOR_SIZE)
+                return false; // Live data no longer fits in one sector
+            if (!writeRecord(key, nullptr, offset + sizeof(header), header.length))
+                return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Erase the sector at write_offset and pull in live records from the next one
+     */
+    bool openSector()
+    {
+        // Its live records should have been pulled forward when the previous sector opened
+        if (hasLiveRecords(write_offset))
+            return false;
+
+        if (!isErased(write_offset, EurorackStorage::SECTOR_SIZE))
+        {
+            if (!flash.eraseSector(write_offset))
+                return false;
+            erase_count++;
+        }
+
+        sector_open = true;
+        uint32_t next = nextSector(write_offset);
+        return next == write_offset || pullLiveRecords(next);
+    }
+
+    /**
+     * @brief Make room for a record at write_offset, opening a new sector if needed
+     */
+    bool reserve(uint32_t pages)
+    {
+        uint32_t need = pages * EurorackStorage::PAGE_SIZE;
+        if (sector_open && (write_offset % EurorackStorage::SECTOR_SIZE) + need <= EurorackStorage::SECTOR_SIZE)
+            return true;
+
+        if (write_offset % EurorackStorage::SECTOR_SIZE != 0)
+            write_offset = nextSector(write_offset);
+
+        return openSector() && (write_offset % EurorackStorage::SECTOR_SIZE) + need <= EurorackStorage::SECTOR_SIZE;
+    }
+
+public:
+    PTFlashStorage(PTFlashDevice &device)
+        : flash(device), write_offset(0), next_sequence(1), erase_count(0),
+          sector_open(false), mounted(false)
+    {
+        for (uint16_t i = 0; i < MAX_KEYS; i++)
+        {
+            latest[i] = EurorackStorage::NO_RECORD;
+        }
+    }
+
+    /**
+     * @brief Scan the region and index the newest valid record per key
+     * Call once at boot, before load() or save()
+     */
+    bool mount()
+    {
+        uint32_t best_sequence[MAX_KEYS] = {0};
+        uint32_t newest_sequence = 0;
+        uint32_t newest_end = 0;
+
+        for (uint16_t i = 0; i < MAX_KEYS; i++)
+        {
+            latest[i] = EurorackStorage::NO_RECORD;
+        }
+
+        uint32_t offset = 0;
+        while (offset < flash.size())
+        {
+            EurorackStorage::RecordHeader header;
+            if (!readHeader(offset, header, false))
+            {
+                offset += EurorackStorage::PAGE_SIZE;
+                continue;
+            }
+
+            uint32_t end = offset + recordPages(header.length) * EurorackStorage::PAGE_SIZE;
+            // Only pay for the CRC if this record would win
+            if (header.sequence > best_sequence[header.key] && readHeader(offset, header, true))
+            {
+                best_sequence[header.key] = header.sequence;
+                latest[header.key] = offset;
+            }
+            if (header.sequence > newest_sequence)
+            {
+                newest_sequence = header.sequence;
+                newest_end = end;
+            }
+            offset = end;
+        }
+
+        next_sequence = newest_sequence + 1;
+        write_offset = newest_end % flash.size();
+        sector_open = (write_offset % EurorackStorage::SECTOR_SIZE) != 0;
+
+        // Skip pages left dirty by a write torn after the newest record
+        while (sector_open && !isErased(write_offset, EurorackStorage::PAGE_SIZE))
+        {
+            write_offset += EurorackStorage::PAGE_SIZE;
+            if (write_offset % EurorackStorage::SECTOR_SIZE == 0)
+            {
+                write_offset %= flash.size();
+                sector_open = false;
+            }
+        }
+
+        // Finish a relocation that power loss may have interrupted
+        mounted = true;
+        uint32_t sector_start = write_offset - write_offset % EurorackStorage::SECTOR_SIZE;
+        if (sector_open && nextSector(sector_start) != sector_start)
+            return pullLiveRecords(nextSector(sector_start));
+        return true;
+    }
+
+    /**
+     * @brief Store a value; skipped if identical to the stored copy
+     * @return false if not mounted, too large or the flash operation failed
+     */
+    bool save(uint16_t key, const void *data, uint16_t length)
+    {
+        if (!mounted || key >= MAX_KEYS || length > EurorackStorage::MAX_PAYLOAD)
+            return false;
+
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        if (latest[key] != EurorackStorage::NO_RECORD)
+        {
+            EurorackStorage::RecordHeader header;
+            flash.read(latest[key], &header, sizeof(header));
+            if (header.length == length &&
+                header.crc == EurorackStorage::crc32(bytes, length, EurorackStorage::crc32(&header.sequence, 8)))
+                return true; // Unchanged, save the wear
+        }
+
+        return reserve(recordPages(length)) && writeRecord(key, bytes, 0, length);
+    }
+
+    /**
+     * @brief Load the newest copy of a value
+     * @return Stored length, or -1 if missing or larger than max_length
+     */
+    int load(uint16_t key, void *data, uint16_t max_length)
+    {
+        if (!mounted || key >= MAX_KEYS || latest[key] == EurorackStorage::NO_RECORD)
+            return -1;
+
+        EurorackStorage::RecordHeader header;
+        flash.read(latest[key], &header, sizeof(header));
+        if (header.length > max_length)
+            return -1;
+
+        flash.read(latest[key] + sizeof(header), data, header.length);
+        return header.length;
+    }
+
+    bool has(uint16_t key) const { return key < MAX_KEYS && latest[key] != EurorackStorage::NO_RECORD; }
+
+    /**
+     * @brief Sector erases performed since boot
+     */
+    uint32_t getEraseCount() const { return erase_count; }
+};
+
+#endif // __EURORACK_STORAGE_H__
@@ -0,0 +1,157 @@
+/**
+ * @file eurorack_usb_midi.h
+ * @brief USB-MIDI device class integration (TinyUSB)
+ *
+ * PTMidiUsb makes the module a class-compliant USB-MIDI device. Each
+ * 4-byte USB-MIDI event packet is unwrapped by its Code Index Number and
+ * fed through the same PTMidiParser as the DIN input, so notes, CCs and
+ * clock arrive on the event queue exactly as they do from PTMidiUart,
+ * timestamped when the packet is read.
+ *
+ * Outgoing messages are collected during a poll interval and handed to
+ * TinyUSB in a single write, so a burst of notes or clocks goes out in
+ * one bulk transfer instead of one transfer per message.
+ *
+ * Requires the tinyusb_device library, framework/usb/tusb_config.h and
+ * the descriptors in framework/usb/usb_descriptors.c on the build (see
+ * the PT_USB_MIDI option in CMakeLists.txt). USB stdio must be disabled
+ * as it brings its own descriptors.
+ */
+
+#ifndef __EURORACK_USB_MIDI_H__
+#define __EURORACK_USB_MIDI_H__
+
+#include "eurorack_midi.h"
+#include "tusb.h"
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief USB-MIDI device with batched output
+ */
+class PTMidiUsb : public PTMidiInput
+{
+public:
+    // One full-speed bulk packet holds 16 event packets of up to 3 MIDI bytes
+    static const uint32_t TX_BATCH_SIZE = 48;
+
+private:
+    uint8_t tx_batch[TX_BATCH_SIZE];
+    uint32_t tx_count;
+    uint32_t tx_overflows;
+    uint8_t cable;
+
+    bool queueBytes(const uint8_t *bytes, uint32_t length)
+    {
+        if (tx_count + length > TX_BATCH_SIZE)
+        {
+            flush();
+            if (tx_count + length > TX_BATCH_SIZE)
+            {
+                tx_overflows++;
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < length; i++)
+        {
+            tx_batch[tx_count++] = bytes[i];
+        }
+        return true;
+    }
+
+public:
+    PTMidiUsb(uint8_t cable = 0)
+        : tx_count(0), tx_overflows(0), cable(cable)
+    {
+    }
+
+    /**
+     * @brief Start the USB device stack
+     */
+    void init()
+    {
+        tusb_init();
+    }
+
+    bool isMounted() const { return tud_midi_mounted(); }
+
+    /**
+     * @brief Service the USB stack, parse received packets and send pending output
+     * @return Number of event packets parsed
+     */
+    size_t poll()
+    {
+        tud_task();
+
+        uint32_t now = time_us_32();
+        size_t packets = 0;
+        uint8_t packet[4];
+
+        while (tud_midi_available() && tud_midi_packet_read(packet))
+        {
+            processUsbPacket(packet, now);
+            packets++;
+        }
+
+        flush();
+        return packets;
+    }
+
+    /**
+     * @brief Queue a message for the next batch
+     * USB-MIDI packets always carry the status byte, so there is no running status
+     */
+    bool send(const PTMidiMessage &msg)
+    {
+        uint8_t bytes[3] = {msg.status, msg.data1, msg.data2};
+        uint32_t length = 1 + PTMidiParser::dataLength(msg.status);
+        return queueBytes(bytes, length);
+    }
+
+    bool sendNoteOn(uint8_t channel, uint8_t note, uint8_t velocity)
+    {
+        return send({(uint8_t)(EurorackMidi::NOTE_ON | (channel & 0x0F)), (uint8_t)(note & 0x7F), (uint8_t)(velocity & 0x7F)});
+    }
+
+    bool sendNoteOff(uint8_t channel, uint8_t note)
+    {
+        return send({(uint8_t)(EurorackMidi::NOTE_OFF | (channel & 0x0F)), (uint8_t)(note & 0x7F), 0});
+    }
+
+    bool sendControlChange(uint8_t channel, uint8_t controller, uint8_t value)
+    {
+        return send({(uint8_t)(EurorackMidi::CONTROL_CHANGE | (channel & 0x0F)), (uint8_t)(controller & 0x7F), (uint8_t)(value & 0x7F)});
+    }
+
+    bool sendClock() { return send({EurorackMidi::CLOCK, 0, 0}); }
+
+    /**
+     * @brief Hand the batch to TinyUSB in one write
+     * Output is discarded while no host is connected
+     */
+    void flush()
+    {
+        if (tx_count == 0)
+            return;
+
+        if (!tud_midi_mounted())
+        {
+            tx_count = 0;
+            return;
+        }
+
+        uint32_t written = tud_midi_stream_write(cable, tx_batch, tx_count);
+
+        // Keep whatever did not fit in the endpoint FIFO for the next poll
+        for (uint32_t i = written; i < tx_count; i++)
+        {
+            tx_batch[i - written] = tx_batch[i];
+        }
+        tx_count -= written;
+    }
+
+    uint32_t getTxOverflows() const { return tx_overflows; }
+};
+
+#endif // __EURORACK_USB_MIDI_H__
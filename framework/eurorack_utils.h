@@ -13,6 +13,11 @@
 #include "hardware/pwm.h"
 #include "hardware/timer.h"
 
+#include "pt_time_critical.h"
+
+#include <array>
+#include <cstdint>
+
 namespace EurorackUtils
 {
 
@@ -294,6 +299,146 @@ namespace EurorackUtils
             return value;
         }
     }
+
+    /**
+     * @brief Fixed-point helpers for pitch and audio-rate processing
+     *
+     * Pitch is carried as signed Q16.16 volts (65536 = 1V) so 1V/octave
+     * maths stays in integer registers on the FPU-less Cortex-M0+.
+     * Audio-rate samples are signed Q15 (-32768..32767 = -1.0..+1.0).
+     */
+    namespace Fixed
+    {
+        const int32_t ONE_VOLT_Q16 = 65536;
+
+        /**
+         * @brief Convert a voltage to Q16.16 (setup-time helper)
+         * @param volts Voltage in volts
+         * @return Voltage in Q16.16
+         */
+        inline int32_t voltsToQ16(float volts)
+        {
+            return (int32_t)(volts * 65536.0f);
+        }
+
+        /**
+         * @brief Convert a Q16.16 voltage back to float (display/debug helper)
+         * @param volts_q16 Voltage in Q16.16
+         * @return Voltage in volts
+         */
+        inline float q16ToVolts(int32_t volts_q16)
+        {
+            return volts_q16 / 65536.0f;
+        }
+
+        /**
+         * @brief Convert ADC reading to Eurorack voltage in Q16.16
+         * Integer equivalent of CV::adcToEurorackVoltage()
+         * @param adc_value 12-bit ADC value (0-4095)
+         * @return Voltage in Q16.16, -5V to +5V
+         */
+        inline int32_t adcToPitchQ16(uint16_t adc_value)
+        {
+            // 40970 / 256 ~= 10V * 65536 / 4095
+            return (int32_t)(((uint32_t)adc_value * 40970u) >> 8) - 5 * ONE_VOLT_Q16;
+        }
+
+        /**
+         * @brief Convert a Q15 sample to a 16-bit DAC/PWM level
+         * Full scale maps onto the -5V to +5V range of PTCVOutput::setLevel()
+         * @param sample Q15 sample
+         * @return 16-bit DAC value (0-65535)
+         */
+        inline uint16_t sampleToDAC(int16_t sample)
+        {
+            return (uint16_t)((int32_t)sample + 32768);
+        }
+
+        namespace detail
+        {
+            constexpr double expSeries(double x)
+            {
+                double sum = 1.0;
+                double term = 1.0;
+                for (int n = 1; n < 24; n++)
+                {
+                    term *= x / n;
+                    sum += term;
+                }
+                return sum;
+            }
+
+            constexpr std::array<uint32_t, 257> makeExp2Table()
+            {
+                std::array<uint32_t, 257> table{};
+                for (int i = 0; i <= 256; i++)
+                {
+                    double value = expSeries(0.6931471805599453 * i / 256.0) * 65536.0;
+                    table[i] = (uint32_t)(value + 0.5);
+                }
+                return table;
+            }
+        }
+
+        /**
+         * @brief 2^(i/256) in Q16.16 for i = 0..256, built at compile time, kept in SRAM
+         */
+        inline constexpr std::array<uint32_t, 257> PT_TIME_CRITICAL_DATA(EXP2_TABLE) = detail::makeExp2Table();
+
+        /**
+         * @brief Fractional power of two
+         * @param frac Fraction of an octave in Q16 (0-65535)
+         * @return 2^(frac/65536) in Q16.16 (65536-131072)
+         */
+        inline uint32_t exp2Q16(uint32_t frac)
+        {
+            uint32_t index = (frac >> 8) & 0xFF;
+            uint32_t weight = frac & 0xFF;
+            uint32_t a = EXP2_TABLE[index];
+            uint32_t b = EXP2_TABLE[index + 1];
+            return a + (((b - a) * weight) >> 8);
+        }
+
+        /**
+         * @brief Convert a frequency to a 32-bit phase increment (setup-time helper)
+         * @param hz Frequency in Hz
+         * @param sample_rate Sample rate in Hz
+         * @return Phase increment per sample (2^32 = one cycle)
+         */
+        inline uint32_t frequencyToIncrement(float hz, float sample_rate)
+        {
+            float cycles = Math::constrain(hz / sample_rate, 0.0f, 0.5f);
+            return (uint32_t)(cycles * 4294967296.0f);
+        }
+
+        /**
+         * @brief Apply a 1V/octave pitch offset to a phase increment
+         * @param base_increment Phase increment at 0V
+         * @param pitch_q16 Pitch in Q16.16 volts
+         * @return Phase increment, clamped below Nyquist
+         */
+        inline uint32_t pitchToIncrement(uint32_t base_increment, int32_t pitch_q16)
+        {
+            int32_t octave = pitch_q16 >> 16; // floor for negative pitch
+            uint64_t scaled = (uint64_t)base_increment * exp2Q16((uint32_t)pitch_q16 & 0xFFFF);
+
+            if (octave >= 0)
+            {
+                if (octave > 14)
+                    return 0x7FFFFFFF;
+                scaled <<= octave;
+            }
+            else
+            {
+                if (octave < -32)
+                    return 0;
+                scaled >>= -octave;
+            }
+
+            scaled >>= 16;
+            return scaled > 0x7FFFFFFF ? 0x7FFFFFFF : (uint32_t)scaled;
+        }
+    }
 }
 
 #endif /* __EURORACK_UTILS_H__ */
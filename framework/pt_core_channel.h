@@ -0,0 +1,372 @@
+/**
+ * @file pt_core_channel.h
+ * @brief One-way message channel between the two RP2040 cores
+ *
+ * Messages travel through a ring in shared SRAM; the SIO FIFO only
+ * carries a doorbell word, so a message is never limited to the FIFO's
+ * 32 bits or its 8 entries. Bulk data (audio blocks, display frames)
+ * moves without copying: the sender acquires a block from the channel's
+ * pool, fills it and sends it, the receiver processes it in place and
+ * releases it, which hands it back to the sender.
+ *
+ * Each channel has exactly one sending core and one receiving core.
+ * When the ring or the block pool is full, trySend()/tryAcquire() fail
+ * and send()/acquire() sleep (WFE) until the receiver frees space, so a
+ * slow consumer throttles its producer instead of losing data.
+ *
+ * The channel owns the SIO FIFO in its direction: the receiver discards
+ * every FIFO word it pops while waiting. Do not combine it with
+ * multicore_fifo_push/pop traffic of your own in the same direction; a
+ * channel each way is fine. Doorbells are only a wake-up hint, so a
+ * flash lockout handler (multicore_lockout_victim_init) eating them
+ * costs nothing but a WFE wake-up.
+ *
+ *         // Shared, e.g. at file scope
+ *         PTCoreChannel<16, 256, 4> audio_to_core1;
+ *
+ *         // Core 0: fill and hand over a block
+ *         int16_t *samples = (int16_t *)audio_to_core1.acquire();
+ *         render(samples);
+ *         audio_to_core1.sendBlock(samples, AUDIO_BLOCK);
+ *
+ *         // Core 1: process it in place, then give it back
+ *         PTCoreMessage message;
+ *         audio_to_core1.receive(message);
+ *         process((int16_t *)audio_to_core1.data(message));
+ *         audio_to_core1.release(message);
+ */
+
+#ifndef __PT_CORE_CHANNEL_H__
+#define __PT_CORE_CHANNEL_H__
+
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Single-producer, single-consumer ring shared between the cores
+ *
+ * Head and tail are each written by one side only; the acquire/release
+ * ordering publishes the slot before the index that makes it visible.
+ * On the M0+ these are plain loads and stores with a DMB.
+ */
+template <typename T, uint32_t SIZE>
+class PTCoreRing
+{
+    static_assert(SIZE >= 2 && (SIZE & (SIZE - 1)) == 0, "PTCoreRing size must be a power of two");
+
+private:
+    T slots[SIZE];
+    std::atomic<uint32_t> head; // Written by the producer only
+    std::atomic<uint32_t> tail; // Written by the consumer only
+
+public:
+    PTCoreRing() : head(0), tail(0) {}
+
+    bool push(const T &item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= SIZE)
+            return false;
+
+        slots[h % SIZE] = item;
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &item)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire))
+            return false;
+
+        item = slots[t % SIZE];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    uint32_t size() const
+    {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    bool isEmpty() const { return size() == 0; }
+
+    /**
+     * @brief Empty the ring; only while neither side is using it
+     */
+    void reset()
+    {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+    }
+};
+
+/**
+ * @brief Message passed through a PTCoreChannel
+ */
+struct PTCoreMessage
+{
+    uint32_t type;      // Application-defined
+    uint32_t data;      // Event-specific data, e.g. a block's valid length
+    uint32_t timestamp; // time_us_32() when sent
+    int32_t block;      // Pool block carried, or -1
+};
+
+/**
+ * @brief Inter-core channel: SIO FIFO doorbells, shared ring, zero-copy block pool
+ * @tparam MESSAGES Messages in flight (power of two)
+ * @tparam BLOCK_SIZE Bytes per pool block
+ * @tparam BLOCKS Blocks in the pool (at most MESSAGES)
+ */
+template <uint32_t MESSAGES = 16, size_t BLOCK_SIZE = 256, uint32_t BLOCKS = 4>
+class PTCoreChannel
+{
+    static_assert(BLOCKS >= 1 && BLOCKS <= MESSAGES, "PTCoreChannel needs 1 to MESSAGES blocks");
+
+public:
+    static const uint32_t DOORBELL = 0x50544348; // "PTCH"
+
+private:
+    PTCoreRing<PTCoreMessage, MESSAGES> messages; // Sender -> receiver
+    PTCoreRing<uint32_t, MESSAGES> free_blocks;   // Receiver -> sender
+    alignas(8) uint8_t blocks[BLOCKS][BLOCK_SIZE];
+
+    // Sender-side statistics
+    volatile uint32_t sent;
+    volatile uint32_t full_count;
+    volatile uint32_t max_depth;
+
+    // Receiver-side statistics
+    volatile uint32_t received;
+
+    /**
+     * @brief Wake the receiver: a doorbell if the FIFO has room, else just an event
+     *
+     * A full FIFO already holds doorbells the receiver has yet to pop.
+     */
+    void ringDoorbell()
+    {
+        if (multicore_fifo_wready())
+            multicore_fifo_push_blocking(DOORBELL); // Also signals SEV
+        else
+            __sev();
+    }
+
+    bool publish(uint32_t type, uint32_t data, int32_t block)
+    {
+        PTCoreMessage message = {type, data, time_us_32(), block};
+        if (!messages.push(message))
+            return false;
+
+        sent++;
+        uint32_t depth = messages.size();
+        if (depth > max_depth)
+            max_depth = depth;
+        ringDoorbell();
+        return true;
+    }
+
+    int32_t blockIndex(void *block) const
+    {
+        return (int32_t)(((uint8_t *)block - &blocks[0][0]) / BLOCK_SIZE);
+    }
+
+public:
+    PTCoreChannel() { reset(); }
+
+    /**
+     * @brief Empty the channel and return every block to the pool
+     *
+     * Call before the other core starts using it.
+     */
+    void reset()
+    {
+        messages.reset();
+        free_blocks.reset();
+        for (uint32_t i = 0; i < BLOCKS; i++)
+        {
+            free_blocks.push(i);
+        }
+        sent = 0;
+        full_count = 0;
+        max_depth = 0;
+        received = 0;
+    }
+
+    // ---- Sending core ----
+
+    /**
+     * @brief Send a message without a block
+     * @return false if the ring is full
+     */
+    bool trySend(uint32_t type, uint32_t data = 0)
+    {
+        if (publish(type, data, -1))
+            return true;
+        full_count++;
+        return false;
+    }
+
+    /**
+     * @brief Send a message, sleeping while the ring is full
+     */
+    void send(uint32_t type, uint32_t data = 0)
+    {
+        if (publish(type, data, -1))
+            return;
+        full_count++; // Once per blocked send, however often the core wakes
+        do
+        {
+            __wfe();
+        } while (!publish(type, data, -1));
+    }
+
+    /**
+     * @brief Take a free block to fill
+     * @return Block of BLOCK_SIZE bytes, or nullptr if all are in flight
+     */
+    void *tryAcquire()
+    {
+        uint32_t index;
+        if (free_blocks.pop(index))
+            return blocks[index];
+        full_count++;
+        return nullptr;
+    }
+
+    /**
+     * @brief Take a free block, sleeping until the receiver releases one
+     */
+    void *acquire()
+    {
+        uint32_t index;
+        if (!free_blocks.pop(index))
+        {
+            full_count++;
+            do
+            {
+                __wfe();
+            } while (!free_blocks.pop(index));
+        }
+        return blocks[index];
+    }
+
+    /**
+     * @brief Hand a filled block to the receiving core without copying it
+     * @param block From acquire(); the sender must not touch it afterwards
+     * @return false if the ring is full (the block stays with the sender)
+     */
+    bool trySendBlock(void *block, uint32_t type, uint32_t data = 0)
+    {
+        if (publish(type, data, blockIndex(block)))
+            return true;
+        full_count++;
+        return false;
+    }
+
+    void sendBlock(void *block, uint32_t type, uint32_t data = 0)
+    {
+        int32_t index = blockIndex(block);
+        if (publish(type, data, index))
+            return;
+        full_count++;
+        do
+        {
+            __wfe();
+        } while (!publish(type, data, index));
+    }
+
+    // ---- Receiving core ----
+
+    /**
+     * @brief Take the next message if there is one
+     */
+    bool tryReceive(PTCoreMessage &message)
+    {
+        if (!messages.pop(message))
+            return false;
+
+        received++;
+        __sev(); // A sender may be waiting for ring space
+        return true;
+    }
+
+    /**
+     * @brief Take the next message, sleeping until one arrives
+     */
+    void receive(PTCoreMessage &message)
+    {
+        while (!tryReceive(message))
+        {
+            if (multicore_fifo_rvalid())
+                multicore_fifo_pop_blocking(); // Doorbell; the ring is the truth
+            else
+                __wfe();
+        }
+    }
+
+    /**
+     * @brief Take the next message, giving up after a while
+     * @return false on timeout
+     */
+    bool receive(PTCoreMessage &message, uint32_t timeout_us)
+    {
+        uint32_t start = time_us_32();
+        while (!tryReceive(message))
+        {
+            if (time_us_32() - start >= timeout_us)
+                return false;
+            if (multicore_fifo_rvalid())
+                multicore_fifo_pop_blocking();
+            else
+                tight_loop_contents(); // No WFE: nothing might wake it before the deadline
+        }
+        return true;
+    }
+
+    /**
+     * @brief Block carried by a message
+     * @return BLOCK_SIZE bytes, or nullptr for a plain message
+     */
+    void *data(const PTCoreMessage &message)
+    {
+        return message.block >= 0 ? blocks[message.block] : nullptr;
+    }
+
+    /**
+     * @brief Return a message's block to the sender's pool
+     */
+    void release(const PTCoreMessage &message)
+    {
+        if (message.block < 0)
+            return;
+
+        free_blocks.push((uint32_t)message.block); // Never full: holds at most BLOCKS
+        __sev();
+    }
+
+    // ---- Statistics (read from either core) ----
+
+    static constexpr size_t blockSize() { return BLOCK_SIZE; }
+    static constexpr uint32_t blockCount() { return BLOCKS; }
+
+    uint32_t pending() const { return messages.size(); }
+    uint32_t getSent() const { return sent; }
+    uint32_t getReceived() const { return received; }
+    uint32_t getMaxDepth() const { return max_depth; }
+
+    /**
+     * @brief Times the sender found the ring or the pool full (backpressure)
+     *
+     * Counts each failed try-call, and each send(), sendBlock() or
+     * acquire() that had to sleep once, however many wake-ups it took.
+     */
+    uint32_t getFullCount() const { return full_count; }
+};
+
+#endif // __PT_CORE_CHANNEL_H__
@@ -0,0 +1,264 @@
+/**
+ * @file pt_monitor.h
+ * @brief CPU load, stack/heap high-water marks and event queue depth
+ *
+ * PTMonitor gathers the numbers needed to size a module's firmware:
+ * - Idle percentage per core, from the busy time its scheduler counts
+ *   (PTScheduler::getBusyTime(), SimpleScheduler::getBusyTime())
+ * - Stack high-water mark per core, by painting the stacks at boot and
+ *   finding the deepest word overwritten since
+ * - Heap in use
+ * - Deepest the event queue has been
+ *
+ * update() does the measuring (a stack scan and a heap walk) and should
+ * run at status-report rate, e.g. once a second. getSnapshot() and
+ * report() only read the last result.
+ *
+ * Usage:
+ *
+ *     static PTMonitor monitor;
+ *     int main() {
+ *         monitor.paintStacks();        // First thing, before multicore_launch_core1()
+ *         ...
+ *         monitor.watchCore(0, &scheduler);
+ *         monitor.watchQueue(scheduler.getEventQueue());
+ *     }
+ *     // In a status thread:
+ *     monitor.update();
+ *     monitor.report();
+ *
+ * Host builds (PICO_ON_DEVICE 0) measure load, heap (from the C library
+ * allocator) and queue depth on the host process. The host stack says
+ * nothing about the target's, so paintStacks() paints nothing there and
+ * report() prints "n/a"; paintStack() still measures a region given to it.
+ */
+
+#ifndef __PT_MONITOR_H__
+#define __PT_MONITOR_H__
+
+#include "pico/stdlib.h"
+
+#include "pt_thread.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <malloc.h>
+
+#if PICO_ON_DEVICE
+// Linker script symbols (memmap_default.ld)
+extern "C" char __StackBottom, __StackTop, __StackOneBottom, __StackOneTop, __end__, __HeapLimit;
+#endif
+
+/**
+ * @brief Resource usage at the last PTMonitor::update()
+ */
+struct PTMonitorSnapshot
+{
+    static const uint16_t NOT_WATCHED = 0xFFFF;
+
+    uint32_t uptime_ms;
+    uint16_t idle_permille[2]; // Since the previous update, NOT_WATCHED without a scheduler
+    uint32_t stack_used[2];    // Bytes, deepest use since paintStacks()
+    uint32_t stack_size[2];    // Bytes painted, 0 if not painted
+    uint32_t heap_used;
+    uint32_t heap_size;
+    uint32_t queue_max_depth;
+    uint32_t queue_capacity;
+};
+
+class PTMonitor
+{
+public:
+    static const uint32_t STACK_PAINT = 0x50545354; // "PTST"
+    static const uint32_t STACK_MARGIN = 64;        // Left unpainted below the caller's frame
+
+private:
+    struct Core
+    {
+        const void *scheduler;
+        uint32_t (*busy)(const void *scheduler);
+        uint32_t last_busy_us;
+        uint64_t last_time_us;
+    };
+
+    struct Stack
+    {
+        const uint32_t *bottom;
+        uint32_t words;
+        uint32_t untouched; // Words still painted at the last scan
+    };
+
+    Core cores[2];
+    Stack stacks[2];
+    const PTEventQueue *queue;
+    PTMonitorSnapshot snapshot;
+
+    static void paint(Stack &stack, uint32_t *bottom, uint32_t *top)
+    {
+        stack.bottom = bottom;
+        stack.words = top > bottom ? (uint32_t)(top - bottom) : 0;
+        stack.untouched = stack.words;
+        for (volatile uint32_t *word = bottom; word < top; word++)
+        {
+            *word = STACK_PAINT;
+        }
+    }
+
+    /**
+     * @brief Bytes used: the stack grows down, so count painted words from the bottom
+     */
+    static uint32_t scan(Stack &stack)
+    {
+        // Use only grows, so the scan never needs to pass the previous mark
+        const volatile uint32_t *word = stack.bottom;
+        uint32_t untouched = 0;
+        while (untouched < stack.untouched && word[untouched] == STACK_PAINT)
+        {
+            untouched++;
+        }
+        stack.untouched = untouched;
+        return (stack.words - untouched) * 4;
+    }
+
+    static void readHeap(uint32_t &used, uint32_t &size)
+    {
+#if PICO_ON_DEVICE
+        struct mallinfo info = mallinfo();
+        used = (uint32_t)info.uordblks;
+        size = (uint32_t)(&__HeapLimit - &__end__);
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        struct mallinfo2 info = mallinfo2();
+        used = (uint32_t)info.uordblks;
+        size = (uint32_t)info.arena;
+#else
+        used = 0;
+        size = 0;
+#endif
+    }
+
+public:
+    PTMonitor() : cores(), stacks(), queue(nullptr), snapshot()
+    {
+        snapshot.idle_permille[0] = PTMonitorSnapshot::NOT_WATCHED;
+        snapshot.idle_permille[1] = PTMonitorSnapshot::NOT_WATCHED;
+    }
+
+    /**
+     * @brief Paint both core stacks; call first thing in main()
+     *
+     * Core 0 is painted from the bottom of its stack up to just below the
+     * caller's frame. Core 1's default stack is painted whole, so this
+     * must run before multicore_launch_core1(). A core 1 started with its
+     * own stack can be painted with paintStack() instead. Does nothing
+     * on the host.
+     */
+    __attribute__((noinline)) void paintStacks()
+    {
+#if PICO_ON_DEVICE
+        volatile uint32_t marker = 0; // Its address is the current stack depth
+        uint32_t *frame = (uint32_t *)&marker;
+        paint(stacks[0], (uint32_t *)&__StackBottom, frame - STACK_MARGIN / 4);
+        paint(stacks[1], (uint32_t *)&__StackOneBottom, (uint32_t *)&__StackOneTop);
+#endif
+    }
+
+    /**
+     * @brief Paint a stack the linker script does not know about
+     * @param core Core the stack belongs to
+     * @param bottom Lowest address of the stack
+     * @param bytes Stack size
+     */
+    void paintStack(uint core, void *bottom, size_t bytes)
+    {
+        paint(stacks[core & 1], (uint32_t *)bottom, (uint32_t *)bottom + bytes / 4);
+    }
+
+    /**
+     * @brief Take a core's idle time from its scheduler
+     * @param scheduler PTScheduler or SimpleScheduler running on that core
+     */
+    template <typename Scheduler>
+    void watchCore(uint core, const Scheduler *scheduler)
+    {
+        Core &c = cores[core & 1];
+        c.scheduler = scheduler;
+        c.busy = [](const void *s)
+        { return static_cast<const Scheduler *>(s)->getBusyTime(); };
+        c.last_busy_us = scheduler->getBusyTime();
+        c.last_time_us = time_us_64();
+    }
+
+    void watchQueue(const PTEventQueue *event_queue) { queue = event_queue; }
+
+    /**
+     * @brief Measure everything and refresh the snapshot
+     */
+    const PTMonitorSnapshot &update()
+    {
+        uint64_t now = time_us_64();
+        snapshot.uptime_ms = (uint32_t)(now / 1000);
+
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            Core &c = cores[i];
+            if (c.scheduler)
+            {
+                uint32_t busy = c.busy(c.scheduler);
+                uint64_t wall = now - c.last_time_us;
+                uint32_t busy_delta = busy - c.last_busy_us;
+                if (wall > 0)
+                {
+                    uint64_t busy_permille = (uint64_t)busy_delta * 1000 / wall;
+                    snapshot.idle_permille[i] = busy_permille >= 1000 ? 0 : (uint16_t)(1000 - busy_permille);
+                }
+                c.last_busy_us = busy;
+                c.last_time_us = now;
+            }
+
+            snapshot.stack_size[i] = stacks[i].words * 4;
+            snapshot.stack_used[i] = stacks[i].words ? scan(stacks[i]) : 0;
+        }
+
+        readHeap(snapshot.heap_used, snapshot.heap_size);
+
+        if (queue)
+        {
+            snapshot.queue_max_depth = (uint32_t)queue->getMaxDepth();
+            snapshot.queue_capacity = (uint32_t)queue->capacity();
+        }
+        return snapshot;
+    }
+
+    const PTMonitorSnapshot &getSnapshot() const { return snapshot; }
+
+    /**
+     * @brief Print the snapshot as one line, e.g.
+     *
+     * [mon] up 12.3s idle 91.4% -- stack 1032/4092 -- heap 2048/251904 evq 5/32
+     */
+    void report() const
+    {
+        printf("[mon] up %lu.%lus idle", (unsigned long)(snapshot.uptime_ms / 1000),
+               (unsigned long)(snapshot.uptime_ms / 100 % 10));
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            if (snapshot.idle_permille[i] == PTMonitorSnapshot::NOT_WATCHED)
+                printf(" --");
+            else
+                printf(" %u.%u%%", snapshot.idle_permille[i] / 10, snapshot.idle_permille[i] % 10);
+        }
+        printf(" stack");
+        for (uint32_t i = 0; i < 2; i++)
+        {
+            if (snapshot.stack_size[i] == 0)
+                printf(PICO_ON_DEVICE ? " --" : " n/a"); // Not painted; never on the host
+            else
+                printf(" %lu/%lu", (unsigned long)snapshot.stack_used[i], (unsigned long)snapshot.stack_size[i]);
+        }
+        printf(" heap %lu/%lu evq %lu/%lu\n",
+               (unsigned long)snapshot.heap_used, (unsigned long)snapshot.heap_size,
+               (unsigned long)snapshot.queue_max_depth, (unsigned long)snapshot.queue_capacity);
+    }
+};
+
+#endif // __PT_MONITOR_H__
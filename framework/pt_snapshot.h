@@ -0,0 +1,207 @@
+/**
+ * @file pt_snapshot.h
+ * @brief Latest-value handoff of a parameter struct from one writer to one reader
+ *
+ * Control threads on one core publish whole parameter sets (tempo, step
+ * voltage, modulation depth...) and an audio loop on the other core
+ * reads the most recent complete set once per block. Neither side takes
+ * a lock, the writer never waits for the reader, and the reader never
+ * sees half of one publish and half of another.
+ *
+ * Two variants with the same interface:
+ *  - PTSnapshot: triple buffer. read() returns the latest set in place,
+ *    without copying; costs three copies of the struct.
+ *  - PTSeqSnapshot: seqlock. One copy of the struct; read() copies it
+ *    out and retries if a publish overlapped.
+ *
+ *         struct AudioParams { float tempo; float step_cv; float depth; };
+ *         PTSnapshot<AudioParams> params;
+ *
+ *         params.publish({bpm, cv, depth});              // Core 0, any rate
+ *         const AudioParams &p = params.read();          // Core 1, once per block
+ *
+ * Only loads, stores and barriers are used: the M0+ has no atomic
+ * read-modify-write instructions.
+ */
+
+#ifndef __PT_SNAPSHOT_H__
+#define __PT_SNAPSHOT_H__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief Triple-buffered snapshot: wait-free writer, copy-free reader
+ *
+ * The writer fills whichever buffer is neither the latest one nor the
+ * one the reader holds, then makes it the latest. The reader claims the
+ * latest buffer and confirms no publish slipped in before its claim was
+ * visible; it only retries when a publish lands in that window, so the
+ * read takes constant time in practice.
+ */
+template <typename T>
+class PTSnapshot
+{
+    static_assert(std::is_trivially_copyable<T>::value, "PTSnapshot needs a trivially copyable struct");
+
+private:
+    T buffers[3];
+    std::atomic<uint32_t> latest;  // Written by the writer only
+    std::atomic<uint32_t> reading; // Written by the reader only
+    std::atomic<uint32_t> version; // Publishes so far
+    uint32_t seen_version;         // Reader side
+
+public:
+    PTSnapshot() : buffers(), latest(0), reading(0), version(0), seen_version(0) {}
+
+    explicit PTSnapshot(const T &initial) : PTSnapshot()
+    {
+        buffers[0] = initial;
+    }
+
+    // ---- Writer ----
+
+    /**
+     * @brief Make a complete set the latest one; never waits
+     */
+    void publish(const T &value)
+    {
+        uint32_t current = latest.load(std::memory_order_relaxed);
+        uint32_t held = reading.load(std::memory_order_seq_cst);
+
+        // The one buffer that is neither the latest nor the reader's
+        uint32_t target = 3 - current - held;
+        if (current == held)
+            target = (current + 1) % 3;
+
+        buffers[target] = value;
+        latest.store(target, std::memory_order_seq_cst);
+        version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // ---- Reader ----
+
+    /**
+     * @brief Latest complete set
+     * @return Reference valid until the next read()
+     */
+    const T &read()
+    {
+        uint32_t index = latest.load(std::memory_order_seq_cst);
+        while (true)
+        {
+            reading.store(index, std::memory_order_seq_cst);
+            uint32_t check = latest.load(std::memory_order_seq_cst);
+            if (check == index)
+                break;
+            index = check; // A publish raced the claim; claim the newer one
+        }
+        return buffers[index];
+    }
+
+    /**
+     * @brief Whether a publish happened since the last call
+     */
+    bool changed()
+    {
+        uint32_t v = version.load(std::memory_order_acquire);
+        bool fresh = v != seen_version;
+        seen_version = v;
+        return fresh;
+    }
+
+    /**
+     * @brief Publishes so far (wraps)
+     */
+    uint32_t getVersion() const
+    {
+        return version.load(std::memory_order_acquire);
+    }
+};
+
+/**
+ * @brief Seqlock snapshot: wait-free writer, single buffer, copying reader
+ *
+ * The sequence is odd while the writer is mid-copy. The reader copies
+ * the struct and keeps the copy only if the sequence was even and did
+ * not move; a retry costs one more copy. Prefer it over PTSnapshot for
+ * large structs or tight RAM.
+ */
+template <typename T>
+class PTSeqSnapshot
+{
+    static_assert(std::is_trivially_copyable<T>::value, "PTSeqSnapshot needs a trivially copyable struct");
+
+private:
+    T value;
+    std::atomic<uint32_t> sequence;
+    uint32_t seen_sequence; // Reader side
+    uint32_t retries;       // Reader side
+
+public:
+    PTSeqSnapshot() : value(), sequence(0), seen_sequence(0), retries(0) {}
+
+    explicit PTSeqSnapshot(const T &initial) : PTSeqSnapshot()
+    {
+        value = initial;
+    }
+
+    // ---- Writer ----
+
+    void publish(const T &next)
+    {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy((void *)&value, &next, sizeof(T));
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // ---- Reader ----
+
+    /**
+     * @brief Copy of the latest complete set
+     */
+    T read()
+    {
+        T copy;
+        while (true)
+        {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0)
+            {
+                memcpy(&copy, (const void *)&value, sizeof(T));
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before)
+                    return copy;
+            }
+            retries++;
+        }
+    }
+
+    bool changed()
+    {
+        uint32_t seq = sequence.load(std::memory_order_acquire) & ~1u;
+        bool fresh = seq != seen_sequence;
+        seen_sequence = seq;
+        return fresh;
+    }
+
+    uint32_t getVersion() const
+    {
+        return sequence.load(std::memory_order_acquire) / 2;
+    }
+
+    /**
+     * @brief Reads that had to copy again because a publish overlapped
+     */
+    uint32_t getRetries() const
+    {
+        return retries;
+    }
+};
+
+#endif // __PT_SNAPSHOT_H__
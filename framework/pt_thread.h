@@ -31,6 +31,9 @@ extern "C"
 #include "hardware/clocks.h"
 #include "hardware/sync.h"
 
+#include "pt_time_critical.h"
+#include "pt_watchdog.h"
+
 #include <functional>
 #include <array>
 #include <climits>
@@ -57,6 +60,14 @@ enum class PTEventType
     SCREEN_REFRESH,
     SEQUENCE_STEP,
     CV_CHANGE,
+    MIDI_NOTE_ON,        // data: channel << 16 | note << 8 | velocity
+    MIDI_NOTE_OFF,       // data: channel << 16 | note << 8 | velocity
+    MIDI_CONTROL_CHANGE, // data: channel << 16 | controller << 8 | value
+    MIDI_CLOCK,          // data: sequencer step count since start
+    MIDI_START,
+    MIDI_STOP,
+    MIDI_CONTINUE,
+    POT_CHANGE, // data: pot index (PTMuxPots)
     USER_EVENT
 };
 
@@ -72,54 +83,297 @@ struct PTEvent
 
     PTEvent() : type(PTEventType::NONE), data(0), timestamp(0), processed(false) {}
     PTEvent(PTEventType t, uint32_t d = 0) : type(t), data(d), timestamp(time_us_32()), processed(false) {}
+
+    // Per-type statistics slots: one per built-in type, custom types share USER_EVENT
+    static const size_t TYPE_SLOTS = static_cast<size_t>(PTEventType::USER_EVENT) + 1;
+
+    static size_t typeSlot(PTEventType type)
+    {
+        size_t index = static_cast<size_t>(type);
+        return index < TYPE_SLOTS ? index : TYPE_SLOTS - 1;
+    }
+};
+
+#ifndef PT_EVENT_QUEUE_SIZE
+#define PT_EVENT_QUEUE_SIZE 32 // Events PTEventQueue holds before dropping
+#endif
+
+#ifndef PT_LATENCY_STATS
+#define PT_LATENCY_STATS 0 // Per-type event latency histograms in PTEventQueue (~2KB SRAM each)
+#endif
+
+/**
+ * @brief Log2-bucketed histogram of event latency (occurrence to pop) per event type
+ *
+ * Bucket 0 counts 0us, bucket n counts [2^(n-1), 2^n) us, and the last
+ * bucket everything above. Counters are only written by the consumer,
+ * so readers take them without locking; a snapshot taken while events
+ * are being popped may be off by the event in flight.
+ */
+class PTLatencyHistogram
+{
+public:
+    static const uint32_t BUCKETS = 24; // Last bucket: >= ~4.2s
+    static const size_t TYPES = PTEvent::TYPE_SLOTS;
+
+private:
+    volatile uint32_t buckets[TYPES][BUCKETS];
+    volatile uint32_t max_us[TYPES];
+
+    static size_t typeIndex(PTEventType type) { return PTEvent::typeSlot(type); }
+
+public:
+    PTLatencyHistogram() { reset(); }
+
+    /**
+     * @brief Bucket for a latency (bit length, without a CLZ instruction on the M0+)
+     */
+    static inline uint32_t bucketFor(uint32_t us)
+    {
+        uint32_t bits = 0;
+        if (us >= (1u << 16))
+        {
+            us >>= 16;
+            bits += 16;
+        }
+        if (us >= (1u << 8))
+        {
+            us >>= 8;
+            bits += 8;
+        }
+        if (us >= (1u << 4))
+        {
+            us >>= 4;
+            bits += 4;
+        }
+        if (us >= (1u << 2))
+        {
+            us >>= 2;
+            bits += 2;
+        }
+        if (us >= (1u << 1))
+        {
+            us >>= 1;
+            bits += 1;
+        }
+        bits += us;
+        return bits < BUCKETS ? bits : BUCKETS - 1;
+    }
+
+    /**
+     * @brief Largest latency counted by a bucket
+     */
+    static uint32_t bucketUpperBound(uint32_t bucket)
+    {
+        return bucket == 0 ? 0 : (bucket >= BUCKETS - 1 ? UINT32_MAX : (1u << bucket) - 1);
+    }
+
+    inline void record(PTEventType type, uint32_t latency_us)
+    {
+        size_t t = typeIndex(type);
+        buckets[t][bucketFor(latency_us)]++;
+        if (latency_us > max_us[t])
+            max_us[t] = latency_us;
+    }
+
+    void reset()
+    {
+        for (size_t t = 0; t < TYPES; t++)
+        {
+            for (uint32_t b = 0; b < BUCKETS; b++)
+            {
+                buckets[t][b] = 0;
+            }
+            max_us[t] = 0;
+        }
+    }
+
+    uint32_t getBucket(PTEventType type, uint32_t bucket) const { return buckets[typeIndex(type)][bucket % BUCKETS]; }
+    uint32_t getMax(PTEventType type) const { return max_us[typeIndex(type)]; }
+
+    uint32_t getCount(PTEventType type) const
+    {
+        uint32_t total = 0;
+        for (uint32_t b = 0; b < BUCKETS; b++)
+        {
+            total += buckets[typeIndex(type)][b];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Latency below which the given share of events fall
+     * @param permille 500 = median, 990 = p99
+     * @return Upper bound of the bucket holding that event (bucket resolution), capped at the maximum
+     */
+    uint32_t getPercentile(PTEventType type, uint32_t permille) const
+    {
+        uint32_t count = getCount(type);
+        if (count == 0)
+            return 0;
+
+        uint32_t rank = (uint32_t)(((uint64_t)count * permille + 999) / 1000);
+        uint32_t seen = 0;
+        for (uint32_t b = 0; b < BUCKETS; b++)
+        {
+            seen += buckets[typeIndex(type)][b];
+            if (seen >= rank)
+            {
+                uint32_t bound = bucketUpperBound(b);
+                return bound < getMax(type) ? bound : getMax(type);
+            }
+        }
+        return getMax(type);
+    }
 };
 
 /**
  * @brief Event queue for managing interrupt-driven events
+ *
+ * Overflow is counted here rather than left to callers: drops per event
+ * type, the high-water mark and the time spent full can be read and
+ * reset at runtime, and an optional hook sees every dropped event.
  */
 class PTEventQueue
 {
+public:
+    static const size_t MAX_EVENTS = PT_EVENT_QUEUE_SIZE;
+
+    /**
+     * @brief Called with each event push() drops, in the pusher's context (often an IRQ)
+     */
+    typedef void (*OverflowHook)(const PTEvent &dropped);
+
 private:
-    static const size_t MAX_EVENTS = 32;
     std::array<PTEvent, MAX_EVENTS> events;
     volatile size_t head;
     volatile size_t tail;
     volatile size_t count;
+    volatile size_t max_depth;
+    volatile uint32_t drops[PTEvent::TYPE_SLOTS];
+    uint32_t full_since_us;
+    uint64_t full_time_us; // Completed full periods
+    OverflowHook overflow_hook;
+#if PT_LATENCY_STATS
+    PTLatencyHistogram latency;
+#endif
 
 public:
-    PTEventQueue() : head(0), tail(0), count(0) {}
+    PTEventQueue() : head(0), tail(0), count(0), max_depth(0), drops(), full_since_us(0), full_time_us(0),
+                     overflow_hook(nullptr)
+    {
+    }
 
-    bool push(const PTEvent &event)
+    bool PT_TIME_CRITICAL(push)(const PTEvent &event)
     {
+        uint32_t irq_state = save_and_disable_interrupts();
         if (count >= MAX_EVENTS)
+        {
+            drops[PTEvent::typeSlot(event.type)]++;
+            restore_interrupts(irq_state);
+            if (overflow_hook)
+                overflow_hook(event);
             return false;
+        }
 
-        uint32_t irq_state = save_and_disable_interrupts();
         events[head] = event;
         head = (head + 1) % MAX_EVENTS;
         count++;
+        if (count > max_depth)
+            max_depth = count;
+        if (count == MAX_EVENTS)
+            full_since_us = time_us_32();
         restore_interrupts(irq_state);
         return true;
     }
 
-    bool pop(PTEvent &event)
+    bool PT_TIME_CRITICAL(pop)(PTEvent &event)
     {
         if (count == 0)
             return false;
 
         uint32_t irq_state = save_and_disable_interrupts();
+        if (count == MAX_EVENTS)
+            full_time_us += time_us_32() - full_since_us;
         event = events[tail];
         tail = (tail + 1) % MAX_EVENTS;
         count--;
         restore_interrupts(irq_state);
+
+#if PT_LATENCY_STATS
+        // Consume time against the timestamp taken where the event was raised
+        latency.record(event.type, time_us_32() - event.timestamp);
+#endif
         return true;
     }
 
     bool isEmpty() const { return count == 0; }
     size_t size() const { return count; }
+    size_t capacity() const { return MAX_EVENTS; }
+
+    /**
+     * @brief Deepest the queue has been since start or resetMaxDepth()
+     */
+    size_t getMaxDepth() const { return max_depth; }
+    void resetMaxDepth() { max_depth = count; }
+
+    /**
+     * @brief Events dropped because the queue was full
+     */
+    uint32_t getDropped(PTEventType type) const { return drops[PTEvent::typeSlot(type)]; }
+    uint32_t getDroppedTotal() const
+    {
+        uint32_t total = 0;
+        for (size_t t = 0; t < PTEvent::TYPE_SLOTS; t++)
+        {
+            total += drops[t];
+        }
+        return total;
+    }
+
+    /**
+     * @brief Total time the queue has been full, including a full period still going on
+     */
+    uint64_t getFullTime() const
+    {
+        uint32_t irq_state = save_and_disable_interrupts();
+        uint64_t total = full_time_us;
+        if (count == MAX_EVENTS)
+            total += time_us_32() - full_since_us;
+        restore_interrupts(irq_state);
+        return total;
+    }
+
+    /**
+     * @brief Clear drop counts, full time and the high-water mark
+     */
+    void resetStats()
+    {
+        uint32_t irq_state = save_and_disable_interrupts();
+        for (size_t t = 0; t < PTEvent::TYPE_SLOTS; t++)
+        {
+            drops[t] = 0;
+        }
+        full_time_us = 0;
+        full_since_us = time_us_32();
+        max_depth = count;
+        restore_interrupts(irq_state);
+    }
+
+    void setOverflowHook(OverflowHook hook) { overflow_hook = hook; }
+
+#if PT_LATENCY_STATS
+    /**
+     * @brief Time events spent between being raised and being popped, per type
+     */
+    const PTLatencyHistogram &getLatency() const { return latency; }
+    void resetLatency() { latency.reset(); }
+#endif
     void clear()
     {
         uint32_t irq_state = save_and_disable_interrupts();
+        if (count == MAX_EVENTS)
+            full_time_us += time_us_32() - full_since_us;
         head = tail = count = 0;
         restore_interrupts(irq_state);
     }
@@ -135,14 +389,23 @@ private:
     bool active;
     const char *name;
     uint32_t last_run_time;
+    uint32_t last_duration_us;
     uint32_t run_count;
 
+    // Timing supervision (0 = off)
+    uint32_t budget_us;
+    uint32_t deadline_us;
+    uint32_t max_run_us;
+    uint32_t overrun_count;
+    uint32_t deadline_misses;
+
 protected:
     PTEventQueue *event_queue;
 
 public:
     PTThread(const char *thread_name = "PTThread")
-        : active(true), name(thread_name), last_run_time(0), run_count(0), event_queue(nullptr)
+        : active(true), name(thread_name), last_run_time(0), last_duration_us(0), run_count(0), budget_us(0), deadline_us(0),
+          max_run_us(0), overrun_count(0), deadline_misses(0), event_queue(nullptr)
     {
         PT_INIT(&thread_pt);
     }
@@ -158,15 +421,26 @@ public:
     /**
      * @brief Execute the thread - internal scheduler interface
      */
-    int execute()
+    int PT_TIME_CRITICAL(execute)()
     {
         if (!active)
             return PT_EXITED;
 
-        last_run_time = time_us_32();
+        uint32_t start = time_us_32();
+        if (deadline_us && run_count > 0 && start - last_run_time > deadline_us)
+            deadline_misses++;
+        last_run_time = start;
+
         int result = run();
         run_count++;
 
+        uint32_t elapsed = time_us_32() - start;
+        last_duration_us = elapsed;
+        if (elapsed > max_run_us)
+            max_run_us = elapsed;
+        if (budget_us && elapsed > budget_us)
+            overrun_count++;
+
         if (result == PT_ENDED || result == PT_EXITED)
         {
             active = false;
@@ -205,6 +479,38 @@ public:
      */
     uint32_t getRunCount() const { return run_count; }
     uint32_t getLastRunTime() const { return last_run_time; }
+    uint32_t getLastRunDuration() const { return last_duration_us; }
+
+    /**
+     * @brief Longest single run() allowed; longer runs count as overruns
+     *
+     * With a PTWatchdog attached to the scheduler, a run still going past
+     * its budget is also reported while it is stuck.
+     */
+    void setBudget(uint32_t us) { budget_us = us; }
+    uint32_t getBudget() const { return budget_us; }
+
+    /**
+     * @brief Longest allowed gap between two runs; longer gaps count as deadline misses
+     *
+     * A SimpleThread runs on an interval and bounds its lateness past it
+     * instead, with SimpleThread::setMaxLateness().
+     */
+    void setDeadline(uint32_t us) { deadline_us = us; }
+    uint32_t getDeadline() const { return deadline_us; }
+
+    /**
+     * @brief Timing statistics
+     */
+    uint32_t getMaxRunTime() const { return max_run_us; }
+    uint32_t getOverrunCount() const { return overrun_count; }
+    uint32_t getDeadlineMisses() const { return deadline_misses; }
+    void resetTimingStats()
+    {
+        max_run_us = 0;
+        overrun_count = 0;
+        deadline_misses = 0;
+    }
 
     /**
      * @brief Set event queue for interrupt handling
@@ -226,10 +532,12 @@ private:
     size_t thread_count;
     PTEventQueue global_event_queue;
     uint32_t scheduler_ticks;
+    volatile uint32_t busy_us;
     bool running;
+    PTWatchdog *watchdog;
 
 public:
-    PTScheduler() : thread_count(0), scheduler_ticks(0), running(false) {}
+    PTScheduler() : thread_count(0), scheduler_ticks(0), busy_us(0), running(false), watchdog(nullptr) {}
 
     /**
      * @brief Add a thread to the scheduler
@@ -250,7 +558,7 @@ public:
     /**
      * @brief Remove a thread from the scheduler
      */
-    bool removeThread(PTThread *thread)
+    bool PT_TIME_CRITICAL(removeThread)(PTThread *thread)
     {
         for (size_t i = 0; i < thread_count; i++)
         {
@@ -271,16 +579,26 @@ public:
     /**
      * @brief Run one scheduler cycle
      */
-    void runOnce()
+    void PT_TIME_CRITICAL(runOnce)()
     {
         scheduler_ticks++;
+        if (watchdog)
+            watchdog->feed();
 
         for (size_t i = 0; i < thread_count; i++)
         {
             PTThread *thread = threads[i];
             if (thread && thread->isActive())
             {
+                if (watchdog)
+                    watchdog->enter((int)i, thread->getName(), thread->getBudget());
                 int result = thread->execute();
+                if (watchdog)
+                    watchdog->leave();
+
+                // PT_WAITING also ends runs that did work before blocking again,
+                // so every run counts; idle is the time spent outside threads
+                busy_us += thread->getLastRunDuration();
 
                 // Remove ended threads
                 if (result == PT_ENDED || result == PT_EXITED)
@@ -315,6 +633,24 @@ public:
      */
     size_t getThreadCount() const { return thread_count; }
     uint32_t getSchedulerTicks() const { return scheduler_ticks; }
+    /**
+     * @brief Microseconds spent in execute() calls (wraps after ~71 minutes)
+     *
+     * Runs that only polled a wait condition count too, as in
+     * SimpleScheduler::getBusyTime(); idle time is the rest of the
+     * wall-clock time, spent in the scheduler loop itself.
+     */
+    uint32_t getBusyTime() const { return busy_us; }
+
+    PTThread *getThread(size_t index) const { return index < thread_count ? threads[index] : nullptr; }
+
+    /**
+     * @brief Supervise threads with a watchdog (nullptr to detach)
+     *
+     * Thread indices reported by the watchdog are positions in this
+     * scheduler, i.e. the order of addThread() calls.
+     */
+    void setWatchdog(PTWatchdog *wd) { watchdog = wd; }
 
     /**
      * @brief Get global event queue
@@ -0,0 +1,57 @@
+/**
+ * @file pt_time_critical.h
+ * @brief SRAM placement for interrupt handlers and other hot paths
+ *
+ * Functions marked PT_TIME_CRITICAL are linked into a .time_critical
+ * section and copied to SRAM at boot, so they never stall on an XIP
+ * cache miss (or on flash being erased by the other core). They are
+ * also kept out of line, so a caller in flash cannot inline its own
+ * copy back into XIP.
+ *
+ * Usage, on the declaration or an in-class definition:
+ *
+ *     bool PT_TIME_CRITICAL(push)(const PTEvent &event) { ... }
+ *
+ * Lookup tables read by time-critical code go in SRAM the same way,
+ * with PT_TIME_CRITICAL_DATA on the variable's declarator:
+ *
+ *     inline constexpr std::array<int16_t, 257> PT_TIME_CRITICAL_DATA(SINE_TABLE) = makeSineTable();
+ *
+ * A constexpr table otherwise stays in flash .rodata, where reading it
+ * takes XIP cache misses and stalls while flash is written.
+ *
+ * A time-critical function should only call inline code or other
+ * time-critical functions. tools/pt_placement.py checks this on the
+ * linked firmware and reports how much SRAM the placement costs, and
+ * which framework tables are in SRAM and which still in flash. The
+ * check only sees direct calls: a call through a pointer (a virtual
+ * such as PTThread::run(), an overflow hook, the GPIO dispatch table)
+ * is not followed, so every function reached that way from a
+ * time-critical path has to be marked by hand.
+ *
+ * Builds without the Pico SDK section macros (e.g. the host benchmarks)
+ * compile the functions normally.
+ */
+
+#ifndef __PT_TIME_CRITICAL_H__
+#define __PT_TIME_CRITICAL_H__
+
+#include "pico/stdlib.h"
+
+#ifndef PT_TIME_CRITICAL
+#ifdef __not_in_flash
+#define PT_TIME_CRITICAL(func_name) __noinline __not_in_flash("pt." #func_name) func_name
+#else
+#define PT_TIME_CRITICAL(func_name) func_name
+#endif
+#endif
+
+#ifndef PT_TIME_CRITICAL_DATA
+#ifdef __not_in_flash
+#define PT_TIME_CRITICAL_DATA(var_name) __not_in_flash("pt." #var_name) var_name
+#else
+#define PT_TIME_CRITICAL_DATA(var_name) var_name
+#endif
+#endif
+
+#endif // __PT_TIME_CRITICAL_H__
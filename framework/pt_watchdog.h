@@ -0,0 +1,193 @@
+/**
+ * @file pt_watchdog.h
+ * @brief Runaway-thread supervision for the cooperative schedulers
+ *
+ * A thread that never returns (a missing yield, a loop waiting on
+ * hardware that never answers) freezes PTScheduler and SimpleScheduler
+ * without any sign of which thread did it. PTWatchdog closes that gap:
+ *
+ * - The scheduler calls enter()/leave() around every thread and feed()
+ *   once per pass, which also feeds the RP2040 hardware watchdog.
+ * - A repeating timer interrupt calls check(). A thread that has been
+ *   running longer than its budget is reported through the runaway
+ *   callback while it is still running.
+ * - The running thread's index is kept in a watchdog scratch register,
+ *   so after a watchdog reset getResetThread() says which thread hung.
+ *
+ * Usage:
+ *
+ *     static PTWatchdog watchdog;
+ *     watchdog.setRunawayCallback([](int index, const char *name, uint32_t us) { ... });
+ *     watchdog.begin(500);              // Reset after 500ms without a pass
+ *     if (watchdog.getResetThread() >= 0) { ... }
+ *     thread.setBudget(2000);           // Flag runs longer than 2ms
+ *     scheduler.setWatchdog(&watchdog);
+ */
+
+#ifndef __PT_WATCHDOG_H__
+#define __PT_WATCHDOG_H__
+
+#include "pico/stdlib.h"
+#include "hardware/watchdog.h"
+#include "hardware/sync.h"
+
+#include "pt_time_critical.h"
+
+class PTWatchdog
+{
+public:
+    /**
+     * @brief Called from the timer interrupt when a thread overruns its budget
+     * @param index Thread index in its scheduler
+     * @param name Thread name
+     * @param elapsed_us Time the thread has been running so far
+     */
+    typedef void (*RunawayCallback)(int index, const char *name, uint32_t elapsed_us);
+
+    static const uint32_t SCRATCH_THREAD = 0;         // Scratch 0-3 are free; the SDK uses 4-7
+    static const uint32_t SCRATCH_MAGIC = 0x50540000; // "PT" in the upper half, index below
+
+private:
+    // Written by the scheduler, read by check() in the timer interrupt
+    volatile int32_t current;
+    volatile uint32_t started_us;
+    volatile uint32_t budget_us;
+    const char *volatile current_name;
+    volatile bool flagged;
+
+    volatile uint32_t runaway_count;
+    volatile int32_t last_runaway;
+    RunawayCallback callback;
+
+    uint32_t load_value; // Watchdog reload, 0 when the hardware watchdog is off
+    int32_t reset_thread;
+    repeating_timer_t timer;
+
+    static bool onTimer(repeating_timer_t *rt)
+    {
+        static_cast<PTWatchdog *>(rt->user_data)->check();
+        return true;
+    }
+
+public:
+    PTWatchdog()
+        : current(-1), started_us(0), budget_us(0), current_name(nullptr), flagged(false),
+          runaway_count(0), last_runaway(-1), callback(nullptr), load_value(0), reset_thread(-1), timer()
+    {
+    }
+
+    /**
+     * @brief Start the hardware watchdog and the budget check timer
+     * @param timeout_ms Reset if no scheduler pass feeds the watchdog for this long, 0 to leave it off
+     * @param check_period_us Budget check interval; overruns are seen at most this late
+     * @return false if no timer slot was free
+     */
+    bool begin(uint32_t timeout_ms, uint32_t check_period_us = 1000)
+    {
+        // Latch the reset cause before enter() overwrites the scratch register
+        reset_thread = readResetThread();
+        watchdog_hw->scratch[SCRATCH_THREAD] = 0;
+
+        if (timeout_ms > 0)
+        {
+            watchdog_enable(timeout_ms, true); // Paused while a debugger halts the core
+
+            // What watchdog_update() reloads: the counter ticks twice per us (RP2040-E1)
+            uint64_t ticks = (uint64_t)timeout_ms * 2000;
+            load_value = ticks > 0xFFFFFF ? 0xFFFFFF : (uint32_t)ticks;
+        }
+        return add_repeating_timer_us(-(int64_t)check_period_us, onTimer, this, &timer);
+    }
+
+    void setRunawayCallback(RunawayCallback cb) { callback = cb; }
+
+    /**
+     * @brief Scheduler hook: once per pass
+     *
+     * Writes the reload register directly rather than calling
+     * watchdog_update(), which lives in flash, so the SRAM scheduler
+     * loop does not call out to XIP.
+     */
+    inline void feed()
+    {
+        if (load_value)
+        {
+            watchdog_hw->load = load_value;
+        }
+    }
+
+    /**
+     * @brief Scheduler hook: a thread is about to run
+     * @param budget_us Run time allowed before it counts as a runaway, 0 for none
+     */
+    inline void enter(int index, const char *name, uint32_t budget_us)
+    {
+        current = -1; // Keep check() out while the fields change
+        __compiler_memory_barrier();
+        started_us = time_us_32();
+        this->budget_us = budget_us;
+        current_name = name;
+        flagged = false;
+        watchdog_hw->scratch[SCRATCH_THREAD] = SCRATCH_MAGIC | ((uint32_t)index & 0xFFFF);
+        __compiler_memory_barrier();
+        current = index;
+    }
+
+    /**
+     * @brief Scheduler hook: the thread returned
+     */
+    inline void leave()
+    {
+        current = -1;
+        watchdog_hw->scratch[SCRATCH_THREAD] = 0;
+    }
+
+    /**
+     * @brief Flag the running thread if it is over budget (timer interrupt)
+     */
+    void PT_TIME_CRITICAL(check)()
+    {
+        int32_t index = current;
+        if (index < 0 || flagged || budget_us == 0)
+            return;
+
+        uint32_t elapsed = time_us_32() - started_us;
+        if (elapsed <= budget_us || current != index)
+            return;
+
+        flagged = true;
+        runaway_count++;
+        last_runaway = index;
+        if (callback)
+        {
+            callback(index, current_name, elapsed);
+        }
+    }
+
+    /**
+     * @brief Index of the thread running when the watchdog last reset the chip
+     * @return Thread index, or -1 if the last reset was not a watchdog reset
+     *         during a thread. Valid after begin().
+     */
+    int32_t getResetThread() const { return reset_thread; }
+
+    /**
+     * @brief Read the reset thread straight from the scratch register (before begin())
+     */
+    static int32_t readResetThread()
+    {
+        uint32_t tag = watchdog_hw->scratch[SCRATCH_THREAD];
+        if (!watchdog_caused_reboot() || (tag & 0xFFFF0000) != SCRATCH_MAGIC)
+            return -1;
+        return (int32_t)(tag & 0xFFFF);
+    }
+
+    /**
+     * @brief Runaway statistics
+     */
+    uint32_t getRunawayCount() const { return runaway_count; }
+    int32_t getLastRunaway() const { return last_runaway; }
+    int32_t getCurrentThread() const { return current; }
+};
+
+#endif // __PT_WATCHDOG_H__
@@ -9,9 +9,42 @@
 
 #include "pico/stdlib.h"
 #include "hardware/timer.h"
+#include "hardware/sync.h"
+
+#include "pt_watchdog.h"
+
+#ifndef SIMPLE_THREAD_INBOX_SIZE
+#define SIMPLE_THREAD_INBOX_SIZE 8 // Events an event-driven SimpleThread holds between runs
+#endif
+
+/**
+ * @brief Event delivered to SimpleThread subscribers
+ *
+ * Types are small integers (0-31) chosen by the application, so an
+ * enum of its own event kinds can be posted directly.
+ */
+struct SimpleEvent
+{
+    uint32_t type;
+    uint32_t data;
+    uint32_t timestamp;
+
+    /**
+     * @brief Subscription mask bit of an event type
+     */
+    static constexpr uint32_t bit(uint32_t type)
+    {
+        return type < 32 ? 1u << type : 0;
+    }
+};
 
 /**
  * @brief Simple cooperative thread base class
+ *
+ * Runs on every scheduler pass, every interval, or - once it subscribes
+ * to event types - only when matching events are pending. Subscribed
+ * threads get their own copy of each event; the batch is available to
+ * execute() through getEvents() / getEventCount().
  */
 class SimpleThread
 {
@@ -21,6 +54,23 @@ private:
     bool enabled;
     const char *name;
 
+    // Timing supervision (0 = off)
+    uint32_t budget_us;
+    uint32_t max_lateness_us;
+    uint32_t last_duration_us;
+    uint32_t max_run_us;
+    uint32_t overrun_count;
+    uint32_t deadline_misses;
+
+    // Event mode: inbox filled by SimpleScheduler::post(), drained into batch by run()
+    uint32_t event_mask;
+    SimpleEvent inbox[SIMPLE_THREAD_INBOX_SIZE];
+    volatile uint32_t inbox_head;
+    volatile uint32_t inbox_count;
+    volatile uint32_t inbox_dropped;
+    SimpleEvent batch[SIMPLE_THREAD_INBOX_SIZE];
+    uint32_t batch_count;
+
 public:
     /**
      * @brief Constructor
@@ -31,6 +81,17 @@ public:
         interval_ms = 0;
         enabled = true;
         name = thread_name;
+        budget_us = 0;
+        max_lateness_us = 0;
+        last_duration_us = 0;
+        max_run_us = 0;
+        overrun_count = 0;
+        deadline_misses = 0;
+        event_mask = 0;
+        inbox_head = 0;
+        inbox_count = 0;
+        inbox_dropped = 0;
+        batch_count = 0;
     }
 
     /**
@@ -52,6 +113,83 @@ public:
         interval_ms = ms;
     }
 
+    /**
+     * @brief Run only when events of these types are pending
+     *
+     * A non-zero interval still wakes the thread when no event arrived
+     * for that long, e.g. to end an LED blink; setInterval(0) sleeps
+     * until the next event.
+     * @param type_mask SimpleEvent::bit() of each type, or'ed together
+     */
+    void subscribe(uint32_t type_mask)
+    {
+        event_mask |= type_mask;
+    }
+
+    /**
+     * @brief Stop receiving events of these types; none left returns to polling
+     * @param type_mask SimpleEvent::bit() of each type, or'ed together
+     */
+    void unsubscribe(uint32_t type_mask)
+    {
+        event_mask &= ~type_mask;
+    }
+
+    bool isEventDriven() const
+    {
+        return event_mask != 0;
+    }
+
+    bool isSubscribed(uint32_t type) const
+    {
+        return (event_mask & SimpleEvent::bit(type)) != 0;
+    }
+
+    /**
+     * @brief Queue an event for the next run (normally via SimpleScheduler::post)
+     *
+     * Safe from interrupt handlers on the scheduler's core.
+     * @return false if the inbox was full and the event was dropped
+     */
+    bool deliver(const SimpleEvent &event)
+    {
+        uint32_t irq_state = save_and_disable_interrupts();
+        if (inbox_count >= SIMPLE_THREAD_INBOX_SIZE)
+        {
+            inbox_dropped++;
+            restore_interrupts(irq_state);
+            return false;
+        }
+        inbox[(inbox_head + inbox_count) % SIMPLE_THREAD_INBOX_SIZE] = event;
+        inbox_count++;
+        restore_interrupts(irq_state);
+        return true;
+    }
+
+    /**
+     * @brief Events being handled by the current execute(), oldest first
+     */
+    const SimpleEvent *getEvents() const
+    {
+        return batch;
+    }
+
+    /**
+     * @brief Size of the batch; 0 when woken by the interval instead
+     */
+    uint32_t getEventCount() const
+    {
+        return batch_count;
+    }
+
+    /**
+     * @brief Events lost because the inbox was full
+     */
+    uint32_t getDroppedEvents() const
+    {
+        return inbox_dropped;
+    }
+
     /**
      * @brief Check if the thread should run
      * @return true if thread should execute
@@ -61,12 +199,28 @@ public:
         if (!enabled)
             return false;
 
-        if (interval_ms == 0)
+        if (event_mask)
+        {
+            if (inbox_count)
+            {
+                last_time = get_absolute_time(); // Interval counts from the last wake
+                return true;
+            }
+            if (interval_ms == 0)
+                return false; // Sleep until an event arrives
+        }
+        else if (interval_ms == 0)
             return true; // Run every time
 
         absolute_time_t current_time = get_absolute_time();
-        if (absolute_time_diff_us(last_time, current_time) >= (interval_ms * 1000))
+        int64_t elapsed = absolute_time_diff_us(last_time, current_time);
+        if (elapsed >= (interval_ms * 1000))
         {
+            // Late by more than the allowed lateness (default: a whole interval)
+            int64_t late = elapsed - (int64_t)interval_ms * 1000;
+            if (late > (max_lateness_us ? (int64_t)max_lateness_us : (int64_t)interval_ms * 1000))
+                deadline_misses++;
+
             last_time = current_time;
             return true;
         }
@@ -100,15 +254,113 @@ public:
         return name;
     }
 
+    /**
+     * @brief Longest single execute() allowed; longer runs count as overruns
+     *
+     * With a PTWatchdog attached to the scheduler, a run still going past
+     * its budget is also reported while it is stuck.
+     * @param us Budget in microseconds, 0 for none
+     */
+    void setBudget(uint32_t us)
+    {
+        budget_us = us;
+    }
+
+    uint32_t getBudget() const
+    {
+        return budget_us;
+    }
+
+    /**
+     * @brief How late past its interval a run may start before it counts as a deadline miss
+     *
+     * Not PTThread::setDeadline(), which bounds the whole gap between runs:
+     * here the run is due every interval and this bounds the lateness on
+     * top, so the longest gap without a miss is the interval plus this.
+     * @param us Allowed lateness in microseconds, 0 for one interval
+     */
+    void setMaxLateness(uint32_t us)
+    {
+        max_lateness_us = us;
+    }
+
+    uint32_t getMaxLateness() const
+    {
+        return max_lateness_us;
+    }
+
+    /**
+     * @brief Duration of the latest execute(), in microseconds
+     */
+    uint32_t getLastRunDuration() const
+    {
+        return last_duration_us;
+    }
+
+    /**
+     * @brief Longest execute() so far, in microseconds
+     */
+    uint32_t getMaxRunTime() const
+    {
+        return max_run_us;
+    }
+
+    /**
+     * @brief Number of runs longer than the budget
+     */
+    uint32_t getOverrunCount() const
+    {
+        return overrun_count;
+    }
+
+    /**
+     * @brief Number of runs that started more than the max lateness past their interval
+     */
+    uint32_t getDeadlineMisses() const
+    {
+        return deadline_misses;
+    }
+
     /**
      * @brief Run the thread (calls execute if shouldRun returns true)
+     * @return true if execute() ran
      */
-    void run()
+    bool run()
+    {
+        if (!shouldRun())
+            return false;
+
+        if (event_mask)
+            takeEvents();
+
+        uint32_t start = time_us_32();
+        execute();
+        uint32_t elapsed = time_us_32() - start;
+        batch_count = 0;
+
+        last_duration_us = elapsed;
+        if (elapsed > max_run_us)
+            max_run_us = elapsed;
+        if (budget_us && elapsed > budget_us)
+            overrun_count++;
+        return true;
+    }
+
+private:
+    /**
+     * @brief Move the inbox into the batch, leaving it free for new events
+     */
+    void takeEvents()
     {
-        if (shouldRun())
+        uint32_t irq_state = save_and_disable_interrupts();
+        batch_count = inbox_count;
+        for (uint32_t i = 0; i < batch_count; i++)
         {
-            execute();
+            batch[i] = inbox[(inbox_head + i) % SIMPLE_THREAD_INBOX_SIZE];
         }
+        inbox_head = (inbox_head + batch_count) % SIMPLE_THREAD_INBOX_SIZE;
+        inbox_count = 0;
+        restore_interrupts(irq_state);
     }
 };
 
@@ -121,12 +373,14 @@ private:
     static const int MAX_THREADS = 16;
     SimpleThread *threads[MAX_THREADS];
     int thread_count;
+    volatile uint32_t busy_us;
+    PTWatchdog *watchdog;
 
 public:
     /**
      * @brief Constructor
      */
-    SimpleScheduler() : thread_count(0)
+    SimpleScheduler() : thread_count(0), busy_us(0), watchdog(nullptr)
     {
         for (int i = 0; i < MAX_THREADS; i++)
         {
@@ -149,20 +403,83 @@ public:
         return false;
     }
 
+    /**
+     * @brief Deliver an event to every thread subscribed to its type
+     *
+     * Each subscriber gets its own copy, so two threads interested in
+     * the same type no longer race for it. Safe from interrupt handlers
+     * on the scheduler's core.
+     * @param type Event type (0-31)
+     * @param data Event-specific data
+     * @param timestamp Time of occurrence, time_us_32()
+     * @return Number of threads the event was queued for
+     */
+    int post(uint32_t type, uint32_t data, uint32_t timestamp)
+    {
+        SimpleEvent event = {type, data, timestamp};
+        int delivered = 0;
+        for (int i = 0; i < thread_count; i++)
+        {
+            if (threads[i] != nullptr && threads[i]->isSubscribed(type) && threads[i]->deliver(event))
+                delivered++;
+        }
+        return delivered;
+    }
+
+    int post(uint32_t type, uint32_t data = 0)
+    {
+        return post(type, data, time_us_32());
+    }
+
     /**
      * @brief Run all threads
      */
     void run()
     {
+        if (watchdog)
+            watchdog->feed();
+
         for (int i = 0; i < thread_count; i++)
         {
             if (threads[i] != nullptr)
             {
-                threads[i]->run();
+                if (watchdog)
+                    watchdog->enter(i, threads[i]->getName(), threads[i]->getBudget());
+                if (threads[i]->run())
+                    busy_us += threads[i]->getLastRunDuration();
+                if (watchdog)
+                    watchdog->leave();
             }
         }
     }
 
+    /**
+     * @brief Microseconds spent in execute() calls (wraps after ~71 minutes)
+     * @return Busy time; idle time is the rest of the wall-clock time
+     */
+    uint32_t getBusyTime() const
+    {
+        return busy_us;
+    }
+
+    /**
+     * @brief Supervise threads with a watchdog (nullptr to detach)
+     * @param wd Watchdog; reported indices follow the addThread() order
+     */
+    void setWatchdog(PTWatchdog *wd)
+    {
+        watchdog = wd;
+    }
+
+    /**
+     * @brief Get a thread by index, e.g. to name PTWatchdog::getResetThread()
+     * @return Thread, or nullptr if out of range
+     */
+    SimpleThread *getThread(int index) const
+    {
+        return (index >= 0 && index < thread_count) ? threads[index] : nullptr;
+    }
+
     /**
      * @brief Remove all threads from scheduler
      */
@@ -0,0 +1,37 @@
+/**
+ * @file tusb_config.h
+ * @brief TinyUSB configuration for the USB-MIDI device (eurorack_usb_midi.h)
+ */
+
+#ifndef __TUSB_CONFIG_H__
+#define __TUSB_CONFIG_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CFG_TUSB_RHPORT0_MODE (OPT_MODE_DEVICE | OPT_MODE_FULL_SPEED)
+
+#ifndef CFG_TUSB_OS
+#define CFG_TUSB_OS OPT_OS_PICO
+#endif
+
+#define CFG_TUD_ENABLED 1
+#define CFG_TUD_ENDPOINT0_SIZE 64
+
+// Device classes: MIDI only
+#define CFG_TUD_CDC 0
+#define CFG_TUD_MSC 0
+#define CFG_TUD_HID 0
+#define CFG_TUD_MIDI 1
+#define CFG_TUD_VENDOR 0
+
+// One bulk packet each way; PTMidiUsb batches output to fill it
+#define CFG_TUD_MIDI_RX_BUFSIZE 64
+#define CFG_TUD_MIDI_TX_BUFSIZE 64
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TUSB_CONFIG_H__
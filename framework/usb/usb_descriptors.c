@@ -0,0 +1,113 @@
+/**
+ * @file usb_descriptors.c
+ * @brief USB descriptors for the USB-MIDI device (one cable in, one out)
+ *
+ * The VID/PID pair is the TinyUSB test pair; replace it with an
+ * allocated one before shipping hardware.
+ */
+
+#include <string.h>
+
+#include "tusb.h"
+#include "pico/unique_id.h"
+
+#define USB_VID 0xCAFE
+#define USB_PID 0x4010
+#define USB_BCD 0x0200
+
+static const tusb_desc_device_t desc_device = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = USB_BCD,
+    .bDeviceClass = 0x00, // Class defined per interface
+    .bDeviceSubClass = 0x00,
+    .bDeviceProtocol = 0x00,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USB_VID,
+    .idProduct = USB_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = 0x01,
+    .iProduct = 0x02,
+    .iSerialNumber = 0x03,
+    .bNumConfigurations = 0x01,
+};
+
+uint8_t const *tud_descriptor_device_cb(void)
+{
+    return (uint8_t const *)&desc_device;
+}
+
+enum
+{
+    ITF_NUM_MIDI = 0,
+    ITF_NUM_MIDI_STREAMING,
+    ITF_NUM_TOTAL
+};
+
+#define CONFIG_TOTAL_LEN (TUD_CONFIG_DESC_LEN + TUD_MIDI_DESC_LEN)
+
+#define EPNUM_MIDI_OUT 0x01
+#define EPNUM_MIDI_IN 0x81
+
+static const uint8_t desc_configuration[] = {
+    // Config number, interface count, string index, total length, attributes, power in mA
+    TUD_CONFIG_DESCRIPTOR(1, ITF_NUM_TOTAL, 0, CONFIG_TOTAL_LEN, 0x00, 100),
+
+    // Interface number, string index, EP out, EP in, EP size
+    TUD_MIDI_DESCRIPTOR(ITF_NUM_MIDI, 0, EPNUM_MIDI_OUT, EPNUM_MIDI_IN, 64),
+};
+
+uint8_t const *tud_descriptor_configuration_cb(uint8_t index)
+{
+    (void)index;
+    return desc_configuration;
+}
+
+static const char *string_desc[] = {
+    (const char[]){0x09, 0x04}, // 0: English (0x0409)
+    "PT Eurorack",              // 1: Manufacturer
+    "PT Eurorack MIDI",         // 2: Product
+    NULL,                       // 3: Serial, from the flash unique ID
+};
+
+#define STRING_DESC_MAX_CHARS 31
+
+static uint16_t desc_str[STRING_DESC_MAX_CHARS + 1];
+
+uint16_t const *tud_descriptor_string_cb(uint8_t index, uint16_t langid)
+{
+    (void)langid;
+    size_t chr_count;
+
+    if (index == 0)
+    {
+        memcpy(&desc_str[1], string_desc[0], 2);
+        chr_count = 1;
+    }
+    else
+    {
+        if (index >= sizeof(string_desc) / sizeof(string_desc[0]))
+            return NULL;
+
+        char serial[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+        const char *str = string_desc[index];
+        if (index == 3)
+        {
+            pico_get_unique_board_id_string(serial, sizeof(serial));
+            str = serial;
+        }
+
+        chr_count = strlen(str);
+        if (chr_count > STRING_DESC_MAX_CHARS)
+            chr_count = STRING_DESC_MAX_CHARS;
+
+        // ASCII to UTF-16
+        for (size_t i = 0; i < chr_count; i++)
+        {
+            desc_str[1 + i] = str[i];
+        }
+    }
+
+    desc_str[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * chr_count + 2));
+    return desc_str;
+}
@@ -24,27 +24,36 @@
 #include <cstdlib>
 
 #include "framework/simple_threads.h"
+#include "framework/eurorack_board_default.h"
 #include "framework/eurorack_utils.h"
+#include "framework/eurorack_modulation.h"
+#include "framework/eurorack_quantizer.h"
+#include "framework/eurorack_sequencer.h"
+#include "framework/eurorack_storage.h"
 
-// Hardware pin definitions (adjust for your hardware)
-#define ENCODER1_A_PIN 2
-#define ENCODER1_B_PIN 3
-#define ENCODER1_BTN_PIN 4
+// Pin assignments come from the board description; edit the pin list in
+// framework/eurorack_board_default.h for your hardware
+static constexpr const auto &BOARD = EurorackBoards::DEFAULT_BOARD;
+using PTBoard::Role;
 
-#define BUTTON1_PIN 5
-#define BUTTON2_PIN 6
+static constexpr uint ENCODER1_A_PIN = BOARD.gpio(Role::ENCODER_A);
+static constexpr uint ENCODER1_B_PIN = BOARD.gpio(Role::ENCODER_B);
+static constexpr uint ENCODER1_BTN_PIN = BOARD.gpio(Role::ENCODER_BUTTON);
 
-#define LED1_PIN 25 // Onboard LED
-#define LED2_PIN 15 // External LEDs
-#define LED3_PIN 16
+static constexpr uint BUTTON1_PIN = BOARD.gpio(Role::BUTTON, 0);
+static constexpr uint BUTTON2_PIN = BOARD.gpio(Role::BUTTON, 1);
 
-#define CV_IN1_PIN 26  // ADC0
-#define CV_IN2_PIN 27  // ADC1
-#define CV_OUT1_PIN 20 // PWM
-#define CV_OUT2_PIN 21 // PWM
+static constexpr uint LED1_PIN = BOARD.gpio(Role::LED, 0); // Onboard LED
+static constexpr uint LED2_PIN = BOARD.gpio(Role::LED, 1); // External LEDs
+static constexpr uint LED3_PIN = BOARD.gpio(Role::LED, 2);
 
-#define GATE_IN_PIN 7
-#define GATE_OUT_PIN 8
+static constexpr uint CV_IN1_PIN = BOARD.gpio(Role::CV_IN, 0);
+static constexpr uint CV_IN2_PIN = BOARD.gpio(Role::CV_IN, 1);
+static constexpr uint CV_OUT1_PIN = BOARD.gpio(Role::CV_OUT, 0);
+static constexpr uint CV_OUT2_PIN = BOARD.gpio(Role::CV_OUT, 1);
+
+static constexpr uint GATE_IN_PIN = BOARD.gpio(Role::GATE_IN);
+static constexpr uint GATE_OUT_PIN = BOARD.gpio(Role::GATE_OUT);
 
 // Event system for inter-thread communication
 struct EurorackEvent
@@ -74,6 +83,8 @@ private:
     volatile size_t head = 0;
     volatile size_t tail = 0;
     volatile size_t count = 0;
+    volatile size_t max_depth = 0;
+    volatile uint32_t drops[EurorackEvent::CV_CHANGE + 1] = {};
     spin_lock_t *lock;
 
 public:
@@ -83,13 +94,19 @@ public:
     }
     bool push(EurorackEvent::Type type, uint32_t data = 0)
     {
+        uint32_t irq_state = spin_lock_blocking(lock);
         if (count >= MAX_EVENTS)
+        {
+            drops[type]++; // Callers don't check; the status line reports these
+            spin_unlock(lock, irq_state);
             return false;
+        }
 
-        uint32_t irq_state = spin_lock_blocking(lock);
         events[head] = {type, data, time_us_32()};
         head = (head + 1) % MAX_EVENTS;
         count++;
+        if (count > max_depth)
+            max_depth = count;
         spin_unlock(lock, irq_state);
         return true;
     }
@@ -109,6 +126,16 @@ public:
 
     bool isEmpty() const { return count == 0; }
     size_t size() const { return count; }
+    size_t getMaxDepth() const { return max_depth; }
+    uint32_t getDropped(EurorackEvent::Type type) const { return drops[type]; }
+
+    uint32_t getDroppedTotal() const
+    {
+        uint32_t total = 0;
+        for (uint32_t d : drops)
+            total += d;
+        return total;
+    }
 };
 
 // Global event queue
@@ -117,9 +144,50 @@ EurorackEventQueue g_event_queue;
 // Global state variables
 volatile float g_tempo_bpm = 120.0f;
 volatile bool g_sequencer_running = false;
-volatile uint8_t g_current_step = 0;
-volatile uint8_t g_sequence_length = 8;
-volatile float g_sequence_voltages[16] = {0.0f}; // Up to 16 step sequence
+
+// Pattern-based sequencer and the start time of the step it is playing
+PTSequencer g_sequencer;
+volatile uint32_t g_step_start_time = 0;
+
+// Persistent settings in the last 64KB of flash
+PTPicoFlashDevice g_flash(16);
+PTFlashStorage g_storage(g_flash);
+const uint16_t STORAGE_KEY_TEMPO = 0;
+const uint16_t STORAGE_KEY_PATTERN = 1; // Patterns use keys 1-8
+
+void saveSettings()
+{
+    float tempo = g_tempo_bpm;
+    g_storage.save(STORAGE_KEY_TEMPO, &tempo, sizeof(tempo));
+    for (uint8_t i = 0; i < PTSequencer::MAX_PATTERNS; i++)
+    {
+        g_storage.save(STORAGE_KEY_PATTERN + i, &g_sequencer.getPattern(i), sizeof(PTPattern));
+    }
+}
+
+void loadSettings()
+{
+    float tempo;
+    if (g_storage.load(STORAGE_KEY_TEMPO, &tempo, sizeof(tempo)) == sizeof(tempo))
+    {
+        g_tempo_bpm = EurorackUtils::Math::constrain(tempo, 60.0f, 200.0f);
+    }
+    for (uint8_t i = 0; i < PTSequencer::MAX_PATTERNS; i++)
+    {
+        PTPattern pattern;
+        if (g_storage.load(STORAGE_KEY_PATTERN + i, &pattern, sizeof(pattern)) == sizeof(pattern) &&
+            pattern.isValid())
+        {
+            g_sequencer.getPattern(i) = pattern;
+        }
+    }
+}
+
+// Quantizer between CV input 1 and the sequence (C major)
+PTQuantizer g_quantizer(EurorackQuantizer::MAJOR, 0);
+
+// Modulation envelope on CV output 2, rendered at the maintenance rate (100Hz)
+PTEnvelope g_cv2_envelope(100.0f, PTEnvelope::AD);
 
 // Encoder state tracking
 struct EncoderState
@@ -284,19 +352,10 @@ struct CVOutputState
     uint channel;
     uint16_t current_level = 32767; // Mid-range
 
-    CVOutputState(uint p) : pin(p)
-    {
-        gpio_set_function(pin, GPIO_FUNC_PWM);
-        slice = pwm_gpio_to_slice_num(pin);
-        channel = pwm_gpio_to_channel(pin);
+    // No hardware access here: the slice is set up by PTBoard::init()
+    CVOutputState(uint p) : pin(p), slice(pwm_gpio_to_slice_num(p)), channel(pwm_gpio_to_channel(p)) {}
 
-        pwm_config config = pwm_get_default_config();
-        pwm_config_set_clkdiv(&config, 1.0f);
-        pwm_config_set_wrap(&config, 65535);
-        pwm_init(slice, &config, true);
-
-        setLevel(current_level);
-    }
+    void begin() { setLevel(current_level); }
 
     void setVoltage(float voltage)
     {
@@ -321,6 +380,28 @@ struct CVOutputState
 CVOutputState g_cv_out1(CV_OUT1_PIN);
 CVOutputState g_cv_out2(CV_OUT2_PIN);
 
+/**
+ * @brief Advance the sequencer one step and update the outputs
+ * Shared by the internal clock and external gate sync
+ */
+void advanceSequencer(uint32_t now, uint32_t step_us)
+{
+    const PTStepEvent &step = g_sequencer.advance(step_us);
+    g_step_start_time = now;
+
+    // Output CV for current step
+    g_cv_out1.setVoltage(EurorackUtils::Fixed::q16ToVolts(EurorackQuantizer::NOTE_PITCH_Q16[step.note]));
+
+    // Trigger modulation envelope; the gate output follows g_sequencer.gateAt()
+    if (step.gate)
+    {
+        g_cv2_envelope.trigger();
+    }
+
+    // Generate sequence step event
+    g_event_queue.push(EurorackEvent::SEQUENCE_STEP, step.step);
+}
+
 /**
  * @brief Hardware Input Polling Thread
  * Polls all hardware inputs and generates events
@@ -382,15 +463,21 @@ private:
     uint32_t led_blink_time = 0;
 
 public:
-    UIThread() : SimpleThread("UI") {}
+    UIThread() : SimpleThread("UI")
+    {
+        // Sleeps until the controls change
+        subscribe(SimpleEvent::bit(EurorackEvent::ENCODER_TURN) |
+                  SimpleEvent::bit(EurorackEvent::BUTTON_PRESS) |
+                  SimpleEvent::bit(EurorackEvent::BUTTON_RELEASE));
+    }
 
     void execute() override
     {
-        EurorackEvent event;
+        const SimpleEvent *events = getEvents();
 
-        // Process all pending events
-        while (g_event_queue.pop(event))
+        for (uint32_t i = 0; i < getEventCount(); i++)
         {
+            const SimpleEvent &event = events[i];
             switch (event.type)
             {
             case EurorackEvent::ENCODER_TURN:
@@ -408,8 +495,8 @@ public:
                 else
                 {
                     // Adjust sequence length
-                    g_sequence_length += delta;
-                    g_sequence_length = EurorackUtils::Math::constrain((float)g_sequence_length, 1.0f, 16.0f);
+                    PTPattern &pattern = g_sequencer.getCurrentPattern();
+                    pattern.length = EurorackUtils::Math::clamp((int)pattern.length + (int)delta, 1, 16);
                 }
 
                 // Blink LED to indicate parameter change
@@ -426,14 +513,18 @@ public:
                 }
                 else if (event.data == BUTTON1_PIN)
                 {
-                    // Start/Stop sequencer
+                    // Start/Stop sequencer, storing the pattern bank on stop
                     g_sequencer_running = !g_sequencer_running;
                     gpio_put(LED2_PIN, g_sequencer_running);
+                    if (!g_sequencer_running)
+                    {
+                        saveSettings();
+                    }
                 }
                 else if (event.data == BUTTON2_PIN)
                 {
                     // Reset sequencer
-                    g_current_step = 0;
+                    g_sequencer.reset(g_sequencer.getCurrentPatternIndex());
                     gpio_put(LED3_PIN, true);
                     led_blink_time = time_us_32();
                 }
@@ -454,13 +545,14 @@ public:
             }
         }
 
-        // Turn off LED blink after 100ms
+        // Turn off LED blink after 100ms, waking every 10ms until then
         if (led_blink_time > 0 && (time_us_32() - led_blink_time) > 100000)
         {
             gpio_put(LED1_PIN, false);
             gpio_put(LED3_PIN, false);
             led_blink_time = 0;
         }
+        setInterval(led_blink_time > 0 ? 10 : 0);
     }
 };
 
@@ -486,28 +578,26 @@ public:
 
     void execute() override
     {
+        uint32_t now = time_us_32();
+
+        // Gate output follows the step's gate length and ratchets
+        bool gate = g_sequencer.gateAt(now - g_step_start_time);
+        if (gate != g_gate_output.active)
+        {
+            gate ? g_gate_output.setHigh() : g_gate_output.setLow();
+        }
+
         if (!g_sequencer_running)
         {
+            return; // Stepped by external sync instead
         }
 
-        uint32_t now = time_us_32();
         updateStepInterval();
 
         if (now - last_step_time >= step_interval_us)
         {
             last_step_time = now;
-
-            // Advance sequence step
-            g_current_step = (g_current_step + 1) % g_sequence_length;
-
-            // Output CV for current step
-            g_cv_out1.setVoltage(g_sequence_voltages[g_current_step]);
-
-            // Trigger gate output
-            g_gate_output.trigger();
-
-            // Generate sequence step event
-            g_event_queue.push(EurorackEvent::SEQUENCE_STEP, g_current_step);
+            advanceSequencer(now, step_interval_us);
         }
     }
 };
@@ -522,14 +612,18 @@ private:
     uint32_t last_gate_time = 0;
 
 public:
-    GateInputThread() : SimpleThread("GateInput") {}
+    GateInputThread() : SimpleThread("GateInput")
+    {
+        subscribe(SimpleEvent::bit(EurorackEvent::GATE_RISING));
+    }
 
     void execute() override
     {
-        EurorackEvent event;
+        const SimpleEvent *events = getEvents();
 
-        while (g_event_queue.pop(event))
+        for (uint32_t i = 0; i < getEventCount(); i++)
         {
+            const SimpleEvent &event = events[i];
             if (event.type == EurorackEvent::GATE_RISING)
             {
                 uint32_t now = event.timestamp;
@@ -549,9 +643,7 @@ public:
                 // External sync mode - advance sequencer if not running internally
                 if (!g_sequencer_running)
                 {
-                    g_current_step = (g_current_step + 1) % g_sequence_length;
-                    g_cv_out1.setVoltage(g_sequence_voltages[g_current_step]);
-                    g_gate_output.trigger();
+                    advanceSequencer(now, (uint32_t)(60000000.0f / g_tempo_bpm));
                 }
             }
         }
@@ -582,13 +674,10 @@ public:
             // Sample CV inputs and update sequence
             adc_select_input(0);
             uint16_t cv1_raw = adc_read();
-            float cv1_voltage = EurorackUtils::CV::adcToEurorackVoltage(cv1_raw);
+            uint8_t cv1_note = g_quantizer.quantizeNote(cv1_raw);
 
-            // Update current step voltage with CV input 1
-            if (g_current_step < 16)
-            {
-                g_sequence_voltages[g_current_step] = cv1_voltage;
-            }
+            // Update current step note with quantized CV input 1
+            g_sequencer.getCurrentPattern().steps[g_sequencer.getCurrentStep()].setNote(cv1_note);
 
             // Process CV input 2 for modulation (could control tempo, etc.)
             adc_select_input(1);
@@ -625,20 +714,18 @@ public:
         {
             last_update_time = now;
 
-            // Update gate outputs (for timed gates)
-            g_gate_output.update();
-
             // Update status LED based on sequencer state
             if (g_sequencer_running)
             {
                 // Blink LED in sync with sequence steps
-                bool led_state = (g_current_step % 2) == 0;
+                bool led_state = (g_sequencer.getCurrentStep() % 2) == 0;
                 gpio_put(LED2_PIN, led_state);
             }
 
-            // Output second CV channel with modulated value
-            float cv2_out = g_sequence_voltages[g_current_step] * 0.5f; // Harmonic
-            g_cv_out2.setVoltage(cv2_out);
+            // Output second CV channel from the step envelope
+            int16_t envelope;
+            g_cv2_envelope.process(&envelope, 1);
+            g_cv_out2.setLevel(EurorackUtils::Fixed::sampleToDAC(envelope));
         }
     }
 };
@@ -668,12 +755,14 @@ public:
             static uint32_t status_count = 0;
             if ((status_count++ % 4) == 0)
             { // Print every 4th update (1 second)
-                printf("Tempo: %.1f BPM | Step: %d/%d | Running: %s | CV1: %.2fV\n",
+                printf("Tempo: %.1f BPM | Step: %d/%d | Running: %s | CV1: %.2fV | Events: max %u, dropped %lu\n",
                        g_tempo_bpm,
-                       g_current_step + 1,
-                       g_sequence_length,
+                       g_sequencer.getCurrentStep() + 1,
+                       g_sequencer.getCurrentPattern().length,
                        g_sequencer_running ? "YES" : "NO",
-                       g_cv_out1.getVoltage());
+                       g_cv_out1.getVoltage(),
+                       (unsigned)g_event_queue.getMaxDepth(),
+                       (unsigned long)g_event_queue.getDroppedTotal());
             }
         }
     }
@@ -684,51 +773,26 @@ void init_hardware()
 {
     stdio_init_all();
 
-    // Initialize GPIO pins
-    gpio_init(LED1_PIN);
-    gpio_init(LED2_PIN);
-    gpio_init(LED3_PIN);
-    gpio_set_dir(LED1_PIN, GPIO_OUT);
-    gpio_set_dir(LED2_PIN, GPIO_OUT);
-    gpio_set_dir(LED3_PIN, GPIO_OUT);
-
-    // Initialize encoder pins
-    gpio_init(ENCODER1_A_PIN);
-    gpio_init(ENCODER1_B_PIN);
-    gpio_init(ENCODER1_BTN_PIN);
-    gpio_set_dir(ENCODER1_A_PIN, GPIO_IN);
-    gpio_set_dir(ENCODER1_B_PIN, GPIO_IN);
-    gpio_set_dir(ENCODER1_BTN_PIN, GPIO_IN);
-    gpio_pull_up(ENCODER1_A_PIN);
-    gpio_pull_up(ENCODER1_B_PIN);
-    gpio_pull_up(ENCODER1_BTN_PIN);
-
-    // Initialize button pins
-    gpio_init(BUTTON1_PIN);
-    gpio_init(BUTTON2_PIN);
-    gpio_set_dir(BUTTON1_PIN, GPIO_IN);
-    gpio_set_dir(BUTTON2_PIN, GPIO_IN);
-    gpio_pull_up(BUTTON1_PIN);
-    gpio_pull_up(BUTTON2_PIN);
-
-    // Initialize gate pins
-    gpio_init(GATE_IN_PIN);
-    gpio_init(GATE_OUT_PIN);
-    gpio_set_dir(GATE_IN_PIN, GPIO_IN);
-    gpio_set_dir(GATE_OUT_PIN, GPIO_OUT);
-    gpio_pull_down(GATE_IN_PIN);
-    gpio_put(GATE_OUT_PIN, false);
-
-    // Initialize ADC for CV inputs
-    adc_init();
-    adc_gpio_init(CV_IN1_PIN);
-    adc_gpio_init(CV_IN2_PIN);
+    // Every pin, the ADC and the PWM slices, from the board description
+    PTBoard::init(BOARD);
+    g_cv_out1.begin();
+    g_cv_out2.begin();
 
     // Initialize sequence with default values (chromatic scale)
+    PTPattern &pattern = g_sequencer.getPattern(0);
     for (int i = 0; i < 16; i++)
     {
-        g_sequence_voltages[i] = (float)i / 12.0f; // 1V per octave, semitone steps
+        pattern.steps[i].setNote(60 + i); // 1V per octave, semitone steps from 0V
     }
+    pattern.length = 8;
+
+    // Restore tempo and patterns saved on the last stop
+    g_storage.mount();
+    loadSettings();
+
+    // Short attack, decay within a step at 120 BPM
+    g_cv2_envelope.setAttack(10.0f);
+    g_cv2_envelope.setDecay(300.0f);
 }
 
 int main()
@@ -762,8 +826,16 @@ int main()
 
     printf("Starting scheduler with %d threads...\n", scheduler.getThreadCount());
 
-    // Run the scheduler
-    scheduler.run();
+    // Hand queued events to their subscribers (UI, gate input), then run a pass
+    while (true)
+    {
+        EurorackEvent event;
+        while (g_event_queue.pop(event))
+        {
+            scheduler.post(event.type, event.data, event.timestamp);
+        }
+        scheduler.run();
+    }
 
     return 0;
 }
@@ -19,38 +19,53 @@
 
 #include "framework/pt_thread.h"
 #include "framework/eurorack_hardware.h"
+#include "framework/eurorack_board_default.h"
 #include "framework/eurorack_utils.h"
 
-// Hardware pin definitions (adjust for your hardware)
-#define ENCODER1_A_PIN 2
-#define ENCODER1_B_PIN 3
-#define ENCODER1_BTN_PIN 4
-
-#define BUTTON1_PIN 5
-#define BUTTON2_PIN 6
-
-#define LED1_PIN 25 // Onboard LED
-#define LED2_PIN 15
-#define LED3_PIN 16
-
-#define CV_IN1_PIN 26  // ADC0
-#define CV_IN2_PIN 27  // ADC1
-#define CV_OUT1_PIN 20 // PWM
-#define CV_OUT2_PIN 21 // PWM
-
-#define GATE_IN_PIN 7
-#define GATE_OUT_PIN 8
-
-// Global hardware objects
-PTEncoder encoder1(ENCODER1_A_PIN, ENCODER1_B_PIN, ENCODER1_BTN_PIN);
-PTButton button1(BUTTON1_PIN);
-PTButton button2(BUTTON2_PIN);
-PTCVInput cv_in1(CV_IN1_PIN);
-PTCVInput cv_in2(CV_IN2_PIN);
-PTCVOutput cv_out1(CV_OUT1_PIN);
-PTCVOutput cv_out2(CV_OUT2_PIN);
-PTGateInput gate_in(GATE_IN_PIN);
-PTGateOutput gate_out(GATE_OUT_PIN);
+// Pin assignments come from the board description; edit the pin list in
+// framework/eurorack_board_default.h for your hardware
+static constexpr const auto &BOARD = EurorackBoards::DEFAULT_BOARD;
+using PTBoard::Role;
+
+static constexpr uint ENCODER1_A_PIN = BOARD.gpio(Role::ENCODER_A);
+static constexpr uint ENCODER1_B_PIN = BOARD.gpio(Role::ENCODER_B);
+static constexpr uint ENCODER1_BTN_PIN = BOARD.gpio(Role::ENCODER_BUTTON);
+
+static constexpr uint BUTTON1_PIN = BOARD.gpio(Role::BUTTON, 0);
+static constexpr uint BUTTON2_PIN = BOARD.gpio(Role::BUTTON, 1);
+
+static constexpr uint LED1_PIN = BOARD.gpio(Role::LED, 0); // Onboard LED
+static constexpr uint LED2_PIN = BOARD.gpio(Role::LED, 1); // External LEDs
+static constexpr uint LED3_PIN = BOARD.gpio(Role::LED, 2);
+
+static constexpr uint CV_IN1_PIN = BOARD.gpio(Role::CV_IN, 0);
+static constexpr uint CV_IN2_PIN = BOARD.gpio(Role::CV_IN, 1);
+static constexpr uint CV_OUT1_PIN = BOARD.gpio(Role::CV_OUT, 0);
+static constexpr uint CV_OUT2_PIN = BOARD.gpio(Role::CV_OUT, 1);
+
+static constexpr uint GATE_IN_PIN = BOARD.gpio(Role::GATE_IN);
+static constexpr uint GATE_OUT_PIN = BOARD.gpio(Role::GATE_OUT);
+
+// Global hardware objects; set up in main() by PTBoard::init(), not here
+PTEncoder encoder1(ENCODER1_A_PIN, ENCODER1_B_PIN, ENCODER1_BTN_PIN, false);
+PTButton button1(BUTTON1_PIN, true, 50000, false);
+PTButton button2(BUTTON2_PIN, true, 50000, false);
+PTCVInput cv_in1(CV_IN1_PIN, 50, false);
+PTCVInput cv_in2(CV_IN2_PIN, 50, false);
+PTCVOutput cv_out1(CV_OUT1_PIN, false);
+PTCVOutput cv_out2(CV_OUT2_PIN, false);
+PTGateInput gate_in(GATE_IN_PIN, true, false);
+PTGateOutput gate_out(GATE_OUT_PIN, true, 10000, false);
+
+// Edge interrupt dispatch, one handler per input pin of the board
+static constexpr auto EDGES = PTBoard::makeEdgeTable(
+    BOARD,
+    PTBoard::bind(Role::ENCODER_A, 0, PTEncoder::onEdge, &encoder1),
+    PTBoard::bind(Role::ENCODER_BUTTON, 0, PTEncoder::onEdge, &encoder1),
+    PTBoard::bind(Role::BUTTON, 0, PTButton::onEdge, &button1),
+    PTBoard::bind(Role::BUTTON, 1, PTButton::onEdge, &button2),
+    PTBoard::bind(Role::GATE_IN, 0, PTGateInput::onEdge, &gate_in));
+PT_EDGE_CHECK(BOARD, EDGES);
 
 // Global variables
 volatile float tempo_bpm = 120.0f;
@@ -395,13 +410,9 @@ int main()
 {
     stdio_init_all();
 
-    // Initialize hardware
-    gpio_init(LED1_PIN);
-    gpio_init(LED2_PIN);
-    gpio_init(LED3_PIN);
-    gpio_set_dir(LED1_PIN, GPIO_OUT);
-    gpio_set_dir(LED2_PIN, GPIO_OUT);
-    gpio_set_dir(LED3_PIN, GPIO_OUT);
+    // Initialize hardware: every pin from the board description, with the
+    // edge interrupts routed through the board's single GPIO callback
+    PTBoard::init(BOARD, EDGES);
 
     // Initialize sequence with default values
     for (int i = 0; i < 16; i++)
@@ -7,11 +7,17 @@
  * - Inter-thread communication using events
  * - Pattern switching based on signals between threads
  * - State machine approach for reliable operation
+ * - With PT_USB_MIDI (cmake -DPT_USB_MIDI=ON): a USB-MIDI device that
+ *   echoes the notes it receives back to the computer
  */
 
 #include "pico/stdlib.h"
 #include "hardware/gpio.h"
 #include "framework/pt_thread.h"
+#include "framework/pt_monitor.h"
+#if PT_USB_MIDI
+#include "framework/eurorack_usb_midi.h"
+#endif
 #include <cstdio>
 
 // LED pin definition (using onboard LED)
@@ -20,6 +26,9 @@
 // Custom event types for pattern switching
 #define PATTERN_SWITCH_EVENT PTEventType::USER_EVENT
 
+// CPU load, stack/heap and event queue monitor
+static PTMonitor monitor;
+
 /**
  * @brief Fast blink pattern thread using state machine approach
  * Creates rapid LED blinking with short pauses
@@ -261,6 +270,59 @@ private:
     }
 };
 
+#if PT_USB_MIDI
+/**
+ * @brief Services the USB-MIDI device every millisecond and echoes received notes
+ * Its events go to a queue of its own, as the blink threads drain the scheduler's
+ */
+class UsbMidiThread : public PTThread
+{
+private:
+    PTMidiUsb &usb_midi;
+    PTEventQueue midi_events;
+    uint32_t last_poll_time;
+    uint32_t notes_received;
+
+public:
+    UsbMidiThread(PTMidiUsb &usb_midi)
+        : PTThread("UsbMidi"), usb_midi(usb_midi), last_poll_time(0), notes_received(0)
+    {
+        usb_midi.setEventQueue(&midi_events);
+    }
+
+    int run() override
+    {
+        uint32_t now = time_us_32();
+        if ((now - last_poll_time) < 1000)
+            return PT_WAITING;
+        last_poll_time = now;
+
+        usb_midi.poll(); // tud_task(), then packets through PTMidiInput's parser
+        PTEvent event;
+        while (midi_events.pop(event))
+        {
+            uint8_t channel = EurorackMidi::eventChannel(event.data);
+            uint8_t note = EurorackMidi::eventData1(event.data);
+            if (event.type == PTEventType::MIDI_NOTE_ON)
+            {
+                usb_midi.sendNoteOn(channel, note, EurorackMidi::eventData2(event.data));
+                notes_received++;
+            }
+            else if (event.type == PTEventType::MIDI_NOTE_OFF)
+            {
+                usb_midi.sendNoteOff(channel, note);
+            }
+        }
+        return PT_WAITING;
+    }
+
+    uint32_t getNotesReceived() const { return notes_received; }
+};
+
+static PTMidiUsb usb_midi;
+static UsbMidiThread *usb_midi_thread = nullptr;
+#endif
+
 /**
  * @brief Status reporting thread using simple timer
  * Periodically reports system status
@@ -290,6 +352,12 @@ public:
             printf("Uptime: %.1f seconds\n", (float)now / 1000000.0f);
             printf("LED State: %s\n", gpio_get(LED_PIN) ? "ON" : "OFF");
             printf("Event Queue Size: %zu\n", event_queue ? event_queue->size() : 0);
+#if PT_USB_MIDI
+            printf("USB MIDI: %s, %lu notes echoed\n", usb_midi.isMounted() ? "mounted" : "no host",
+                   usb_midi_thread ? usb_midi_thread->getNotesReceived() : 0);
+#endif
+            monitor.update();
+            monitor.report();
             printf("==========================\n\n");
             last_report_time = now;
         }
@@ -299,8 +367,14 @@ public:
 };
 int main()
 {
+    // Paint the stacks before anything else uses them
+    monitor.paintStacks();
+
     // Initialize system
     stdio_init_all();
+#if PT_USB_MIDI
+    usb_midi.init(); // tusb_init(); USB stdio is off, the descriptors are framework/usb's
+#endif
 
     // Initialize LED pin
     gpio_init(LED_PIN);
@@ -335,6 +409,13 @@ int main()
     scheduler.addThread(&fast_thread);
     scheduler.addThread(&slow_thread);
     scheduler.addThread(&status_thread);
+#if PT_USB_MIDI
+    UsbMidiThread midi_thread(usb_midi);
+    usb_midi_thread = &midi_thread;
+    scheduler.addThread(&midi_thread);
+#endif
+    monitor.watchCore(0, &scheduler);
+    monitor.watchQueue(scheduler.getEventQueue());
 
     printf("All threads initialized and added to scheduler.\n");
     printf("Starting main execution loop...\n\n");
@@ -8,6 +8,10 @@
 #include "pico/stdlib.h"
 #include "framework/simple_threads.h"
 #include "framework/eurorack_utils.h"
+#include "framework/pt_monitor.h"
+
+// CPU load, stack and heap monitor
+static PTMonitor monitor;
 
 /**
  * @brief Fast blink thread - creates rapid LED blinking
@@ -108,7 +112,8 @@ public:
         printf("\n=== System Status #%lu ===\n", status_count);
         printf("Uptime: %lu ms\n", EurorackUtils::Timing::getMillis());
         printf("LED State: %s\n", EurorackUtils::LED::getState() ? "ON" : "OFF");
-        printf("Core0 temp: ~%.1f°C (estimated)\n", 27.0f + (float)(EurorackUtils::Timing::getMillis() % 100) / 100.0f * 3.0f);
+        monitor.update();
+        monitor.report();
         printf("===========================\n\n");
     }
 };
@@ -158,6 +163,9 @@ public:
 
 int main()
 {
+    // Paint the stacks before anything else uses them
+    monitor.paintStacks();
+
     // Initialize the system
     EurorackUtils::init();
 
@@ -193,6 +201,7 @@ int main()
     scheduler.addThread(&slow_pulse);
     scheduler.addThread(&status);
     scheduler.addThread(&control);
+    monitor.watchCore(0, &scheduler);
 
     printf("All threads initialized successfully!\n");
     printf("Starting main execution loop...\n\n");
@@ -0,0 +1,211 @@
+#!/usr/bin/env python3
+"""
+SRAM placement report and check for RP2040 firmware.
+
+Reads a linked ELF and lists the functions that run from SRAM
+(PT_TIME_CRITICAL and the SDK's __not_in_flash_func code) with their
+sizes, plus the SRAM/flash totals, so the cost of moving code out of
+XIP flash is visible on every build. It also lists the framework's
+tables (data objects in --scope) by placement: those in SRAM
+(PT_TIME_CRITICAL_DATA) and those still in flash, which time-critical
+code must not read.
+
+With --check, exits non-zero if a framework function placed in SRAM
+calls a function that is still in flash, either directly or through a
+linker long-branch veneer (__<callee>_veneer, as GNU ld names them).
+Such a call brings back the XIP cache miss the placement was meant to
+avoid. --warn runs the same check but only prints the calls it finds,
+as warnings. tools/pt_placement_test.py runs the check on fixture
+arm-none-eabi nm/objdump output in tools/fixtures/.
+
+The check only follows direct branches (bl/b to a fixed address) found
+by disassembling the SRAM functions. Indirect calls, through a register
+(blx/bx), are invisible to it: virtual calls such as PTThread::run(),
+function-pointer hooks (PTEventQueue::OverflowHook, the GPIO dispatch
+table, SDK callbacks) and calls through the ROM function tables. A
+time-critical function that calls through a pointer can still land in
+flash with the check passing; mark every possible target
+PT_TIME_CRITICAL by hand.
+
+Each --group LABEL=REGEX adds a code size line: the bytes of every
+function matching REGEX, wherever it is placed, e.g. to compare the
+interrupt path of two implementations. --groups-only prints just those
+lines, which also works on host binaries (--nm nm).
+
+Usage:
+    pt_placement.py [--nm NM] [--objdump OBJDUMP] [--check | --warn]
+                    [--scope REGEX] [--allow REGEX ...]
+                    [--group LABEL=REGEX ...] [--groups-only] firmware.elf
+"""
+
+import argparse
+import bisect
+import re
+import subprocess
+import sys
+
+FLASH = (0x10000000, 0x11000000)
+SRAM = (0x20000000, 0x20042000)
+
+# Callers that must stay in SRAM: the framework's own classes and namespaces
+DEFAULT_SCOPE = r"^(PT|Simple|Eurorack)"
+
+CODE_TYPES = "tTwW"
+DATA_TYPES = "dDrRuvV"  # Including GNU unique (u) and weak (v, V) objects: inline variables
+
+# "20000012:\tbl\t10000100 <memcpy>"; the name runs to the end of the line as
+# demangled templates contain '>'
+BRANCH_RE = re.compile(r"^\s*([0-9a-f]+):\s+(bl|b|b\.n|b\.w|b[a-z]{2}(?:\.[nw])?)\s+([0-9a-f]+)\s+<(.+)>\s*$")
+
+
+def in_range(address, region):
+    return region[0] <= address < region[1]
+
+
+def run(command):
+    try:
+        return subprocess.run(command, check=True, capture_output=True, text=True).stdout
+    except (OSError, subprocess.CalledProcessError) as error:
+        sys.exit("pt_placement: failed to run %s: %s" % (command[0], error))
+
+
+def read_symbols(nm, elf):
+    """Sized, defined symbols as (address, size, type, demangled name)."""
+    symbols = []
+    for line in run([nm, "-S", "-C", "--defined-only", elf]).splitlines():
+        parts = line.split(None, 3)
+        if len(parts) != 4:
+            continue
+        address, size, kind, name = parts
+        symbols.append((int(address, 16), int(size, 16), kind, name))
+    return symbols
+
+
+def report(symbols, scope):
+    ram_code = sorted((s for s in symbols if s[2] in CODE_TYPES and in_range(s[0], SRAM)),
+                      key=lambda s: -s[1])
+    flash_code = sum(s[1] for s in symbols if s[2] in CODE_TYPES and in_range(s[0], FLASH))
+    ram_data = sum(s[1] for s in symbols if s[2] in DATA_TYPES and in_range(s[0], SRAM))
+    ram_bss = sum(s[1] for s in symbols if s[2] in "bB" and in_range(s[0], SRAM))
+
+    print("SRAM code:")
+    for address, size, _, name in ram_code:
+        print("  %08x %6d  %s" % (address, size, name))
+
+    for label, region in (("SRAM", SRAM), ("flash", FLASH)):
+        tables = sorted((s for s in symbols
+                         if s[2] in DATA_TYPES and s[1] > 0 and in_range(s[0], region) and scope.search(s[3])),
+                        key=lambda s: -s[1])
+        print("Framework tables in %s:" % label)
+        for address, size, _, name in tables:
+            print("  %08x %6d  %s" % (address, size, name))
+
+    print("Totals: SRAM code %d bytes in %d functions, flash code %d bytes, "
+          "SRAM data %d bytes, SRAM bss %d bytes"
+          % (sum(s[1] for s in ram_code), len(ram_code), flash_code, ram_data, ram_bss))
+    return ram_code
+
+
+def report_groups(symbols, groups):
+    """Print the code size of each (label, regex) group of functions."""
+    print("Code size:")
+    for label, pattern in groups:
+        seen = set()
+        members = []
+        for address, size, kind, name in symbols:
+            # Aliases (e.g. complete/base destructors) share an address
+            if kind in CODE_TYPES and size > 0 and address not in seen and pattern.search(name):
+                seen.add(address)
+                members.append((name, size))
+        total = sum(size for _, size in members)
+        detail = ", ".join("%s %d" % (name.split("(")[0], size) for name, size in members)
+        print("  %-28s %6d bytes  %s" % (label, total, detail or "(no match)"))
+
+
+def check(objdump, elf, ram_code, scope, allow):
+    """Return (caller, callee, address) for each SRAM -> flash call in scope."""
+    functions = sorted((s[0], s[0] + s[1], s[3]) for s in ram_code if s[1] > 0)
+    starts = [f[0] for f in functions]
+
+    # RAM code is linked into .data (and the scratch banks), among the
+    # variables, so the sections are disassembled whole (-D) and only
+    # branches inside sized SRAM functions count. Literal pools print as
+    # .word thanks to the ARM mapping symbols.
+    listing = run([objdump, "-D", "-C", "--no-show-raw-insn",
+                   "-j", ".data", "-j", ".scratch_x", "-j", ".scratch_y", elf])
+
+    violations = []
+    for line in listing.splitlines():
+        match = BRANCH_RE.match(line)
+        if not match:
+            continue
+        address = int(match.group(1), 16)
+        target = int(match.group(3), 16)
+        callee = match.group(4)
+
+        index = bisect.bisect_right(starts, address) - 1
+        if index < 0 or address >= functions[index][1]:
+            continue
+        start, end, caller = functions[index]
+        if start <= target < end or not scope.search(caller):
+            continue
+
+        into_flash = in_range(target, FLASH) or callee.endswith("_veneer")
+        if into_flash and not any(pattern.search(callee) for pattern in allow):
+            violations.append((caller, callee, address))
+    return violations
+
+
+def main():
+    parser = argparse.ArgumentParser(description="SRAM placement report and check")
+    parser.add_argument("elf")
+    parser.add_argument("--nm", default="arm-none-eabi-nm")
+    parser.add_argument("--objdump", default="arm-none-eabi-objdump")
+    parser.add_argument("--check", action="store_true",
+                        help="fail if time-critical framework code calls into flash (direct calls only)")
+    parser.add_argument("--warn", action="store_true",
+                        help="run the --check analysis but only warn about what it finds")
+    parser.add_argument("--scope", default=DEFAULT_SCOPE,
+                        help="regex selecting the SRAM functions to check (default: %(default)s)")
+    parser.add_argument("--allow", action="append", default=[],
+                        help="regex of flash callees to accept, may be repeated")
+    parser.add_argument("--group", action="append", default=[], metavar="LABEL=REGEX",
+                        help="report the code size of the functions matching REGEX, may be repeated")
+    parser.add_argument("--groups-only", action="store_true",
+                        help="print only the --group sizes (no placement report or check)")
+    args = parser.parse_args()
+
+    groups = []
+    for group in args.group:
+        label, separator, pattern = group.partition("=")
+        if not separator:
+            parser.error("--group needs LABEL=REGEX, got %r" % group)
+        groups.append((label, re.compile(pattern)))
+
+    symbols = read_symbols(args.nm, args.elf)
+    if args.groups_only:
+        report_groups(symbols, groups)
+        return 0
+
+    scope = re.compile(args.scope)
+    ram_code = report(symbols, scope)
+    if groups:
+        report_groups(symbols, groups)
+    if not args.check and not args.warn:
+        return 0
+
+    violations = check(args.objdump, args.elf, ram_code, scope,
+                       [re.compile(pattern) for pattern in args.allow])
+    severity = "error" if args.check else "warning"
+    for caller, callee, address in violations:
+        print("%s: time-critical %s calls %s in flash (at %08x)" % (severity, caller, callee, address),
+              file=sys.stderr)
+    if violations:
+        print("pt_placement: %d direct call(s) from SRAM into flash; mark the callee PT_TIME_CRITICAL "
+              "or make it inline" % len(violations), file=sys.stderr)
+        return 1 if args.check else 0
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,123 @@
+#!/usr/bin/env python3
+"""
+Host test of pt_placement.py --check and --warn.
+
+Runs the script with nm and objdump replaced by the fixture output in
+tools/fixtures/ (the format of arm-none-eabi-nm -S -C and
+arm-none-eabi-objdump -D -C --no-show-raw-insn). The fixture firmware has
+time-critical functions that call, from SRAM:
+  - memcpy in flash, directly
+  - time_us_64 in flash through a long-branch veneer in SRAM
+  - a template in flash, whose demangled name contains '>'
+  - main in flash, as a tail call (b.w) from the .scratch_x bank
+  - panic in flash, which the test accepts with --allow
+and calls that are fine: to other SRAM functions, branches inside the
+function, an indirect blx, and a flash call from __wrap_memset, which
+is outside the default scope. The report must list the framework's
+sine table in SRAM and its CRC table in flash, and not the SDK's data.
+
+Usage: pt_placement_test.py (exit status 1 on a failed check)
+"""
+
+import os
+import stat
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+FIXTURES = os.path.join(HERE, "fixtures")
+
+EXPECTED = [
+    "time-critical PTEventQueue::push(PTEvent const&) calls memcpy in flash (at 20000012)",
+    "time-critical PTGateInput::handleEdge() calls __time_us_64_veneer in flash (at 20000034)",
+    "time-critical PTGateInput::handleEdge() calls int Fixed::mul<16>(int, int) in flash (at 2000003c)",
+    "time-critical PTScheduler::coreOneEntry() calls main in flash (at 20040006)",
+]
+PANIC = "time-critical PTEncoder::handleEncoderChange() calls panic in flash (at 2000004c)"
+
+failures = 0
+
+
+def check(ok, what):
+    global failures
+    print("%-64s %s" % (what, "ok" if ok else "FAILED"))
+    if not ok:
+        failures += 1
+
+
+def fake_tool(directory, name, fixture):
+    """An executable that prints a fixture whatever its arguments."""
+    path = os.path.join(directory, name)
+    with open(path, "w") as tool:
+        tool.write("#!/bin/sh\ncat '%s'\n" % os.path.join(FIXTURES, fixture))
+    os.chmod(path, os.stat(path).st_mode | stat.S_IXUSR)
+    return path
+
+
+def run(tools, *args):
+    """Return (exit status, stderr lines) of pt_placement.py on the fixture."""
+    command = [sys.executable, os.path.join(HERE, "pt_placement.py"),
+               "--nm", tools[0], "--objdump", tools[1]] + list(args) + ["firmware.elf"]
+    result = subprocess.run(command, capture_output=True, text=True)
+    return result.returncode, result.stderr.splitlines()
+
+
+def report(tools):
+    """Return the stdout lines of pt_placement.py's report on the fixture."""
+    command = [sys.executable, os.path.join(HERE, "pt_placement.py"),
+               "--nm", tools[0], "--objdump", tools[1], "firmware.elf"]
+    return subprocess.run(command, capture_output=True, text=True).stdout.splitlines()
+
+
+def findings(lines, severity):
+    prefix = severity + ": "
+    return sorted(line[len(prefix):] for line in lines if line.startswith(prefix))
+
+
+def main():
+    if len(sys.argv) > 1:
+        print("usage: %s" % sys.argv[0], file=sys.stderr)
+        return 1
+
+    with tempfile.TemporaryDirectory() as directory:
+        tools = (fake_tool(directory, "nm", "placement.nm"),
+                 fake_tool(directory, "objdump", "placement.objdump"))
+
+        status, lines = run(tools)
+        check(status == 0 and not lines, "report only: exit 0, no findings")
+
+        lines = report(tools)
+        sram = lines.index("Framework tables in SRAM:")
+        flash = lines.index("Framework tables in flash:")
+        check(lines[sram + 1:flash] == ["  200001c0    514  EurorackOscillators::SINE_TABLE"] and
+              lines[flash + 1] == "  10000400   1024  EurorackStorage::CRC_TABLE" and
+              lines[flash + 2].startswith("Totals:"),
+              "report: framework tables by placement, SDK data left out")
+
+        status, lines = run(tools, "--check", "--allow", "^panic$")
+        check(status == 1, "--check: exit 1 on calls into flash")
+        check(findings(lines, "error") == sorted(EXPECTED),
+              "--check: direct, veneer, template and tail calls, nothing else")
+
+        status, lines = run(tools, "--check")
+        check(status == 1 and findings(lines, "error") == sorted(EXPECTED + [PANIC]),
+              "--check without --allow: panic reported too")
+
+        allow = ["--allow", "^(panic|memcpy|main)$", "--allow", "_veneer$", "--allow", "Fixed::mul"]
+        status, lines = run(tools, "--check", *allow)
+        check(status == 0 and not findings(lines, "error"), "--check with every callee allowed: exit 0")
+
+        status, lines = run(tools, "--warn", "--allow", "^panic$")
+        check(status == 0 and findings(lines, "warning") == sorted(EXPECTED) and not findings(lines, "error"),
+              "--warn: same findings as warnings, exit 0")
+
+        status, lines = run(tools, "--check", "--scope", "^PTEncoder::")
+        check(status == 1 and findings(lines, "error") == [PANIC], "--scope limits the callers checked")
+
+    print("ok" if failures == 0 else "FAILED")
+    return 0 if failures == 0 else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())